@@ -0,0 +1,56 @@
+
+//
+// Copyright (c) 2013-2015, John Mettraux, jmettraux+flon@gmail.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// Made in Japan.
+//
+
+  // FNV-1a (64 bits), the stable ids of the examples, one implementation
+  // compiled into rodzo (--list) and spliced into the runtime
+  // (rdz_stable_id(), RDZ_LIST=1), both must yield the same ids
+
+#define RDZ_FNV_START 14695981039346656037ULL
+
+static unsigned long long rdz_fnv(unsigned long long h, const char *s)
+{
+  for (; *s; s++) { h ^= (unsigned char)*s; h *= 1099511628211ULL; }
+
+  return h;
+}
+
+static unsigned long long rdz_fnv_title(
+  unsigned long long h, const char *title, int ordinal)
+{
+  // a title, preceded by a separator (a 0 byte), followed by "#2", "#3",
+  // ... when an earlier sibling bears the same title
+
+  h *= 1099511628211ULL;
+  h = rdz_fnv(h, title);
+
+  if (ordinal < 2) return h;
+
+  char o[16]; int l = 0; o[l++] = '#';
+  char d[12]; int dl = 0; for (; ordinal > 0; ordinal /= 10) d[dl++] = '0' + ordinal % 10;
+  while (dl > 0) o[l++] = d[--dl];
+  o[l] = '\0';
+
+  return rdz_fnv(h, o);
+}
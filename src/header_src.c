@@ -27,8 +27,23 @@
    * rodzo header
    */
 
+  // the specs are compiled as c99 (see test*/tmp/Makefile), the runtime
+  // needs POSIX.1-2008 (sockets, clock_gettime(), open_memstream()...)
+  // and a few extensions (backtrace(), strsignal())
+
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+#ifndef _DARWIN_C_SOURCE
+#define _DARWIN_C_SOURCE
+#endif
+
 #include <ctype.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <strings.h>
@@ -37,16 +52,53 @@
 #include <glob.h>
 #include <errno.h>
 #include <sys/time.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <time.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef RDZ_CONCURRENT
+#include <pthread.h>
+#endif
+
+  // the runtime sections run from environment variables but only some
+  // specs need are compiled in when the spec is built with -DRDZ_WITH_x
+
+#if defined(RDZ_LEAKS) && ! defined(RDZ_WITH_MEMCHECK)
+#define RDZ_WITH_MEMCHECK 1 // the block count is only read by memcheck
+#endif
+#ifdef RDZ_WITH_REMOTE
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netdb.h>
+#include <poll.h>
+#endif
+#if defined(RDZ_WITH_SAMPLE) && (defined(__GLIBC__) || defined(__APPLE__))
+#define RDZ_SAMPLING 1
+#include <execinfo.h> // backtrace_symbols()
+#include <sys/ucontext.h>
+#ifdef __APPLE__
+#include <pthread.h> // pthread_get_stackaddr_np()
+#endif
+#endif
+#if defined(RDZ_WITH_BISECT) || defined(RDZ_WITH_MEMCHECK)
+#define RDZ_RERUN 1 // the spec re-executes itself
+#ifdef __APPLE__
+#include <mach-o/dyld.h> // _NSGetExecutablePath()
+#endif
+#endif
 
 
 int rdz_hexdump_on = 0;
 
-  // avoiding strdup and the posix_source requirement...
+  // avoiding strdup (and strlcpy, absent from older glibcs)...
 char *rdz_strdup(char *s)
 {
   size_t l = strlen(s) + 1;
   char *r = calloc(l, sizeof(char));
-  strlcpy(r, s, l);
+  memcpy(r, s, l);
   return r;
 }
 char *rdz_strndup(char *s, size_t n)
@@ -56,25 +108,51 @@ char *rdz_strndup(char *s, size_t n)
   return r;
 }
 
+void *rdz_let_set(int *set, void *let, const void *value, size_t size)
+{
+  // stores a let's value from within a call, two uses of a let in the
+  // same expression are then not unsequenced modifications
+
+  memcpy(let, value, size); *set = 1;
+  return let;
+}
+
 typedef double rdz_func();
 
-typedef struct rdz_node {
-  int dorun;
-  int nodenumber;
-  int parentnumber;
-  size_t depth;
-  int *children;
-  //int indent;
-  char type;
-  char *fname;
-  int lstart;
-  int ltstart;
-  int llength;
-  char *text;
-  rdz_func *func;
-} rdz_node;
-
-rdz_node **rdz_nodes = NULL;
+  // the spec tree is emitted by rodzo as flat static const tables,
+  // a node is known by its nodenumber, its index in each of the tables
+
+typedef struct rdz_tree {
+  int count;
+  const char *types;
+  const int *parents;
+  const int *depths;
+  const int *lstarts;
+  const int *ltstarts;
+  const int *llengths;
+  const int *coffsets; // where the node's children start in ->children
+  const int *ccounts; // how many children the node has
+  const int *children;
+  const int *texts; // offsets in ->strings
+  const int *fnames; // offsets in ->strings
+  const int *deps; // offsets in ->strings, the file and what it includes
+  const int *flags; // RDZ_F_CONCURRENT
+  const char *strings;
+  rdz_func *const *funcs;
+} rdz_tree;
+
+#define RDZ_F_CONCURRENT 1
+#define RDZ_F_STRESS 2
+#define RDZ_F_FUZZ 4
+
+const rdz_tree *rdz_t = NULL;
+int *rdz_doruns = NULL; // the only mutable part, one per node
+
+char *rdz_text(int n) { return (char *)rdz_t->strings + rdz_t->texts[n]; }
+char *rdz_fname(int n) { return (char *)rdz_t->strings + rdz_t->fnames[n]; }
+char *rdz_deps(int n) { return (char *)rdz_t->strings + rdz_t->deps[n]; }
+
+const int *rdz_children(int n) { return rdz_t->children + rdz_t->coffsets[n]; }
 
 //void rdz_print_node(rdz_node *n)
 //{
@@ -96,6 +174,7 @@ typedef struct rdz_result {
   int itnumber;
   int lnumber;
   int ltnumber;
+  char *memcheck; // the valgrind report, RDZ_VALGRIND=1
 } rdz_result;
 
 double rdz_now()
@@ -112,19 +191,19 @@ double rdz_duration(double start)
   return rdz_now() - start; // still ms
 }
 
-char *rdz_determine_title(rdz_node *n)
+char *rdz_determine_title(int n)
 {
   char **texts = calloc(128, sizeof(char *));
-  rdz_node *nn = n;
+  int nn = n;
   size_t i = 0;
   size_t l = 0;
 
   while (1)
   {
-    texts[i++] = nn->text;
-    l = l + strlen(nn->text) + 1;
-    if (nn->parentnumber < 1) break;
-    nn = rdz_nodes[nn->parentnumber];
+    texts[i++] = rdz_text(nn);
+    l = l + strlen(rdz_text(nn)) + 1;
+    if (rdz_t->parents[nn] < 1) break;
+    nn = rdz_t->parents[nn];
   }
 
   char *title = calloc(l + 1, sizeof(char));
@@ -133,9 +212,9 @@ char *rdz_determine_title(rdz_node *n)
   for (size_t ii = i - 1; ; ii--)
   {
     l = strlen(texts[ii]);
-    strlcpy(t, texts[ii], l);
+    memcpy(t, texts[ii], l);
     t = t + l;
-    strlcpy(t, " ", 1);
+    *t = ' ';
     t = t + 1;
     if (ii == 0) break;
   }
@@ -145,28 +224,29 @@ char *rdz_determine_title(rdz_node *n)
   return title;
 }
 
-rdz_result *rdz_result_malloc(
+rdz_result *rdz_result_init(
+  rdz_result *r,
   int success, char *msg, int itnumber, int lnumber, int ltnumber)
 {
-  rdz_node *n = rdz_nodes[itnumber];
-
-  rdz_result *r = calloc(1, sizeof(rdz_result));
   r->success = success;
   r->message = msg;
-  r->title = rdz_determine_title(n);
+  r->title = NULL;
   r->itnumber = itnumber;
   r->lnumber = lnumber;
   r->ltnumber = ltnumber;
+  r->memcheck = NULL;
+
+  if (success != 1) r->title = rdz_determine_title(itnumber);
+    // only pending and failures get their title listed in the summary
 
   return r;
 }
 
-void rdz_result_free(rdz_result *r)
+void rdz_result_clear(rdz_result *r)
 {
   free(r->message);
   free(r->title);
-
-  free(r);
+  free(r->memcheck);
 }
 
 #define RDZ_LINES_MAX 32
@@ -174,12 +254,58 @@ int *rdz_lines = NULL;
 char *rdz_example = NULL;
 #define RDZ_FILES_MAX 16
 char **rdz_files = NULL;
-int rdz_it = -1;
+char *rdz_sources = NULL;
+char *rdz_coverage = NULL;
+char *rdz_its = NULL; // I=6 or I=6,14,27
+int rdz_jobs = 1;
+int rdz_worker = 0;
+char *rdz_coordinator = NULL; // RDZ_COORDINATOR=/tmp/s.sock or :7001
+char *rdz_remote = NULL; // RDZ_WORKER=/tmp/s.sock or localhost:7001
+int rdz_remote_fd = -1; // the connection to the coordinator
+int rdz_list = 0; // RDZ_LIST=1, list the nodes, run nothing
+char *rdz_durations = NULL; // RDZ_DURATIONS=file, remembers the durations
+double *rdz_ran = NULL; // the durations of this run, one per node
+long rdz_repeat = 0; // RDZ_REPEAT=500
+int rdz_sample_hz = 0; // RDZ_SAMPLE=997
+char *rdz_trace = NULL; // RDZ_TRACE=trace.json
+#ifdef RDZ_CONCURRENT
+__thread
+#endif
+volatile int rdz_sample_node = 0; // what the samples get attributed to
+int rdz_until_fail = 0; // RDZ_UNTIL_FAIL=1
+int rdz_bisect = -1; // RDZ_BISECT=14, the failing example
+int rdz_bisect_fd = -1; // where a bisection run tells what failed
+int rdz_bisect_it = -1; // in a bisection run, the example bisected
+int rdz_valgrind = 0; // RDZ_VALGRIND=1
+char *rdz_leaky = NULL; // the examples that left the heap bigger
+char *rdz_corpus = NULL; // RDZ_CORPUS=dir, where the fuzz blocks find inputs
+double rdz_fuzz_timeout = 1000.0; // RDZ_FUZZ_TIMEOUT=ms, budget per input
+int rdz_update_snapshots = 0; // RDZ_UPDATE_SNAPSHOTS=1
+double rdz_bench_time = 300.0; // RDZ_BENCH_TIME=ms, per compare/benchmark
+int rdz_snap_written = 0;
+int rdz_snap_updated = 0;
+double rdz_conc_work = 0.0; // sum of the durations of the concurrent its
+double rdz_conc_wall = 0.0; // time it took to run them
 
 int rdz_count = 0;
 int rdz_fail_count = 0;
 int rdz_pending_count = 0;
-rdz_result **rdz_results = NULL;
+rdz_result *rdz_results = NULL;
+int rdz_results_size = 0;
+
+rdz_result *rdz_results_push()
+{
+  // the table is sized by rodzo from the ensure count, but a "with rows"
+  // or a looping ensure records more, so it grows as needed
+
+  if (rdz_count >= rdz_results_size)
+  {
+    rdz_results_size = rdz_results_size * 2 + 4;
+    rdz_results = realloc(rdz_results, rdz_results_size * sizeof(rdz_result));
+  }
+
+  return rdz_results + rdz_count++;
+}
 
 // PS1="\[\033[1;34m\][\$(date +%H%M)][\u@\h:\w]$\[\033[0m\] "
 //
@@ -192,13 +318,18 @@ rdz_result **rdz_results = NULL;
 // Brown       0;33     Yellow        1;33
 // Light Gray  0;37     White         1;37
 
+static int rdz_tty = -1;
+
 static int istty()
 {
+  if (rdz_tty > -1) return rdz_tty;
+    // determined once, workers (RDZ_JOBS) write to a file but stay colourful
+
   int rno = errno;
-  int r = isatty(1);
+  rdz_tty = isatty(1);
   errno = rno;
 
-  return r;
+  return rdz_tty;
 }
 
 char *rdz_rd() { return istty() ? "[0;31m" : ""; }
@@ -215,13 +346,15 @@ void rdz_print_level(int nodenumber)//, int min)
 {
   if (nodenumber < 0) return;
 
-  rdz_node *n = rdz_nodes[nodenumber];
-  if (n->depth == 0) return;
+  int depth = rdz_t->depths[nodenumber];
+  if (depth == 0) return;
 
-  for (size_t i = 0; i < n->depth - 1; i++) printf("  "); // indent
+  for (int i = 0; i < depth - 1; i++) printf("  "); // indent
 
-  printf("%s", n->text);
-  printf(" %sL=%d I=%d%s\n", rdz_gr(), n->ltstart, n->nodenumber, rdz_cl());
+  printf("%s", rdz_text(nodenumber));
+  printf(
+    " %sL=%d I=%d%s\n",
+    rdz_gr(), rdz_t->ltstarts[nodenumber], nodenumber, rdz_cl());
 }
 
 void rdz_duration_to_s(double duration, char *ca)
@@ -244,19 +377,21 @@ void rdz_print_result(rdz_result *r, double duration)
 {
   if (r == NULL) return;
 
-  rdz_node *rit = rdz_nodes[r->itnumber];
+  int depth = rdz_t->depths[r->itnumber];
 
-  for (size_t i = 0; i < rit->depth - 1; i++) printf("  "); // indent
+  for (int i = 0; i < depth - 1; i++) printf("  "); // indent
 
   char *co = rdz_gn();
   if (r->success == -1) co = rdz_yl();
   else if (r->success == 0) co = rdz_rd();
 
-  printf("%s%s", co, rit->text);
+  printf("%s%s", co, rdz_text(r->itnumber));
 
   if (r->success == -1) printf(" (PENDING: %s)", r->message);
   if (r->success == 0) printf(" (FAILED)");
 
+  if (rdz_ran && duration >= 0.0) rdz_ran[r->itnumber] = duration;
+
   char du[77]; rdz_duration_to_s(duration, du);
 
   printf(
@@ -496,19 +631,203 @@ char *rdz_string_contains(char *operator, char *result, char *expected)
     return r ? NULL : rdz_string_expected(result, "to contain", expected);
 }
 
+typedef struct rdz_job { // an "it" run on the thread pool
+  int n;
+  int count;
+  int size;
+  rdz_result *results; // its own, replayed in order once all are done
+  double duration;
+} rdz_job;
+
+#ifdef RDZ_CONCURRENT
+__thread rdz_job *rdz_job_current = NULL;
+
+typedef struct rdz_stress_site { // one per ensure line, not per iteration
+  int success;
+  char *message;
+  int itnumber;
+  int lnumber;
+  int ltnumber;
+  long iteration; // where it failed
+} rdz_stress_site;
+
+#define RDZ_STRESS_SITES_MAX 32
+
+typedef struct rdz_stress_thread { // an "it" threads(8) iterations(1000)
+  int thread;
+  long iterations;
+  long done;
+  double duration;
+  int count;
+  rdz_stress_site sites[RDZ_STRESS_SITES_MAX];
+  struct rdz_stress *stress;
+} rdz_stress_thread;
+
+__thread rdz_stress_thread *rdz_stress_current = NULL;
+
+static void rdz_stress_site_record(
+  rdz_stress_site *ss, int *count, long iteration,
+  int success, char *msg, int itnumber, int lnumber, int ltnumber)
+{
+  // keeps the first failure for the line, else the first success
+
+  for (int i = 0; i < *count; i++)
+  {
+    rdz_stress_site *s = ss + i;
+
+    if (s->lnumber != lnumber) continue;
+
+    if (s->success != 1 || success == 1) { free(msg); return; }
+
+    free(s->message); s->success = success; s->message = msg;
+    s->iteration = iteration;
+
+    return;
+  }
+
+  if (*count >= RDZ_STRESS_SITES_MAX) { free(msg); return; }
+
+  rdz_stress_site *s = ss + (*count)++;
+  s->success = success; s->message = msg; s->iteration = iteration;
+  s->itnumber = itnumber; s->lnumber = lnumber; s->ltnumber = ltnumber;
+}
+#endif
+
 void rdz_record(int success, char *msg, int itnumber, int lnumber, int ltnumber)
 {
-  rdz_result *result =
-    rdz_result_malloc(success, msg, itnumber, lnumber, ltnumber);
+#ifdef RDZ_CONCURRENT
+  rdz_stress_thread *st = rdz_stress_current;
+
+  if (st)
+  {
+    rdz_stress_site_record(
+      st->sites, &st->count, st->done,
+      success, msg, itnumber, lnumber, ltnumber);
+
+    return;
+  }
+
+  rdz_job *j = rdz_job_current;
+
+  if (j)
+  {
+    if (j->count >= j->size)
+    {
+      j->size = j->size * 2 + 4;
+      j->results = realloc(j->results, j->size * sizeof(rdz_result));
+    }
+    rdz_result_init(
+      j->results + j->count++, success, msg, itnumber, lnumber, ltnumber);
+
+    return;
+  }
+#endif
 
-  rdz_results[rdz_count++] = result;
+  rdz_result_init(
+    rdz_results_push(), success, msg, itnumber, lnumber, ltnumber);
 
   if (success == -1) rdz_pending_count++;
   if (success == 0) rdz_fail_count++;
 }
 
+typedef struct rdz_site {
+  char *format;
+  char *operator;
+  int itnumber;
+  int lnumber;
+  int ltnumber;
+} rdz_site;
+
+static void rdz_format_i64(char *s, size_t n, const char *format, long long v)
+{
+  if (strcmp(format, "li") == 0) snprintf(s, n, "%li", (long)v);
+  else if (strcmp(format, "lli") == 0) snprintf(s, n, "%lli", v);
+  else if (strcmp(format, "zd") == 0) snprintf(s, n, "%zd", (ssize_t)v);
+  else if (strcmp(format, "c") == 0) snprintf(s, n, "%c", (int)v);
+  else snprintf(s, n, "%d", (int)v);
+}
+
+static void rdz_format_u64(
+  char *s, size_t n, const char *format, unsigned long long v)
+{
+  if (strcmp(format, "lu") == 0) snprintf(s, n, "%lu", (unsigned long)v);
+  else if (strcmp(format, "llu") == 0) snprintf(s, n, "%llu", v);
+  else if (strcmp(format, "zu") == 0) snprintf(s, n, "%zu", (size_t)v);
+  else if (strcmp(format, "o") == 0) snprintf(s, n, "%o", (unsigned int)v);
+  else snprintf(s, n, "%u", (unsigned int)v);
+}
+
+static void rdz_format_f64(char *s, size_t n, const char *format, double v)
+{
+  if (strcmp(format, "e") == 0) snprintf(s, n, "%e", v);
+  else snprintf(s, n, "%f", v);
+}
+
+static int rdz_ensure_record(int success, char *l, char *r, const rdz_site *s)
+{
+  char *msg = NULL;
+
+  if ( ! success)
+  {
+    char verb[8]; snprintf(verb, 8, "to %s", s->operator);
+
+    msg = calloc(2048, sizeof(char));
+    snprintf(
+      msg, 2048,
+      "     expected %s\n"
+      "     %8s %s",
+      l, verb, r);
+  }
+
+  rdz_record(success, msg, s->itnumber, s->lnumber, s->ltnumber);
+
+  return success;
+}
+
+  // typed ensures (i==, zu!=, f==, ...) are turned into a call to
+  // one of the three functions below, no allocation unless they fail
+
+int rdz_ensure_i64(long long l, long long r, const rdz_site *s)
+{
+  int success = (s->operator[0] == '!') ? (l != r) : (l == r);
+  if (success) return rdz_ensure_record(1, NULL, NULL, s);
+
+  char sl[64]; rdz_format_i64(sl, 64, s->format, l);
+  char sr[64]; rdz_format_i64(sr, 64, s->format, r);
+
+  return rdz_ensure_record(0, sl, sr, s);
+}
+
+int rdz_ensure_u64(unsigned long long l, unsigned long long r, const rdz_site *s)
+{
+  int success = (s->operator[0] == '!') ? (l != r) : (l == r);
+  if (success) return rdz_ensure_record(1, NULL, NULL, s);
+
+  char sl[64]; rdz_format_u64(sl, 64, s->format, l);
+  char sr[64]; rdz_format_u64(sr, 64, s->format, r);
+
+  return rdz_ensure_record(0, sl, sr, s);
+}
+
+int rdz_ensure_f64(double l, double r, const rdz_site *s)
+{
+  int success = (s->operator[0] == '!') ? (l != r) : (l == r);
+  if (success) return rdz_ensure_record(1, NULL, NULL, s);
+
+  char sl[512]; rdz_format_f64(sl, 512, s->format, l);
+  char sr[512]; rdz_format_f64(sr, 512, s->format, r);
+
+  return rdz_ensure_record(0, sl, sr, s);
+}
+
 void rdz_extract_arguments()
 {
+  // start from scratch (rodzo-runner calls rdz_main() repeatedly)
+
+  rdz_lines = NULL; rdz_files = NULL; rdz_its = NULL;
+  rdz_count = 0; rdz_fail_count = 0; rdz_pending_count = 0;
+  rdz_conc_work = 0.0; rdz_conc_wall = 0.0;
+
   // E=example
 
   rdz_example = getenv("E");
@@ -536,7 +855,7 @@ void rdz_extract_arguments()
     }
   }
 
-  // I=6
+  // I=6 or I=6,14
 
   char *i = getenv("I");
 
@@ -544,7 +863,7 @@ void rdz_extract_arguments()
   {
     rdz_example = NULL;
 
-    rdz_it = atoi(i);
+    rdz_its = i;
   }
 
   // F=fname
@@ -567,7 +886,7 @@ void rdz_extract_arguments()
       else
       {
         fn = calloc(l + 9, sizeof(char));
-        strlcpy(fn, "../spec/", 8); strlcpy(fn + 8, f, l);
+        memcpy(fn, "../spec/", 8); memcpy(fn + 8, f, l);
       }
 
       glob_t gl;
@@ -583,6 +902,150 @@ void rdz_extract_arguments()
     }
   }
 
+  // S="src/flutil.c src/flutil.h"
+
+  rdz_sources = getenv("S");
+
+  // RDZ_JOBS=4
+
+  char *j = getenv("RDZ_JOBS");
+
+  rdz_jobs = j ? atoi(j) : 1;
+
+  // RDZ_COORDINATOR=/tmp/s.sock and RDZ_WORKER=/tmp/s.sock
+
+  rdz_coordinator = getenv("RDZ_COORDINATOR");
+  rdz_remote = getenv("RDZ_WORKER");
+
+#ifndef RDZ_WITH_REMOTE
+  if (rdz_coordinator || rdz_remote)
+  {
+    fprintf(stderr, "RDZ_COORDINATOR and RDZ_WORKER need a spec built with -DRDZ_WITH_REMOTE\n");
+    exit(1);
+  }
+#endif
+
+  // RDZ_LIST=1 and RDZ_DURATIONS=.durations
+
+  char *li = getenv("RDZ_LIST");
+
+  rdz_list = li && (strcmp(li, "1") == 0 || strcmp(li, "true") == 0);
+  rdz_durations = getenv("RDZ_DURATIONS");
+
+  // RDZ_REPEAT=500 and RDZ_UNTIL_FAIL=1
+
+  char *re = getenv("RDZ_REPEAT");
+  char *uf = getenv("RDZ_UNTIL_FAIL");
+
+  rdz_repeat = re ? atol(re) : 0;
+  rdz_until_fail = uf && (strcmp(uf, "1") == 0 || strcmp(uf, "true") == 0);
+
+  // RDZ_BISECT=14
+
+  char *bi = getenv("RDZ_BISECT");
+  char *bf = getenv("RDZ_BISECT_FD"); // set for the bisection runs
+
+  rdz_bisect = bi ? atoi(bi) : -1;
+  rdz_bisect_fd = bf ? atoi(bf) : -1;
+
+#ifndef RDZ_WITH_BISECT
+  if (rdz_bisect > -1)
+  {
+    fprintf(stderr, "RDZ_BISECT needs a spec built with -DRDZ_WITH_BISECT\n");
+    exit(1);
+  }
+#endif
+
+  // a bisection run reads its I= from a file, not from the environment
+  // where tens of thousands of examples would overflow the exec
+
+  char *bs = getenv("RDZ_BISECT_SET");
+  FILE *bsf = bf && bs ? fdopen(atoi(bs), "r") : NULL;
+
+  if (bsf)
+  {
+    char *s = NULL; size_t sl = 0;
+
+    if (getline(&s, &sl, bsf) > 0)
+    {
+      s[strcspn(s, "\n")] = '\0';
+      rdz_example = NULL; rdz_its = s; // the bisected example comes last
+
+      char *c = strrchr(s, ','); rdz_bisect_it = atoi(c ? c + 1 : s);
+    }
+    else
+    {
+      free(s);
+    }
+    fclose(bsf);
+  }
+
+  // RDZ_VALGRIND=1
+
+  char *va = getenv("RDZ_VALGRIND");
+
+  rdz_valgrind = va && (strcmp(va, "1") == 0 || strcmp(va, "true") == 0);
+
+#ifndef RDZ_WITH_MEMCHECK
+  if (rdz_valgrind)
+  {
+    fprintf(stderr, "RDZ_VALGRIND needs a spec built with -DRDZ_WITH_MEMCHECK\n");
+    rdz_valgrind = 0;
+  }
+#endif
+
+  // RDZ_CORPUS=fuzz/corpus and RDZ_FUZZ_TIMEOUT=250
+
+  char *ft = getenv("RDZ_FUZZ_TIMEOUT");
+
+  rdz_corpus = getenv("RDZ_CORPUS");
+  rdz_fuzz_timeout = ft ? atof(ft) : 1000.0;
+  if (rdz_fuzz_timeout <= 0.0) rdz_fuzz_timeout = 1000.0;
+
+  // RDZ_BENCH_TIME=1000
+
+  char *bt = getenv("RDZ_BENCH_TIME");
+
+  rdz_bench_time = bt ? atof(bt) : 300.0;
+  if (rdz_bench_time <= 0.0) rdz_bench_time = 300.0;
+
+  // RDZ_UPDATE_SNAPSHOTS=1
+
+  char *us = getenv("RDZ_UPDATE_SNAPSHOTS");
+
+  rdz_update_snapshots = us && (strcmp(us, "1") == 0 || strcmp(us, "true") == 0);
+  rdz_snap_written = 0; rdz_snap_updated = 0;
+
+  // RDZ_TRACE=trace.json
+
+  rdz_trace = getenv("RDZ_TRACE");
+
+  // RDZ_SAMPLE=997
+
+  char *sa = getenv("RDZ_SAMPLE");
+
+  rdz_sample_hz = sa ? atoi(sa) : 0;
+
+#ifndef RDZ_SAMPLING
+  if (rdz_sample_hz > 0)
+  {
+    fprintf(stderr, "RDZ_SAMPLE needs a spec built with -DRDZ_WITH_SAMPLE (glibc or macOS)\n");
+    rdz_sample_hz = 0;
+  }
+#endif
+
+  // RDZ_COVERAGE=cov
+
+  rdz_coverage = getenv("RDZ_COVERAGE");
+
+#ifndef RDZ_GCOV
+  if (rdz_coverage)
+  {
+    fprintf(stderr, "RDZ_COVERAGE needs a spec built with --coverage -DRDZ_GCOV\n");
+    rdz_coverage = NULL;
+  }
+#endif
+
   // RDZ_HEXDUMP
 
   char *rh = getenv("RDZ_HEXDUMP");
@@ -597,14 +1060,16 @@ void rdz_extract_arguments()
     );
 }
 
-void rdz_run_all_children(rdz_node *n)
+void rdz_run_all_children(int n)
 {
-  for (size_t i = 0; n->children[i] > -1; i++)
+  const int *cs = rdz_children(n);
+
+  for (int i = 0; i < rdz_t->ccounts[n]; i++)
   {
-    rdz_node *cn = rdz_nodes[n->children[i]];
-    char ct = cn->type;
+    int cn = cs[i];
+    char ct = rdz_t->types[cn];
     if (ct != 'd' && ct != 'c' && ct != 'i' && ct != 'p') continue;
-    if (cn->dorun < 1) cn->dorun = 1;
+    if (rdz_doruns[cn] < 1) rdz_doruns[cn] = 1;
     if (ct != 'i' || ct != 'p') rdz_run_all_children(cn);
   }
 }
@@ -612,39 +1077,48 @@ void rdz_run_all_parents(int parentnumber)
 {
   if (parentnumber < 0) return;
 
-  rdz_node *pn = rdz_nodes[parentnumber];
-  if (pn->dorun < 1) pn->dorun = 1;
+  if (rdz_doruns[parentnumber] < 1) rdz_doruns[parentnumber] = 1;
 
-  rdz_run_all_parents(pn->parentnumber);
+  rdz_run_all_parents(rdz_t->parents[parentnumber]);
 }
 
-int rdz_determine_dorun_l(rdz_node *n)
+int rdz_determine_dorun_l(int n)
 {
   if (rdz_lines == NULL) return -1;
 
+  int ltstart = rdz_t->ltstarts[n];
+  int llength = rdz_t->llengths[n];
+
   for (size_t i = 0; rdz_lines[i] > -1; i++)
   {
     int l = rdz_lines[i];
-    if (l >= n->ltstart && l <= n->ltstart + n->llength) return 1;
+    if (l >= ltstart && l <= ltstart + llength) return 1;
   }
 
   return 0;
 }
 
-int rdz_determine_dorun_i(rdz_node *n)
+int rdz_determine_dorun_i(int n)
 {
-  if (rdz_it < 0) return -1;
+  if (rdz_its == NULL) return -1;
+
+  for (char *i = rdz_its; ; i++)
+  {
+    if (atoi(i) == n) return 1;
 
-  return n->nodenumber == rdz_it;
+    i = strchr(i, ','); if (i == NULL) break;
+  }
+
+  return 0;
 }
 
-int rdz_determine_dorun_e(rdz_node *n)
+int rdz_determine_dorun_e(int n)
 {
   if (rdz_example == NULL) return -1;
-  return (strstr(n->text, rdz_example) != NULL);
+  return (strstr(rdz_text(n), rdz_example) != NULL);
 }
 
-int rdz_determine_dorun_f(rdz_node *n)
+int rdz_determine_dorun_f(int n)
 {
   if (rdz_files == NULL) return -1;
 
@@ -652,7 +1126,68 @@ int rdz_determine_dorun_f(rdz_node *n)
   {
     char *fn = rdz_files[i];
     if (fn == NULL) break;
-    if (strcmp(fn, n->fname) == 0) return 1;
+    if (strcmp(fn, rdz_fname(n)) == 0) return 1;
+  }
+
+  return 0;
+}
+
+size_t rdz_stem_length(const char *s, size_t l)
+{
+  for (size_t i = l; i > 0; i--)
+  {
+    if (s[i - 1] == '/') break;
+    if (s[i - 1] == '.') return i - 1;
+  }
+  return l;
+}
+
+int rdz_path_match(const char *a, size_t al, const char *b, size_t bl)
+{
+  // "src/flutil.c" matches "../src/flutil.h", the extensions and the
+  // leading ./ and ../ are ignored, the shorter path has to be the tail
+  // of the longer one
+
+  while (al > 1 && a[0] == '.' && a[1] == '/') { a += 2; al -= 2; }
+  while (al > 2 && strncmp(a, "../", 3) == 0) { a += 3; al -= 3; }
+  while (bl > 1 && b[0] == '.' && b[1] == '/') { b += 2; bl -= 2; }
+  while (bl > 2 && strncmp(b, "../", 3) == 0) { b += 3; bl -= 3; }
+
+  al = rdz_stem_length(a, al);
+  bl = rdz_stem_length(b, bl);
+
+  if (al > bl) { const char *s = a; a = b; b = s; size_t l = al; al = bl; bl = l; }
+
+  if (al < 1) return 0;
+  if (strncmp(a, b + bl - al, al) != 0) return 0;
+
+  return al == bl || b[bl - al - 1] == '/';
+}
+
+int rdz_determine_dorun_s(int n)
+{
+  if (rdz_sources == NULL) return -1;
+
+  char *d = rdz_deps(n);
+
+  if (*d == '\0') return 1; // no dependency info (no -MH), let it run
+
+  for (char *s = rdz_sources; *s; )
+  {
+    s += strspn(s, " \t"); size_t sl = strcspn(s, " \t");
+    if (sl < 1) break;
+
+    for (char *e = d; *e; )
+    {
+      e += strspn(e, " "); size_t el = strcspn(e, " ");
+      if (el < 1) break;
+
+      if (rdz_path_match(s, sl, e, el)) return 1;
+
+      e += el;
+    }
+
+    s += sl;
   }
 
   return 0;
@@ -662,148 +1197,4708 @@ void rdz_determine_dorun()
 {
   // first pass, determine if a node should get run on its own
 
-  for (size_t i = 0; rdz_nodes[i] != NULL; i++)
+  for (int n = 0; n < rdz_t->count; n++)
   {
-    rdz_node *n = rdz_nodes[i];
-    char t = n->type;
+    char t = rdz_t->types[n];
 
     //if (t == 'B' || t == 'b' || t == 'A' || t == 'a') continue;
-    if (t == 'G' || t == 'g') n->dorun = 1;
+    if (t == 'G' || t == 'g') rdz_doruns[n] = 1;
     if (t != 'd' && t != 'c' && t != 'i' && t != 'p') continue;
 
     int re = rdz_determine_dorun_e(n);
     int rl = rdz_determine_dorun_l(n);
     int rf = rdz_determine_dorun_f(n);
     int ri = rdz_determine_dorun_i(n);
+    int rs = rdz_determine_dorun_s(n);
 
-    if (rl < 0 && re < 0 && rf < 0 && ri < 0) n->dorun = 1;
-    if (rf > 0) n->dorun = 1;
-    if (rl > 0) n->dorun = 2; // all children if they're all 0
-    if (re > 0) n->dorun = 3; // ancestors and all children
-    if (ri > 0) n->dorun = 3;
+    if (rl < 0 && re < 0 && rf < 0 && ri < 0 && rs < 0) rdz_doruns[n] = 1;
+    if (rf > 0) rdz_doruns[n] = 1;
+    if (rs > 0) rdz_doruns[n] = 1;
+    if (rl > 0) rdz_doruns[n] = 2; // all children if they're all 0
+    if (re > 0) rdz_doruns[n] = 3; // ancestors and all children
+    if (ri > 0) rdz_doruns[n] = 3;
 
     //printf(
-    //  "%zu) re: %d, rl: %d, rf: %d n->dorun: %d\n",
-    //  i, re, rl, rf, n->dorun);
+    //  "%d) re: %d, rl: %d, rf: %d dorun: %d\n",
+    //  n, re, rl, rf, rdz_doruns[n]);
   }
 
   // second pass, ancestors and children are brought in
 
-  for (size_t i = 0; rdz_nodes[i] != NULL; i++)
+  for (int n = 0; n < rdz_t->count; n++)
   {
-    rdz_node *n = rdz_nodes[i];
-
-    if (n->dorun < 2) continue;
+    if (rdz_doruns[n] < 2) continue;
 
     int run_parents = 0;
     int run_children = 0;
 
-    if (n->dorun == 2)
+    if (rdz_doruns[n] == 2)
     {
       run_children = 1;
 
-      for (size_t j = 0; n->children[j] > -1; j++)
+      const int *cs = rdz_children(n);
+
+      for (int j = 0; j < rdz_t->ccounts[n]; j++)
       {
-        if (rdz_nodes[n->children[j]]->dorun > 1) run_children = 0;
+        if (rdz_doruns[cs[j]] > 1) run_children = 0;
       }
     }
-    else //if (n->dorun == 3)
+    else //if (rdz_doruns[n] == 3)
     {
       run_parents = 1;
       run_children = 1;
     }
 
-    if (run_parents) rdz_run_all_parents(n->parentnumber);
+    if (run_parents) rdz_run_all_parents(rdz_t->parents[n]);
     if (run_children) rdz_run_all_children(n);
   }
 }
 
-void rdz_run_offlines(int nodenumber, char type)
-{
-  if (nodenumber == -1) return;
-  rdz_node *n = rdz_nodes[nodenumber];
+  //
+  // RDZ_TRACE
 
-  // before each offline
-  if (type == 'y') rdz_run_offlines(n->parentnumber, type);
+static void rdz_json_string(FILE *f, const char *s)
+{
+  fputc('"', f);
 
-  for (size_t i = 0; n->children[i] > -1; i++)
+  for (const unsigned char *c = (const unsigned char *)s; *c; c++)
   {
-    rdz_node *nn = rdz_nodes[n->children[i]];
-    if (nn->type == type) nn->func();
+    if (*c == '"' || *c == '\\') fprintf(f, "\\%c", *c);
+    else if (*c < 0x20) fprintf(f, "\\u%04x", *c);
+    else fputc(*c, f);
   }
 
-  // after each offline
-  if (type == 'z') rdz_run_offlines(n->parentnumber, type);
+  fputc('"', f);
 }
 
-void rdz_dorun(rdz_node *n)
+typedef struct rdz_trace_event {
+  char ph; // 'B'egin or 'E'nd
+  int n;
+  double ts; // microseconds, monotonic
+} rdz_trace_event;
+
+typedef struct rdz_trace_buf { // one per thread, no locking when recording
+  int tid;
+  size_t from; // in a forked worker, what was recorded before the fork
+  size_t count;
+  size_t size;
+  rdz_trace_event *events;
+  struct rdz_trace_buf *next;
+} rdz_trace_buf;
+
+static rdz_trace_buf *rdz_trace_bufs = NULL;
+static int rdz_trace_tids = 0;
+static char *rdz_trace_forked = NULL; // what the forked workers recorded
+static size_t rdz_trace_forked_length = 0;
+#ifdef RDZ_CONCURRENT
+__thread
+#endif
+rdz_trace_buf *rdz_trace_local = NULL;
+
+void rdz_trace_record(char ph, int n)
 {
-  if (n->nodenumber == 0) printf("\n"); // initial blank line
+  struct timespec t; clock_gettime(CLOCK_MONOTONIC, &t);
 
-  if ( ! n->dorun) return;
+  rdz_trace_buf *b = rdz_trace_local;
 
-  char t = n->type;
+  if (b == NULL) // first event for this thread, register its buffer
+  {
+    b = calloc(1, sizeof(rdz_trace_buf));
+    b->tid = __atomic_add_fetch(&rdz_trace_tids, 1, __ATOMIC_RELAXED);
+    b->next = __atomic_load_n(&rdz_trace_bufs, __ATOMIC_ACQUIRE);
+    while ( ! __atomic_compare_exchange_n(
+      &rdz_trace_bufs, &b->next, b, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+    rdz_trace_local = b;
+  }
 
-  if (t == 'i')
+  if (b->count >= b->size)
   {
-    if (n->children[0] > -1) { rdz_dorun(rdz_nodes[n->children[0]]); return; }
+    b->size = b->size ? b->size * 2 : 1024;
+    b->events = realloc(b->events, b->size * sizeof(rdz_trace_event));
+  }
 
-    int rc = rdz_count;
+  rdz_trace_event *e = b->events + b->count++;
+  e->ph = ph; e->n = n;
+  e->ts = t.tv_sec * 1000000.0 + t.tv_nsec / 1000.0;
+}
 
-    double du = n->func(); // run the "it"
+double rdz_call_traced(int n)
+{
+  rdz_trace_record('B', n);
+  double r = rdz_t->funcs[n]();
+  rdz_trace_record('E', n);
 
-    if (rdz_count == rc) // no ensure in the example, record a success...
-    {
-      rdz_record(1, rdz_strdup(n->text), n->nodenumber, n->lstart, n->ltstart);
-    }
+  return r;
+}
 
-    rdz_print_result(rdz_results[rdz_count - 1], du);
-  }
-  else if (t == 'p')
-  {
-    rdz_record(-1, rdz_strdup(n->text), n->parentnumber, n->lstart, n->ltstart);
+static void rdz_write(int fd, const char *s, size_t l); // see below
 
-    rdz_print_result(rdz_results[rdz_count - 1], -1.0);
-  }
-  else if (t == 'G' || t == 'g' || t == 'd' || t == 'c')
+double rdz_call(int n)
+{
+  // runs an "it" or a hook, traced or not, a bisection run tells when
+  // the bisected example starts and ends, in case it doesn't end
+
+  int b = n == rdz_bisect_it;
+
+  if (b) rdz_write(rdz_bisect_fd, "start\n", 6);
+
+  double r = rdz_trace ? rdz_call_traced(n) : rdz_t->funcs[n]();
+
+  if (b) rdz_write(rdz_bisect_fd, "end\n", 4);
+
+  return r;
+}
+
+static const char *rdz_trace_category(char t)
+{
+  if (t == 'd') return "describe";
+  if (t == 'c') return "context";
+  if (t == 'i') return "it";
+  if (t == 'B') return "before all";
+  if (t == 'A') return "after all";
+  if (t == 'y') return "before each offline";
+  if (t == 'z') return "after each offline";
+  return "rodzo";
+}
+
+static void rdz_trace_write_events(FILE *f, int *first)
+{
+  // the events recorded by this process (since the fork, for a worker)
+
+  int pid = (int)getpid();
+
+  for (rdz_trace_buf *b = rdz_trace_bufs; b; b = b->next)
   {
-    rdz_print_level(n->nodenumber);
-    for (size_t i = 0; n->children[i] > -1; i++) // before all
-    {
-      rdz_node *nn = rdz_nodes[n->children[i]];
-      if (nn->type == 'B') nn->func();
-    }
-    for (size_t i = 0; n->children[i] > -1; i++) // children
-    {
-      rdz_node *nn = rdz_nodes[n->children[i]];
-      if (nn->type != 'd' && nn->type != 'c' && nn->type != 'i') continue;
-      rdz_run_offlines(n->nodenumber, 'y'); // before each offline
-      rdz_dorun(nn);
-      rdz_run_offlines(n->nodenumber, 'z'); // after each offline
-    }
-    for (size_t i = 0; n->children[i] > -1; i++) // after all
+    if (b->count <= b->from) continue;
+
+    fprintf(
+      f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,"
+      "\"args\":{\"name\":\"%s %d\"}}",
+      *first ? "" : ",\n", pid, b->tid, b->tid == 1 ? "main" : "thread", b->tid);
+    *first = 0;
+
+    for (size_t i = b->from; i < b->count; i++)
     {
-      rdz_node *nn = rdz_nodes[n->children[i]];
-      if (nn->type == 'A') nn->func();
+      rdz_trace_event *e = b->events + i;
+      char t = rdz_t->types[e->n];
+      const char *cat = rdz_trace_category(t);
+
+      fprintf(f, ",\n{\"name\":");
+      rdz_json_string(f, t == 'd' || t == 'c' || t == 'i' ? rdz_text(e->n) : cat);
+      fprintf(
+        f, ",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d,"
+        "\"args\":{\"I\":%d,\"L\":%d}}",
+        cat, e->ph, e->ts, pid, b->tid, e->n, rdz_t->ltstarts[e->n]);
     }
   }
 }
 
-char *rdz_read_line(char *fname, int lnumber)
+void rdz_trace_fork()
 {
-  char *l = calloc(1024, sizeof(char));
-  char *ll = l;
+  // in a freshly forked worker, only what comes next is the worker's
 
-  FILE *in = fopen(fname, "r");
+  for (rdz_trace_buf *b = rdz_trace_bufs; b; b = b->next) b->from = b->count;
+}
 
-  if (in == NULL)
-  {
-    fprintf(stderr, "cannot find source file %s\n", fname);
-    exit(1);
-  }
+void rdz_trace_gather(const char *s, size_t l)
+{
+  // keeps what a forked worker recorded, for rdz_trace_write()
 
-  while(1)
-  {
+  if (l < 1) return;
+
+  rdz_trace_forked = realloc(rdz_trace_forked, rdz_trace_forked_length + l + 3);
+  memcpy(rdz_trace_forked + rdz_trace_forked_length, ",\n", 2);
+  memcpy(rdz_trace_forked + rdz_trace_forked_length + 2, s, l);
+  rdz_trace_forked_length += l + 2;
+  rdz_trace_forked[rdz_trace_forked_length] = '\0';
+}
+
+void rdz_trace_write()
+{
+  // the trace event format, as loaded by chrome://tracing or Perfetto
+
+  if (rdz_trace == NULL) return;
+
+  FILE *f = fopen(rdz_trace, "w");
+
+  if (f == NULL) { fprintf(stderr, "couldn't write %s\n", rdz_trace); return; }
+
+  int first = 1;
+
+  fprintf(f, "[\n");
+  rdz_trace_write_events(f, &first);
+  if (rdz_trace_forked) fputs(first ? rdz_trace_forked + 2 : rdz_trace_forked, f);
+  fprintf(f, "\n]\n");
+
+  fclose(f);
+
+  while (rdz_trace_bufs)
+  {
+    rdz_trace_buf *b = rdz_trace_bufs; rdz_trace_bufs = b->next;
+    free(b->events); free(b);
+  }
+  rdz_trace_local = NULL; rdz_trace_tids = 0;
+  free(rdz_trace_forked); rdz_trace_forked = NULL; rdz_trace_forked_length = 0;
+}
+
+void rdz_run_offlines(int nodenumber, char type)
+{
+  if (nodenumber == -1) return;
+
+  // before each offline
+  if (type == 'y') rdz_run_offlines(rdz_t->parents[nodenumber], type);
+
+  const int *cs = rdz_children(nodenumber);
+
+  for (int i = 0; i < rdz_t->ccounts[nodenumber]; i++)
+  {
+    if (rdz_t->types[cs[i]] == type) rdz_call(cs[i]);
+  }
+
+  // after each offline
+  if (type == 'z') rdz_run_offlines(rdz_t->parents[nodenumber], type);
+}
+
+int rdz_has_offlines(int nodenumber)
+{
+  for (int n = nodenumber; n > -1; n = rdz_t->parents[n])
+  {
+    const int *cs = rdz_children(n);
+
+    for (int i = 0; i < rdz_t->ccounts[n]; i++)
+    {
+      char t = rdz_t->types[cs[i]]; if (t == 'y' || t == 'z') return 1;
+    }
+  }
+
+  return 0;
+}
+
+#ifdef RDZ_GCOV
+void __gcov_reset(void);
+void __gcov_dump(void);
+#endif
+
+void rdz_coverage_start()
+{
+#ifdef RDZ_GCOV
+  if (rdz_coverage) __gcov_reset();
+#endif
+}
+
+void rdz_coverage_stop(int n)
+{
+#ifdef RDZ_GCOV
+  if (rdz_coverage == NULL) return;
+
+  // the .gcda files for example n go under cov/n/
+
+  char prefix[1024]; snprintf(prefix, 1024, "%s/%d", rdz_coverage, n);
+
+  setenv("GCOV_PREFIX", prefix, 1);
+  __gcov_dump();
+  unsetenv("GCOV_PREFIX");
+
+  __gcov_reset(); // and the final (at exit) dump will be empty
+#else
+  (void)n;
+#endif
+}
+
+#ifdef RDZ_GCOV
+void rdz_coverage_lines(FILE *out, char *gcda)
+{
+  // runs gcov on the .gcda, writes " file:1-3,7" for each source
+
+  char cmd[2048]; snprintf(cmd, 2048, "gcov -t '%s' 2>/dev/null", gcda);
+
+  FILE *in = popen(cmd, "r"); if (in == NULL) return;
+
+  char line[4096];
+  int first = -1; int last = -1;
+
+  while (fgets(line, 4096, in))
+  {
+    char *c = strchr(line, ':'); if (c == NULL) continue;
+    char *c1 = strchr(c + 1, ':'); if (c1 == NULL) continue;
+
+    int l = atoi(c + 1);
+
+    if (l == 0 && strncmp(c1 + 1, "Source:", 7) == 0)
+    {
+      if (first > -1) fprintf(out, last > first ? "%d-%d" : "%d", first, last);
+      first = -1; last = -1;
+      c1[strcspn(c1, "\n")] = '\0';
+      fprintf(out, " %s:", c1 + 8);
+      continue;
+    }
+
+    char *s = line; while (*s == ' ') ++s;
+    if (*s < '1' || *s > '9') continue; // "-", "#####" or "====="
+
+    if (l == last + 1 && first > -1) { last = l; continue; }
+
+    if (first > -1) fprintf(out, last > first ? "%d-%d," : "%d,", first, last);
+    first = l; last = l;
+  }
+  if (first > -1) fprintf(out, last > first ? "%d-%d" : "%d", first, last);
+
+  pclose(in);
+}
+#endif
+
+void rdz_coverage_map()
+{
+#ifdef RDZ_GCOV
+  if (rdz_coverage == NULL) return;
+
+  // writes cov/map.txt, one line per example,
+  // "node_number file:lines file:lines..."
+
+  char path[1024]; snprintf(path, 1024, "%s/map.txt", rdz_coverage);
+
+  FILE *out = fopen(path, "wb"); if (out == NULL) return;
+
+  for (int n = 0; n < rdz_t->count; n++)
+  {
+    if (rdz_t->types[n] != 'i' || ! rdz_doruns[n]) continue;
+
+    char cmd[1024];
+    snprintf(cmd, 1024, "find '%s/%d' -name '*.gcda' 2>/dev/null", rdz_coverage, n);
+
+    FILE *in = popen(cmd, "r"); if (in == NULL) continue;
+
+    fprintf(out, "%d", n);
+
+    char gcda[1024];
+
+    while (fgets(gcda, 1024, in))
+    {
+      gcda[strcspn(gcda, "\n")] = '\0';
+
+      // the .gcno sits where the spec got compiled,
+      // cov/6/home/x/spec/s.gcda --> /home/x/spec/s.gcno
+
+      char gcno[1024]; strcpy(gcno, gcda);
+      strcpy(gcno + strlen(gcno) - 5, ".gcno");
+      char *g = gcno + strlen(rdz_coverage) + 1; g = strchr(g, '/');
+
+      if (g) symlink(g, gcno);
+
+      rdz_coverage_lines(out, gcda);
+    }
+
+    fprintf(out, "\n");
+
+    pclose(in);
+  }
+
+  fclose(out);
+
+  printf("\n%scoverage map written to %s%s\n", rdz_gr(), path, rdz_cl());
+#endif
+}
+
+  //
+  // RDZ_SAMPLE
+
+#ifdef RDZ_SAMPLING
+
+#define RDZ_SAMPLE_DEPTH 64
+#define RDZ_SAMPLE_RING 8192
+
+typedef struct rdz_sample {
+  volatile unsigned long seq; // index + 1, once written
+  int node;
+  int depth;
+  void *pcs[RDZ_SAMPLE_DEPTH];
+} rdz_sample;
+
+static rdz_sample *rdz_sample_ring = NULL; // preallocated, written by the handler
+static volatile unsigned long rdz_sample_head = 0;
+static unsigned long rdz_sample_tail = 0;
+static unsigned long rdz_sample_dropped = 0;
+static unsigned long rdz_sample_total = 0;
+
+typedef struct rdz_stack { // samples aggregated per node and stack
+  unsigned long count;
+  int node;
+  int depth;
+  void *pcs[RDZ_SAMPLE_DEPTH];
+} rdz_stack;
+
+static rdz_stack *rdz_stacks = NULL;
+static size_t rdz_stacks_size = 0;
+static size_t rdz_stacks_count = 0;
+static unsigned long *rdz_sample_counts = NULL; // per node
+
+static char *rdz_sample_stack_lo = NULL; // the main thread stack, the
+static char *rdz_sample_stack_hi = NULL; // frame walk doesn't read past it
+
+static int rdz_sample_regs(void *uc, void **pc, char **fp)
+{
+  // the pc and the frame pointer of the interrupted code
+
+  (void)uc; (void)pc; (void)fp;
+
+#if defined(__APPLE__) && defined(__x86_64__)
+  *pc = (void *)((ucontext_t *)uc)->uc_mcontext->__ss.__rip;
+  *fp = (char *)((ucontext_t *)uc)->uc_mcontext->__ss.__rbp;
+  return 1;
+#elif defined(__APPLE__) && defined(__aarch64__)
+  *pc = (void *)((ucontext_t *)uc)->uc_mcontext->__ss.__pc;
+  *fp = (char *)((ucontext_t *)uc)->uc_mcontext->__ss.__fp;
+  return 1;
+#elif defined(__linux__) && defined(__x86_64__)
+  *pc = (void *)((ucontext_t *)uc)->uc_mcontext.gregs[16]; // REG_RIP
+  *fp = (char *)((ucontext_t *)uc)->uc_mcontext.gregs[10]; // REG_RBP
+  return 1;
+#elif defined(__linux__) && defined(__aarch64__)
+  *pc = (void *)((ucontext_t *)uc)->uc_mcontext.pc;
+  *fp = (char *)((ucontext_t *)uc)->uc_mcontext.regs[29];
+  return 1;
+#else
+  return 0;
+#endif
+}
+
+static void rdz_sample_handler(int sig, siginfo_t *si, void *uc)
+{
+  // async-signal-safe: no backtrace() (it may lock or allocate, in the
+  // middle of a malloc() it may deadlock), the stack is walked by following
+  // the saved frame pointers, each frame is [ previous fp, return address ].
+  // The walk stays within the main thread stack and only goes up, other
+  // threads get their leaf pc only. Code compiled without frame pointers
+  // yields short or partial stacks, never a fault.
+
+  (void)sig; (void)si;
+
+  int e = errno;
+
+  unsigned long i = __atomic_fetch_add(&rdz_sample_head, 1, __ATOMIC_ACQ_REL);
+  rdz_sample *s = rdz_sample_ring + (i % RDZ_SAMPLE_RING);
+
+  __atomic_store_n(&s->seq, 0, __ATOMIC_RELEASE);
+  s->node = rdz_sample_node;
+
+  int d = 0;
+  void *pc = NULL; char *fp = NULL;
+
+  if (rdz_sample_regs(uc, &pc, &fp))
+  {
+    s->pcs[d++] = pc;
+
+    char *lo = (char *)&d; // below the interrupted frames
+    char *hi = rdz_sample_stack_hi;
+
+    if (lo < rdz_sample_stack_lo || lo >= hi) fp = NULL; // not the main thread
+
+    while (
+      d < RDZ_SAMPLE_DEPTH &&
+      fp >= lo && fp + 2 * sizeof(void *) <= hi &&
+      ((size_t)fp & (sizeof(void *) - 1)) == 0
+    ) {
+      void **fr = (void **)fp;
+      if (fr[1] == NULL) break;
+      s->pcs[d++] = fr[1];
+      if ((char *)fr[0] <= fp) break;
+      fp = fr[0];
+    }
+  }
+
+  s->depth = d;
+  __atomic_store_n(&s->seq, i + 1, __ATOMIC_RELEASE);
+
+  errno = e;
+}
+
+static size_t rdz_stack_hash(int node, int depth, void **pcs)
+{
+  size_t h = 14695981039346656037ULL ^ (size_t)node;
+  for (int i = 0; i < depth; i++) { h ^= (size_t)pcs[i]; h *= 1099511628211ULL; }
+  return h;
+}
+
+static void rdz_stack_add(int node, int depth, void **pcs, unsigned long count)
+{
+  if (rdz_stacks_count * 2 >= rdz_stacks_size) // grow and rehash
+  {
+    rdz_stack *old = rdz_stacks; size_t os = rdz_stacks_size;
+
+    rdz_stacks_size = os ? os * 2 : 1024;
+    rdz_stacks = calloc(rdz_stacks_size, sizeof(rdz_stack));
+    rdz_stacks_count = 0;
+
+    for (size_t i = 0; i < os; i++)
+    {
+      if (old[i].count) rdz_stack_add(old[i].node, old[i].depth, old[i].pcs, old[i].count);
+    }
+    free(old);
+  }
+
+  size_t m = rdz_stacks_size - 1;
+
+  for (size_t i = rdz_stack_hash(node, depth, pcs) & m; ; i = (i + 1) & m)
+  {
+    rdz_stack *st = rdz_stacks + i;
+
+    if (st->count == 0)
+    {
+      st->node = node; st->depth = depth;
+      memcpy(st->pcs, pcs, depth * sizeof(void *));
+      rdz_stacks_count++;
+    }
+    else if (
+      st->node != node || st->depth != depth ||
+      memcmp(st->pcs, pcs, depth * sizeof(void *)) != 0
+    ) continue;
+
+    st->count += count;
+    return;
+  }
+}
+
+void rdz_sample_drain()
+{
+  // moves the samples from the ring to the stack table, called from
+  // rdz_dorun() between examples, not from the handler
+
+  if (rdz_sample_ring == NULL) return;
+
+  unsigned long head = __atomic_load_n(&rdz_sample_head, __ATOMIC_ACQUIRE);
+
+  if (head - rdz_sample_tail > RDZ_SAMPLE_RING) // overrun
+  {
+    rdz_sample_dropped += head - rdz_sample_tail - RDZ_SAMPLE_RING;
+    rdz_sample_tail = head - RDZ_SAMPLE_RING;
+  }
+
+  for (; rdz_sample_tail < head; rdz_sample_tail++)
+  {
+    unsigned long i = rdz_sample_tail;
+    rdz_sample *s = rdz_sample_ring + (i % RDZ_SAMPLE_RING);
+
+    if (__atomic_load_n(&s->seq, __ATOMIC_ACQUIRE) != i + 1) { rdz_sample_dropped++; continue; }
+
+    rdz_sample c; memcpy(&c, s, sizeof(rdz_sample));
+
+    if (__atomic_load_n(&s->seq, __ATOMIC_ACQUIRE) != i + 1) { rdz_sample_dropped++; continue; }
+
+    if (c.depth > RDZ_SAMPLE_DEPTH) c.depth = RDZ_SAMPLE_DEPTH;
+
+    rdz_stack_add(c.node, c.depth, c.pcs, 1);
+    rdz_sample_total++;
+  }
+}
+
+static void rdz_sample_stack_bounds()
+{
+  // where the main thread stack lies, read once, out of the handler
+
+#ifdef __APPLE__
+  rdz_sample_stack_hi = pthread_get_stackaddr_np(pthread_self());
+  rdz_sample_stack_lo = rdz_sample_stack_hi - pthread_get_stacksize_np(pthread_self());
+#else
+  FILE *f = fopen("/proc/self/maps", "r"); if (f == NULL) return;
+
+  char *line = NULL; size_t n = 0;
+
+  while (getline(&line, &n, f) > 0)
+  {
+    if (strstr(line, "[stack]") == NULL) continue;
+    unsigned long a, b;
+    if (sscanf(line, "%lx-%lx", &a, &b) != 2) continue;
+    rdz_sample_stack_lo = (char *)a; rdz_sample_stack_hi = (char *)b;
+    break;
+  }
+  free(line);
+  fclose(f);
+#endif
+}
+
+void rdz_sample_start()
+{
+  if (rdz_sample_hz < 1) return;
+
+  rdz_sample_stack_bounds();
+
+  rdz_sample_ring = calloc(RDZ_SAMPLE_RING, sizeof(rdz_sample));
+  rdz_sample_head = 0; rdz_sample_tail = 0;
+  rdz_sample_dropped = 0; rdz_sample_total = 0;
+
+  struct sigaction sa; memset(&sa, 0, sizeof(sa));
+  sa.sa_sigaction = rdz_sample_handler;
+  sa.sa_flags = SA_RESTART | SA_SIGINFO;
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGPROF, &sa, NULL);
+
+  long us = 1000000L / rdz_sample_hz; if (us < 1) us = 1;
+  struct itimerval it = { { us / 1000000L, us % 1000000L }, { us / 1000000L, us % 1000000L } };
+  setitimer(ITIMER_PROF, &it, NULL);
+}
+
+static char *rdz_frame_name(const char *sym)
+{
+  // "./s(rdz_dorun+0x2a) [0x55d1c]" --> "rdz_dorun"
+  // "./s(+0x2a3c) [0x55d1c]" --> "0x55d1c" (build with -rdynamic)
+
+  const char *o = strchr(sym, '(');
+  const char *p = o ? strpbrk(o, "+)") : NULL;
+  if (o && p && p > o + 1) return rdz_strndup((char *)o + 1, p - o - 1);
+
+  const char *b = strrchr(sym, '[');
+  const char *c = b ? strchr(b, ']') : NULL;
+  if (b && c) return rdz_strndup((char *)b + 1, c - b - 1);
+
+  return rdz_strdup((char *)sym);
+}
+
+static int rdz_strptr_cmp(const void *a, const void *b)
+{
+  return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+void rdz_sample_stop()
+{
+  // writes the folded stacks, "title;main;...;leaf count" lines, to
+  // RDZ_SAMPLE_FILE (rdz_sample.folded), ready for flamegraph.pl
+
+  if (rdz_sample_ring == NULL) return;
+
+  struct itimerval it; memset(&it, 0, sizeof(it));
+  setitimer(ITIMER_PROF, &it, NULL);
+  signal(SIGPROF, SIG_IGN);
+
+  rdz_sample_drain();
+
+  rdz_sample_counts = calloc(rdz_t->count, sizeof(unsigned long));
+
+  char **lines = calloc(rdz_stacks_count + 1, sizeof(char *)); size_t lc = 0;
+
+  for (size_t i = 0; i < rdz_stacks_size; i++)
+  {
+    rdz_stack *st = rdz_stacks + i;
+
+    if (st->count == 0) continue;
+
+    rdz_sample_counts[st->node] += st->count;
+
+    char *s = NULL; size_t l = 0; FILE *f = open_memstream(&s, &l);
+
+    char *title = st->node > 0 ? rdz_determine_title(st->node) : rdz_strdup("rodzo");
+    for (char *c = title; *c; c++) if (*c == ';') *c = ',';
+    size_t tl = strlen(title); while (tl > 0 && title[tl - 1] == ' ') title[--tl] = '\0';
+    char t = rdz_t->types[st->node];
+    fprintf(f, "%s%s", title, st->node > 0 && t != 'i' ? " (hooks)" : "");
+    free(title);
+
+    int skip = 0; // the walk starts at the interrupted pc
+    char **syms = st->depth > skip ? backtrace_symbols(st->pcs, st->depth) : NULL;
+    char **names = calloc(st->depth + 1, sizeof(char *));
+
+    int top = st->depth - 1; // the frames above the runtime are left out
+
+    for (int j = skip; syms && j < st->depth; j++)
+    {
+      names[j] = rdz_frame_name(syms[j]);
+      for (char *c = names[j]; *c; c++) if (*c == ';' || *c == ' ') *c = '_';
+      if (top == st->depth - 1 && strncmp(names[j], "rdz_", 4) == 0) top = j - 1;
+    }
+    if (syms && top == st->depth - 1 && st->depth == RDZ_SAMPLE_DEPTH)
+    {
+      fprintf(f, ";[truncated]");
+    }
+    for (int j = top; syms && j >= skip; j--) fprintf(f, ";%s", names[j]);
+
+    for (int j = 0; j < st->depth; j++) free(names[j]);
+    free(names);
+    free(syms);
+
+    fprintf(f, " %lu", st->count);
+    fclose(f);
+
+    lines[lc++] = s;
+  }
+
+  qsort(lines, lc, sizeof(char *), rdz_strptr_cmp);
+
+  char *path = getenv("RDZ_SAMPLE_FILE"); if (path == NULL) path = "rdz_sample.folded";
+  FILE *out = fopen(path, "w");
+
+  for (size_t i = 0; i < lc; )
+  {
+    // different return addresses may fold to the same line, sum them
+
+    char *sp = strrchr(lines[i], ' ');
+    size_t kl = sp - lines[i];
+    unsigned long count = 0; size_t j = i;
+
+    for (; j < lc; j++)
+    {
+      char *spj = strrchr(lines[j], ' ');
+      if ((size_t)(spj - lines[j]) != kl || strncmp(lines[i], lines[j], kl) != 0) break;
+      count += strtoul(spj + 1, NULL, 10);
+    }
+
+    if (out) fprintf(out, "%.*s %lu\n", (int)kl, lines[i], count);
+
+    for (; i < j; i++) free(lines[i]);
+  }
+
+  if (out) fclose(out);
+  free(lines);
+
+  free(rdz_stacks); rdz_stacks = NULL; rdz_stacks_size = 0; rdz_stacks_count = 0;
+  free((void *)rdz_sample_ring); rdz_sample_ring = NULL;
+}
+
+static int rdz_sample_cmp(const void *a, const void *b)
+{
+  unsigned long ca = rdz_sample_counts[*(const int *)a];
+  unsigned long cb = rdz_sample_counts[*(const int *)b];
+
+  return ca > cb ? -1 : ca < cb;
+}
+
+void rdz_sample_summary()
+{
+  if (rdz_sample_counts == NULL) return;
+
+  char *path = getenv("RDZ_SAMPLE_FILE"); if (path == NULL) path = "rdz_sample.folded";
+
+  if (rdz_fail_count > 0) printf("\n"); // after the failures
+
+  printf(
+    "Samples: %lu at %dhz, %lu dropped, folded stacks in %s\n\n",
+    rdz_sample_total, rdz_sample_hz, rdz_sample_dropped, path);
+
+  int *ns = calloc(rdz_t->count, sizeof(int)); int nc = 0;
+  for (int n = 0; n < rdz_t->count; n++) if (rdz_sample_counts[n]) ns[nc++] = n;
+
+  qsort(ns, nc, sizeof(int), rdz_sample_cmp);
+
+  for (int i = 0; i < nc && i < 10; i++) // the top ten
+  {
+    int n = ns[i];
+    char *title = n > 0 ? rdz_determine_title(n) : rdz_strdup("rodzo");
+    printf(
+      "  %5.1f%%  %s%s%sI=%d%s\n",
+      100.0 * rdz_sample_counts[n] / (rdz_sample_total ? rdz_sample_total : 1),
+      title, n > 0 && rdz_t->types[n] != 'i' ? "(hooks) " : "",
+      rdz_gr(), n, rdz_cl());
+    free(title);
+  }
+  printf("\n");
+
+  free(ns);
+  free(rdz_sample_counts); rdz_sample_counts = NULL;
+}
+
+#else
+
+void rdz_sample_drain() {}
+void rdz_sample_start() {}
+void rdz_sample_stop() {}
+void rdz_sample_summary() {}
+
+#endif
+
+  //
+  // RDZ_VALGRIND, the native leak counter
+
+#if defined(RDZ_LEAKS) && defined(__GLIBC__)
+
+// built with -DRDZ_LEAKS, the spec replaces malloc() and co (glibc allows
+// it) to count the live heap blocks
+
+extern void *__libc_malloc(size_t s);
+extern void *__libc_calloc(size_t n, size_t s);
+extern void *__libc_realloc(void *p, size_t s);
+extern void *__libc_memalign(size_t a, size_t s);
+extern void __libc_free(void *p);
+
+long rdz_blocks = 0;
+
+static void *rdz_counted(void *p)
+{
+  if (p) __atomic_add_fetch(&rdz_blocks, 1, __ATOMIC_RELAXED);
+
+  return p;
+}
+
+void *malloc(size_t s) { return rdz_counted(__libc_malloc(s)); }
+void *calloc(size_t n, size_t s) { return rdz_counted(__libc_calloc(n, s)); }
+void *memalign(size_t a, size_t s) { return rdz_counted(__libc_memalign(a, s)); }
+void *aligned_alloc(size_t a, size_t s) { return memalign(a, s); }
+void *valloc(size_t s) { return memalign(sysconf(_SC_PAGESIZE), s); }
+
+void *pvalloc(size_t s)
+{
+  size_t ps = sysconf(_SC_PAGESIZE);
+
+  return memalign(ps, (s + ps - 1) / ps * ps);
+}
+
+int posix_memalign(void **r, size_t a, size_t s)
+{
+  void *p = memalign(a, s); if (p == NULL) return ENOMEM;
+
+  *r = p;
+
+  return 0;
+}
+
+void *realloc(void *p, size_t s)
+{
+  void *r = __libc_realloc(p, s);
+
+  if (p == NULL) rdz_counted(r);
+  else if (s == 0 && r == NULL) __atomic_sub_fetch(&rdz_blocks, 1, __ATOMIC_RELAXED);
+
+  return r;
+}
+
+void free(void *p)
+{
+  if (p) __atomic_sub_fetch(&rdz_blocks, 1, __ATOMIC_RELAXED);
+
+  __libc_free(p);
+}
+
+#define RDZ_BLOCKS() rdz_blocks
+#else
+#define RDZ_BLOCKS() 0
+#endif
+
+void rdz_leak_check(int n, int from, long blocks)
+{
+  // flags the example if it left more blocks than the results it recorded
+
+  for (int i = from; i < rdz_count; i++)
+  {
+    if (rdz_results[i].message) blocks++;
+    if (rdz_results[i].title) blocks++;
+  }
+
+  if (RDZ_BLOCKS() > blocks) rdz_leaky[n] = 1;
+}
+
+void rdz_dorun(int n);
+
+static int rdz_tmpfd(const char *kind, int w)
+{
+  char *d = getenv("TMPDIR"); if (d == NULL || *d == '\0') d = "/tmp";
+
+  char path[1024];
+  snprintf(path, 1024, "%s/rdz_%d_%s_%d", d, (int)getpid(), kind, w);
+
+  int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+  unlink(path);
+
+  return fd;
+}
+
+static void rdz_write(int fd, const char *s, size_t l)
+{
+  while (l > 0)
+  {
+    ssize_t w = write(fd, s, l); if (w < 1) return;
+    s += w; l -= w;
+  }
+}
+
+static char *rdz_read(int fd, size_t *l)
+{
+  size_t size = 4096; *l = 0;
+  char *r = calloc(size, sizeof(char));
+
+  lseek(fd, 0, SEEK_SET);
+
+  while (1)
+  {
+    if (*l + 1 >= size) { size *= 2; r = realloc(r, size); }
+    ssize_t rr = read(fd, r + *l, size - *l - 1); if (rr < 1) break;
+    *l += rr;
+  }
+  r[*l] = '\0';
+
+  return r;
+}
+
+static void rdz_snap_window(char *s, size_t n, const char *d, size_t l, size_t at)
+{
+  // up to 64 bytes around the offset, from the start of its line if close,
+  // escaped, so that text and binary snapshots read the same
+
+  size_t from = at > 32 ? at - 32 : 0;
+  for (size_t i = at; i > from; i--) if (d[i - 1] == '\n') { from = i; break; }
+
+  size_t to = from + 64; if (to > l) to = l;
+
+  size_t j = 0;
+  if (j < n) j += snprintf(s + j, n - j, "%s\"", from > 0 ? "..." : "");
+
+  for (size_t i = from; i < to && j + 8 < n; i++)
+  {
+    unsigned char c = d[i];
+
+    if (c == '\n') j += snprintf(s + j, n - j, "\\n");
+    else if (c == '"' || c == '\\') j += snprintf(s + j, n - j, "\\%c", c);
+    else if (c >= 32 && c <= 126) s[j++] = c;
+    else j += snprintf(s + j, n - j, "\\x%02x", c);
+  }
+
+  if (j < n) snprintf(s + j, n - j, "\"%s", to < l ? "..." : "");
+}
+
+static int rdz_snap_write(const char *path, const char *data, size_t l)
+{
+  // writes to a temporary file next to the snapshot, then renames it over
+
+  char *tmp = calloc(strlen(path) + 32, sizeof(char));
+  sprintf(tmp, "%s.%d.tmp", path, (int)getpid());
+
+  for (char *s = tmp + 1; (s = strchr(s, '/')) != NULL; s++) // mkdir -p
+  {
+    *s = '\0'; mkdir(tmp, 0755); *s = '/';
+  }
+
+  int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  int r = fd > -1 ? 0 : -1;
+
+  if (fd > -1) { rdz_write(fd, data, l); if (close(fd) != 0) r = -1; }
+  if (r == 0) r = rename(tmp, path);
+  if (r != 0) unlink(tmp);
+
+  free(tmp);
+
+  return r;
+}
+
+char *rdz_string_snap(char *result, char *name, const char *fname)
+{
+  // ensure(out ===snap "name"), compares with __snapshots__/name next to
+  // the spec file, RDZ_UPDATE_SNAPSHOTS=1 (re)writes it when it differs
+
+  if (result == NULL) return rdz_strdup("     result is NULL");
+  if (name == NULL) return rdz_strdup("     snapshot name is NULL");
+
+  const char *sl = strrchr(fname, '/');
+  int dl = sl ? (int)(sl - fname + 1) : 0;
+
+  char *path = calloc(dl + strlen(name) + 16, sizeof(char));
+  sprintf(path, "%.*s__snapshots__/%s", dl, fname, name);
+
+  size_t rl = strlen(result);
+  size_t sz = 0;
+  char *d = NULL;
+  struct stat st;
+
+  int fd = open(path, O_RDONLY);
+  int found = fd > -1 && fstat(fd, &st) == 0;
+
+  if (found) sz = st.st_size;
+  if (found && sz > 0 && sz == rl) // the length first, no need to map else
+  {
+    d = mmap(NULL, sz, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (d == MAP_FAILED) d = NULL;
+  }
+  if (fd > -1) close(fd);
+
+  int same = found && sz == rl && (rl == 0 || (d && memcmp(d, result, rl) == 0));
+
+  if (d) munmap(d, sz);
+
+  if (same) { free(path); return NULL; }
+
+  char *s = calloc(2048, sizeof(char));
+
+  if (rdz_update_snapshots)
+  {
+    if (rdz_snap_write(path, result, rl) == 0)
+    {
+      __atomic_fetch_add(found ? &rdz_snap_updated : &rdz_snap_written, 1, __ATOMIC_SEQ_CST);
+      free(s); s = NULL;
+    }
+    else
+    {
+      snprintf(s, 2048, "     couldn't write snapshot %s: %s", path, strerror(errno));
+    }
+  }
+  else if ( ! found)
+  {
+    snprintf(
+      s, 2048,
+      "     no snapshot at %s\n"
+      "     (RDZ_UPDATE_SNAPSHOTS=1 writes it)", path);
+  }
+  else
+  {
+    // map again, the whole thing this time, to show where it differs
+
+    fd = open(path, O_RDONLY);
+    d = fd > -1 && sz > 0 ? mmap(NULL, sz, PROT_READ, MAP_PRIVATE, fd, 0) : NULL;
+    if (d == MAP_FAILED) d = NULL;
+    if (fd > -1) close(fd);
+
+    size_t l = sz < rl ? sz : rl;
+    size_t at = 0;
+    if (d)
+    {
+      while (at + 64 <= l && memcmp(d + at, result + at, 64) == 0) at += 64;
+      while (at < l && d[at] == result[at]) at++;
+    }
+
+    size_t line = 1;
+    for (size_t i = 0; i < at; i++) if (result[i] == '\n') line++;
+
+    char ew[512]; rdz_snap_window(ew, 512, d ? d : "", d ? sz : 0, at);
+    char rw[512]; rdz_snap_window(rw, 512, result, rl, at);
+
+    snprintf(
+      s, 2048,
+      "     snapshot %s differs at byte %zu, line %zu\n"
+      "     expected %zu bytes, got %zu\n"
+      "     expected %s\n"
+      "          got %s",
+      path, at, line, sz, rl, ew, rw);
+
+    if (d) munmap(d, sz);
+  }
+
+  free(path);
+
+  return s;
+}
+
+static void rdz_trace_dump(int fd)
+{
+  // a forked worker hands its trace events over to the parent process
+
+  char *o = NULL; size_t l = 0;
+  FILE *f = open_memstream(&o, &l);
+
+  int first = 1; rdz_trace_write_events(f, &first);
+
+  fclose(f);
+  rdz_write(fd, o, l);
+  free(o);
+}
+
+static void rdz_write_results(int fd, int from)
+{
+  // "success itnumber lnumber ltnumber msglength\nmsg\n"...
+
+  for (int i = from; i < rdz_count; i++)
+  {
+    rdz_result *r = rdz_results + i;
+
+    char h[128];
+    int l = snprintf(
+      h, 128, "%d %d %d %d %d\n",
+      r->success, r->itnumber, r->lnumber, r->ltnumber,
+      r->message ? (int)strlen(r->message) : -1);
+
+    rdz_write(fd, h, l);
+    if (r->message) rdz_write(fd, r->message, strlen(r->message));
+    rdz_write(fd, "\n", 1);
+  }
+}
+
+#define RDZ_REP_SAMPLES 1024
+
+typedef struct rdz_rep { // RDZ_REPEAT, the tally for one "it"
+  long passes;
+  long fails;
+  double min;
+  double max;
+  double total;
+  long seen;
+  int count;
+  double *samples; // a reservoir, for the median and the p90
+} rdz_rep;
+
+rdz_rep *rdz_reps = NULL;
+long rdz_rep_runs = 0;
+long rdz_rep_failed_runs = 0;
+volatile sig_atomic_t rdz_rep_stop = 0;
+
+static void rdz_rep_sample(rdz_rep *r, double du)
+{
+  if (du < 0.0) return;
+
+  if (r->seen == 0 || du < r->min) r->min = du;
+  if (r->seen == 0 || du > r->max) r->max = du;
+  r->total += du;
+  r->seen++;
+
+  if (r->samples == NULL) r->samples = calloc(RDZ_REP_SAMPLES, sizeof(double));
+
+  if (r->count < RDZ_REP_SAMPLES) { r->samples[r->count++] = du; return; }
+
+  long j = rand() % r->seen; if (j < RDZ_REP_SAMPLES) r->samples[j] = du;
+}
+
+static void rdz_repeat_record(int n, int from, double duration)
+{
+  if (rdz_reps == NULL) return;
+
+  int failed = 0;
+  for (int i = from; i < rdz_count; i++) if (rdz_results[i].success == 0) failed = 1;
+
+  if (failed) rdz_reps[n].fails++; else rdz_reps[n].passes++;
+
+  rdz_rep_sample(rdz_reps + n, duration);
+}
+
+static void rdz_remote_send(int n, int from, double duration)
+{
+  // as a RDZ_WORKER, streams the results of an "it" to the coordinator,
+  // "it itnumber count duration\n" followed by the results
+
+  if (rdz_remote_fd < 0) return;
+
+  char h[128];
+  int l = snprintf(h, 128, "it %d %d %f\n", n, rdz_count - from, duration);
+
+  rdz_write(rdz_remote_fd, h, l);
+  rdz_write_results(rdz_remote_fd, from);
+
+  for (int i = from; i < rdz_count; i++) rdz_result_clear(rdz_results + i);
+  rdz_count = from; // keeps the worker's result table from growing
+}
+
+static char *rdz_record_results(char *ss, char *e)
+{
+  while (ss < e)
+  {
+    int success, itnumber, lnumber, ltnumber, ml, hl;
+    if (sscanf(
+      ss, "%d %d %d %d %d%n",
+      &success, &itnumber, &lnumber, &ltnumber, &ml, &hl) < 5) break;
+
+    ss += hl + 1; // the message may start with spaces, don't let scanf eat them
+    char *msg = ml > -1 ? rdz_strndup(ss, ml) : NULL;
+    ss += (ml > -1 ? ml : 0) + 1;
+
+    rdz_record(success, msg, itnumber, lnumber, ltnumber);
+  }
+
+  return ss;
+}
+
+static void rdz_read_results(int fd)
+{
+  size_t l = 0; char *s = rdz_read(fd, &l);
+
+  rdz_record_results(s, s + l);
+
+  free(s);
+}
+
+static int rdz_record_lost(int n, const char *seen, const char *msg)
+{
+  // records a failure for each "it" under n the dead worker didn't report
+
+  if ( ! rdz_doruns[n]) return 0;
+
+  char t = rdz_t->types[n];
+  const int *cs = rdz_children(n);
+  int cc = rdz_t->ccounts[n];
+
+  if (t == 'i')
+  {
+    if (seen[n]) return 0; // reported
+    if (cc > 0) { rdz_dorun(cs[0]); return 0; } // pending, nothing to run
+
+    rdz_record(0, rdz_strdup((char *)msg), n, rdz_t->lstarts[n], rdz_t->ltstarts[n]);
+    rdz_print_result(rdz_results + rdz_count - 1, -1.0);
+
+    return 1;
+  }
+  if (t != 'd' && t != 'c' && t != 'G' && t != 'g') return 0;
+
+  int lost = 0;
+  for (int i = 0; i < cc; i++) lost += rdz_record_lost(cs[i], seen, msg);
+
+  return lost;
+}
+
+int rdz_dorun_forked(int n, const int *cs, int cc, int offlines)
+{
+  // the before all has run, fork workers that inherit its state and
+  // split the children among them, their output and results are gathered
+  // back in order, returns 0 if there is no point in forking
+
+  int *runnable = calloc(cc + 1, sizeof(int)); int rc = 0;
+
+  for (int i = 0; i < cc; i++)
+  {
+    char ct = rdz_t->types[cs[i]];
+    if (ct != 'd' && ct != 'c' && ct != 'i') continue;
+    if (rdz_doruns[cs[i]]) runnable[rc++] = cs[i];
+  }
+
+  int jobs = rdz_jobs < rc ? rdz_jobs : rc;
+
+  if (jobs < 2) { free(runnable); return 0; }
+
+  int *outs = calloc(jobs, sizeof(int));
+  int *ress = calloc(jobs, sizeof(int));
+  int *tras = calloc(jobs, sizeof(int));
+  pid_t *pids = calloc(jobs, sizeof(pid_t));
+
+  istty(); fflush(stdout);
+
+  for (int w = 0; w < jobs; w++)
+  {
+    outs[w] = rdz_tmpfd("out", w);
+    ress[w] = rdz_tmpfd("res", w);
+    if (rdz_trace) tras[w] = rdz_tmpfd("trace", w);
+
+    pids[w] = fork();
+
+    if (pids[w] != 0) continue;
+
+    // worker, contiguous slices keep the output in declaration order
+
+    rdz_worker = 1;
+    dup2(outs[w], 1);
+    if (rdz_trace) rdz_trace_fork();
+
+    int from = rdz_count;
+
+    for (int i = w * rc / jobs; i < (w + 1) * rc / jobs; i++)
+    {
+      if (offlines) rdz_run_offlines(n, 'y');
+      rdz_dorun(runnable[i]);
+      if (offlines) rdz_run_offlines(n, 'z');
+    }
+
+    fflush(stdout);
+    rdz_write_results(ress[w], from);
+    if (rdz_trace) rdz_trace_dump(tras[w]);
+
+    _exit(0);
+  }
+
+  for (int w = 0; w < jobs; w++)
+  {
+    int status = 0;
+    if (pids[w] > 0) waitpid(pids[w], &status, 0);
+
+    size_t l = 0; char *o = rdz_read(outs[w], &l);
+    fwrite(o, sizeof(char), l, stdout);
+    free(o);
+
+    int from = rdz_count;
+    rdz_read_results(ress[w]);
+
+    if (rdz_trace)
+    {
+      o = rdz_read(tras[w], &l); rdz_trace_gather(o, l); free(o);
+      close(tras[w]);
+    }
+
+    if (pids[w] < 0 || ! WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+      printf(
+        "%sworker %d (I=%d) failed, status %d%s\n",
+        rdz_rd(), w, runnable[w * rc / jobs], status, rdz_cl());
+
+      char *seen = calloc(rdz_t->count, sizeof(char));
+      for (int i = from; i < rdz_count; i++) seen[rdz_results[i].itnumber] = 1;
+
+      char msg[80];
+      snprintf(msg, 80, "     worker %d failed (status %d) before reporting it", w, status);
+
+      int lost = 0;
+      for (int i = w * rc / jobs; i < (w + 1) * rc / jobs; i++)
+      {
+        lost += rdz_record_lost(runnable[i], seen, msg);
+      }
+      if (lost == 0) rdz_fail_count++; // it died after reporting, still a failure
+
+      free(seen);
+    }
+
+    close(outs[w]); close(ress[w]);
+  }
+
+  fflush(stdout);
+
+  free(pids); free(tras); free(ress); free(outs); free(runnable);
+
+  return 1;
+}
+
+void rdz_replay(rdz_job *j)
+{
+  int from = rdz_count;
+
+  for (int i = 0; i < j->count; i++)
+  {
+    rdz_result *r = j->results + i;
+
+    *rdz_results_push() = *r;
+
+    if (r->success == -1) rdz_pending_count++;
+    if (r->success == 0) rdz_fail_count++;
+  }
+
+  if (j->count == 0) // no ensure in the example, record a success...
+  {
+    rdz_record(
+      1, rdz_strdup(rdz_text(j->n)),
+      j->n, rdz_t->lstarts[j->n], rdz_t->ltstarts[j->n]);
+  }
+
+  rdz_print_result(rdz_results + rdz_count - 1, j->duration);
+
+  rdz_repeat_record(j->n, from, j->duration);
+  rdz_remote_send(j->n, from, j->duration);
+
+  free(j->results); j->results = NULL;
+}
+
+#ifdef RDZ_CONCURRENT
+
+typedef struct rdz_pool {
+  pthread_mutex_t mutex;
+  int next;
+  int count;
+  rdz_job **jobs;
+  int n; // parent node number
+  int offlines;
+} rdz_pool;
+
+static void *rdz_pool_work(void *a)
+{
+  rdz_pool *p = a;
+
+  while (1)
+  {
+    pthread_mutex_lock(&p->mutex); int i = p->next++; pthread_mutex_unlock(&p->mutex);
+
+    if (i >= p->count) break;
+
+    rdz_job *j = p->jobs[i];
+
+    rdz_job_current = j;
+
+    if (p->offlines) rdz_run_offlines(p->n, 'y');
+    rdz_sample_node = j->n;
+    j->duration = rdz_call(j->n);
+    if (p->offlines) rdz_run_offlines(p->n, 'z');
+    rdz_sample_node = p->n;
+
+    rdz_job_current = NULL;
+  }
+
+  return NULL;
+}
+
+rdz_job *rdz_run_concurrently(int n, const int *cs, int cc, int offlines)
+{
+  // runs the direct "it" children of n on a pool of RDZ_THREADS threads
+  // (defaults to the number of cores), returns one job per child,
+  // j->n is -1 for the children that are left to rdz_dorun()
+
+  rdz_job *jobs = calloc(cc, sizeof(rdz_job));
+  rdz_job **todo = calloc(cc, sizeof(rdz_job *));
+  int count = 0;
+
+  for (int i = 0; i < cc; i++)
+  {
+    int cn = cs[i];
+    jobs[i].n = -1;
+    if (rdz_t->types[cn] != 'i' || ! rdz_doruns[cn]) continue;
+    if (rdz_t->ccounts[cn] > 0) continue; // pending
+    jobs[i].n = cn; todo[count++] = jobs + i;
+  }
+
+  char *e = getenv("RDZ_THREADS");
+  long threads = e ? atol(e) : 4;
+#ifdef _SC_NPROCESSORS_ONLN
+  if (e == NULL) threads = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+  if (threads > count) threads = count;
+  if (threads < 1) threads = 1;
+
+  rdz_pool p;
+  pthread_mutex_init(&p.mutex, NULL);
+  p.next = 0; p.count = count; p.jobs = todo; p.n = n; p.offlines = offlines;
+
+  pthread_t *ts = calloc(threads, sizeof(pthread_t));
+
+  double start = rdz_now();
+
+  long started = 1; // this thread works as well
+
+  for (; started < threads; started++)
+  {
+    int r = pthread_create(ts + started, NULL, rdz_pool_work, &p);
+    if (r == 0) continue;
+
+    static int warned = 0;
+    if ( ! warned++) fprintf(
+      stderr, "couldn't start thread %ld of %ld (%s), running on %ld\n",
+      started + 1, threads, strerror(r), started);
+    break;
+  }
+
+  rdz_pool_work(&p);
+  for (long i = 1; i < started; i++) pthread_join(ts[i], NULL);
+
+  rdz_conc_wall += rdz_duration(start);
+  for (int i = 0; i < count; i++) rdz_conc_work += todo[i]->duration;
+
+  pthread_mutex_destroy(&p.mutex);
+  free(ts);
+  free(todo);
+
+  return jobs;
+}
+
+typedef struct rdz_stress {
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  int ready;
+  int go;
+  void (*func)(rdz_stress_thread *);
+} rdz_stress;
+
+typedef struct rdz_stress_report {
+  int n;
+  int threads;
+  int asked; // more than threads when some couldn't be started
+  long done;
+  double wall;
+  double *ops; // per thread, ops/s
+} rdz_stress_report;
+
+rdz_stress_report *rdz_stresses = NULL;
+int rdz_stress_count = 0;
+
+static void *rdz_stress_work(void *a)
+{
+  rdz_stress_thread *t = a;
+  rdz_stress *s = t->stress;
+
+  pthread_mutex_lock(&s->mutex); // wait for all the threads to be ready
+  s->ready++;
+  pthread_cond_broadcast(&s->cond);
+  while ( ! s->go) pthread_cond_wait(&s->cond, &s->mutex);
+  pthread_mutex_unlock(&s->mutex);
+
+  rdz_stress_current = t;
+
+  double start = rdz_now();
+  s->func(t);
+  t->duration = rdz_duration(start);
+
+  rdz_stress_current = NULL;
+
+  return NULL;
+}
+
+void rdz_stress_run(
+  void (*func)(rdz_stress_thread *), int threads, long iterations, int n)
+{
+  // runs the body of the "it" on threads, all released at once,
+  // the results are folded per ensure line, a failure in any thread wins
+
+  rdz_stress s;
+  pthread_mutex_init(&s.mutex, NULL);
+  pthread_cond_init(&s.cond, NULL);
+  s.ready = 0; s.go = 0; s.func = func;
+
+  rdz_stress_thread *ts = calloc(threads, sizeof(rdz_stress_thread));
+  pthread_t *ps = calloc(threads, sizeof(pthread_t));
+
+  int asked = threads;
+
+  for (int i = 0; i < asked; i++)
+  {
+    ts[i].thread = i; ts[i].iterations = iterations; ts[i].stress = &s;
+
+    int r = pthread_create(ps + i, NULL, rdz_stress_work, ts + i);
+    if (r == 0) continue;
+
+    fprintf(
+      stderr, "couldn't start stress thread %d of %d (%s), running on %d\n",
+      i + 1, asked, strerror(r), i > 0 ? i : 1);
+    threads = i; // only wait for the threads that started
+    break;
+  }
+
+  pthread_mutex_lock(&s.mutex);
+  while (s.ready < threads) pthread_cond_wait(&s.cond, &s.mutex);
+  double start = rdz_now();
+  s.go = 1;
+  pthread_cond_broadcast(&s.cond);
+  pthread_mutex_unlock(&s.mutex);
+
+  for (int i = 0; i < threads; i++) pthread_join(ps[i], NULL);
+
+  if (threads == 0) { rdz_stress_work(ts); threads = 1; } // on this thread
+
+  double wall = rdz_duration(start);
+
+  rdz_stress_site sites[RDZ_STRESS_SITES_MAX]; int count = 0;
+
+  for (int i = 0; i < threads; i++)
+  {
+    for (int j = 0; j < ts[i].count; j++)
+    {
+      rdz_stress_site *ss = ts[i].sites + j;
+      char *m = ss->message;
+
+      if (ss->success == 0)
+      {
+        size_t l = (m ? strlen(m) : 0) + 64; char *mm = calloc(l, sizeof(char));
+        snprintf(
+          mm, l, "%s%s     in thread %d, iteration %ld",
+          m ? m : "", m ? "\n" : "", i, ss->iteration);
+        free(m); m = mm;
+      }
+
+      rdz_stress_site_record(
+        sites, &count, ss->iteration,
+        ss->success, m, ss->itnumber, ss->lnumber, ss->ltnumber);
+    }
+  }
+
+  for (int i = 0; i < count; i++)
+  {
+    rdz_stress_site *ss = sites + i;
+    rdz_record(ss->success, ss->message, ss->itnumber, ss->lnumber, ss->ltnumber);
+  }
+
+  rdz_stresses = realloc(
+    rdz_stresses, (rdz_stress_count + 1) * sizeof(rdz_stress_report));
+  rdz_stress_report *r = rdz_stresses + rdz_stress_count++;
+  r->n = n; r->threads = threads; r->asked = asked; r->done = 0; r->wall = wall;
+  r->ops = calloc(threads, sizeof(double));
+
+  for (int i = 0; i < threads; i++)
+  {
+    r->done += ts[i].done;
+    r->ops[i] = ts[i].duration > 0.0 ? ts[i].done * 1000.0 / ts[i].duration : 0.0;
+  }
+
+  pthread_cond_destroy(&s.cond);
+  pthread_mutex_destroy(&s.mutex);
+  free(ps);
+  free(ts);
+}
+
+void rdz_stress_summary(int print)
+{
+  for (int i = 0; print && i < rdz_stress_count; i++)
+  {
+    rdz_stress_report *r = rdz_stresses + i;
+
+    if (i == 0) printf(rdz_fail_count > 0 ? "\nStress:\n\n" : "Stress:\n\n");
+
+    char *title = rdz_determine_title(r->n);
+    double ops = r->wall > 0.0 ? r->done * 1000.0 / r->wall : 0.0;
+
+    printf("  %s\n", title);
+    char of[32] = "";
+    if (r->asked > r->threads) snprintf(of, sizeof(of), " (of %d asked)", r->asked);
+    printf(
+      "     %s%d threads%s, %ld iterations, %.0f ops/s%s\n",
+      rdz_gr(), r->threads, of, r->done, ops, rdz_cl());
+    for (int j = 0; j < r->threads; j++)
+    {
+      printf("       %sthread %d: %.0f ops/s%s\n", rdz_gr(), j, r->ops[j], rdz_cl());
+    }
+
+    free(title);
+  }
+
+  if (print && rdz_stress_count > 0) printf("\n");
+
+  for (int i = 0; i < rdz_stress_count; i++) free(rdz_stresses[i].ops);
+  free(rdz_stresses); rdz_stresses = NULL; rdz_stress_count = 0;
+}
+
+#endif
+
+static int *rdz_opened = NULL; // RDZ_WORKER, the groups entered, in order
+static int rdz_opened_count = 0;
+
+void rdz_dorun(int n)
+{
+  if (n == 0) printf("\n"); // initial blank line
+
+  if ( ! rdz_doruns[n]) return;
+
+  char t = rdz_t->types[n];
+  const int *cs = rdz_children(n);
+  int cc = rdz_t->ccounts[n];
+
+  if (t != 'p') rdz_sample_node = n;
+
+  if (t == 'i')
+  {
+    if (cc > 0) { rdz_dorun(cs[0]); return; }
+
+    int rc = rdz_count;
+
+    rdz_coverage_start();
+
+    long blocks = RDZ_BLOCKS();
+
+    double du = rdz_call(n); // run the "it"
+
+    if (rdz_leaky) rdz_leak_check(n, rc, blocks);
+
+    rdz_coverage_stop(n);
+
+    rdz_sample_node = rdz_t->parents[n];
+    if (rdz_sample_hz) rdz_sample_drain();
+
+    if (rdz_count == rc) // no ensure in the example, record a success...
+    {
+      rdz_record(
+        1, rdz_strdup(rdz_text(n)),
+        n, rdz_t->lstarts[n], rdz_t->ltstarts[n]);
+    }
+
+    rdz_print_result(rdz_results + rdz_count - 1, du);
+
+    rdz_repeat_record(n, rc, du);
+    rdz_remote_send(n, rc, du);
+
+    for (int i = rc; n == rdz_bisect_it && i < rdz_count; i++) // right away
+    {
+      if (rdz_results[i].success != 0) continue;
+      char s[32]; int l = snprintf(s, 32, "%d\n", n); rdz_write(rdz_bisect_fd, s, l);
+    }
+  }
+  else if (t == 'p')
+  {
+    rdz_record(
+      -1, rdz_strdup(rdz_text(n)),
+      rdz_t->parents[n], rdz_t->lstarts[n], rdz_t->ltstarts[n]);
+
+    rdz_print_result(rdz_results + rdz_count - 1, -1.0);
+  }
+  else if (t == 'G' || t == 'g' || t == 'd' || t == 'c')
+  {
+    rdz_print_level(n);
+    if (rdz_trace && (t == 'd' || t == 'c')) rdz_trace_record('B', n);
+    int offlines = rdz_has_offlines(n); // spare a scan per child if none
+    int befores = 0;
+    int open = 0; // a worker's later chunk entering the group again
+    for (int i = 0; rdz_opened && i < rdz_opened_count; i++)
+    {
+      if (rdz_opened[i] == n) open = 1;
+    }
+    if (rdz_opened && ! open) rdz_opened[rdz_opened_count++] = n;
+    for (int i = 0; ! open && i < cc; i++) // before all
+    {
+      if (rdz_t->types[cs[i]] == 'B') { rdz_call(cs[i]); befores++; }
+    }
+    int forked = 0;
+    if (befores && rdz_jobs > 1 && ! rdz_worker) // RDZ_JOBS=4
+    {
+      forked = rdz_dorun_forked(n, cs, cc, offlines);
+    }
+    rdz_job *jobs = NULL;
+#ifdef RDZ_CONCURRENT
+    if ( ! forked && (rdz_t->flags[n] & RDZ_F_CONCURRENT))
+    {
+      jobs = rdz_run_concurrently(n, cs, cc, offlines);
+    }
+#endif
+    for (int i = 0; ! forked && i < cc; i++) // children
+    {
+      char ct = rdz_t->types[cs[i]];
+      if (ct != 'd' && ct != 'c' && ct != 'i') continue;
+      if (jobs && jobs[i].n > -1) { rdz_replay(jobs + i); continue; }
+      if (offlines) rdz_run_offlines(n, 'y'); // before each offline
+      rdz_dorun(cs[i]);
+      rdz_sample_node = n;
+      if (offlines) rdz_run_offlines(n, 'z'); // after each offline
+    }
+    free(jobs);
+    for (int i = 0; ! rdz_opened && i < cc; i++) // after all
+    {
+      if (rdz_t->types[cs[i]] == 'A') rdz_call(cs[i]);
+    }
+    if (rdz_trace && (t == 'd' || t == 'c')) rdz_trace_record('E', n);
+  }
+}
+
+int rdz_reachable(int n)
+{
+  // would rdz_dorun(0) reach the node?
+
+  for (int m = n; m > -1; m = rdz_t->parents[m]) if ( ! rdz_doruns[m]) return 0;
+
+  return 1;
+}
+
+  //
+  // RDZ_LIST / RDZ_DURATIONS
+
+#include "fnv.c" // rdz_fnv(), shared with rodzo, spliced in by the Makefile
+
+static int rdz_title_ordinal(int n)
+{
+  // 1 for the first sibling with that title, 2 for the next one, ...
+
+  int p = rdz_t->parents[n]; if (p < 0) return 1;
+
+  const int *cs = rdz_children(p);
+  int o = 1;
+
+  for (int i = 0; i < rdz_t->ccounts[p] && cs[i] != n; i++)
+  {
+    char t = rdz_t->types[cs[i]];
+    if (t != 'd' && t != 'c' && t != 'i') continue;
+    if (strcmp(rdz_text(cs[i]), rdz_text(n)) == 0) o++;
+  }
+
+  return o;
+}
+
+unsigned long long rdz_stable_id(int n)
+{
+  // FNV-1a over the file name and the titles, from the top down, it
+  // survives lines moving around, rodzo --list computes the same,
+  // siblings bearing the same title are told apart by their ordinal
+
+  unsigned long long h = rdz_fnv(RDZ_FNV_START, rdz_fname(n));
+
+  int chain[128]; int cl = 0;
+
+  for (int m = n; m > -1 && cl < 128; m = rdz_t->parents[m])
+  {
+    char t = rdz_t->types[m];
+    if (t == 'd' || t == 'c' || t == 'i') chain[cl++] = m;
+  }
+
+  for (int i = cl - 1; i >= 0; i--)
+  {
+    h = rdz_fnv_title(h, rdz_text(chain[i]), rdz_title_ordinal(chain[i]));
+  }
+
+  return h;
+}
+
+typedef struct rdz_known_duration {
+  unsigned long long id;
+  double duration; // ms
+} rdz_known_duration;
+
+static int rdz_known_duration_cmp(const void *a, const void *b)
+{
+  unsigned long long ia = ((const rdz_known_duration *)a)->id;
+  unsigned long long ib = ((const rdz_known_duration *)b)->id;
+
+  return ia < ib ? -1 : ia > ib;
+}
+
+static rdz_known_duration *rdz_durations_load(size_t *count)
+{
+  // reads the "id duration" lines of the RDZ_DURATIONS file, sorted by id
+
+  *count = 0;
+
+  FILE *f = rdz_durations ? fopen(rdz_durations, "r") : NULL;
+  if (f == NULL) return NULL;
+
+  size_t size = 1024;
+  rdz_known_duration *ds = calloc(size, sizeof(rdz_known_duration));
+
+  unsigned long long id; double du;
+
+  while (fscanf(f, "%llx %lf", &id, &du) == 2)
+  {
+    if (*count >= size) { size *= 2; ds = realloc(ds, size * sizeof(*ds)); }
+    ds[*count].id = id; ds[(*count)++].duration = du;
+  }
+  fclose(f);
+
+  qsort(ds, *count, sizeof(rdz_known_duration), rdz_known_duration_cmp);
+
+  return ds;
+}
+
+static double rdz_durations_find(rdz_known_duration *ds, size_t count, int n)
+{
+  rdz_known_duration k = { rdz_stable_id(n), 0.0 };
+
+  rdz_known_duration *d = ds ?
+    bsearch(&k, ds, count, sizeof(k), rdz_known_duration_cmp) : NULL;
+
+  return d ? d->duration : -1.0;
+}
+
+void rdz_durations_save()
+{
+  // merges the durations of this run into the RDZ_DURATIONS file
+
+  if (rdz_durations == NULL || rdz_ran == NULL) return;
+
+  size_t count = 0; rdz_known_duration *ds = rdz_durations_load(&count);
+
+  char *tmp = calloc(strlen(rdz_durations) + 5, sizeof(char));
+  strcpy(tmp, rdz_durations); strcat(tmp, ".tmp");
+
+  FILE *f = fopen(tmp, "w");
+
+  if (f == NULL) { free(tmp); free(ds); return; }
+
+  for (int n = 0; n < rdz_t->count; n++)
+  {
+    if (rdz_ran[n] < 0.0) continue;
+
+    unsigned long long id = rdz_stable_id(n);
+    rdz_known_duration k = { id, 0.0 };
+    rdz_known_duration *d = ds ?
+      bsearch(&k, ds, count, sizeof(k), rdz_known_duration_cmp) : NULL;
+
+    if (d) d->duration = -1.0; // superseded
+    fprintf(f, "%016llx %f\n", id, rdz_ran[n]);
+  }
+  for (size_t i = 0; i < count; i++)
+  {
+    if (ds[i].duration >= 0.0) fprintf(f, "%016llx %f\n", ds[i].id, ds[i].duration);
+  }
+
+  fclose(f);
+  rename(tmp, rdz_durations);
+
+  free(tmp); free(ds);
+}
+
+void rdz_list_nodes()
+{
+  // one JSON line per describe, context and it, in run order, honours
+  // E=, L=, I=, F= and S=, runs nothing (not even the before alls)
+
+  size_t dcount = 0; rdz_known_duration *ds = rdz_durations_load(&dcount);
+
+  for (int n = 0; n < rdz_t->count; n++)
+  {
+    char t = rdz_t->types[n];
+
+    if (t != 'd' && t != 'c' && t != 'i') continue;
+    if ( ! rdz_reachable(n)) continue;
+
+    printf(
+      "{\"id\":\"%016llx\",\"n\":%d,\"type\":\"%s\",\"file\":",
+      rdz_stable_id(n), n,
+      t == 'd' ? "describe" : (t == 'c' ? "context" : "it"));
+    rdz_json_string(stdout, rdz_fname(n));
+    printf(
+      ",\"lstart\":%d,\"ltstart\":%d,\"llength\":%d,\"titles\":[",
+      rdz_t->lstarts[n], rdz_t->ltstarts[n], rdz_t->llengths[n]);
+
+    int chain[128]; int cl = 0;
+    for (int m = n; m > -1 && cl < 128; m = rdz_t->parents[m])
+    {
+      char mt = rdz_t->types[m];
+      if (mt == 'd' || mt == 'c' || mt == 'i') chain[cl++] = m;
+    }
+    for (int i = cl - 1; i >= 0; i--)
+    {
+      if (i < cl - 1) putchar(',');
+      rdz_json_string(stdout, rdz_text(chain[i]));
+    }
+
+    printf("],\"tags\":[");
+    int tc = 0;
+    if (t == 'i' && rdz_t->ccounts[n] > 0) printf("%s\"pending\"", tc++ ? "," : "");
+    if (rdz_t->flags[n] & RDZ_F_CONCURRENT) printf("%s\"concurrent\"", tc++ ? "," : "");
+    if (rdz_t->flags[n] & RDZ_F_STRESS) printf("%s\"stress\"", tc++ ? "," : "");
+
+    double du = t == 'i' ? rdz_durations_find(ds, dcount, n) : -1.0;
+    if (du < 0.0) printf("],\"duration\":null}\n");
+    else printf("],\"duration\":%f}\n", du);
+  }
+
+  free(ds);
+}
+
+  //
+  // RDZ_COORDINATOR / RDZ_WORKER
+
+#ifdef RDZ_WITH_REMOTE
+
+static int rdz_socket(const char *addr, int listening)
+{
+  // "/tmp/s.sock" is a unix socket, "localhost:7001" or ":7001" is tcp,
+  // ":7001" listens on the loopback only, the protocol isn't authenticated,
+  // "*:7001" (or "0.0.0.0:7001") is needed to listen on every interface
+
+  int fd = -1;
+
+  if (strchr(addr, '/'))
+  {
+    struct sockaddr_un sa; memset(&sa, 0, sizeof(sa));
+    sa.sun_family = AF_UNIX;
+    snprintf(sa.sun_path, sizeof(sa.sun_path), "%s", addr);
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0); if (fd < 0) return -1;
+
+    if (listening) unlink(addr);
+
+    int r = listening ?
+      bind(fd, (struct sockaddr *)&sa, sizeof(sa)) || listen(fd, 64) :
+      connect(fd, (struct sockaddr *)&sa, sizeof(sa));
+
+    if (r != 0) { close(fd); return -1; }
+
+    return fd;
+  }
+
+  char *c = strrchr(addr, ':');
+  char host[256]; snprintf(host, 256, "%.*s", c ? (int)(c - addr) : 0, addr);
+
+  struct addrinfo hints, *ai = NULL;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+
+  const char *h = *host ? host : NULL;
+  if (listening && h == NULL) h = "127.0.0.1"; // ":7001", the loopback only
+  if (h && strcmp(h, "*") == 0) { h = NULL; hints.ai_flags = AI_PASSIVE; }
+
+  if (getaddrinfo(h, c ? c + 1 : addr, &hints, &ai) != 0)
+  {
+    return -1;
+  }
+
+  for (struct addrinfo *a = ai; a; a = a->ai_next)
+  {
+    fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+    if (fd < 0) continue;
+
+    int one = 1;
+    if (listening) setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    int r = listening ?
+      bind(fd, a->ai_addr, a->ai_addrlen) || listen(fd, 64) :
+      connect(fd, a->ai_addr, a->ai_addrlen);
+
+    if (r == 0) break;
+
+    close(fd); fd = -1;
+  }
+
+  freeaddrinfo(ai);
+
+  return fd;
+}
+
+typedef struct rdz_unit { // an "it" handed out by the coordinator
+  int n;
+  int state; // 0 queued, 1 handed out, 2 done
+  int owners; // how many workers have it (2 when stolen)
+  int tries;
+  double duration;
+  int count;
+  rdz_result *results;
+} rdz_unit;
+
+typedef struct rdz_peer { // a connected worker
+  int fd;
+  char *buf;
+  size_t len;
+  size_t size;
+  int *units; // the units handed to the worker, in order
+  int ucount;
+  int usize;
+  double seen; // last time it sent something, ms
+  int busy;
+} rdz_peer;
+
+#define RDZ_PEERS_MAX 256
+#define RDZ_CHUNK_MAX 16
+#define RDZ_UNIT_RESULTS_MAX 1048576 // per example, more is a protocol error
+
+static char *rdz_parse_results(
+  char *s, char *e, int count, rdz_result *rs, int *bad)
+{
+  // parses count results written by rdz_write_results(), returns a pointer
+  // past them, or NULL if they're not all there yet (rs is NULL: check only)
+  // or if they don't make sense (*bad is set then)
+
+  for (int i = 0; i < count; i++)
+  {
+    if (memchr(s, '\n', e - s) == NULL) return NULL;
+
+    int success, itnumber, lnumber, ltnumber, ml, hl;
+    if (
+      sscanf(
+        s, "%d %d %d %d %d%n",
+        &success, &itnumber, &lnumber, &ltnumber, &ml, &hl) < 5 ||
+      success < -1 || success > 1 ||
+      itnumber < 0 || itnumber >= rdz_t->count || ml < -1
+    ) { *bad = 1; return NULL; }
+
+    s += hl + 1;
+    if ((ml > -1 ? ml : 0) + 1 > e - s) return NULL;
+
+    if (rs)
+    {
+      char *msg = ml > -1 ? rdz_strndup(s, ml) : NULL;
+      rdz_result_init(rs + i, success, msg, itnumber, lnumber, ltnumber);
+    }
+
+    s += (ml > -1 ? ml : 0) + 1;
+  }
+
+  return s;
+}
+
+static void rdz_unit_done(rdz_unit *u, int count, rdz_result *rs, double du)
+{
+  u->state = 2; u->count = count; u->results = rs; u->duration = du;
+}
+
+static int rdz_peer_assign(rdz_peer *p, rdz_unit *us, int uc, int live)
+{
+  // hands a chunk to the worker, chunks shrink as the queue empties,
+  // once it's empty the idle worker steals the tail of the biggest
+  // outstanding chunk (first result wins), returns 0 if nothing to hand
+
+  int queued = 0;
+  for (int i = 0; i < uc; i++) if (us[i].state == 0) queued++;
+
+  int chunk = queued / (2 * (live > 0 ? live : 1));
+  if (chunk > RDZ_CHUNK_MAX) chunk = RDZ_CHUNK_MAX;
+  if (chunk < 1) chunk = 1;
+
+  int *picks = calloc(chunk, sizeof(int)); int k = 0;
+
+  for (int i = 0; i < uc && k < chunk; i++)
+  {
+    if (us[i].state == 0) picks[k++] = i;
+  }
+
+  if (k == 0) // steal
+  {
+    for (int i = uc - 1; i >= 0 && k < chunk; i--)
+    {
+      if (us[i].state != 1 || us[i].owners > 1) continue;
+
+      int mine = 0;
+      for (int j = 0; j < p->ucount; j++) if (p->units[j] == i) mine = 1;
+
+      if ( ! mine) picks[k++] = i;
+    }
+    for (int i = 0; i < k / 2; i++) // back in tree order
+    {
+      int x = picks[i]; picks[i] = picks[k - 1 - i]; picks[k - 1 - i] = x;
+    }
+  }
+
+  if (k == 0) { free(picks); p->busy = 0; return 0; }
+
+  size_t l = 8 + 12 * k; char *line = calloc(l, sizeof(char));
+  strcpy(line, "run"); char *ll = line + 3;
+
+  for (int i = 0; i < k; i++)
+  {
+    rdz_unit *u = us + picks[i];
+    u->state = 1; u->owners++;
+
+    if (p->ucount >= p->usize)
+    {
+      p->usize = p->usize * 2 + RDZ_CHUNK_MAX;
+      p->units = realloc(p->units, p->usize * sizeof(int));
+    }
+    p->units[p->ucount++] = picks[i];
+
+    ll += snprintf(ll, l - (ll - line), " %d", u->n);
+  }
+  strcat(ll, "\n");
+
+  rdz_write(p->fd, line, strlen(line));
+
+  p->busy = 1; p->seen = rdz_now();
+
+  free(line); free(picks);
+
+  return k;
+}
+
+static int rdz_peer_lost(rdz_peer *p, rdz_unit *us, int retries)
+{
+  // the worker crashed, hung up or timed out, its undone units are
+  // requeued, the one it was probably running counts a try,
+  // returns how many units got done (given up on)
+
+  int done = 0;
+  int first = 1;
+
+  for (int i = 0; i < p->ucount; i++)
+  {
+    rdz_unit *u = us + p->units[i];
+
+    if (u->state == 2) continue;
+
+    if (--u->owners > 0) { first = 0; continue; }
+
+    if (first) u->tries++;
+    first = 0;
+
+    u->state = 0;
+
+    if (u->tries <= retries) continue;
+
+    rdz_result *r = calloc(1, sizeof(rdz_result));
+    char *msg = calloc(128, sizeof(char));
+    snprintf(msg, 128, "     worker lost %d times (crash or timeout)", u->tries);
+    rdz_result_init(
+      r, 0, msg, u->n, rdz_t->lstarts[u->n], rdz_t->ltstarts[u->n]);
+
+    rdz_unit_done(u, 1, r, -1.0);
+    done++;
+  }
+
+  close(p->fd); p->fd = -1;
+  free(p->buf); p->buf = NULL; p->len = 0; p->size = 0;
+  free(p->units); p->units = NULL; p->ucount = 0; p->usize = 0;
+  p->busy = 0;
+
+  return done;
+}
+
+static int rdz_peer_read(rdz_peer *p, rdz_unit *us, const int *lookup, int *done)
+{
+  // reads what the worker sent, returns -1 if it's gone, 1 if it finished
+  // its chunk, 0 else
+
+  if (p->len + 4097 > p->size)
+  {
+    p->size = p->size * 2 + 4097; p->buf = realloc(p->buf, p->size);
+  }
+
+  ssize_t r = read(p->fd, p->buf + p->len, p->size - p->len - 1);
+  if (r < 1) return -1;
+
+  p->len += r; p->buf[p->len] = '\0';
+  p->seen = rdz_now();
+
+  int finished = 0;
+  char *s = p->buf;
+  char *e = p->buf + p->len;
+
+  while (s < e && memchr(s, '\n', e - s))
+  {
+    if (strncmp(s, "done\n", 5) == 0) { s += 5; finished = 1; continue; }
+
+    int n, count, hl, bad = 0; double du;
+    if (
+      sscanf(s, "it %d %d %lf%n", &n, &count, &du, &hl) < 3 ||
+      n < 0 || n >= rdz_t->count || lookup[n] < 0 ||
+      count < 0 || count > RDZ_UNIT_RESULTS_MAX
+    ) return -1; // protocol error, let it go
+
+    char *ss = s + hl + 1;
+    if (rdz_parse_results(ss, e, count, NULL, &bad) == NULL)
+    {
+      if (bad) return -1;
+      break; // wait for more
+    }
+
+    rdz_unit *u = us + lookup[n];
+    rdz_result *rs = calloc(count > 0 ? count : 1, sizeof(rdz_result));
+
+    s = rdz_parse_results(ss, e, count, rs, &bad);
+
+    if (u->state == 2) // stolen and already done, first result wins
+    {
+      for (int i = 0; i < count; i++) rdz_result_clear(rs + i);
+      free(rs);
+    }
+    else
+    {
+      rdz_unit_done(u, count, rs, du); (*done)++;
+    }
+  }
+
+  p->len = e - s; memmove(p->buf, s, p->len); p->buf[p->len] = '\0';
+
+  return finished;
+}
+
+static void rdz_coordinate_print(int n, rdz_unit *us, const int *lookup)
+{
+  // the tree is printed as for a local run, the results are those
+  // streamed back by the workers
+
+  if (n == 0) printf("\n"); // initial blank line
+
+  if ( ! rdz_doruns[n]) return;
+
+  char t = rdz_t->types[n];
+  const int *cs = rdz_children(n);
+  int cc = rdz_t->ccounts[n];
+
+  if (t == 'i' && lookup[n] > -1)
+  {
+    rdz_unit *u = us + lookup[n];
+
+    for (int i = 0; i < u->count; i++)
+    {
+      rdz_result *r = u->results + i;
+
+      *rdz_results_push() = *r;
+
+      if (r->success == -1) rdz_pending_count++;
+      if (r->success == 0) rdz_fail_count++;
+    }
+
+    if (u->count == 0)
+    {
+      rdz_record(
+        1, rdz_strdup(rdz_text(n)), n, rdz_t->lstarts[n], rdz_t->ltstarts[n]);
+    }
+
+    rdz_print_result(rdz_results + rdz_count - 1, u->duration);
+
+    free(u->results); u->results = NULL;
+  }
+  else if (t == 'i' || t == 'p')
+  {
+    rdz_dorun(n); // pending, nothing gets run
+  }
+  else if (t == 'G' || t == 'g' || t == 'd' || t == 'c')
+  {
+    rdz_print_level(n);
+
+    for (int i = 0; i < cc; i++)
+    {
+      char ct = rdz_t->types[cs[i]];
+      if (ct == 'd' || ct == 'c' || ct == 'i') rdz_coordinate_print(cs[i], us, lookup);
+    }
+  }
+}
+
+void rdz_coordinate()
+{
+  // serves the selected "it"s to the RDZ_WORKERs connecting, runs none
+  // of them, not even the before alls, then prints the gathered results
+
+  signal(SIGPIPE, SIG_IGN); // a worker may die while being written to
+
+  int lfd = rdz_socket(rdz_coordinator, 1);
+
+  if (lfd < 0)
+  {
+    fprintf(stderr, "couldn't listen on %s\n", rdz_coordinator);
+    exit(1);
+  }
+
+  char *e = getenv("RDZ_TIMEOUT"); // seconds
+  double timeout = (e ? atof(e) : 60.0) * 1000.0;
+  e = getenv("RDZ_RETRIES");
+  int retries = e ? atoi(e) : 2;
+
+  int *lookup = calloc(rdz_t->count, sizeof(int));
+  rdz_unit *us = calloc(rdz_t->count, sizeof(rdz_unit));
+  int uc = 0;
+
+  for (int n = 0; n < rdz_t->count; n++)
+  {
+    lookup[n] = -1;
+
+    if (rdz_t->types[n] != 'i' || rdz_t->ccounts[n] > 0) continue;
+    if ( ! rdz_reachable(n)) continue;
+
+    us[uc].n = n; lookup[n] = uc++;
+  }
+
+  rdz_peer *ps = calloc(RDZ_PEERS_MAX, sizeof(rdz_peer)); int pc = 0;
+  struct pollfd *fds = calloc(RDZ_PEERS_MAX + 1, sizeof(struct pollfd));
+
+  int done = 0;
+
+  while (done < uc)
+  {
+    int live = 0;
+    for (int i = 0; i < pc; i++) if (ps[i].fd > -1) live++;
+
+    for (int i = 0; i < pc; i++) // idle workers get work
+    {
+      if (ps[i].fd > -1 && ! ps[i].busy) rdz_peer_assign(ps + i, us, uc, live);
+    }
+
+    fds[0].fd = lfd; fds[0].events = POLLIN; fds[0].revents = 0;
+    for (int i = 0; i < pc; i++)
+    {
+      fds[i + 1].fd = ps[i].fd; fds[i + 1].events = POLLIN; fds[i + 1].revents = 0;
+    }
+
+    if (poll(fds, pc + 1, 1000) < 0 && errno != EINTR) break;
+
+    if ((fds[0].revents & POLLIN) && pc < RDZ_PEERS_MAX)
+    {
+      int fd = accept(lfd, NULL, NULL);
+
+      if (fd > -1) { ps[pc].fd = fd; ps[pc].seen = rdz_now(); pc++; }
+    }
+
+    for (int i = 0; i < pc; i++)
+    {
+      rdz_peer *p = ps + i;
+
+      if (p->fd < 0) continue;
+
+      int r = 0;
+
+      if (fds[i + 1].revents) r = rdz_peer_read(p, us, lookup, &done);
+
+      if (r == 0 && p->busy && rdz_now() - p->seen > timeout) r = -1;
+
+      if (r < 0) done += rdz_peer_lost(p, us, retries);
+      else if (r > 0) p->busy = 0;
+    }
+  }
+
+  for (int i = 0; i < pc; i++)
+  {
+    if (ps[i].fd < 0) continue;
+
+    rdz_write(ps[i].fd, "quit\n", 5);
+    close(ps[i].fd);
+    free(ps[i].buf); free(ps[i].units);
+  }
+
+  close(lfd);
+  if (strchr(rdz_coordinator, '/')) unlink(rdz_coordinator);
+
+  rdz_coordinate_print(0, us, lookup);
+
+  free(fds); free(ps);
+  free(us); free(lookup);
+}
+
+void rdz_work()
+{
+  // connects to the RDZ_COORDINATOR and runs the chunks it hands out,
+  // "run 3 5 7\n", until it says "quit\n" or hangs up
+
+  int fd = -1;
+
+  for (int i = 0; fd < 0 && i < 50; i++) // the coordinator may be starting
+  {
+    fd = rdz_socket(rdz_remote, 0);
+
+    struct timespec ts = { 0, 100 * 1000 * 1000 };
+    if (fd < 0) nanosleep(&ts, NULL);
+  }
+
+  if (fd < 0)
+  {
+    fprintf(stderr, "couldn't connect to %s\n", rdz_remote);
+    rdz_fail_count++;
+    return;
+  }
+
+  rdz_remote_fd = fd;
+  rdz_worker = 1; // no RDZ_JOBS forking under a coordinator
+
+  // the chunks are run one after the other, the before alls of a group
+  // are run when a chunk enters it for the first time, the after alls
+  // when the coordinator is done with the worker, as for a serial run
+
+  rdz_opened = calloc(rdz_t->count, sizeof(int));
+  rdz_opened_count = 0;
+
+  size_t size = 1024; char *line = calloc(size, sizeof(char));
+
+  while (1)
+  {
+    size_t l = 0;
+
+    while (1)
+    {
+      if (l + 1 >= size) { size *= 2; line = realloc(line, size); }
+      if (read(fd, line + l, 1) < 1) { l = 0; break; }
+      if (line[l] == '\n') break;
+      l++;
+    }
+    line[l] = '\0';
+
+    if (strncmp(line, "run ", 4) != 0) break; // "quit" or gone
+
+    memset(rdz_doruns, 0, rdz_t->count * sizeof(int));
+
+    for (char *s = line + 4; *s; )
+    {
+      int n = (int)strtol(s, &s, 10);
+      if (n < 1 || n >= rdz_t->count) break;
+
+      for (int m = n; m > -1; m = rdz_t->parents[m]) rdz_doruns[m] = 1;
+    }
+
+    rdz_dorun(0);
+    fflush(stdout);
+
+    rdz_write(fd, "done\n", 5);
+  }
+
+  for (int o = rdz_opened_count - 1; o >= 0; o--) // after all, innermost first
+  {
+    int n = rdz_opened[o];
+    const int *cs = rdz_children(n);
+
+    for (int i = 0; i < rdz_t->ccounts[n]; i++)
+    {
+      if (rdz_t->types[cs[i]] == 'A') rdz_call(cs[i]);
+    }
+  }
+  fflush(stdout);
+
+  free(rdz_opened); rdz_opened = NULL;
+
+  free(line);
+  close(fd);
+  rdz_remote_fd = -1;
+}
+
+#else
+
+void rdz_coordinate() {}
+void rdz_work() {}
+
+#endif // RDZ_WITH_REMOTE
+
+  //
+  // RDZ_REPEAT / RDZ_UNTIL_FAIL
+
+static void rdz_rep_on_signal(int sig) { (void)sig; rdz_rep_stop = 1; }
+
+static void rdz_results_clear()
+{
+  for (int i = 0; i < rdz_count; i++) rdz_result_clear(rdz_results + i);
+  rdz_count = 0; rdz_fail_count = 0; rdz_pending_count = 0;
+}
+
+static void rdz_results_recount()
+{
+  rdz_fail_count = 0; rdz_pending_count = 0;
+
+  for (int i = 0; i < rdz_count; i++)
+  {
+    if (rdz_results[i].success == -1) rdz_pending_count++;
+    if (rdz_results[i].success == 0) rdz_fail_count++;
+  }
+}
+
+static void rdz_repeat_loop(long reps)
+{
+  // runs the selection reps times, the output goes nowhere, the
+  // results of the first failing run are kept for the summary,
+  // else those of the last run
+
+  rdz_result *kept = NULL; int kc = 0; // the first failing run's results
+
+  for (long r = 0; r < reps && ! rdz_rep_stop; r++)
+  {
+    if (r > 0 && kept == NULL && rdz_fail_count > 0) // keep them aside
+    {
+      kept = calloc(rdz_count + 1, sizeof(rdz_result)); kc = rdz_count;
+      memcpy(kept, rdz_results, kc * sizeof(rdz_result));
+      rdz_count = 0; rdz_fail_count = 0; rdz_pending_count = 0;
+    }
+    else if (r > 0)
+    {
+      rdz_results_clear();
+    }
+
+    rdz_dorun(0);
+    fflush(stdout);
+
+    rdz_rep_runs++;
+
+    if (rdz_fail_count < 1) continue;
+
+    rdz_rep_failed_runs++;
+
+    if (rdz_until_fail) break;
+  }
+
+  if (kept)
+  {
+    rdz_results_clear();
+    memcpy(rdz_results, kept, kc * sizeof(rdz_result)); rdz_count = kc;
+    free(kept);
+  }
+
+  rdz_results_recount();
+}
+
+static void rdz_repeat_write(int fd)
+{
+  // "runs failed\n", then "n passes fails min max total seen samples...\n"
+  // per "it", then "--\n" and the kept results
+
+  char *s = NULL; size_t l = 0; FILE *f = open_memstream(&s, &l);
+
+  fprintf(f, "%ld %ld\n", rdz_rep_runs, rdz_rep_failed_runs);
+
+  for (int n = 0; n < rdz_t->count; n++)
+  {
+    rdz_rep *r = rdz_reps + n;
+
+    if (r->passes + r->fails < 1) continue;
+
+    fprintf(
+      f, "%d %ld %ld %f %f %f %ld",
+      n, r->passes, r->fails, r->min, r->max, r->total, r->seen);
+    for (int i = 0; i < r->count; i++) fprintf(f, " %f", r->samples[i]);
+    fprintf(f, "\n");
+  }
+  fprintf(f, "--\n");
+  fclose(f);
+
+  rdz_write(fd, s, l);
+  free(s);
+
+  rdz_write_results(fd, 0);
+}
+
+static int rdz_repeat_read(int fd, int keep)
+{
+  // merges what a worker wrote, returns 1 if it kept failing results
+
+  size_t l = 0; char *s = rdz_read(fd, &l); char *e = s + l;
+
+  char *ss = s;
+  long runs = strtol(ss, &ss, 10); rdz_rep_runs += runs;
+  long failed = strtol(ss, &ss, 10); rdz_rep_failed_runs += failed;
+
+  while (ss < e)
+  {
+    ss += strspn(ss, " \n");
+    if (strncmp(ss, "--\n", 3) == 0) { ss += 3; break; }
+
+    int n = (int)strtol(ss, &ss, 10);
+    rdz_rep *r = rdz_reps + n;
+
+    r->passes += strtol(ss, &ss, 10);
+    r->fails += strtol(ss, &ss, 10);
+    double mi = strtod(ss, &ss); double ma = strtod(ss, &ss);
+    double to = strtod(ss, &ss); long se = strtol(ss, &ss, 10);
+
+    if (se > 0 && (r->seen == 0 || mi < r->min)) r->min = mi;
+    if (se > 0 && (r->seen == 0 || ma > r->max)) r->max = ma;
+    r->total += to; r->seen += se;
+
+    if (r->samples == NULL) r->samples = calloc(RDZ_REP_SAMPLES, sizeof(double));
+
+    while (*ss == ' ')
+    {
+      double d = strtod(ss, &ss);
+      if (r->count < RDZ_REP_SAMPLES) r->samples[r->count++] = d;
+    }
+  }
+
+  int kept = (failed > 0);
+
+  if (keep) rdz_record_results(ss, e);
+
+  free(s);
+
+  return kept;
+}
+
+static void rdz_repeat_run()
+{
+  istty(); // determine it before stdout gets redirected
+
+  long reps = rdz_repeat > 0 ? rdz_repeat : (rdz_until_fail ? 0x7fffffffL : 1);
+  int jobs = rdz_jobs > 1 ? rdz_jobs : 1;
+  if (jobs > reps) jobs = (int)reps;
+
+  rdz_reps = calloc(rdz_t->count, sizeof(rdz_rep));
+
+  signal(SIGINT, rdz_rep_on_signal); // ctrl-c stops and summarizes
+
+  fflush(stdout);
+  int out = dup(1);
+  int nul = open("/dev/null", O_WRONLY); dup2(nul, 1); close(nul);
+
+  if (jobs < 2)
+  {
+    rdz_repeat_loop(reps);
+  }
+  else
+  {
+    // the repetitions are spread over forked workers, with RDZ_UNTIL_FAIL
+    // the first failing worker stops the others (SIGUSR1)
+
+    int *fds = calloc(jobs, sizeof(int));
+    pid_t *pids = calloc(jobs, sizeof(pid_t));
+
+    for (int w = 0; w < jobs; w++)
+    {
+      fds[w] = rdz_tmpfd("rep", w);
+      pids[w] = fork();
+
+      if (pids[w] != 0) continue;
+
+      rdz_worker = 1;
+      signal(SIGUSR1, rdz_rep_on_signal);
+      srand(getpid());
+
+      rdz_repeat_loop(reps / jobs + (w < reps % jobs ? 1 : 0));
+
+      fflush(stdout);
+      rdz_repeat_write(fds[w]);
+
+      _exit(rdz_rep_failed_runs > 0 ? 1 : 0);
+    }
+
+    for (int left = jobs; left > 0; left--)
+    {
+      int status = 0;
+      pid_t pid = wait(&status);
+
+      if (pid < 0 && errno == EINTR) { left++; continue; }
+      if (pid < 0) break;
+
+      if ( ! rdz_until_fail || ! WIFEXITED(status) || WEXITSTATUS(status) == 0)
+      {
+        continue;
+      }
+
+      for (int w = 0; w < jobs; w++) if (pids[w] != pid) kill(pids[w], SIGUSR1);
+    }
+
+    int kept = 0; // the results of the first failing worker, else the last
+
+    for (int w = 0; w < jobs; w++)
+    {
+      if ( ! kept) rdz_results_clear();
+      if (rdz_repeat_read(fds[w], ! kept)) kept = 1;
+      close(fds[w]);
+    }
+
+    rdz_results_recount();
+
+    free(fds); free(pids);
+  }
+
+  fflush(stdout);
+  dup2(out, 1); close(out);
+
+  signal(SIGINT, SIG_DFL);
+}
+
+static int rdz_double_cmp(const void *a, const void *b)
+{
+  double da = *(const double *)a; double db = *(const double *)b;
+
+  return da < db ? -1 : da > db;
+}
+
+void rdz_repeat_summary(int durations)
+{
+  if (rdz_reps == NULL) return;
+
+  if (rdz_fail_count > 0) printf("\n"); // after the failures
+
+  printf(
+    "Repeat: %ld runs, %s%ld failed%s",
+    rdz_rep_runs,
+    rdz_rep_failed_runs > 0 ? rdz_rd() : "", rdz_rep_failed_runs, rdz_cl());
+  if (rdz_until_fail && rdz_rep_failed_runs > 0) printf(" (until the first failure)");
+  printf("\n\n");
+
+  for (int n = 0; n < rdz_t->count; n++)
+  {
+    rdz_rep *r = rdz_reps + n;
+
+    if (r->passes + r->fails < 1) continue;
+
+    char *title = rdz_determine_title(n);
+
+    printf("  %s%s%s", r->fails > 0 ? rdz_rd() : "", title, rdz_cl());
+    printf(" %sL=%d I=%d%s\n", rdz_gr(), rdz_t->ltstarts[n], n, rdz_cl());
+    printf("     %ld passed, %ld failed", r->passes, r->fails);
+
+    if (durations && r->count > 0)
+    {
+      qsort(r->samples, r->count, sizeof(double), rdz_double_cmp);
+
+      printf(
+        "%s  min %.3fms median %.3fms p90 %.3fms max %.3fms mean %.3fms%s",
+        rdz_gr(),
+        r->min, r->samples[r->count / 2], r->samples[r->count * 9 / 10],
+        r->max, r->total / r->seen, rdz_cl());
+    }
+    printf("\n");
+
+    free(title);
+  }
+
+  printf("\n");
+
+  for (int n = 0; n < rdz_t->count; n++) free(rdz_reps[n].samples);
+  free(rdz_reps); rdz_reps = NULL;
+  rdz_rep_runs = 0; rdz_rep_failed_runs = 0; rdz_rep_stop = 0;
+}
+
+  //
+  // RDZ_BISECT
+
+#ifdef RDZ_RERUN
+
+static char *rdz_rerun_unset[] = {
+  "E", "L", "F", "S", "RDZ_BISECT", "RDZ_REPEAT", "RDZ_UNTIL_FAIL",
+  "RDZ_LIST", "RDZ_DURATIONS", "RDZ_COVERAGE", "RDZ_SAMPLE", "RDZ_TRACE",
+  "RDZ_COORDINATOR", "RDZ_WORKER", "RDZ_VALGRIND", "RDZ_UPDATE_SNAPSHOTS",
+  "RDZ_BISECT_FD", "RDZ_BISECT_SET",
+  NULL };
+
+static char *rdz_self_exe()
+{
+  char *r = calloc(4096, sizeof(char));
+
+#ifdef __APPLE__
+  uint32_t size = 4096;
+  if (_NSGetExecutablePath(r, &size) == 0) return r;
+#else
+  if (readlink("/proc/self/exe", r, 4095) > 0) return r;
+#endif
+
+  free(r);
+
+  return NULL;
+}
+
+#endif // RDZ_RERUN
+
+#ifdef RDZ_WITH_BISECT
+
+static void rdz_bisect_report()
+{
+  // in a bisection run, tells the bisecting process what failed
+
+  for (int i = 0; i < rdz_count; i++)
+  {
+    rdz_result *r = rdz_results + i;
+    if (r->success != 0) continue;
+
+    char s[32]; int l = snprintf(s, 32, "%d\n", r->itnumber);
+    rdz_write(rdz_bisect_fd, s, l);
+  }
+
+  rdz_write(rdz_bisect_fd, "done\n", 5);
+  close(rdz_bisect_fd); rdz_bisect_fd = -1;
+}
+
+static pid_t rdz_bisect_spawn(char *exe, int *ns, size_t count, int w, int *fd)
+{
+  // fork + exec of the spec itself, with I=n0,n1,...,bisect passed in
+  // a file (RDZ_BISECT_SET), the results come back through a pipe
+
+  char *is = calloc((count + 1) * 12 + 2, sizeof(char));
+  char *s = is;
+  for (size_t i = 0; i < count; i++) s += sprintf(s, "%d,", ns[i]);
+  sprintf(s, "%d\n", rdz_bisect);
+
+  int sfd = rdz_tmpfd("bisect", w);
+  if (sfd < 0) { free(is); return -1; }
+  rdz_write(sfd, is, strlen(is)); lseek(sfd, 0, SEEK_SET);
+  free(is);
+
+  int ps[2]; if (pipe(ps) != 0) { close(sfd); return -1; }
+
+  fflush(stdout);
+
+  pid_t pid = fork();
+
+  if (pid == 0)
+  {
+    close(ps[0]);
+
+    int dn = open("/dev/null", O_RDWR);
+    dup2(dn, 0); dup2(dn, 1); dup2(dn, 2);
+
+    for (size_t i = 0; rdz_rerun_unset[i]; i++) unsetenv(rdz_rerun_unset[i]);
+    unsetenv("I");
+
+    char sf[16]; snprintf(sf, 16, "%d", ps[1]);
+    setenv("RDZ_BISECT_FD", sf, 1);
+    snprintf(sf, 16, "%d", sfd);
+    setenv("RDZ_BISECT_SET", sf, 1);
+
+    execl(exe, exe, (char *)NULL);
+    _exit(127);
+  }
+
+  close(ps[1]); close(sfd);
+
+  if (pid < 0) { close(ps[0]); return -1; }
+
+  *fd = ps[0];
+
+  return pid;
+}
+
+static int rdz_bisect_test(
+  char *exe, int **sets, size_t *counts, size_t sc, int *died)
+{
+  // runs the candidate sets, as many at once as there are cores, returns
+  // the index of the first set reproducing the failure, -1 if none does,
+  // -2 if the spec executable couldn't be run
+  //
+  // a run reproduces the failure if it reports the bisected example as
+  // failed or if it died while running it, a run dying elsewhere
+  // (another example crashing on its own) doesn't count
+
+  long cores = rdz_jobs > 1 ? rdz_jobs : sysconf(_SC_NPROCESSORS_ONLN);
+  if (cores < 1) cores = 1;
+
+  pid_t *pids = calloc(cores, sizeof(pid_t));
+  int *fds = calloc(cores, sizeof(int));
+
+  int r = -1;
+
+  for (size_t from = 0; r == -1 && from < sc; from += cores)
+  {
+    size_t to = from + cores; if (to > sc) to = sc;
+
+    for (size_t i = from; i < to; i++)
+    {
+      pids[i - from] = rdz_bisect_spawn(
+        exe, sets[i], counts[i], i - from, fds + i - from);
+    }
+
+    for (size_t i = from; i < to; i++)
+    {
+      if (pids[i - from] < 0) continue;
+
+      size_t l = 0; char *o = rdz_read(fds[i - from], &l);
+      close(fds[i - from]);
+
+      int status = 0; waitpid(pids[i - from], &status, 0);
+
+      if (l == 0 && WIFEXITED(status) && WEXITSTATUS(status) == 127)
+      {
+        r = -2; // the exec failed
+      }
+
+      int failed = // died while running it
+        strstr(o, "start\n") && ! strstr(o, "end\n") && ! strstr(o, "done\n");
+
+      if (died && ! strstr(o, "start\n")) (*died)++; // before reaching it
+
+      for (char *c = o; c && ! failed; c = strchr(c, '\n'), c = c ? c + 1 : c)
+      {
+        if (atoi(c) == rdz_bisect) failed = 1;
+      }
+
+      free(o);
+
+      if (failed && r == -1) r = i;
+    }
+  }
+
+  free(fds); free(pids);
+
+  return r;
+}
+
+void rdz_bisect_run()
+{
+  // delta debugging (ddmin) over the examples preceding the failing one,
+  // the subsets and complements of each round are tried concurrently
+
+  if (rdz_bisect >= rdz_t->count || rdz_t->types[rdz_bisect] != 'i')
+  {
+    printf("%sRDZ_BISECT=%d isn't an example%s\n", rdz_rd(), rdz_bisect, rdz_cl());
+    return;
+  }
+
+  char *exe = rdz_self_exe();
+
+  if (exe == NULL)
+  {
+    printf("%sRDZ_BISECT couldn't locate the spec executable%s\n", rdz_rd(), rdz_cl());
+    return;
+  }
+
+  char *title = rdz_determine_title(rdz_bisect);
+
+  int *set = calloc(rdz_t->count, sizeof(int));
+  size_t len = 0;
+
+  for (int n = 1; n < rdz_bisect; n++)
+  {
+    if (rdz_t->types[n] == 'i' && rdz_reachable(n)) set[len++] = n;
+  }
+  size_t before = len;
+
+  printf("\nBisect: %s %sI=%d%s\n\n", title, rdz_gr(), rdz_bisect, rdz_cl());
+
+  int **sets = calloc(2 * len + 2, sizeof(int *));
+  size_t *counts = calloc(2 * len + 2, sizeof(size_t));
+  size_t runs = 2;
+
+  sets[0] = set; counts[0] = 0; // on its own
+  sets[1] = set; counts[1] = len; // after all the preceding examples
+
+  int died = 0;
+  int r = rdz_bisect_test(exe, sets, counts, 2, &died);
+
+  if (r == -2)
+  {
+    printf("  %scouldn't run %s%s\n\n", rdz_rd(), exe, rdz_cl());
+    len = 0;
+  }
+  else if (r == 0)
+  {
+    printf("  fails on its own\n\n");
+    len = 0;
+  }
+  else if (r < 0 && died)
+  {
+    printf(
+      "  %sthe run dies before reaching it, "
+      "an example preceding it crashes on its own%s\n\n", rdz_rd(), rdz_cl());
+    len = 0;
+  }
+  else if (r < 0)
+  {
+    printf("  doesn't fail after the %zu examples preceding it\n\n", len);
+    len = 0;
+  }
+
+  for (size_t k = 2; len > 1; )
+  {
+    if (k > len) k = len;
+
+    size_t sc = 0;
+
+    for (size_t i = 0; i < k; i++) // subsets
+    {
+      size_t f = i * len / k, t = (i + 1) * len / k;
+      sets[sc] = calloc(t - f + 1, sizeof(int));
+      memcpy(sets[sc], set + f, (t - f) * sizeof(int));
+      counts[sc++] = t - f;
+    }
+    for (size_t i = 0; k > 2 && i < k; i++) // complements
+    {
+      size_t f = i * len / k, t = (i + 1) * len / k;
+      sets[sc] = calloc(len - (t - f) + 1, sizeof(int));
+      memcpy(sets[sc], set, f * sizeof(int));
+      memcpy(sets[sc] + f, set + t, (len - t) * sizeof(int));
+      counts[sc++] = len - (t - f);
+    }
+
+    r = rdz_bisect_test(exe, sets, counts, sc, NULL);
+    runs += sc;
+
+    if (r == -2)
+    {
+      printf("  %scouldn't run %s%s\n\n", rdz_rd(), exe, rdz_cl());
+      for (size_t i = 0; i < sc; i++) free(sets[i]);
+      len = 0; break;
+    }
+
+    printf(
+      "  %zu examples, %zu candidates, %s\n",
+      len, sc, r < 0 ? "none fails" : "one fails");
+
+    if (r > -1)
+    {
+      memcpy(set, sets[r], counts[r] * sizeof(int));
+      len = counts[r];
+      k = (size_t)r < k ? 2 : (k > 2 ? k - 1 : 2);
+    }
+
+    for (size_t i = 0; i < sc; i++) free(sets[i]);
+
+    if (r > -1) continue;
+    if (k >= len) break;
+    k = k * 2;
+  }
+
+  if (len > 0)
+  {
+    printf(
+      "\n  fails after %zu of the %zu examples preceding it (%zu runs):\n\n",
+      len, before, runs);
+
+    for (size_t i = 0; i < len; i++)
+    {
+      char *t = rdz_determine_title(set[i]);
+      printf("    %s %sL=%d I=%d%s\n", t, rdz_gr(), rdz_t->ltstarts[set[i]], set[i], rdz_cl());
+      free(t);
+    }
+
+    printf("\n%smake spec I=", rdz_rd());
+    for (size_t i = 0; i < len; i++) printf("%d,", set[i]);
+    printf("%d%s\n\n", rdz_bisect, rdz_cl());
+  }
+
+  free(counts); free(sets); free(set); free(title); free(exe);
+}
+
+#else
+
+static void rdz_bisect_report() {}
+void rdz_bisect_run() {}
+
+#endif // RDZ_WITH_BISECT
+
+  //
+  // RDZ_VALGRIND
+
+#ifdef RDZ_WITH_MEMCHECK
+
+static char *rdz_memcheck_parse(char *log)
+{
+  // "==123== Invalid read of size 4" ... "==123== ERROR SUMMARY: 1 errors"
+  // turned into a short report
+
+  char *r = NULL; size_t rl = 0;
+  FILE *f = open_memstream(&r, &rl);
+
+  long errors = -1;
+  long lost[3] = { 0, 0, 0 };
+  char *kinds[3] = { "definitely lost: ", "indirectly lost: ", "possibly lost: " };
+  int blocks = 0; int frame = 0;
+
+  for (char *l = log; l && *l; )
+  {
+    char *e = strchr(l, '\n'); if (e) *e = '\0';
+
+    char *c = l;
+    if (*c == '=') { c = strchr(c + 2, '='); c = c ? c + 2 : l; if (*c == ' ') c++; }
+
+    char *k = NULL;
+
+    if (strncmp(c, "ERROR SUMMARY: ", 15) == 0)
+    {
+      errors = atol(c + 15);
+    }
+    else if ((k = strstr(c, " lost: ")) != NULL)
+    {
+      for (size_t i = 0; i < 3; i++)
+      {
+        char *kk = strstr(c, kinds[i]); if (kk == NULL) continue;
+
+        long v = 0; // "1,024 bytes in 2 blocks"
+        for (char *d = kk + strlen(kinds[i]); *d && *d != ' '; d++)
+        {
+          if (*d >= '0' && *d <= '9') v = v * 10 + (*d - '0');
+        }
+        lost[i] = v;
+      }
+    }
+    else if (
+      strncmp(c, "Invalid ", 8) == 0 ||
+      strncmp(c, "Conditional jump", 16) == 0 ||
+      strncmp(c, "Use of uninitialised", 20) == 0 ||
+      strncmp(c, "Syscall param", 13) == 0 ||
+      strncmp(c, "Mismatched ", 11) == 0 ||
+      strncmp(c, "Source and destination overlap", 30) == 0 ||
+      strncmp(c, "Process terminating", 19) == 0 ||
+      strstr(c, " are definitely lost in loss record") ||
+      strstr(c, " are possibly lost in loss record"))
+    {
+      if (++blocks <= 5) fprintf(f, "  %s\n", c);
+      else if (blocks == 6) fprintf(f, "  ...\n");
+      frame = blocks <= 5;
+    }
+    else if (frame && (strncmp(c, "   at ", 6) == 0 || strncmp(c, "   by ", 6) == 0))
+    {
+      char *fn = strstr(c, ": "); fn = fn ? fn + 2 : c + 6;
+
+      if (strstr(fn, "vg_replace_") == NULL) // skip malloc() and co
+      {
+        fprintf(f, "    at %s\n", fn); frame = 0;
+      }
+    }
+    else if (*c == '\0')
+    {
+      frame = 0;
+    }
+
+    l = e ? e + 1 : NULL;
+  }
+
+  fclose(f);
+
+  char *s = NULL;
+
+  if (errors < 0)
+  {
+    s = rdz_strdup("memcheck: no report (is valgrind installed?)\n");
+  }
+  else
+  {
+    char *s0 = NULL; size_t sl = 0;
+    FILE *ff = open_memstream(&s0, &sl);
+
+    fprintf(ff, "memcheck: %ld error%s", errors, errors == 1 ? "" : "s");
+    for (size_t i = 0; i < 3; i++)
+    {
+      if (lost[i] > 0) fprintf(ff, ", %ld bytes %.*s", lost[i], (int)strlen(kinds[i]) - 2, kinds[i]);
+    }
+    fprintf(ff, "\n%s", r);
+    fclose(ff);
+
+    s = s0;
+  }
+
+  free(r);
+
+  return s;
+}
+
+static void rdz_memcheck_attach(int n, char *report)
+{
+  // to the failing result of the example, else to its last result
+
+  rdz_result *r = NULL;
+
+  for (int i = 0; i < rdz_count; i++)
+  {
+    rdz_result *rr = rdz_results + i;
+
+    if (rr->itnumber != n) continue;
+    if (r == NULL || r->success != 0) r = rr;
+  }
+
+  if (r == NULL) { free(report); return; }
+
+  free(r->memcheck); r->memcheck = report;
+}
+
+void rdz_memcheck_run()
+{
+  // reruns the failing examples and the ones flagged by rdz_leak_check()
+  // under valgrind, one example per process, as many at once as cores
+
+  int *ns = calloc(rdz_t->count, sizeof(int));
+  int nc = 0;
+
+  for (int n = 0; n < rdz_t->count; n++)
+  {
+    if (rdz_t->types[n] != 'i') continue;
+
+    int flagged = rdz_leaky && rdz_leaky[n];
+
+    for (int i = 0; ! flagged && i < rdz_count; i++)
+    {
+      flagged = rdz_results[i].itnumber == n && rdz_results[i].success == 0;
+    }
+
+    if (flagged) ns[nc++] = n;
+  }
+
+  char *exe = nc > 0 ? rdz_self_exe() : NULL;
+
+  long cores = rdz_jobs > 1 ? rdz_jobs : sysconf(_SC_NPROCESSORS_ONLN);
+  if (cores < 1) cores = 1;
+
+  pid_t *pids = calloc(cores, sizeof(pid_t));
+  int *fds = calloc(cores, sizeof(int));
+
+  for (int from = 0; exe && from < nc; from += cores)
+  {
+    int to = from + cores; if (to > nc) to = nc;
+
+    fflush(stdout);
+
+    for (int i = from; i < to; i++)
+    {
+      int fd = fds[i - from] = rdz_tmpfd("vg", i - from);
+
+      pids[i - from] = fork();
+
+      if (pids[i - from] != 0) continue;
+
+      int dn = open("/dev/null", O_RDWR);
+      dup2(dn, 0); dup2(dn, 1); dup2(dn, 2);
+
+      for (size_t j = 0; rdz_rerun_unset[j]; j++) unsetenv(rdz_rerun_unset[j]);
+
+      char si[16]; snprintf(si, 16, "%d", ns[i]);
+      setenv("I", si, 1);
+      char sl[32]; snprintf(sl, 32, "--log-fd=%d", fd);
+
+      execlp(
+        "valgrind", "valgrind", "--leak-check=full", sl, exe, (char *)NULL);
+      _exit(127);
+    }
+
+    for (int i = from; i < to; i++)
+    {
+      if (pids[i - from] > 0) waitpid(pids[i - from], NULL, 0);
+
+      size_t l = 0; char *o = rdz_read(fds[i - from], &l);
+      close(fds[i - from]);
+
+      rdz_memcheck_attach(ns[i], rdz_memcheck_parse(o));
+      free(o);
+    }
+  }
+
+  free(fds); free(pids); free(exe); free(ns);
+}
+
+void rdz_memcheck_summary()
+{
+  int seen = 0;
+
+  for (int i = 0; i < rdz_count; i++)
+  {
+    rdz_result *r = rdz_results + i;
+
+    if (r->memcheck == NULL) continue;
+
+    if ( ! seen) printf("%sMemcheck:\n\n", rdz_fail_count > 0 ? "\n" : "");
+    seen = 1;
+
+    char *title = rdz_determine_title(r->itnumber);
+    int clean = strncmp(r->memcheck, "memcheck: 0 errors\n", 19) == 0;
+
+    printf("  %s%s%s", clean ? "" : rdz_rd(), title, rdz_cl());
+    printf(" %sL=%d I=%d%s\n", rdz_gr(), r->ltnumber, r->itnumber, rdz_cl());
+
+    for (char *l = r->memcheck; *l; ) // indented, line by line
+    {
+      char *e = strchr(l, '\n'); size_t ll = e ? (size_t)(e - l) : strlen(l);
+      printf("     %s%.*s%s\n", rdz_cy(), (int)ll, l, rdz_cl());
+      l += ll + (e ? 1 : 0);
+    }
+
+    free(title);
+  }
+
+  if (seen) printf("\n");
+}
+
+#else
+
+void rdz_memcheck_run() {}
+void rdz_memcheck_summary() {}
+
+#endif // RDZ_WITH_MEMCHECK
+
+//
+// fuzz "x" (const uint8_t *data, size_t size) { ... }
+
+#ifdef RDZ_WITH_FUZZ // the generated file defines it when needed
+
+#define RDZ_FUZZ_WORKERS_MAX 64
+#define RDZ_FUZZ_LISTED 10
+
+typedef double rdz_fuzz_func(const uint8_t *data, size_t size);
+
+typedef struct rdz_fuzz_flag { // an input that failed, crashed or ran too long
+  long input;
+  char kind[16]; // "ensure", "crash", "timeout" or "slow"
+  int lnumber;
+  int ltnumber;
+  char *message;
+} rdz_fuzz_flag;
+
+typedef struct rdz_fuzz_report { // one per fuzz block, for the summary
+  int n;
+  char *corpus;
+  char **paths; // a single NULL path when there is no corpus
+  long inputs;
+  long execs;
+  int workers;
+  double duration;
+  size_t count;
+  size_t size;
+  rdz_fuzz_flag *flags;
+  struct rdz_fuzz_report *next;
+} rdz_fuzz_report;
+
+typedef struct rdz_fuzz_shared { // mapped, the workers and the parent see it
+  long next; // the next input to hand out
+  long execs;
+  long current[RDZ_FUZZ_WORKERS_MAX]; // the input being run, -1 if none
+  volatile double started[RDZ_FUZZ_WORKERS_MAX];
+} rdz_fuzz_shared;
+
+static rdz_fuzz_report *rdz_fuzz_reports = NULL; // pushed from any thread
+int rdz_fuzz_entry = 0; // 1 when driven by LLVMFuzzerTestOneInput()
+static const uint8_t *rdz_fuzz_data = NULL;
+static size_t rdz_fuzz_size = 0;
+
+static int rdz_fuzz_path_cmp(const void *a, const void *b)
+{
+  return strcmp(*(char **)a, *(char **)b);
+}
+
+static char **rdz_fuzz_corpus(int n, char **dir, long *count)
+{
+  // RDZ_CORPUS=dir holding a name/ per fuzz block or directly the inputs,
+  // else corpus/name/ next to the spec file
+
+  char *name = rdz_text(n);
+  size_t l = strlen(name);
+  struct stat st;
+
+  if (rdz_corpus)
+  {
+    *dir = calloc(strlen(rdz_corpus) + l + 2, sizeof(char));
+    sprintf(*dir, "%s/%s", rdz_corpus, name);
+    if (stat(*dir, &st) != 0 || ! S_ISDIR(st.st_mode)) strcpy(*dir, rdz_corpus);
+  }
+  else
+  {
+    char *f = rdz_fname(n); char *s = strrchr(f, '/');
+    int fl = s ? (int)(s - f + 1) : 0;
+
+    *dir = calloc(fl + l + 8, sizeof(char));
+    sprintf(*dir, "%.*scorpus/%s", fl, f, name);
+  }
+
+  size_t size = 16; *count = 0;
+  char **paths = calloc(size, sizeof(char *));
+
+  DIR *d = opendir(*dir);
+  struct dirent *de = NULL;
+
+  while (d && (de = readdir(d)) != NULL)
+  {
+    if (de->d_name[0] == '.') continue;
+
+    char *p = calloc(strlen(*dir) + strlen(de->d_name) + 2, sizeof(char));
+    sprintf(p, "%s/%s", *dir, de->d_name);
+
+    if (stat(p, &st) != 0 || ! S_ISREG(st.st_mode)) { free(p); continue; }
+
+    if (*count + 1 >= (long)size)
+    {
+      size *= 2; paths = realloc(paths, size * sizeof(char *));
+    }
+    paths[(*count)++] = p;
+  }
+  if (d) closedir(d);
+
+  qsort(paths, *count, sizeof(char *), rdz_fuzz_path_cmp);
+
+  if (*count == 0) { paths[0] = NULL; *count = 1; } // the empty input
+
+  return paths;
+}
+
+static void rdz_fuzz_work(
+  rdz_fuzz_func *f, char **paths, long count,
+  rdz_fuzz_shared *sh, int w, int fd)
+{
+  // a forked worker, takes the next input until there are none left,
+  // reports the ones that failed or were slow, "input kind l lt ml\nmsg\n"
+
+  rdz_worker = 1;
+#ifdef RDZ_CONCURRENT
+  rdz_job_current = NULL; // the results stay here
+#endif
+
+  int dn = open("/dev/null", O_WRONLY); dup2(dn, 1); close(dn);
+
+  while (1)
+  {
+    long i = __atomic_fetch_add(&sh->next, 1, __ATOMIC_SEQ_CST);
+    if (i >= count) break;
+
+    void *m = NULL; size_t size = 0;
+    int ifd = paths[i] ? open(paths[i], O_RDONLY) : -1;
+    struct stat st;
+
+    if (ifd > -1 && fstat(ifd, &st) == 0 && st.st_size > 0)
+    {
+      size = st.st_size;
+      m = mmap(NULL, size, PROT_READ, MAP_PRIVATE, ifd, 0);
+      if (m == MAP_FAILED) { m = NULL; size = 0; }
+    }
+    if (ifd > -1) close(ifd);
+
+    int rc = rdz_count;
+
+    sh->started[w] = rdz_now();
+    __atomic_store_n(&sh->current[w], i, __ATOMIC_SEQ_CST);
+
+    f(m ? (const uint8_t *)m : (const uint8_t *)"", size);
+
+    __atomic_store_n(&sh->current[w], -1L, __ATOMIC_SEQ_CST);
+    __atomic_fetch_add(&sh->execs, 1, __ATOMIC_SEQ_CST);
+
+    double du = rdz_duration(sh->started[w]);
+
+    if (m) munmap(m, size);
+
+    rdz_result *r = NULL;
+    for (int j = rc; r == NULL && j < rdz_count; j++)
+    {
+      if (rdz_results[j].success == 0) r = rdz_results + j;
+    }
+
+    char h[128]; char slow[128]; char *msg = NULL; int l = 0;
+
+    if (r)
+    {
+      msg = r->message;
+      l = snprintf(
+        h, 128, "%ld ensure %d %d %d\n",
+        i, r->lnumber, r->ltnumber, msg ? (int)strlen(msg) : -1);
+    }
+    else if (du > rdz_fuzz_timeout)
+    {
+      msg = slow;
+      snprintf(
+        slow, 128, "     took %.1fms, over the %.0fms budget",
+        du, rdz_fuzz_timeout);
+      l = snprintf(h, 128, "%ld slow -1 -1 %d\n", i, (int)strlen(msg));
+    }
+
+    if (l > 0)
+    {
+      rdz_write(fd, h, l);
+      if (msg) rdz_write(fd, msg, strlen(msg));
+      rdz_write(fd, "\n", 1);
+    }
+
+    for (int j = rc; j < rdz_count; j++) rdz_result_clear(rdz_results + j);
+    rdz_count = rc; rdz_fail_count = 0; rdz_pending_count = 0;
+  }
+
+  _exit(0);
+}
+
+static void rdz_fuzz_flag_add(
+  rdz_fuzz_report *rp, long input, const char *kind,
+  int lnumber, int ltnumber, char *message)
+{
+  if (rp->count >= rp->size)
+  {
+    rp->size = rp->size * 2 + 4;
+    rp->flags = realloc(rp->flags, rp->size * sizeof(rdz_fuzz_flag));
+  }
+
+  rdz_fuzz_flag *f = rp->flags + rp->count++;
+
+  f->input = input;
+  snprintf(f->kind, 16, "%s", kind);
+  f->lnumber = lnumber < 0 ? rdz_t->lstarts[rp->n] : lnumber;
+  f->ltnumber = ltnumber < 0 ? rdz_t->ltstarts[rp->n] : ltnumber;
+  f->message = message;
+}
+
+static int rdz_fuzz_flag_cmp(const void *a, const void *b)
+{
+  long ia = ((rdz_fuzz_flag *)a)->input; long ib = ((rdz_fuzz_flag *)b)->input;
+
+  return ia < ib ? -1 : ia > ib;
+}
+
+static pid_t rdz_fuzz_spawn(
+  rdz_fuzz_func *f, rdz_fuzz_report *rp, rdz_fuzz_shared *sh, int w, int fd)
+{
+  fflush(stdout);
+
+  pid_t pid = fork();
+  if (pid == 0) rdz_fuzz_work(f, rp->paths, rp->inputs, sh, w, fd);
+
+  return pid;
+}
+
+double rdz_fuzz_run(int n, rdz_fuzz_func *f)
+{
+  // replays the corpus through the fuzz block, in forked workers so that
+  // a crash or a hang only costs a worker, flags the failing inputs
+
+  if (rdz_fuzz_entry) return f(rdz_fuzz_data, rdz_fuzz_size);
+
+  double start = rdz_now();
+
+  rdz_fuzz_report *rp = calloc(1, sizeof(rdz_fuzz_report));
+  rp->n = n;
+  rp->paths = rdz_fuzz_corpus(n, &rp->corpus, &rp->inputs);
+
+  long cores = rdz_jobs > 1 ? rdz_jobs : sysconf(_SC_NPROCESSORS_ONLN);
+  if (cores > rp->inputs) cores = rp->inputs;
+  if (cores > RDZ_FUZZ_WORKERS_MAX) cores = RDZ_FUZZ_WORKERS_MAX;
+  if (cores < 1) cores = 1;
+  rp->workers = cores;
+
+  int sfd = rdz_tmpfd("fuzz", n);
+  rdz_fuzz_shared *sh = MAP_FAILED;
+  if (sfd > -1 && ftruncate(sfd, sizeof(rdz_fuzz_shared)) == 0)
+  {
+    sh = mmap(
+      NULL, sizeof(rdz_fuzz_shared), PROT_READ | PROT_WRITE, MAP_SHARED, sfd, 0);
+  }
+  if (sfd > -1) close(sfd);
+
+  if (sh == MAP_FAILED)
+  {
+    rdz_record(
+      0, rdz_strdup("     couldn't map the fuzz workers' shared state"),
+      n, rdz_t->lstarts[n], rdz_t->ltstarts[n]);
+    free(rp->corpus); free(rp);
+
+    return rdz_duration(start);
+  }
+
+  pid_t pids[RDZ_FUZZ_WORKERS_MAX];
+  int fds[RDZ_FUZZ_WORKERS_MAX];
+  long killed[RDZ_FUZZ_WORKERS_MAX];
+
+  for (int w = 0; w < cores; w++)
+  {
+    sh->current[w] = -1; killed[w] = -1;
+    fds[w] = rdz_tmpfd("fuzzw", w);
+    pids[w] = rdz_fuzz_spawn(f, rp, sh, w, fds[w]);
+  }
+
+  struct timespec ts = { 0, 1000000 }; // 1ms
+
+  for (int live = cores; live > 0; )
+  {
+    int idle = 1;
+
+    for (int w = 0; w < cores; w++)
+    {
+      if (pids[w] < 1) continue;
+
+      int status = 0;
+
+      if (waitpid(pids[w], &status, WNOHANG) == pids[w])
+      {
+        idle = 0; live--; pids[w] = 0;
+
+        long i = __atomic_load_n(&sh->current[w], __ATOMIC_SEQ_CST);
+        char *msg = calloc(128, sizeof(char));
+
+        if (i < 0) { free(msg); msg = NULL; }
+        else if (killed[w] == i)
+        {
+          snprintf(
+            msg, 128, "     still running after %.0fms, killed",
+            rdz_fuzz_timeout);
+          rdz_fuzz_flag_add(rp, i, "timeout", -1, -1, msg);
+        }
+        else if (WIFSIGNALED(status))
+        {
+          snprintf(
+            msg, 128, "     crashed, signal %d (%s)",
+            WTERMSIG(status), strsignal(WTERMSIG(status)));
+          rdz_fuzz_flag_add(rp, i, "crash", -1, -1, msg);
+        }
+        else
+        {
+          snprintf(
+            msg, 128, "     exited, status %d", WEXITSTATUS(status));
+          rdz_fuzz_flag_add(rp, i, "crash", -1, -1, msg);
+        }
+
+        sh->current[w] = -1; killed[w] = -1;
+
+        if (__atomic_load_n(&sh->next, __ATOMIC_SEQ_CST) < rp->inputs)
+        {
+          pids[w] = rdz_fuzz_spawn(f, rp, sh, w, fds[w]); live++;
+        }
+      }
+      else
+      {
+        long i = __atomic_load_n(&sh->current[w], __ATOMIC_SEQ_CST);
+
+        if (
+          i > -1 && killed[w] != i &&
+          rdz_duration(sh->started[w]) > rdz_fuzz_timeout
+        ) {
+          kill(pids[w], SIGKILL); killed[w] = i;
+        }
+      }
+    }
+
+    if (idle) nanosleep(&ts, NULL);
+  }
+
+  for (int w = 0; w < cores; w++)
+  {
+    size_t l = 0; char *s = rdz_read(fds[w], &l); char *e = s + l;
+    close(fds[w]);
+
+    for (char *ss = s; ss < e; )
+    {
+      long i; char kind[16]; int lnumber, ltnumber, ml, hl;
+      if (sscanf(
+        ss, "%ld %15s %d %d %d%n",
+        &i, kind, &lnumber, &ltnumber, &ml, &hl) < 5) break;
+
+      ss += hl + 1;
+      char *msg = ml > -1 ? rdz_strndup(ss, ml) : NULL;
+      ss += (ml > -1 ? ml : 0) + 1;
+
+      rdz_fuzz_flag_add(rp, i, kind, lnumber, ltnumber, msg);
+    }
+
+    free(s);
+  }
+
+  rp->execs = sh->execs;
+  munmap(sh, sizeof(rdz_fuzz_shared));
+
+  if (rp->count > 0) // the first flagged input becomes the failure
+  {
+    qsort(rp->flags, rp->count, sizeof(rdz_fuzz_flag), rdz_fuzz_flag_cmp);
+      // not before, flags is NULL when nothing got flagged
+
+    rdz_fuzz_flag *fl = rp->flags;
+    char *p = rp->paths[fl->input];
+    char *m = fl->message ? fl->message : "";
+
+    char *msg = calloc(strlen(p ? p : "") + strlen(m) + 64, sizeof(char));
+    sprintf(
+      msg, "     input %s (%s)%s%s",
+      p ? p : "(empty)", fl->kind, *m ? "\n" : "", m);
+
+    rdz_record(0, msg, n, fl->lnumber, fl->ltnumber);
+  }
+
+  rp->duration = rdz_duration(start);
+
+  rp->next = __atomic_load_n(&rdz_fuzz_reports, __ATOMIC_SEQ_CST);
+  while ( ! __atomic_compare_exchange_n(
+    &rdz_fuzz_reports, &rp->next, rp, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)
+  );
+
+  return rp->duration;
+}
+
+static int rdz_fuzz_report_cmp(const void *a, const void *b)
+{
+  return (*(rdz_fuzz_report **)a)->n - (*(rdz_fuzz_report **)b)->n;
+}
+
+void rdz_fuzz_summary(int durations)
+{
+  if (rdz_fuzz_reports == NULL) return;
+
+  size_t count = 0;
+  for (rdz_fuzz_report *rp = rdz_fuzz_reports; rp; rp = rp->next) count++;
+
+  rdz_fuzz_report **rps = calloc(count, sizeof(rdz_fuzz_report *));
+  count = 0;
+  for (rdz_fuzz_report *rp = rdz_fuzz_reports; rp; rp = rp->next) rps[count++] = rp;
+
+  qsort(rps, count, sizeof(rdz_fuzz_report *), rdz_fuzz_report_cmp);
+
+  printf("%sFuzz:\n\n", rdz_fail_count > 0 ? "\n" : "");
+
+  for (size_t i = 0; i < count; i++)
+  {
+    rdz_fuzz_report *rp = rps[i];
+    int n = rp->n;
+
+    char *title = rdz_determine_title(n);
+
+    printf("  %s%s%s", rp->count ? rdz_rd() : "", title, rdz_cl());
+    printf(" %sL=%d I=%d%s\n", rdz_gr(), rdz_t->ltstarts[n], n, rdz_cl());
+
+    if (rp->paths[0] == NULL)
+      printf("     no corpus at %s, replayed the empty input", rp->corpus);
+    else
+      printf("     %ld inputs from %s", rp->inputs, rp->corpus);
+    printf(", %zu flagged", rp->count);
+    if (durations && rp->duration > 0.0)
+    {
+      printf(
+        ", %d workers, %.0f execs/s",
+        rp->workers, rp->execs / (rp->duration / 1000.0));
+    }
+    printf("\n");
+
+    for (size_t j = 0; j < rp->count; j++)
+    {
+      rdz_fuzz_flag *fl = rp->flags + j;
+      char *p = rp->paths[fl->input];
+
+      if (j < RDZ_FUZZ_LISTED)
+      {
+        printf("     %s%-7s %s%s\n", rdz_rd(), fl->kind, p ? p : "(empty)", rdz_cl());
+      }
+
+      free(fl->message);
+    }
+    if (rp->count > RDZ_FUZZ_LISTED)
+    {
+      printf("     ... and %zu more\n", rp->count - RDZ_FUZZ_LISTED);
+    }
+
+    for (long j = 0; j < rp->inputs; j++) free(rp->paths[j]);
+    free(rp->paths); free(rp->flags); free(rp->corpus); free(rp);
+    free(title);
+  }
+
+  printf("\n");
+
+  free(rps); rdz_fuzz_reports = NULL;
+}
+
+void rdz_fuzz_init()
+{
+  // LLVMFuzzerInitialize(), the before alls around the fuzz blocks run once
+
+  rdz_fuzz_entry = 1;
+
+  char *done = calloc(rdz_t->count, sizeof(char));
+  int *chain = calloc(rdz_t->count, sizeof(int));
+
+  for (int n = 0; n < rdz_t->count; n++)
+  {
+    if ( ! (rdz_t->flags[n] & RDZ_F_FUZZ) || ! rdz_doruns[n]) continue;
+
+    int depth = 0;
+    for (int p = rdz_t->parents[n]; p > -1; p = rdz_t->parents[p]) chain[depth++] = p;
+
+    for (int k = depth - 1; k >= 0; k--)
+    {
+      int p = chain[k]; if (done[p]) continue;
+      done[p] = 1;
+
+      const int *cs = rdz_children(p);
+      for (int i = 0; i < rdz_t->ccounts[p]; i++)
+      {
+        if (rdz_t->types[cs[i]] == 'B') rdz_call(cs[i]);
+      }
+    }
+  }
+
+  free(chain); free(done);
+}
+
+int rdz_fuzz_one(const uint8_t *data, size_t size)
+{
+  // LLVMFuzzerTestOneInput(), a failing ensure aborts, for the fuzzer
+  // to keep the input
+
+  rdz_fuzz_data = data; rdz_fuzz_size = size;
+
+  for (int n = 0; n < rdz_t->count; n++)
+  {
+    if ( ! (rdz_t->flags[n] & RDZ_F_FUZZ) || ! rdz_doruns[n]) continue;
+
+    rdz_run_offlines(rdz_t->parents[n], 'y');
+    rdz_call(n);
+    rdz_run_offlines(rdz_t->parents[n], 'z');
+
+    for (int i = 0; i < rdz_count; i++)
+    {
+      rdz_result *r = rdz_results + i;
+
+      if (r->success != 0) continue;
+
+      char *fname = rdz_fname(r->itnumber);
+
+      fprintf(stderr, "\n  %s\n", r->title);
+      if (r->message) fprintf(stderr, "%s\n", r->message);
+      fprintf(stderr, "     # %s:%d I=%d\n\n", fname, r->lnumber, r->itnumber);
+
+      abort();
+    }
+
+    for (int i = 0; i < rdz_count; i++) rdz_result_clear(rdz_results + i);
+    rdz_count = 0; rdz_fail_count = 0;
+  }
+
+  return 0;
+}
+
+#endif // RDZ_WITH_FUZZ
+
+//
+// compare "x" { variant "a" { ... } variant "b" { ... } }
+
+#if defined(RDZ_WITH_COMPARE) || defined(RDZ_WITH_BENCH)
+
+// a bit of maths, without requiring -lm from the spec builds
+
+static double rdz_sqrt(double x)
+{
+  if (x <= 0.0) return 0.0;
+
+  double r = x > 1.0 ? x : 1.0;
+  for (int i = 0; i < 64; i++) r = 0.5 * (r + x / r);
+
+  return r;
+}
+
+#ifdef RDZ_WITH_COMPARE
+
+static double rdz_exp(double x)
+{
+  if (x < -700.0) return 0.0;
+
+  int k = (int)(x / 0.6931471805599453);
+  double r = x - k * 0.6931471805599453;
+
+  double s = 1.0; double t = 1.0;
+  for (int i = 1; i < 24; i++) { t *= r / i; s += t; }
+
+  for (; k > 0; k--) s *= 2.0;
+  for (; k < 0; k++) s *= 0.5;
+
+  return s;
+}
+
+static double rdz_erfc(double x) // Numerical Recipes' erfcc, x >= 0
+{
+  double t = 1.0 / (1.0 + 0.5 * x);
+
+  return t * rdz_exp(
+    -x * x - 1.26551223 + t * (1.00002368 + t * (0.37409196 +
+    t * (0.09678418 + t * (-0.18628806 + t * (0.27886807 +
+    t * (-1.13520398 + t * (1.48851587 + t * (-0.82215223 +
+    t * 0.17087277)))))))));
+}
+
+static unsigned long long rdz_xorshift(unsigned long long *s)
+{
+  *s ^= *s << 13; *s ^= *s >> 7; *s ^= *s << 17;
+
+  return *s;
+}
+
+#endif // RDZ_WITH_COMPARE
+
+static double rdz_median(const double *samples, size_t count, double *tmp)
+{
+  memcpy(tmp, samples, count * sizeof(double));
+  qsort(tmp, count, sizeof(double), rdz_double_cmp);
+
+  return count % 2 ? tmp[count / 2] : 0.5 * (tmp[count / 2 - 1] + tmp[count / 2]);
+}
+
+#ifdef RDZ_WITH_COMPARE
+
+static double rdz_mann_whitney(const double *a, const double *b, size_t n)
+{
+  // the two-sided p-value of the Mann-Whitney U test, normal approximation
+  // with the tie correction, both sides have n samples
+
+  size_t nn = 2 * n;
+  double *ks = calloc(nn, sizeof(double));
+
+  for (size_t i = 0; i < n; i++) { ks[i] = a[i]; ks[n + i] = b[i]; }
+  qsort(ks, nn, sizeof(double), rdz_double_cmp);
+
+  // the rank of a value is the average position of its run of ties
+
+  double ra = 0.0; double ties = 0.0;
+
+  for (size_t i = 0; i < nn; )
+  {
+    size_t j = i; while (j < nn && ks[j] == ks[i]) j++;
+
+    double t = (double)(j - i);
+    ties += t * t * t - t;
+    i = j;
+  }
+
+  for (size_t i = 0; i < n; i++)
+  {
+    size_t lo = 0, hi = nn; // first position >= a[i]
+    while (lo < hi) { size_t m = (lo + hi) / 2; if (ks[m] < a[i]) lo = m + 1; else hi = m; }
+    size_t e = lo; // first position > a[i]
+    hi = nn;
+    while (e < hi) { size_t m = (e + hi) / 2; if (ks[m] <= a[i]) e = m + 1; else hi = m; }
+
+    ra += 0.5 * (lo + 1 + e); // average of the 1-based ranks lo + 1 .. e
+  }
+
+  free(ks);
+
+  double dn = (double)n; double dnn = (double)nn;
+  double u = ra - dn * (dn + 1.0) / 2.0;
+  double mu = dn * dn / 2.0;
+  double sigma = rdz_sqrt(dn * dn / 12.0 * ((dnn + 1.0) - ties / (dnn * (dnn - 1.0))));
+
+  if (sigma <= 0.0) return 1.0;
+
+  double z = (u > mu ? u - mu : mu - u) - 0.5; if (z < 0.0) z = 0.0;
+
+  double p = rdz_erfc(z / sigma / 1.4142135623730951);
+
+  return p > 1.0 ? 1.0 : p;
+}
+
+#endif // RDZ_WITH_COMPARE
+
+#define RDZ_BENCH_SAMPLES 2000
+#define RDZ_BENCH_BOOTSTRAP 200
+
+#ifdef RDZ_CONCURRENT
+__thread
+#endif
+double rdz_variant_t0 = -1.0;
+#ifdef RDZ_CONCURRENT
+__thread
+#endif
+double rdz_variant_t1 = -1.0;
+
+static double rdz_bench_now() // ns
+{
+  struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return 1.0e9 * ts.tv_sec + ts.tv_nsec;
+}
+
+static void rdz_ns_to_s(double ns, char *s, size_t n)
+{
+  if (ns < 1.0e3) snprintf(s, n, "%.1fns", ns);
+  else if (ns < 1.0e6) snprintf(s, n, "%.2fus", ns / 1.0e3);
+  else if (ns < 1.0e9) snprintf(s, n, "%.2fms", ns / 1.0e6);
+  else snprintf(s, n, "%.2fs", ns / 1.0e9);
+}
+
+int rdz_variant(int variant, int k)
+{
+  if (variant != k) return 0;
+
+  rdz_variant_t0 = rdz_bench_now(); // the variant starts
+
+  return 1;
+}
+
+void rdz_variant_stop()
+{
+  rdz_variant_t1 = rdz_bench_now(); // the body is over
+}
+
+#endif // RDZ_WITH_COMPARE || RDZ_WITH_BENCH
+
+#ifdef RDZ_WITH_COMPARE
+
+typedef double rdz_compare_func(int variant);
+
+typedef struct rdz_compare_report { // one per compare block, for the summary
+  int n;
+  const char **names;
+  int count;
+  int winner;
+  long rounds;
+  long batch;
+  double *medians; // ns, one per variant
+  double *ratios; // median of the first variant / median of this one
+  double *los; // the 95% confidence interval of the ratio (bootstrap)
+  double *his;
+  double *ps; // Mann-Whitney U p-value, against the first variant
+  struct rdz_compare_report *next;
+} rdz_compare_report;
+
+static rdz_compare_report *rdz_compare_reports = NULL;
+
+static double rdz_compare_call(rdz_compare_func *f, int v, int from)
+{
+  // runs a variant, returns its duration in ns, or -1.0 if it failed
+
+  rdz_variant_t0 = -1.0; rdz_variant_t1 = -1.0;
+
+  f(v);
+
+  for (int i = from; i < rdz_count; i++)
+  {
+    if (rdz_results[i].success == 0) return -1.0; // keep the failure
+  }
+  for (int i = from; i < rdz_count; i++) rdz_result_clear(rdz_results + i);
+  rdz_count = from;
+
+  if (rdz_variant_t0 < 0.0 || rdz_variant_t1 < rdz_variant_t0) return 0.0;
+
+  return rdz_variant_t1 - rdz_variant_t0;
+}
+
+static void rdz_compare_stats(
+  rdz_compare_report *rp, double **samples, int v, double *tmp)
+{
+  long n = rp->rounds;
+
+  rp->ps[v] = rdz_mann_whitney(samples[0], samples[v], n);
+
+  // bootstrap the ratio of the medians
+
+  double *ratios = calloc(RDZ_BENCH_BOOTSTRAP, sizeof(double));
+  double *ra = calloc(n, sizeof(double));
+  double *rb = calloc(n, sizeof(double));
+  unsigned long long seed = 0x9e3779b97f4a7c15ULL + v;
+
+  for (int i = 0; i < RDZ_BENCH_BOOTSTRAP; i++)
+  {
+    for (long j = 0; j < n; j++)
+    {
+      ra[j] = samples[0][rdz_xorshift(&seed) % n];
+      rb[j] = samples[v][rdz_xorshift(&seed) % n];
+    }
+    double mb = rdz_median(rb, n, tmp);
+    ratios[i] = mb > 0.0 ? rdz_median(ra, n, tmp) / mb : 0.0;
+  }
+
+  qsort(ratios, RDZ_BENCH_BOOTSTRAP, sizeof(double), rdz_double_cmp);
+
+  rp->los[v] = ratios[RDZ_BENCH_BOOTSTRAP * 25 / 1000];
+  rp->his[v] = ratios[RDZ_BENCH_BOOTSTRAP * 975 / 1000 - 1];
+
+  free(rb); free(ra); free(ratios);
+}
+
+double rdz_compare_run(
+  int n, rdz_compare_func *f, const char **names, int count, int winner)
+{
+  // runs the variants in interleaved rounds (a b b a a b...), so that
+  // drift (frequency scaling, caches, neighbours) hits them all alike
+
+  double start = rdz_now();
+  int rc = rdz_count;
+
+  if (count < 2 || winner < -1)
+  {
+    rdz_record(
+      0, rdz_strdup(count < 2 ?
+        "     compare needs at least two variants" :
+        "     faster(\"...\") names none of the variants"),
+      n, rdz_t->lstarts[n], rdz_t->ltstarts[n]);
+
+    return rdz_duration(start);
+  }
+
+  // warm up and calibrate, a sample is worth at least 10us
+
+  double slowest = 0.0;
+
+  for (int v = 0; v < count; v++)
+  {
+    double ns = rdz_compare_call(f, v, rc);
+    if (ns < 0.0) return rdz_duration(start);
+    if (ns > slowest) slowest = ns;
+  }
+
+  long batch = slowest < 1.0e4 ? (long)(1.0e4 / (slowest > 1.0 ? slowest : 1.0)) : 1;
+  if (batch < 1) batch = 1;
+
+  long rounds = (long)(rdz_bench_time * 1.0e6 / (count * batch * (slowest > 1.0 ? slowest : 1.0)));
+  if (rounds > RDZ_BENCH_SAMPLES) rounds = RDZ_BENCH_SAMPLES;
+  if (rounds < 10) rounds = 10;
+
+  double **samples = calloc(count, sizeof(double *));
+  for (int v = 0; v < count; v++) samples[v] = calloc(rounds, sizeof(double));
+
+  int failed = 0;
+
+  for (long r = 0; ! failed && r < rounds; r++)
+  {
+    for (int i = 0; ! failed && i < count; i++)
+    {
+      int v = (r % 2) ? count - 1 - i : i;
+
+      double sum = 0.0;
+
+      for (long b = 0; b < batch; b++)
+      {
+        double ns = rdz_compare_call(f, v, rc);
+        if (ns < 0.0) { failed = 1; break; }
+        sum += ns;
+      }
+
+      samples[v][r] = sum / batch;
+    }
+  }
+
+  if (failed)
+  {
+    for (int v = 0; v < count; v++) free(samples[v]);
+    free(samples);
+
+    return rdz_duration(start);
+  }
+
+  rdz_compare_report *rp = calloc(1, sizeof(rdz_compare_report));
+  rp->n = n; rp->names = names; rp->count = count; rp->winner = winner;
+  rp->rounds = rounds; rp->batch = batch;
+  rp->medians = calloc(count, sizeof(double));
+  rp->ratios = calloc(count, sizeof(double));
+  rp->los = calloc(count, sizeof(double));
+  rp->his = calloc(count, sizeof(double));
+  rp->ps = calloc(count, sizeof(double));
+
+  double *tmp = calloc(rounds, sizeof(double));
+
+  for (int v = 0; v < count; v++)
+  {
+    rp->medians[v] = rdz_median(samples[v], rounds, tmp);
+  }
+  for (int v = 1; v < count; v++)
+  {
+    rp->ratios[v] = rp->medians[v] > 0.0 ? rp->medians[0] / rp->medians[v] : 0.0;
+    rdz_compare_stats(rp, samples, v, tmp);
+  }
+  rp->ratios[0] = 1.0; rp->los[0] = 1.0; rp->his[0] = 1.0; rp->ps[0] = 1.0;
+
+  // compare "x" faster("b"), b has to be significantly faster than the others
+
+  for (int v = 0; winner > -1 && v < count; v++)
+  {
+    if (v == winner) continue;
+
+    double p = rdz_mann_whitney(samples[winner], samples[v], rounds);
+    int faster = rp->medians[winner] < rp->medians[v];
+
+    if (faster && p < 0.05) continue;
+
+    char mw[64]; rdz_ns_to_s(rp->medians[winner], mw, 64);
+    char mv[64]; rdz_ns_to_s(rp->medians[v], mv, 64);
+
+    char *msg = calloc(1024, sizeof(char));
+    snprintf(
+      msg, 1024,
+      "     expected \"%s\" to be faster than \"%s\" (p < 0.05)\n"
+      "          got %s vs %s, p=%.4f",
+      names[winner], names[v], mw, mv, p);
+
+    rdz_record(0, msg, n, rdz_t->lstarts[n], rdz_t->ltstarts[n]);
+
+    break;
+  }
+
+  free(tmp);
+  for (int v = 0; v < count; v++) free(samples[v]);
+  free(samples);
+
+  rp->next = __atomic_load_n(&rdz_compare_reports, __ATOMIC_SEQ_CST);
+  while ( ! __atomic_compare_exchange_n(
+    &rdz_compare_reports, &rp->next, rp, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)
+  );
+
+  return rdz_duration(start);
+}
+
+static int rdz_compare_report_cmp(const void *a, const void *b)
+{
+  return (*(rdz_compare_report **)a)->n - (*(rdz_compare_report **)b)->n;
+}
+
+void rdz_compare_summary(int durations)
+{
+  if (rdz_compare_reports == NULL) return;
+
+  size_t count = 0;
+  for (rdz_compare_report *rp = rdz_compare_reports; rp; rp = rp->next) count++;
+
+  rdz_compare_report **rps = calloc(count, sizeof(rdz_compare_report *));
+  count = 0;
+  for (rdz_compare_report *rp = rdz_compare_reports; rp; rp = rp->next) rps[count++] = rp;
+
+  qsort(rps, count, sizeof(rdz_compare_report *), rdz_compare_report_cmp);
+
+  printf("%sCompare:\n\n", rdz_fail_count > 0 ? "\n" : "");
+
+  for (size_t i = 0; i < count; i++)
+  {
+    rdz_compare_report *rp = rps[i];
+    int n = rp->n;
+
+    char *title = rdz_determine_title(n);
+
+    printf("  %s", title);
+    printf(" %sL=%d I=%d%s\n", rdz_gr(), rdz_t->ltstarts[n], n, rdz_cl());
+
+    for (int v = 0; v < rp->count; v++)
+    {
+      printf("     %s", rp->names[v]);
+
+      if (durations)
+      {
+        char m[64]; rdz_ns_to_s(rp->medians[v], m, 64);
+        int l = strlen(rp->names[v]);
+        printf("%*s %10s", l < 12 ? 12 - l : 0, "", m);
+
+        double r = rp->ratios[v];
+
+        if (v == 0)
+          printf("  %s(baseline)%s", rdz_gr(), rdz_cl());
+        else if (r >= 1.0)
+          printf(
+            "  %s%.2fx faster%s [%.2fx, %.2fx], p=%.4f",
+            rp->ps[v] < 0.05 ? rdz_gn() : "", r, rdz_cl(),
+            rp->los[v], rp->his[v], rp->ps[v]);
+        else if (r > 0.0)
+          printf(
+            "  %s%.2fx slower%s [%.2fx, %.2fx], p=%.4f",
+            rp->ps[v] < 0.05 ? rdz_rd() : "", 1.0 / r, rdz_cl(),
+            rp->his[v] > 0.0 ? 1.0 / rp->his[v] : 0.0,
+            rp->los[v] > 0.0 ? 1.0 / rp->los[v] : 0.0, rp->ps[v]);
+      }
+      printf("\n");
+    }
+
+    if (durations)
+    {
+      printf(
+        "     %s%ld interleaved rounds, %ld call%s per sample%s\n",
+        rdz_gr(), rp->rounds, rp->batch, rp->batch > 1 ? "s" : "", rdz_cl());
+    }
+
+    free(rp->medians); free(rp->ratios); free(rp->los); free(rp->his);
+    free(rp->ps); free(rp);
+    free(title);
+  }
+
+  printf("\n");
+
+  free(rps); rdz_compare_reports = NULL;
+}
+
+#endif // RDZ_WITH_COMPARE
+
+//
+// benchmark "x" sizes(a .. b, xk) complexity("n log n") { measure { ... } }
+
+#ifdef RDZ_WITH_BENCH
+
+#define RDZ_BENCH_SIZES 64
+#define RDZ_BENCH_MODELS 5
+
+static const char *rdz_bench_models[] = { "1", "log n", "n", "n log n", "n^2" };
+
+static double rdz_log2(double x) // x >= 1
+{
+  int e = 0; while (x >= 2.0) { x *= 0.5; e++; }
+
+  // log2(x) for x in [1, 2), via atanh: ln(x) = 2 * atanh((x - 1) / (x + 1))
+
+  double y = (x - 1.0) / (x + 1.0); double yy = y * y;
+  double s = 0.0; double t = y;
+  for (int i = 1; i < 40; i += 2) { s += t / i; t *= yy; }
+
+  return e + 2.0 * s / 0.6931471805599453;
+}
+
+static double rdz_bench_model(int m, double n)
+{
+  if (n < 1.0) n = 1.0;
+  double l = rdz_log2(n); if (l < 1.0) l = 1.0;
+
+  if (m == 1) return l;
+  if (m == 2) return n;
+  if (m == 3) return n * l;
+  if (m == 4) return n * n;
+  return 1.0;
+}
+
+static int rdz_bench_parse_model(const char *s)
+{
+  // "n log n", "O(n log n)", "n^2", "n²", "1"..., returns -1 if unknown
+
+  char *c = calloc(strlen(s) + 1, sizeof(char)); size_t l = 0;
+
+  for (const char *ss = s; *ss; ss++) // lowercase, no spaces
+  {
+    if (*ss == ' ' || *ss == '\t') continue;
+    c[l++] = (*ss >= 'A' && *ss <= 'Z') ? *ss + 32 : *ss;
+  }
+  if (l > 3 && c[0] == 'o' && c[1] == '(' && c[l - 1] == ')')
+  {
+    memmove(c, c + 2, l - 3); c[l - 3] = '\0';
+  }
+
+  int r = -1;
+  if (strcmp(c, "1") == 0) r = 0;
+  else if (strcmp(c, "logn") == 0) r = 1;
+  else if (strcmp(c, "n") == 0) r = 2;
+  else if (strcmp(c, "nlogn") == 0) r = 3;
+  else if (strcmp(c, "n^2") == 0 || strcmp(c, "n\xc2\xb2") == 0) r = 4;
+
+  free(c);
+
+  return r;
+}
+
+typedef double rdz_bench_func(size_t n);
+
+typedef struct rdz_bench_report { // one per benchmark block, for the summary
+  int n;
+  size_t count;
+  size_t sizes[RDZ_BENCH_SIZES];
+  double medians[RDZ_BENCH_SIZES]; // ns, one per size
+  double inters[RDZ_BENCH_MODELS]; // t ~ inter + coef * model(n)
+  double coefs[RDZ_BENCH_MODELS];
+  double rmss[RDZ_BENCH_MODELS]; // root mean square error / mean time
+  int best;
+  long rounds;
+  struct rdz_bench_report *next;
+} rdz_bench_report;
+
+static rdz_bench_report *rdz_bench_reports = NULL;
+
+int rdz_measure()
+{
+  return rdz_variant(0, 0); // the timing starts here, the setup is excluded
+}
+
+static double rdz_bench_call(rdz_bench_func *f, size_t size, int from)
+{
+  // runs the body for a size, returns its duration in ns, or -1.0 if it failed
+
+  rdz_variant_t0 = -1.0; rdz_variant_t1 = -1.0;
+
+  double start = rdz_bench_now();
+
+  f(size);
+
+  double end = rdz_bench_now();
+
+  for (int i = from; i < rdz_count; i++)
+  {
+    if (rdz_results[i].success == 0) return -1.0; // keep the failure
+  }
+  for (int i = from; i < rdz_count; i++) rdz_result_clear(rdz_results + i);
+  rdz_count = from;
+
+  if (rdz_variant_t0 < 0.0) return end - start; // no measure { ... }
+  if (rdz_variant_t1 < rdz_variant_t0) return 0.0;
+
+  return rdz_variant_t1 - rdz_variant_t0;
+}
+
+static void rdz_bench_fit(rdz_bench_report *rp)
+{
+  // least squares, t ~ a + c * f(n), the intercept a absorbs the per call
+  // overhead (timer, setup...) which would else pass for O(1) or O(log n),
+  // the error is relative to the mean time so that the models compare
+
+  double n = rp->count;
+  double mt = 0.0;
+  for (size_t i = 0; i < rp->count; i++) mt += rp->medians[i];
+  mt /= n;
+
+  double least = -1.0;
+
+  for (int m = 0; m < RDZ_BENCH_MODELS; m++)
+  {
+    double mf = 0.0;
+    for (size_t i = 0; i < rp->count; i++) mf += rdz_bench_model(m, rp->sizes[i]);
+    mf /= n;
+
+    double tf = 0.0; double ff = 0.0;
+
+    for (size_t i = 0; i < rp->count; i++)
+    {
+      double f = rdz_bench_model(m, rp->sizes[i]) - mf;
+      tf += (rp->medians[i] - mt) * f; ff += f * f;
+    }
+
+    double c = ff > 0.0 ? tf / ff : 0.0;
+    double a = mt - c * mf;
+
+    if (c < 0.0) { c = 0.0; a = mt; } // getting faster, a constant then
+    if (a < 0.0) // no negative overhead, through the origin then
+    {
+      tf = 0.0; ff = 0.0;
+      for (size_t i = 0; i < rp->count; i++)
+      {
+        double f = rdz_bench_model(m, rp->sizes[i]);
+        tf += rp->medians[i] * f; ff += f * f;
+      }
+      a = 0.0; c = ff > 0.0 ? tf / ff : 0.0;
+    }
+
+    double e = 0.0;
+
+    for (size_t i = 0; i < rp->count; i++)
+    {
+      double d = rp->medians[i] - a - c * rdz_bench_model(m, rp->sizes[i]);
+      e += d * d;
+    }
+
+    rp->inters[m] = a;
+    rp->coefs[m] = c;
+    rp->rmss[m] = mt > 0.0 ? rdz_sqrt(e / n) / mt : 0.0;
+
+    if (least < 0.0 || rp->rmss[m] < least) least = rp->rmss[m];
+  }
+
+  // the simplest model that fits about as well as the best one,
+  // a flat curve is O(1) even if O(n^2) with a tiny c fits it a tad better
+
+  for (rp->best = 0; rp->best < RDZ_BENCH_MODELS - 1; rp->best++)
+  {
+    if (rp->rmss[rp->best] <= least * 1.25 + 0.01) break;
+  }
+}
+
+double rdz_benchmark_run(
+  int n, rdz_bench_func *f,
+  size_t from, size_t to, double step, char op, const char *complexity)
+{
+  // runs the body for each size, until its share of RDZ_BENCH_TIME is spent,
+  // keeps the median per size and fits the medians against O(1) .. O(n^2)
+
+  double start = rdz_now();
+  int rc = rdz_count;
+
+  int expected = complexity ? rdz_bench_parse_model(complexity) : -1;
+
+  if (
+    from > to || (op == '*' && step <= 1.0) || (op == '+' && step < 1.0) ||
+    (complexity && expected < 0)
+  ) {
+    char *msg = calloc(1024, sizeof(char));
+    if (complexity && expected < 0)
+      snprintf(
+        msg, 1024,
+        "     unknown complexity(\"%s\"), "
+        "expected one of 1, log n, n, n log n, n^2", complexity);
+    else
+      snprintf(
+        msg, 1024,
+        "     sizes(%zu .. %zu, %c%g) doesn't go anywhere", from, to, op == '+' ? '+' : 'x', step);
+
+    rdz_record(0, msg, n, rdz_t->lstarts[n], rdz_t->ltstarts[n]);
+
+    return rdz_duration(start);
+  }
+
+  rdz_bench_report *rp = calloc(1, sizeof(rdz_bench_report));
+  rp->n = n;
+
+  for (double s = from; s <= to && rp->count < RDZ_BENCH_SIZES; )
+  {
+    rp->sizes[rp->count++] = (size_t)s;
+    s = op == '+' ? s + step : s * step;
+  }
+
+  // the sizes are run in interleaved rounds (up, then down, then up...),
+  // so that drift (frequency scaling, noisy neighbours) hits them all alike
+  // instead of bending the curve
+
+  size_t sc = rp->count;
+  double *samples = calloc(sc * RDZ_BENCH_SAMPLES, sizeof(double));
+  double *tmp = calloc(RDZ_BENCH_SAMPLES, sizeof(double));
+
+  for (size_t i = 0; i < sc; i++) // warm up
+  {
+    if (rdz_bench_call(f, rp->sizes[i], rc) < 0.0) goto _over;
+  }
+
+  long rounds = 0; double t0 = rdz_bench_now();
+
+  while (
+    rounds < RDZ_BENCH_SAMPLES &&
+    (rounds < 3 || rdz_bench_now() - t0 < rdz_bench_time * 1.0e6)
+  ) {
+    for (size_t j = 0; j < sc; j++)
+    {
+      size_t i = (rounds % 2) ? sc - 1 - j : j;
+
+      double ns = rdz_bench_call(f, rp->sizes[i], rc);
+      if (ns < 0.0) goto _over;
+
+      samples[i * RDZ_BENCH_SAMPLES + rounds] = ns;
+    }
+    rounds++;
+  }
+
+  for (size_t i = 0; i < sc; i++)
+  {
+    rp->medians[i] = rdz_median(samples + i * RDZ_BENCH_SAMPLES, rounds, tmp);
+  }
+  rp->rounds = rounds;
+
+  rdz_bench_fit(rp);
+
+  // complexity("n log n"), the best fit may not be worse than that, unless
+  // n log n fits nearly as well (noise easily swaps close classes)
+
+  if (
+    expected > -1 && rp->count > 1 && rp->best > expected &&
+    rp->rmss[expected] > 2.0 * rp->rmss[rp->best] + 0.05
+  )
+  {
+    char d[16]; rdz_duration_to_s(0.0, d); // not under RDZ_NO_DURATION
+
+    char *msg = calloc(1024, sizeof(char));
+    int l = snprintf(
+      msg, 1024,
+      "     expected at most O(%s), got O(%s)",
+      rdz_bench_models[expected], rdz_bench_models[rp->best]);
+    if (*d) snprintf(
+      msg + l, 1024 - l,
+      "\n          rms %.1f%% for O(%s) vs %.1f%% for O(%s)",
+      100.0 * rp->rmss[rp->best], rdz_bench_models[rp->best],
+      100.0 * rp->rmss[expected], rdz_bench_models[expected]);
+
+    rdz_record(0, msg, n, rdz_t->lstarts[n], rdz_t->ltstarts[n]);
+  }
+
+  free(tmp); free(samples);
+
+  rp->next = __atomic_load_n(&rdz_bench_reports, __ATOMIC_SEQ_CST);
+  while ( ! __atomic_compare_exchange_n(
+    &rdz_bench_reports, &rp->next, rp, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)
+  );
+
+  return rdz_duration(start);
+
+_over: // a failure, no report
+
+  free(tmp); free(samples); free(rp);
+
+  return rdz_duration(start);
+}
+
+static int rdz_bench_report_cmp(const void *a, const void *b)
+{
+  return (*(rdz_bench_report **)a)->n - (*(rdz_bench_report **)b)->n;
+}
+
+void rdz_benchmark_summary(int durations)
+{
+  if (rdz_bench_reports == NULL) return;
+
+  size_t count = 0;
+  for (rdz_bench_report *rp = rdz_bench_reports; rp; rp = rp->next) count++;
+
+  rdz_bench_report **rps = calloc(count, sizeof(rdz_bench_report *));
+  count = 0;
+  for (rdz_bench_report *rp = rdz_bench_reports; rp; rp = rp->next) rps[count++] = rp;
+
+  qsort(rps, count, sizeof(rdz_bench_report *), rdz_bench_report_cmp);
+
+  printf("%sBenchmark:\n\n", rdz_fail_count > 0 ? "\n" : "");
+
+  for (size_t i = 0; i < count; i++)
+  {
+    rdz_bench_report *rp = rps[i];
+    int n = rp->n;
+
+    char *title = rdz_determine_title(n);
+
+    printf("  %s", title);
+    printf(" %sL=%d I=%d%s\n", rdz_gr(), rdz_t->ltstarts[n], n, rdz_cl());
+
+    for (size_t j = 0; j < rp->count; j++)
+    {
+      printf("     n=%zu", rp->sizes[j]);
+
+      if (durations)
+      {
+        char m[64]; rdz_ns_to_s(rp->medians[j], m, 64);
+        char s[32]; snprintf(s, 32, "%zu", rp->sizes[j]);
+        int l = strlen(s);
+        printf("%*s %10s", l < 10 ? 10 - l : 0, "", m);
+      }
+      printf("\n");
+    }
+
+    if (durations && rp->count > 1)
+    {
+      int b = rp->best;
+      size_t l = rp->count - 1;
+
+      char a[64]; rdz_ns_to_s(rp->inters[b], a, 64);
+      char c[64]; rdz_ns_to_s(rp->coefs[b], c, 64);
+      if (rp->coefs[b] < 1.0) snprintf(c, 64, "%.3gns", rp->coefs[b]);
+      double pe = rp->medians[l] / rp->sizes[l];
+      char e[64]; rdz_ns_to_s(pe, e, 64);
+      if (pe < 1.0) snprintf(e, 64, "%.3gns", pe);
+
+      printf(
+        "     best fit %sO(%s)%s, ~%s + %s x %s, rms %.1f%%, %s per element at n=%zu\n",
+        rdz_gn(), rdz_bench_models[b], rdz_cl(),
+        a, c, rdz_bench_models[b], 100.0 * rp->rmss[b], e, rp->sizes[l]);
+
+      printf("     %s", rdz_gr());
+      for (int m = 0; m < RDZ_BENCH_MODELS; m++)
+      {
+        printf(
+          "%sO(%s) %.1f%%",
+          m > 0 ? ", " : "", rdz_bench_models[m], 100.0 * rp->rmss[m]);
+      }
+      printf("%s\n", rdz_cl());
+    }
+
+    if (durations)
+    {
+      printf("     %s%ld interleaved rounds%s\n", rdz_gr(), rp->rounds, rdz_cl());
+    }
+
+    free(rp);
+    free(title);
+  }
+
+  printf("\n");
+
+  free(rps); rdz_bench_reports = NULL;
+}
+
+#endif // RDZ_WITH_BENCH
+
+void rdz_run()
+{
+  if (rdz_list) { rdz_list_nodes(); return; }
+
+  if (rdz_durations && ! rdz_remote)
+  {
+    rdz_ran = calloc(rdz_t->count, sizeof(double));
+    for (int i = 0; i < rdz_t->count; i++) rdz_ran[i] = -1.0;
+  }
+
+  rdz_sample_start();
+
+  if (rdz_coordinator) rdz_coordinate();
+  else if (rdz_remote) rdz_work();
+  else if (rdz_bisect > -1) rdz_bisect_run();
+  else if (rdz_repeat > 1 || rdz_until_fail) rdz_repeat_run();
+  else if (rdz_valgrind)
+  {
+#ifdef RDZ_LEAKS
+    rdz_leaky = calloc(rdz_t->count, sizeof(char));
+#endif
+    rdz_dorun(0);
+    rdz_memcheck_run();
+    free(rdz_leaky); rdz_leaky = NULL;
+  }
+  else rdz_dorun(0);
+
+  rdz_sample_stop();
+  rdz_durations_save();
+  rdz_trace_write();
+
+  if (rdz_bisect_fd > -1) rdz_bisect_report();
+
+  free(rdz_ran); rdz_ran = NULL;
+}
+
+char *rdz_read_line(char *fname, int lnumber)
+{
+  char *l = calloc(1024, sizeof(char));
+  char *ll = l;
+
+  FILE *in = fopen(fname, "r");
+
+  if (in == NULL)
+  {
+    fprintf(stderr, "cannot find source file %s\n", fname);
+    exit(1);
+  }
+
+  while(1)
+  {
     if (lnumber < 1) break;
     char c = fgetc(in);
     if (c == EOF) break;
@@ -817,6 +5912,8 @@ char *rdz_read_line(char *fname, int lnumber)
 
 void rdz_summary(int itcount, double duration)
 {
+  if (rdz_list || rdz_bisect > -1) return;
+
   printf("\n");
 
   if (rdz_pending_count > 0)
@@ -825,15 +5922,15 @@ void rdz_summary(int itcount, double duration)
 
     for (int i = 0; i < rdz_count; i++)
     {
-      rdz_result *r = rdz_results[i];
+      rdz_result *r = rdz_results + i;
 
       if (r->success != -1) continue;
 
-      rdz_node *rit = rdz_nodes[r->itnumber];
+      char *fname = rdz_fname(r->itnumber);
 
       printf("  %s%s%s\n", rdz_yl(), r->title, rdz_cl());
       printf("   %s# %s%s\n", rdz_cy(), r->message, rdz_cl());
-      printf("   %s# %s:%d", rdz_cy(), rit->fname, r->lnumber);
+      printf("   %s# %s:%d", rdz_cy(), fname, r->lnumber);
       printf(" %sL=%d I=%d%s\n", rdz_gr(), r->ltnumber, r->itnumber, rdz_cl());
     }
 
@@ -846,19 +5943,19 @@ void rdz_summary(int itcount, double duration)
 
     for (int i = 0, j = 0; i < rdz_count; i++)
     {
-      rdz_result *r = rdz_results[i];
+      rdz_result *r = rdz_results + i;
 
       if (r->success != 0) continue;
 
-      rdz_node *rit = rdz_nodes[r->itnumber];
+      char *fname = rdz_fname(r->itnumber);
 
-      char *line = rdz_read_line(rit->fname, r->lnumber);
+      char *line = rdz_read_line(fname, r->lnumber);
       printf("  %d) %s\n", ++j, r->title);
       if (r->message) { printf("%s%s%s\n", rdz_rd(), r->message, rdz_cl()); }
       printf("     >");
       printf("%s%s%s", rdz_rd(), line, rdz_cl());
       printf("<\n");
-      printf("     %s# %s:%d%s", rdz_cy(), rit->fname, r->lnumber, rdz_cl());
+      printf("     %s# %s:%d%s", rdz_cy(), fname, r->lnumber, rdz_cl());
       printf(" %sL=%d I=%d%s\n", rdz_gr(), r->ltnumber, r->itnumber, rdz_cl());
       free(line);
     }
@@ -866,12 +5963,34 @@ void rdz_summary(int itcount, double duration)
 
   char sdu[80]; rdz_duration_to_s(duration, sdu);
 
+#ifdef RDZ_CONCURRENT
+  rdz_stress_summary(*sdu != 0); // ops/s vary, not shown under RDZ_NO_DURATION
+#endif
+  rdz_repeat_summary(*sdu != 0);
+  rdz_sample_summary();
+  rdz_memcheck_summary();
+#ifdef RDZ_WITH_FUZZ
+  rdz_fuzz_summary(*sdu != 0);
+#endif
+#ifdef RDZ_WITH_COMPARE
+  rdz_compare_summary(*sdu != 0);
+#endif
+#ifdef RDZ_WITH_BENCH
+  rdz_benchmark_summary(*sdu != 0);
+#endif
+
   printf("\n");
   printf("%s%d examples, ", rdz_fail_count > 0 ? rdz_rd() : rdz_gn(), itcount);
   printf("%d tests seen, ", rdz_count - rdz_pending_count);
   printf("%d failures", rdz_fail_count);
   if (rdz_pending_count > 0) printf(", %d pending", rdz_pending_count);
+  if (rdz_snap_written > 0) printf(", %d snapshots written", rdz_snap_written);
+  if (rdz_snap_updated > 0) printf(", %d snapshots updated", rdz_snap_updated);
   if (*sdu != 0) printf("  %s%s", rdz_gr(), sdu);
+  if (*sdu != 0 && rdz_conc_wall > 0.0)
+  {
+    printf("(concurrent x%.2f) ", rdz_conc_work / rdz_conc_wall);
+  }
   printf("%s\n", rdz_cl());
   printf("\n");
 
@@ -881,7 +6000,7 @@ void rdz_summary(int itcount, double duration)
 
     for (int i = 0; i < rdz_count; i++)
     {
-      rdz_result *r = rdz_results[i];
+      rdz_result *r = rdz_results + i;
 
       if (r->success != 0) continue;
 
@@ -26,39 +26,76 @@
 #define _POSIX_C_SOURCE 200809L
 
 #include <stdio.h>
+#include <ctype.h>
 #include <regex.h>
 #include <dirent.h>
 #include <string.h>
 #include <stdlib.h>
+#include <time.h>
 #include <libgen.h>
 #include <glob.h>
 #include <unistd.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
 
 #include "flutil.h"
+#include "fnv.c" // rdz_fnv(), shared with the runtime
 
 
 #define RODZO_VERSION "1.2.0"
 
-#define NODE_MAX_CHILDREN 128
-
 
 
 //
 // context and tree
 
+typedef struct rows_s {
+  size_t count;
+  char **rows; // "{ \"a\", 1 }", one per row
+  int *lines; // the line each row starts on
+  char **titles; // the it text, formatted with the row
+  size_t ccount;
+  char **names; // the column names, "in", "out" or "c0", "c1"
+  char **firsts; // the first row's columns, they give the column types
+} rows_s;
+
 typedef struct node_s {
   struct node_s *parent;
   int nodenumber;
   int indent;
   short hasbody;
+  short concurrent; // describe "x" concurrent, its run on a thread pool
+  int threads; // it "x" threads(8) iterations(1000), a stress example
+  long iterations;
+  rows_s *rows; // it "x %s" with rows { ... }, held by the first row
+  struct node_s *tmpl; // the first row, for the other rows
+  int row; // row index
+  char *expr; // let x = expr; cleanup;
+  char *cleanup;
+  short eager; // let! x = expr;
+  char *fuzz; // fuzz "x" (const uint8_t *data, size_t size), the parameters
+  short compare; // compare "x" { variant "a" { ... } variant "b" { ... } }
+  char *winner; // compare "x" faster("b")
+  int vcount;
+  char **vnames; // the variant names, in order
+  char *sizes; // benchmark "x" sizes(1<<10 .. 1<<20, x4), "from, to, step, op"
+  char *complexity; // benchmark "x" ... complexity("n log n")
   char type;
   char *text;
-  char *fname;
+  char *fname; // shared, not owned by the node
   int lstart;
   int ltstart;
   int llength;
   flu_sbuffer *lines;
-  struct node_s **children;
+  struct node_s *first; // first child
+  struct node_s *last; // last child
+  struct node_s *next; // next sibling
+  struct node_s *eaches; // first "before each" or "after each" child
+  struct node_s *next_each; // next "before each" or "after each" sibling
 } node_s;
 
 typedef struct {
@@ -66,9 +103,22 @@ typedef struct {
   int nodecount;
   int itcount; // it count
   int encount; // ensure count
+  int sitecount; // typed ensure count
+  flu_sbuffer *sites;
   node_s *node;
   char *out_fname;
   int debug;
+  int reproducible;
+  int deps; // 0 no .d file, 1 spec files (-MD), 2 headers as well (-MH)
+  flu_list *includes; // -I dirs, passed to the preprocessor for -MH
+  int watch; // --watch, regenerate, build and run on change
+  flu_dict *sdeps; // spec file -> "spec file and what it includes" (-MH)
+  int concurrent; // 1 if there is at least one concurrent describe or stress it
+  int fuzz; // --fuzz, LLVMFuzzerTestOneInput() instead of main()
+  int fuzzes; // 1 if there is at least one fuzz block (RDZ_WITH_FUZZ)
+  int compares; // 1 if there is at least one compare block (RDZ_WITH_COMPARE)
+  int benchmarks; // 1 if there is at least one benchmark (RDZ_WITH_BENCH)
+  int list; // --list, JSON lines to stdout, no spec file written
 } context_s;
 
 char *type_to_string(char t)
@@ -82,6 +132,7 @@ char *type_to_string(char t)
   if (t == 'B') return "before all";
   if (t == 'a') return "after each";
   if (t == 'z') return "after each offline";
+  if (t == 'l') return "let";
   if (t == 'A') return "after all";
   if (t == 'g') return "g";
   if (t == 'G') return "G";
@@ -107,9 +158,9 @@ void node_to_s(flu_sbuffer *b, int level, node_s *n)
 
   free(te);
 
-  for (size_t i = 0; n->children[i] != NULL; i++)
+  for (node_s *cn = n->first; cn != NULL; cn = cn->next)
   {
-    node_to_s(b, level + 1, n->children[i]);
+    node_to_s(b, level + 1, cn);
   }
 }
 
@@ -129,12 +180,29 @@ void node_to_p(flu_sbuffer *b, int level, node_s *n)
   int notg = (t != 'g' && t != 'G');
   int notba = (t != 'b' && t != 'B' && t != 'a' && t != 'A');
 
+  if (t == 'l')
+  {
+    for (int i = 0; i < level; i++) flu_sbputs(b, "  ");
+    flu_sbprintf(b, "let%s \"%s\"\n", n->eager ? "!" : "", n->text);
+
+    return;
+  }
+
   if (notg)
   {
     char *te = flu_strrtrim(n->text != NULL ? n->text : "(nil)");
 
     for (int i = 0; i < level; i++) flu_sbputs(b, "  ");
-    flu_sbprintf(b, "%s \"%s\"\n", type_to_string(n->type), te);
+    char *ts = type_to_string(t);
+    if (n->fuzz) ts = "fuzz"; else if (n->compare) ts = "compare";
+    else if (n->sizes) ts = "benchmark";
+    flu_sbprintf(b, "%s \"%s\"", ts, te);
+    if (n->concurrent) flu_sbprintf(b, " concurrent");
+    if (n->threads) flu_sbprintf(b, " threads(%d)", n->threads);
+    if (n->threads) flu_sbprintf(b, " iterations(%ld)", n->iterations);
+    if (n->winner) flu_sbprintf(b, " faster(\"%s\")", n->winner);
+    if (n->complexity) flu_sbprintf(b, " complexity(\"%s\")", n->complexity);
+    flu_sbprintf(b, "\n");
 
     free(te);
   }
@@ -147,9 +215,15 @@ void node_to_p(flu_sbuffer *b, int level, node_s *n)
       flu_sbprintf(b, "{\n");
     }
 
-    for (size_t i = 0; n->children[i] != NULL; i++)
+    for (int i = 0; i < n->vcount; i++)
+    {
+      for (int j = 0; j <= level; j++) flu_sbputs(b, "  ");
+      flu_sbprintf(b, "variant \"%s\"\n", n->vnames[i]);
+    }
+
+    for (node_s *cn = n->first; cn != NULL; cn = cn->next)
     {
-      node_to_p(b, level + 1, n->children[i]);
+      node_to_p(b, level + 1, cn);
     }
 
     if (notg && notba)
@@ -189,8 +263,6 @@ void push(context_s *c, int ind, char type, char *text, char *fn, int lstart)
   if (text == NULL && type == 'p') text = "no reason given";
   if (text != NULL) text = strdup(text);
 
-  if (fn != NULL) fn = strdup(fn);
-
   if (ind == 0) while (c->node->parent != NULL) c->node = c->node->parent;
     // if indentation is 0, go back to trunk
 
@@ -198,7 +270,7 @@ void push(context_s *c, int ind, char type, char *text, char *fn, int lstart)
 
   if (cn && cn->type == 'i' && type != 'p') // "it" without bodies
   {
-    if (cn->children[0] == NULL)
+    if (cn->first == NULL)
     {
       //push(c, ind, 'p', "not yet implemented 2", fn, cn->lstart);
       push(c, ind, 'p', "not yet implemented", fn, cn->lstart);
@@ -211,6 +283,22 @@ void push(context_s *c, int ind, char type, char *text, char *fn, int lstart)
   n->nodenumber = c->nodecount++;
   n->indent = ind;
   n->hasbody = 0;
+  n->concurrent = 0;
+  n->threads = 0;
+  n->iterations = 0;
+  n->rows = NULL;
+  n->tmpl = NULL;
+  n->row = 0;
+  n->expr = NULL;
+  n->cleanup = NULL;
+  n->eager = 0;
+  n->fuzz = NULL;
+  n->compare = 0;
+  n->winner = NULL;
+  n->vcount = 0;
+  n->vnames = NULL;
+  n->sizes = NULL;
+  n->complexity = NULL;
   n->type = type;
   n->text = text;
   n->fname = fn;
@@ -218,18 +306,26 @@ void push(context_s *c, int ind, char type, char *text, char *fn, int lstart)
   n->ltstart = c->loffset + lstart;
   n->llength = 0;
   n->lines = NULL;
-  n->children = calloc(NODE_MAX_CHILDREN + 1, sizeof(node_s *));
+  n->first = NULL;
+  n->last = NULL;
+  n->next = NULL;
+  n->eaches = NULL;
+  n->next_each = NULL;
+
+  if (cn != NULL)
+  {
+    if (cn->last == NULL) cn->first = n; else cn->last->next = n;
+    cn->last = n;
+  }
 
-  for (size_t i = 0; ; i++)
+  if (cn != NULL && (type == 'b' || type == 'a' || type == 'l'))
   {
-    if (cn == NULL) break;
-    if (cn->children[i] != NULL) continue;
-    cn->children[i] = n;
-    break;
+    node_s **e = &cn->eaches; while (*e != NULL) e = &(*e)->next_each;
+    *e = n;
   }
 
   c->node = n;
-  if (type == 'p') c->node = cn;
+  if (type == 'p' || type == 'l') c->node = cn;
 
   if (type == 'i') c->itcount++;
 }
@@ -241,29 +337,60 @@ context_s *malloc_context()
   c->nodecount = 0;
   c->itcount = 0;
   c->encount = 0;
+  c->sitecount = 0;
+  c->sites = flu_sbuffer_malloc();
   c->node = NULL;
   c->out_fname = NULL;
   c->debug = 0;
+  c->reproducible = 0;
+  c->deps = 0;
+  c->includes = flu_list_malloc();
+  c->watch = 0;
+  c->sdeps = NULL;
+  c->concurrent = 0;
+  c->list = 0;
+  c->fuzz = 0;
+  c->fuzzes = 0;
+  c->compares = 0;
+  c->benchmarks = 0;
 
   push(c, -1, 'G', NULL, NULL, -1);
 
   return c;
 }
 
+void free_rows(rows_s *r)
+{
+  if (r == NULL) return;
+
+  for (size_t i = 0; i < r->count; i++) { free(r->rows[i]); free(r->titles[i]); }
+  for (size_t i = 0; i < r->ccount; i++) { free(r->names[i]); free(r->firsts[i]); }
+  free(r->rows); free(r->lines); free(r->titles);
+  free(r->names); free(r->firsts);
+  free(r);
+}
+
 void free_node(node_s *n)
 {
   free(n->text);
-  free(n->fname);
+  free(n->expr);
+  free(n->cleanup);
+  free(n->fuzz);
+  free(n->winner);
+  for (int i = 0; i < n->vcount; i++) free(n->vnames[i]);
+  free(n->vnames);
+  free(n->sizes);
+  free(n->complexity);
+  free_rows(n->rows);
 
   flu_sbuffer_free(n->lines);
 
-  for (size_t i = 0; ; i++)
+  for (node_s *c = n->first; c != NULL; )
   {
-    node_s *c = n->children[i];
-    if (c == NULL) break;
+    node_s *next = c->next;
     free_node(c);
+    c = next;
   }
-  free(n->children);
 
   free(n);
 }
@@ -278,6 +405,9 @@ void free_context(context_s *c)
 {
   clear_tree(c);
 
+  flu_sbuffer_free(c->sites);
+  flu_list_free(c->includes);
+  if (c->sdeps) flu_list_free_all(c->sdeps);
   free(c->out_fname);
   free(c);
 }
@@ -302,6 +432,24 @@ void pull(context_s *c, int indent, int lnumber)
 
   c->node = n->parent;
 
+  for (size_t i = 1; n->rows && i < n->rows->count; i++) // the other rows
+  {
+    rows_s *r = n->rows;
+
+    push(c, n->indent, 'i', r->titles[i], n->fname, r->lines[i]);
+    c->node->tmpl = n;
+    c->node->row = i;
+    c->node->hasbody = 1;
+    c->node->llength = r->lines[i] == n->lstart ? n->llength : 0;
+    c->node = n->parent;
+  }
+  if (n->rows && n->rows->lines[0] != n->lstart) // rows below the it line
+  {
+    n->ltstart += n->rows->lines[0] - n->lstart;
+    n->lstart = n->rows->lines[0];
+    n->llength = 0;
+  }
+
   if (c->node->type == 'G')
   {
     push(c, 0, 'g', NULL, n->fname, lnumber + 1);
@@ -402,6 +550,18 @@ line_s *split(int comment, char *line)
   return l;
 }
 
+int is_block(line_s *l, char *head)
+{
+  // fuzz "x" ..., compare "x" ..., but not fuzz(x) or compare(a, b)
+
+  if (l->head == NULL || strcmp(l->head, head) != 0) return 0;
+
+  char *s = l->line + l->indent + strlen(head);
+  while (*s == ' ' || *s == '\t') s++;
+
+  return *s == '"';
+}
+
 int ends_in_semicolon(char *line)
 {
   if (*line != 0) for (size_t i = strlen(line) - 1; ; --i)
@@ -471,16 +631,18 @@ int push_ensure(context_s *c, FILE *in, int indent, int lnumber, char *l)
   char *ind = calloc(indent + 1, sizeof(char));
   for (int i = 0; i < indent; i++) ind[i] = ' ';
 
-  push_linef(c, "%schar *msg%d = NULL;\n", ind, lnumber);
-
+  int typed = 0;
   regmatch_t ms[6];
 
   if (regexec(&ensure_operator_rex, con, 6, ms, 0)) // no match
   {
+    push_linef(c, "%schar *msg%d = NULL;\n", ind, lnumber);
     push_linef(c, "%sint r%d = %s\n", ind, lnumber, con);
   }
   else if (ms[3].rm_eo > ms[3].rm_so) // type
   {
+    typed = 1;
+
     char *format = extract_match(con, ms[3]);
     char *eq = extract_match(con, ms[4]);
 
@@ -490,6 +652,7 @@ int push_ensure(context_s *c, FILE *in, int indent, int lnumber, char *l)
     *(strrchr(right, ')')) = '\0';
 
     char *type = "int";
+    char *fun = "rdz_ensure_i64";
     //if (strcmp(format, "d") == 0) type = "int";
     if (strcmp(format, "s") == 0) type = "short";
     else if (strcmp(format, "c") == 0) type = "char";
@@ -505,29 +668,44 @@ int push_ensure(context_s *c, FILE *in, int indent, int lnumber, char *l)
     else if (strcmp(format, "zu") == 0) type = "size_t";
     else if (strcmp(format, "zd") == 0) type = "ssize_t";
 
-    push_linef(c, "%s%s left%d = %s;\n", ind, type, lnumber, left);
-    push_linef(c, "%s%s right%d = %s;\n", ind, type, lnumber, right);
+    if (strcmp(type, "double") == 0) fun = "rdz_ensure_f64";
+    else if (strstr(type, "unsigned")) fun = "rdz_ensure_u64";
+    else if (strcmp(type, "size_t") == 0) fun = "rdz_ensure_u64";
 
-    push_linef(
-      c,
-      "%sint r%d = (left%d %s right%d);\n",
-      ind, lnumber, lnumber, eq, lnumber);
-
-    push_linef(c, "%sif ( ! r%d)\n", ind, lnumber);
-    push_linef(c, "%s{\n", ind);
-    push_linef(c, "%s  msg%d = calloc(2048, sizeof(char));\n", ind, lnumber);
-    push_linef(c, "%s  snprintf(\n", ind);
-    push_linef(c, "%s    msg%d, 2048,\n", ind, lnumber);
-    push_linef(c, "%s      \"     expected %s%s\\n\"\n", ind, "%", format);
-    push_linef(c, "%s      \"     %s8s %s%s\",\n", ind, "%", "%", format);
-    push_linef(c, "%s      left%d, \"to %s\", right%d\n", ind, lnumber, eq, lnumber);
-    push_linef(c, "%s    );\n", ind);
-    push_linef(c, "%s}\n", ind);
+    if (c->node->rows) // the site is per row, the row is a parameter
+    {
+      push_linef(
+        c, "%sif ( ! %s((%s)(%s), (%s)(%s), "
+        "&(rdz_site){ \"%s\", \"%s\", __rdz_it, %d, %d })) goto _over;\n",
+        ind, fun, type, left, type, right,
+        format, eq, lnumber, c->loffset + lnumber);
+    }
+    else
+    {
+      flu_sbprintf(
+        c->sites,
+        "  { \"%s\", \"%s\", %d, %d, %d }, // site %d\n",
+        format, eq, c->node->nodenumber, lnumber, c->loffset + lnumber,
+        c->sitecount);
+
+      push_linef(
+        c, "%sif ( ! %s((%s)(%s), (%s)(%s), rdz_sites + %d)) goto _over;\n",
+        ind, fun, type, left, type, right, c->sitecount);
+
+      c->sitecount++;
+    }
+
+    free(format);
+    free(eq);
+    free(left);
+    free(right);
   }
   else // string
   {
     char *oper = extract_match(con, ms[5]);
 
+    push_linef(c, "%schar *msg%d = NULL;\n", ind, lnumber);
+
     con[ms[1].rm_so] = '\0';
     char *left = flu_strtrim(con);
     char *right = chop_right(flu_strtrim(con + ms[1].rm_eo));
@@ -547,9 +725,18 @@ int push_ensure(context_s *c, FILE *in, int indent, int lnumber, char *l)
     push_linef(
       c, "%schar *expected%d = %s;\n",
       ind, lnumber, right);
-    push_linef(
-      c, "%smsg%d = %s(\"%s\", result%d, expected%d);\n",
-      ind, lnumber, fun, oper, lnumber, lnumber);
+    if (strstr(oper, "snap")) // the snapshot sits next to the spec file
+    {
+      push_linef(
+        c, "%smsg%d = rdz_string_snap(result%d, expected%d, \"%s\");\n",
+        ind, lnumber, lnumber, lnumber, c->node->fname);
+    }
+    else
+    {
+      push_linef(
+        c, "%smsg%d = %s(\"%s\", result%d, expected%d);\n",
+        ind, lnumber, fun, oper, lnumber, lnumber);
+    }
     push_linef(
       c, "%sint r%d = (msg%d == NULL);\n",
       ind, lnumber, lnumber);
@@ -572,12 +759,24 @@ int push_ensure(context_s *c, FILE *in, int indent, int lnumber, char *l)
     free(right);
   }
 
-  push_linef(
-    c, "%srdz_record(r%d, msg%d, %d, %d, %d); ",
-    ind, lnumber, lnumber, c->node->nodenumber, lnumber, c->loffset + lnumber);
-  push_linef(
-    c, "if ( ! r%d) goto _over;\n",
-    lnumber);
+  if (typed == 0 && c->node->rows)
+  {
+    push_linef(
+      c, "%srdz_record(r%d, msg%d, __rdz_it, %d, %d); ",
+      ind, lnumber, lnumber, lnumber, c->loffset + lnumber);
+    push_linef(
+      c, "if ( ! r%d) goto _over;\n",
+      lnumber);
+  }
+  else if (typed == 0)
+  {
+    push_linef(
+      c, "%srdz_record(r%d, msg%d, %d, %d, %d); ",
+      ind, lnumber, lnumber, c->node->nodenumber, lnumber, c->loffset + lnumber);
+    push_linef(
+      c, "if ( ! r%d) goto _over;\n",
+      lnumber);
+  }
 
   free(ind);
   free(con);
@@ -587,6 +786,66 @@ int push_ensure(context_s *c, FILE *in, int indent, int lnumber, char *l)
   return lnumber;
 }
 
+int push_let(context_s *c, FILE *in, int indent, int lnumber, char *line)
+{
+  // let doc = parse_file("big.json"); free_doc(doc);
+  // let! now = time(NULL);
+
+  char *l = extract_condition(in, strstr(line, "let"));
+  int lstart = lnumber;
+  lnumber += count_lines(l);
+
+  char *s = l + 3;
+  int eager = (*s == '!'); if (eager) s++;
+  while (*s == ' ' || *s == '\t') s++;
+
+  char *name = s; while (isalnum(*s) || *s == '_') s++;
+  char *ne = s;
+  while (*s == ' ' || *s == '\t') s++;
+
+  if (*s != '=' || ne == name)
+  {
+    fprintf(stderr, "%s:%d: expected let name = expr;\n", c->node->fname, lstart);
+    free(l);
+    return lnumber;
+  }
+
+  char *expr = ++s; // up to the first ; outside of strings and parentheses
+  int depth = 0, string = 0, escape = 0;
+
+  for (; *s; s++)
+  {
+    if (string) { if ( ! escape && *s == string) string = 0; }
+    else if (*s == '"' || *s == '\'') string = *s;
+    else if (*s == '(' || *s == '[' || *s == '{') depth++;
+    else if (*s == ')' || *s == ']' || *s == '}') depth--;
+    else if (*s == ';' && depth == 0) break;
+
+    escape = ! escape && *s == '\\';
+  }
+
+  *ne = '\0';
+  char *e = strndup(expr, s - expr);
+
+  for (char *cc = e; *cc; cc++) if (*cc == '\n' || *cc == '\r') *cc = ' ';
+    // the accessor is a #define, on a single line
+
+  push(c, indent, 'l', name, c->node->fname, lstart);
+
+  node_s *n = c->node->last;
+  n->expr = flu_strtrim(e);
+  n->eager = eager;
+  n->llength = lnumber - lstart;
+
+  char *cl = *s ? flu_strtrim(s + 1) : NULL;
+  if (cl && *cl) n->cleanup = cl; else free(cl);
+
+  free(e);
+  free(l);
+
+  return lnumber;
+}
+
 void push_pending(context_s *c, line_s *l, char *fn, int lstart)
 {
   node_s *cn = c->node;
@@ -602,6 +861,380 @@ void push_pending(context_s *c, line_s *l, char *fn, int lstart)
   }
 }
 
+int is_concurrent(char *line)
+{
+  // describe "x" concurrent
+  // describe "x" concurrent {
+
+  char *q = strrchr(line, '"'); if (q == NULL) return 0;
+  char *s = strstr(q, "concurrent"); if (s == NULL) return 0;
+
+  return strchr(" \t{", s[10]) != NULL;
+}
+
+void parse_stress(context_s *c, char *line)
+{
+  // it "x" threads(8) iterations(100000)
+
+  char *q = strrchr(line, '"'); if (q == NULL) return;
+
+  char *t = strstr(q, "threads(");
+  char *i = strstr(q, "iterations(");
+
+  if (t == NULL && i == NULL) return;
+
+  node_s *n = c->node;
+
+  n->threads = t ? atoi(t + 8) : 1;
+  n->iterations = i ? atol(i + 11) : 1;
+  if (n->threads < 1) n->threads = 1;
+  if (n->iterations < 1) n->iterations = 1;
+
+  c->concurrent = 1;
+}
+
+void parse_fuzz(context_s *c, char *line)
+{
+  // fuzz "x" (const uint8_t *data, size_t size)
+
+  char *q = strrchr(line, '"'); if (q == NULL) q = line;
+
+  char *s = strchr(q, '(');
+  char *e = s ? strrchr(s, ')') : NULL;
+
+  c->node->fuzz = e ?
+    strndup(s + 1, e - s - 1) : strdup("const uint8_t *data, size_t size");
+
+  c->fuzzes = 1;
+}
+
+static char *past_title(char *line)
+{
+  // points right after the first string literal in the line
+
+  char *s = strchr(line, '"'); if (s == NULL) return line + strlen(line);
+
+  for (s++; *s && *s != '"'; s++) if (*s == '\\' && s[1]) s++;
+
+  return *s ? s + 1 : s;
+}
+
+void parse_compare(context_s *c, char *line)
+{
+  // compare "x" faster("b")
+
+  c->node->compare = 1;
+  c->compares = 1;
+
+  char *q = strrchr(line, '"'); if (q == NULL) return;
+  char *f = strstr(line, "faster(\""); if (f == NULL) return;
+
+  f += 8;
+  char *e = strchr(f, '"'); if (e == NULL) return;
+
+  c->node->winner = strndup(f, e - f);
+}
+
+void push_variant(context_s *c, line_s *l)
+{
+  // variant "a" { ... }  -->  if (rdz_variant(__rdz_variant, 0)) { ... }
+
+  node_s *n = c->node;
+
+  n->vnames = realloc(n->vnames, (n->vcount + 1) * sizeof(char *));
+  n->vnames[n->vcount] = strdup(l->text ? l->text : "");
+
+  char *ind = calloc(l->indent + 1, sizeof(char));
+  for (int i = 0; i < l->indent; i++) ind[i] = ' ';
+
+  char *rest = past_title(l->line);
+  while (*rest == ' ' || *rest == '\t') rest++;
+
+  push_linef(
+    c, "%sif (rdz_variant(__rdz_variant, %d))%s%s // variant \"%s\"\n",
+    ind, n->vcount, *rest ? " " : "", rest, n->vnames[n->vcount]);
+
+  n->vcount++;
+
+  free(ind);
+}
+
+void parse_benchmark(context_s *c, char *line)
+{
+  // benchmark "x" sizes(1<<10 .. 1<<20, x4) complexity("n log n")
+  // sizes(100 .. 1000, +100) steps by addition, the step defaults to x2
+
+  node_s *n = c->node;
+
+  c->benchmarks = 1;
+
+  line = past_title(line);
+
+  char *cx = strstr(line, "complexity(\"");
+  if (cx)
+  {
+    cx += 12;
+    char *e = strchr(cx, '"');
+    if (e) n->complexity = strndup(cx, e - cx);
+  }
+
+  char *s = strstr(line, "sizes("); if (s == NULL) return;
+  s += 6;
+
+  char *e = s; // the closing parenthesis
+  for (int depth = 0; *e && (depth > 0 || *e != ')'); e++)
+  {
+    if (*e == '(') depth++; else if (*e == ')') depth--;
+  }
+
+  char *dots = strstr(s, "..");
+  if (dots == NULL || dots > e) return;
+
+  char *comma = NULL; // the last top level comma
+  for (char *cc = dots; cc < e; cc++) if (*cc == ',') comma = cc;
+
+  char *f = strndup(s, dots - s);
+  char *t = strndup(dots + 2, (comma ? comma : e) - dots - 2);
+  char *p = comma ? strndup(comma + 1, e - comma - 1) : strdup("x2");
+
+  char *from = flu_strtrim(f);
+  char *tt = flu_strtrim(t);
+  char *ts = flu_strtrim(p);
+
+  char op = '*';
+  char *st = ts;
+  if (*st == 'x' || *st == '*') st++;
+  else if (*st == '+') { op = '+'; st++; }
+
+  n->sizes = flu_sprintf("(size_t)(%s), (size_t)(%s), (double)(%s), '%c'", from, tt, st, op);
+
+  free(f); free(t); free(p); free(from); free(tt); free(ts);
+}
+
+void push_measure(context_s *c, line_s *l)
+{
+  // measure { ... }  -->  if (rdz_measure()) { ... }
+
+  char *ind = calloc(l->indent + 1, sizeof(char));
+  for (int i = 0; i < l->indent; i++) ind[i] = ' ';
+
+  char *rest = l->line + l->indent + 7;
+  while (*rest == ' ' || *rest == '\t') rest++;
+
+  push_linef(
+    c, "%sif (rdz_measure())%s%s // measure\n", ind, *rest ? " " : "", rest);
+
+  free(ind);
+}
+
+static char *row_title(char *format, char **cols, size_t ccount, size_t row)
+{
+  // "parses %s" and { "a", 1 } -> "parses a", the title is a C string
+
+  flu_sbuffer *b = flu_sbuffer_malloc();
+  size_t ci = 0;
+
+  for (char *s = format; *s; s++)
+  {
+    if (*s != '%') { flu_sbputc(b, *s); continue; }
+    if (s[1] == '%') { flu_sbputc(b, '%'); s++; continue; }
+
+    char *e = s + 1; while (*e && strchr("-+ #0123456789.hlLqjzt", *e)) e++;
+    if (*e == '\0') { flu_sbputs(b, s); break; }
+
+    char *v = ci < ccount ? cols[ci++] : "";
+    size_t l = strlen(v);
+
+    if (l > 1 && v[0] == '"' && v[l - 1] == '"') // string literal
+    {
+      flu_sbwrite(b, v + 1, l - 2);
+    }
+    else
+    {
+      for (char *cc = v; *cc; cc++)
+      {
+        if (*cc == '"' || *cc == '\\') flu_sbputc(b, '\\');
+        flu_sbputc(b, *cc);
+      }
+    }
+
+    s = e;
+  }
+
+  if (ci == 0) flu_sbprintf(b, " (row %zu)", row + 1); // no conversion
+
+  return flu_sbuffer_to_string(b);
+}
+
+static size_t split_row(char *row, char ***cols)
+{
+  // "{ \"a, b\", f(1, 2) }" -> [ "\"a, b\"", "f(1, 2)" ]
+
+  flu_list *l = flu_list_malloc();
+
+  char *s = row + 1; // past the '{'
+  int depth = 0, string = 0, escape = 0;
+
+  for (char *c = s; *c; c++)
+  {
+    if (string) { if ( ! escape && *c == string) string = 0; }
+    else if (*c == '"' || *c == '\'') string = *c;
+    else if (*c == '(' || *c == '[' || *c == '{') depth++;
+    else if ((*c == ')' || *c == ']' || *c == '}') && depth > 0) depth--;
+    else if (depth == 0 && (*c == ',' || *c == '}'))
+    {
+      char *col = strndup(s, c - s);
+      char *t = flu_strtrim(col); free(col);
+      if (*t) flu_list_add(l, t); else free(t);
+      s = c + 1;
+      if (*c == '}') break;
+    }
+
+    escape = ! escape && *c == '\\';
+  }
+
+  size_t count = l->size;
+  *cols = (char **)flu_list_to_array(l, 0);
+  flu_list_free(l);
+
+  return count;
+}
+
+rows_s *parse_rows(FILE *in, int *lnumber, char *line, char *text, int *hasbody)
+{
+  // it "parses %s" with rows { { "a", 1 }, { "b", 2 } } {
+  // it "parses %s" with rows(in, out) {
+  //   { "a", 1 },
+  //   { "b", 2 }
+  // } {
+
+  char *q = strchr(line, '"'); if (q == NULL) return NULL;
+  for (q++; *q && *q != '"'; q++) if (*q == '\\' && q[1]) q++;
+  if (*q == '\0') return NULL;
+
+  char *w = q + 1; while (*w == ' ' || *w == '\t') w++;
+  if (strncmp(w, "with", 4) != 0) return NULL;
+  w += 4; while (*w == ' ' || *w == '\t') w++;
+  if (strncmp(w, "rows", 4) != 0) return NULL;
+  w += 4; while (*w == ' ' || *w == '\t') w++;
+
+  rows_s *r = calloc(1, sizeof(rows_s));
+
+  char **names = NULL;
+  size_t ncount = 0;
+
+  if (*w == '(') // names
+  {
+    char *e = strchr(w, ')'); if (e == NULL) e = w + strlen(w);
+    char *ns = flu_sprintf("{%.*s}", (int)(e - w - 1), w + 1);
+    ncount = split_row(ns, &names);
+    free(ns);
+    w = *e ? e + 1 : e;
+  }
+
+  flu_sbuffer *b = NULL;
+  flu_list *rows = flu_list_malloc();
+  flu_list *lines = flu_list_malloc();
+  int depth = 0, string = 0, escape = 0, bare = 0;
+  char *lin = NULL; size_t len = 0;
+
+  for (char *c = w; ; c++)
+  {
+    if (*c == '\0' || *c == '\n' || *c == '\r') // next line
+    {
+      if (depth == 0 && rows->size > 0) break;
+      if (getline(&lin, &len, in) == -1) break;
+      (*lnumber)++;
+      c = lin - 1; continue;
+    }
+
+    if ( ! string && *c == '/' && c[1] == '/') // comment, till the end of line
+    {
+      c += strlen(c) - 1; continue;
+    }
+
+    int ended = 0;
+
+    if (string) { if ( ! escape && *c == string) string = 0; }
+    else if (*c == '"' || *c == '\'') string = *c;
+    else if (*c == '{' || *c == '(' || *c == '[') depth++;
+    else if (*c == '}' || *c == ')' || *c == ']') depth--;
+
+    escape = ! escape && *c == '\\';
+
+    if (depth == 1 && b == NULL) // between rows
+    {
+      if (strchr("{ \t,", *c)) continue;
+      bare = 1; // rows { 1, 2, 3 }, a single column
+      b = flu_sbuffer_malloc(); flu_sbputs(b, "{ ");
+      flu_list_add(lines, (void *)(long)*lnumber);
+    }
+    else if (depth == 2 && b == NULL && *c == '{')
+    {
+      b = flu_sbuffer_malloc();
+      flu_list_add(lines, (void *)(long)*lnumber);
+    }
+
+    if (b && bare && depth <= 1 && ! string && (*c == ',' || *c == '}'))
+    {
+      ended = 1; flu_sbputs(b, " }");
+    }
+    else if (b)
+    {
+      flu_sbputc(b, *c);
+      ended = ! bare && depth == 1 && *c == '}';
+    }
+
+    if (ended) { flu_list_add(rows, flu_sbuffer_to_string(b)); b = NULL; bare = 0; }
+
+    if (depth == 0 && rows->size > 0) // past the rows, a body?
+    {
+      *hasbody = strchr(c + 1, '{') != NULL; break;
+    }
+  }
+
+  free(lin);
+  if (b) flu_sbuffer_free(b);
+
+  r->count = rows->size;
+  r->rows = (char **)flu_list_to_array(rows, 0);
+  r->lines = calloc(r->count + 1, sizeof(int));
+  r->titles = calloc(r->count + 1, sizeof(char *));
+
+  size_t i = 0;
+  for (flu_node *fn = lines->first; fn; fn = fn->next) r->lines[i++] = (int)(long)fn->item;
+
+  flu_list_free(rows);
+  flu_list_free(lines);
+
+  for (i = 0; i < r->count; i++)
+  {
+    char **cols = NULL;
+    size_t cc = split_row(r->rows[i], &cols);
+
+    r->titles[i] = row_title(text, cols, cc, i);
+
+    if (i == 0) { r->firsts = cols; r->ccount = cc; continue; }
+
+    for (size_t j = 0; j < cc; j++) free(cols[j]);
+    free(cols);
+  }
+
+  r->names = calloc(r->ccount + 1, sizeof(char *));
+
+  for (i = 0; i < r->ccount; i++)
+  {
+    r->names[i] = i < ncount ? strdup(names[i]) : flu_sprintf("c%zu", i);
+  }
+
+  for (i = 0; i < ncount; i++) free(names[i]);
+  free(names);
+
+  if (r->count < 1) { free_rows(r); return NULL; }
+
+  return r;
+}
+
 void process_lines(context_s *c, char *path)
 {
   push(c, 0, 'g', NULL, path, 0);
@@ -651,23 +1284,61 @@ void process_lines(context_s *c, char *path)
       push(c, l->indent, t, tline, path, lnumber);
       free(tline);
     }
-    else if (strcmp(head, "describe") == 0)
+    else if (strcmp(head, "describe") == 0 || strcmp(head, "context") == 0)
     {
-      push(c, l->indent, 'd', l->text, path, lnumber);
+      push(c, l->indent, *head, l->text, path, lnumber);
+      if (is_concurrent(l->line)) { c->node->concurrent = 1; c->concurrent = 1; }
     }
-    else if (strcmp(head, "context") == 0)
+    else if (strcmp(head, "it") == 0 || strcmp(head, "they") == 0)
     {
-      push(c, l->indent, 'c', l->text, path, lnumber);
+      int hasbody = flu_strends(l->line, "{");
+      int lstart = lnumber;
+      rows_s *rows = parse_rows(in, &lnumber, l->line, l->text, &hasbody);
+      push(c, l->indent, 'i', rows ? rows->titles[0] : l->text, path, lstart);
+      if (hasbody) c->node->hasbody = 1;
+      if (rows) c->node->rows = rows; else parse_stress(c, l->line);
     }
-    else if (strcmp(head, "it") == 0 || strcmp(head, "they") == 0)
+    else if (is_block(l, "fuzz"))
+    {
+      push(c, l->indent, 'i', l->text, path, lnumber);
+      if (flu_strends(l->line, "{")) c->node->hasbody = 1;
+      parse_fuzz(c, l->line);
+    }
+    else if (is_block(l, "compare"))
+    {
+      push(c, l->indent, 'i', l->text, path, lnumber);
+      if (flu_strends(l->line, "{")) c->node->hasbody = 1;
+      parse_compare(c, l->line);
+    }
+    else if (is_block(l, "variant") && c->node->compare)
+    {
+      push_variant(c, l);
+    }
+    else if (is_block(l, "benchmark"))
     {
       push(c, l->indent, 'i', l->text, path, lnumber);
       if (flu_strends(l->line, "{")) c->node->hasbody = 1;
+      parse_benchmark(c, l->line);
+      if (c->node->sizes == NULL) c->node->sizes = strdup("1, 1, 2.0, '*'");
+    }
+    else if (
+      strcmp(head, "measure") == 0 && c->node->sizes &&
+      strchr(" \t{", l->line[l->indent + 7])
+    )
+    {
+      push_measure(c, l);
     }
     else if (strcmp(head, "ensure") == 0 || strcmp(head, "expect") == 0)
     {
       lnumber = push_ensure(c, in, l->indent, lnumber, l->line);
     }
+    else if (
+      (strcmp(head, "let") == 0 || strcmp(head, "let!") == 0) &&
+      strchr("dcg", c->node->type)
+    )
+    {
+      lnumber = push_let(c, in, l->indent, lnumber, l->line);
+    }
     else if (strcmp(head, "pending") == 0)
     {
       push_pending(c, l, path, lnumber);
@@ -694,11 +1365,8 @@ void print_eaches(FILE *out, char *indent, char t, node_s *n)
 
   if (t == 'b') print_eaches(out, indent, t, n->parent);
 
-  for (size_t i = 0; ; i++)
+  for (node_s *cn = n->eaches; cn != NULL; cn = cn->next_each)
   {
-    node_s *cn = n->children[i];
-
-    if (cn == NULL) break;
     if (cn->type != t) continue;
 
     flu_sbuffer_close(cn->lines);
@@ -712,6 +1380,90 @@ void print_eaches(FILE *out, char *indent, char t, node_s *n)
   if (t == 'a') print_eaches(out, indent, t, n->parent);
 }
 
+static size_t gather_lets(node_s *n, node_s **lets, size_t count)
+{
+  // from the root down, in declaration order, an inner let takes the
+  // place of an outer one with the same name
+
+  if (n == NULL) return count;
+
+  count = gather_lets(n->parent, lets, count);
+
+  for (node_s *cn = n->eaches; cn != NULL; cn = cn->next_each)
+  {
+    if (cn->type != 'l') continue;
+
+    size_t i = 0;
+    while (i < count && strcmp(lets[i]->text, cn->text) != 0) i++;
+
+    lets[i] = cn; if (i == count) count++;
+  }
+
+  return count;
+}
+
+static size_t count_lets(node_s *n)
+{
+  size_t count = 0;
+
+  for (; n != NULL; n = n->parent)
+  {
+    for (node_s *cn = n->eaches; cn != NULL; cn = cn->next_each)
+    {
+      if (cn->type == 'l') count++;
+    }
+  }
+
+  return count;
+}
+
+static void print_lets(FILE *out, char *indent, node_s *n, int define)
+{
+  // lazy, memoized, fixtures, each let is a #define around a local
+  // variable, computed on first use (stored via rdz_let_set()),
+  // cleaned up after the example
+
+  size_t count = count_lets(n); if (count < 1) return;
+
+  node_s **lets = calloc(count, sizeof(node_s *));
+  count = gather_lets(n, lets, 0);
+
+  if ( ! define) fputs("\n", out);
+
+  for (size_t i = 0; i < count; i++)
+  {
+    node_s *l = lets[define ? i : count - 1 - i];
+    char *na = l->text;
+
+    if (define)
+    {
+      fprintf(out, "%s  // let%s %s li%d\n", indent, l->eager ? "!" : "", na, l->lstart);
+      fprintf(
+        out, "%s  __typeof__(((void)0, %s)) __let_%s __attribute__((unused));\n",
+        indent, l->expr, na);
+      fprintf(
+        out, "%s  int __let_%s_set __attribute__((unused)) = 0;\n",
+        indent, na);
+      fprintf(
+        out, "%s#define %s (*(__let_%s_set ? &__let_%s : "
+        "(__typeof__(__let_%s) *)rdz_let_set(&__let_%s_set, &__let_%s, "
+        "(__typeof__(__let_%s)[1]){ (%s) }, sizeof(__let_%s))))\n",
+        indent, na, na, na, na, na, na, na, l->expr, na);
+      if (l->eager) fprintf(out, "%s  (void)%s;\n", indent, na);
+    }
+    else
+    {
+      if (l->cleanup)
+      {
+        fprintf(out, "%s  if (__let_%s_set) { %s }\n", indent, na, l->cleanup);
+      }
+      fprintf(out, "%s#undef %s\n", indent, na);
+    }
+  }
+
+  free(lets);
+}
+
 static char *neutralize(char *fname)
 {
   char *r = strdup(fname);
@@ -733,8 +1485,8 @@ void print_node(FILE *out, node_s *n)
 {
   char t = n->type;
 
-  if (t == 'b' || t == 'a') return;
-  if (t == 'i' && n->children[0] != NULL) return;
+  if (t == 'b' || t == 'a' || t == 'l') return;
+  if (t == 'i' && n->first != NULL) return;
 
   char *ind;
   if (n->indent > 0)
@@ -772,16 +1524,145 @@ void print_node(FILE *out, node_s *n)
     if (t == 'i') fprintf(out, "%s//\n", ind);
   }
 
+  if (t == 'i' && n->tmpl) // another row, calls the first row's function
+  {
+    char *nfname = neutralize(n->fname);
+    char *t_func = flu_sprintf(
+      "it_%d__%s__l%d", n->tmpl->nodenumber, nfname, n->tmpl->lstart);
+    free(nfname);
+
+    fprintf(
+      out, "%sdouble %s() { return %s__rows(%d, %s_rows + %d); }\n",
+      ind, i_func, t_func, n->nodenumber, t_func, n->row);
+
+    free(t_func); free(i_func); free(ind);
+
+    return;
+  }
+
   int offline = (t == 'B' || t == 'A' || t == 'y' || t == 'z');
   char *type = "none";
 
-  if (t == 'i')
+  if (n->lines != NULL) flu_sbuffer_close(n->lines);
+
+  int over =
+    n->lines != NULL && strstr(n->lines->string, ") goto _over;\n") != NULL;
+
+  if (t == 'i' && n->threads > 0)
+  {
+    // the body goes into its own function, run by each of the threads
+
+    fprintf(out, "%sstatic void %s_thread(rdz_stress_thread *__st)\n", ind, i_func);
+    fprintf(out, "%s{\n", ind);
+    fprintf(out, "%s  int rdz_thread = __st->thread; (void)rdz_thread;\n", ind);
+    fprintf(out, "%s  long rdz_iteration = 0;\n", ind);
+
+    print_lets(out, ind, n->parent, 1);
+    print_eaches(out, ind, 'b', n->parent);
+      // each thread gets its lets and its before/after each
+
+    fprintf(out, "%s  for (; rdz_iteration < __st->iterations; __st->done = ++rdz_iteration)\n", ind);
+    fprintf(out, "%s  {\n", ind);
+    if (n->lines != NULL) fputs(n->lines->string, out);
+    fprintf(out, "%s  }\n", ind);
+    if (over) fprintf(out, "%s_over:\n", ind);
+    fprintf(out, "%s  __st->done = rdz_iteration;\n", ind);
+
+    print_eaches(out, ind, 'a', n->parent);
+    print_lets(out, ind, n->parent, 0);
+
+    fprintf(out, "%s} // %s_thread()\n", ind, i_func);
+    fprintf(out, "\n");
+
+    fprintf(out, "%sdouble %s()\n", ind, i_func);
+    fprintf(out, "%s{\n", ind);
+    fprintf(out, "%s  double __start = rdz_now();", ind);
+    fprintf(out, " double __duration = 0.0;\n");
+
+    fprintf(out,
+      "%s  rdz_stress_run(%s_thread, %d, %ldL, %d);\n",
+      ind, i_func, n->threads, n->iterations, n->nodenumber);
+
+    over = 0;
+  }
+  else if (t == 'i' && n->rows)
+  {
+    // one function for all the rows, each row gets a tiny function calling
+    // it with the row and its own node number
+
+    rows_s *r = n->rows;
+
+    fprintf(out, "%stypedef struct %s_row {\n", ind, i_func);
+    for (size_t i = 0; i < r->ccount; i++)
+    {
+      fprintf(
+        out, "%s  __typeof__(((void)0, %s)) %s;\n", ind, r->firsts[i], r->names[i]);
+    }
+    fprintf(out, "%s} %s_row;\n", ind, i_func);
+    fprintf(out, "%sstatic const %s_row %s_rows[] = {\n", ind, i_func, i_func);
+    for (size_t i = 0; i < r->count; i++)
+    {
+      fprintf(out, "%s  %s, // li%d\n", ind, r->rows[i], r->lines[i]);
+    }
+    fprintf(out, "%s};\n", ind);
+    fprintf(out, "\n");
+
+    fprintf(
+      out, "%sstatic double %s__rows(int __rdz_it, const %s_row *row)\n",
+      ind, i_func, i_func);
+    fprintf(out, "%s{\n", ind);
+    fprintf(out, "%s  (void)__rdz_it; (void)row;\n", ind);
+    fprintf(out, "%s  double __start = rdz_now();", ind);
+    fprintf(out, " double __duration = 0.0;\n");
+
+    print_lets(out, ind, n->parent, 1);
+    print_eaches(out, ind, 'b', n->parent);
+  }
+  else if (t == 'i' && n->compare)
+  {
+    // the body takes the variant to run, rdz_compare_run() interleaves them
+
+    fprintf(out, "%sstatic double %s__compare(int __rdz_variant)\n", ind, i_func);
+    fprintf(out, "%s{\n", ind);
+    fprintf(out, "%s  double __start = rdz_now();", ind);
+    fprintf(out, " double __duration = 0.0;\n");
+
+    print_lets(out, ind, n->parent, 1);
+    print_eaches(out, ind, 'b', n->parent);
+  }
+  else if (t == 'i' && n->sizes)
+  {
+    // the body takes the size, rdz_benchmark_run() times it for each size
+
+    fprintf(out, "%sstatic double %s__bench(size_t n)\n", ind, i_func);
+    fprintf(out, "%s{\n", ind);
+    fprintf(out, "%s  (void)n;\n", ind);
+    fprintf(out, "%s  double __start = rdz_now();", ind);
+    fprintf(out, " double __duration = 0.0;\n");
+
+    print_lets(out, ind, n->parent, 1);
+    print_eaches(out, ind, 'b', n->parent);
+  }
+  else if (t == 'i' && n->fuzz)
+  {
+    // the body takes the input, rdz_fuzz_run() replays the corpus through it
+
+    fprintf(out, "%sstatic double %s__fuzz(%s)\n", ind, i_func, n->fuzz);
+    fprintf(out, "%s{\n", ind);
+    fprintf(out, "%s  double __start = rdz_now();", ind);
+    fprintf(out, " double __duration = 0.0;\n");
+
+    print_lets(out, ind, n->parent, 1);
+    print_eaches(out, ind, 'b', n->parent);
+  }
+  else if (t == 'i')
   {
     fprintf(out, "%sdouble %s()\n", ind, i_func);
     fprintf(out, "%s{\n", ind);
     fprintf(out, "%s  double __start = rdz_now();", ind);
     fprintf(out, " double __duration = 0.0;\n");
 
+    print_lets(out, ind, n->parent, 1);
     print_eaches(out, ind, 'b', n->parent);
   }
   else if (offline)
@@ -797,9 +1678,8 @@ void print_node(FILE *out, node_s *n)
     fprintf(out, "%s{\n", ind);
   }
 
-  if (n->lines != NULL)
+  if (n->lines != NULL && (t != 'i' || n->threads < 1))
   {
-    flu_sbuffer_close(n->lines);
     fputs(n->lines->string, out);
   }
 
@@ -807,18 +1687,69 @@ void print_node(FILE *out, node_s *n)
   {
     fprintf(out, "\n");
 
-    if (n->lines != NULL && strstr(n->lines->string, ") goto _over;\n"))
-    {
-      fprintf(out, "%s_over:\n", ind);
-    }
+    if (over) fprintf(out, "%s_over:\n", ind);
+
+    if (n->compare || n->sizes) fprintf(out, "%s  rdz_variant_stop();\n", ind);
 
     fprintf(out, "\n%s  __duration = rdz_duration(__start);", ind);
 
-    print_eaches(out, ind, 'a', n->parent);
+    if (n->threads < 1) // else done in the thread function
+    {
+      print_eaches(out, ind, 'a', n->parent);
+      print_lets(out, ind, n->parent, 0);
+    }
 
     fprintf(out, "\n");
     fprintf(out, "%s  return __duration;\n", ind);
-    fprintf(out, "%s} // %s()\n", ind, i_func);
+
+    if (n->rows)
+    {
+      fprintf(out, "%s} // %s__rows()\n", ind, i_func);
+      fprintf(out, "\n");
+      fprintf(
+        out, "%sdouble %s() { return %s__rows(%d, %s_rows + 0); }\n",
+        ind, i_func, i_func, n->nodenumber, i_func);
+    }
+    else if (n->compare)
+    {
+      int w = -1;
+      for (int i = 0; w < 0 && n->winner && i < n->vcount; i++)
+      {
+        if (strcmp(n->vnames[i], n->winner) == 0) w = i;
+      }
+      if (n->winner && w < 0) w = -2; // faster("x") names no variant
+
+      fprintf(out, "%s} // %s__compare()\n", ind, i_func);
+      fprintf(out, "\n");
+      fprintf(out, "%sstatic const char *%s_variants[] = {", ind, i_func);
+      for (int i = 0; i < n->vcount; i++) fprintf(out, " \"%s\",", n->vnames[i]);
+      fprintf(out, " NULL };\n");
+      fprintf(
+        out, "%sdouble %s() { return rdz_compare_run(%d, %s__compare, %s_variants, %d, %d); }\n",
+        ind, i_func, n->nodenumber, i_func, i_func, n->vcount, w);
+    }
+    else if (n->sizes)
+    {
+      fprintf(out, "%s} // %s__bench()\n", ind, i_func);
+      fprintf(out, "\n");
+      fprintf(
+        out, "%sdouble %s() { return rdz_benchmark_run(%d, %s__bench, %s, ",
+        ind, i_func, n->nodenumber, i_func, n->sizes);
+      if (n->complexity) fprintf(out, "\"%s\"); }\n", n->complexity);
+      else fprintf(out, "NULL); }\n");
+    }
+    else if (n->fuzz)
+    {
+      fprintf(out, "%s} // %s__fuzz()\n", ind, i_func);
+      fprintf(out, "\n");
+      fprintf(
+        out, "%sdouble %s() { return rdz_fuzz_run(%d, %s__fuzz); }\n",
+        ind, i_func, n->nodenumber, i_func);
+    }
+    else
+    {
+      fprintf(out, "%s} // %s()\n", ind, i_func);
+    }
   }
   else if (offline)
   {
@@ -829,14 +1760,24 @@ void print_node(FILE *out, node_s *n)
   free(i_func);
   free(ind);
 
-  for (size_t i = 0; ; i++)
+  for (node_s *cn = n->first; cn != NULL; cn = cn->next)
   {
-    node_s *cn = n->children[i];
-    if (cn == NULL) break;
     print_node(out, cn);
   }
 }
 
+void print_sites(FILE *out, context_s *c)
+{
+  if (c->sitecount < 1) return;
+
+  flu_sbuffer_close(c->sites);
+
+  fprintf(out, "\n");
+  fprintf(out, "static const rdz_site rdz_sites[] = {\n");
+  fputs(c->sites->string, out);
+  fprintf(out, "};\n");
+}
+
 void print_body(FILE *out, context_s *c)
 {
   node_s *n = c->node; while (n->parent != NULL) n = n->parent;
@@ -863,73 +1804,229 @@ void print_body(FILE *out, context_s *c)
   fclose(f);
 }
 
-void print_nodes(FILE *out, size_t depth, node_s *n)
+char *node_func(node_s *n)
 {
   char t = n->type;
 
-  flu_sbuffer *b = flu_sbuffer_malloc();
-  flu_sbprintf(b, "(int []){");
-  for (size_t i = 0; n->children[i] != NULL; i++)
+  if (t == 'i' && n->first != NULL) return strdup("NULL");
+
+  if (t == 'i')
+  {
+    char *nfname = neutralize(n->fname);
+    char *r = flu_sprintf("it_%d__%s__l%d", n->nodenumber, nfname, n->lstart);
+    free(nfname);
+
+    return r;
+  }
+
+  if (t == 'B') return flu_sprintf("before_all_%d", n->nodenumber);
+  if (t == 'A') return flu_sprintf("after_all_%d", n->nodenumber);
+  if (t == 'y') return flu_sprintf("before_each_offline_%d", n->nodenumber);
+  if (t == 'z') return flu_sprintf("after_each_offline_%d", n->nodenumber);
+
+  return strdup("NULL");
+}
+
+static size_t c_strlen(char *s)
+{
+  // length of the string literal content s, once its escapes are resolved
+
+  size_t l = 0;
+
+  for (char *c = s; *c != '\0'; ++c, ++l)
   {
-    flu_sbprintf(b, " %d,", n->children[i]->nodenumber);
+    if (*c != '\\' || c[1] == '\0') continue;
+
+    ++c;
+
+    if (*c == 'x')
+    {
+      while (isxdigit(c[1])) ++c;
+    }
+    else if (*c >= '0' && *c <= '7')
+    {
+      for (int i = 0; i < 2 && c[1] >= '0' && c[1] <= '7'; ++i) ++c;
+    }
   }
-  flu_sbprintf(b, " -1 }");
-  char *children = flu_sbuffer_to_string(b);
 
-  char *func;
-  if (t == 'i' && n->children[0] != NULL)
+  return l;
+}
+
+void index_nodes(node_s **index, int *depths, int depth, node_s *n)
+{
+  index[n->nodenumber] = n;
+  depths[n->nodenumber] = depth;
+
+  for (node_s *cn = n->first; cn != NULL; cn = cn->next)
   {
-    func = strdup("NULL");
+    index_nodes(index, depths, depth + 1, cn);
   }
-  else if (t == 'i')
+}
+
+void print_table(FILE *out, char *type, char *name, int *values, int count)
+{
+  fprintf(out, "static const %s rdz_t_%s[] = {", type, name);
+
+  for (int i = 0; i < count; i++)
   {
-    char *nfname = neutralize(n->fname);
-    func = flu_sprintf("it_%d__%s__l%d", n->nodenumber, nfname, n->lstart);
-    free(nfname);
+    if (i % 16 == 0) fputs("\n ", out);
+    if (*type == 'c') fprintf(out, " '%c',", values[i]);
+    else fprintf(out, " %d,", values[i]);
   }
-  else if (t == 'B')
+
+  fprintf(out, "\n};\n");
+}
+
+void print_nodes(FILE *out, context_s *c, node_s *root)
+{
+  int count = c->nodecount;
+
+  node_s **index = calloc(count, sizeof(node_s *));
+  int *depths = calloc(count, sizeof(int));
+
+  index_nodes(index, depths, 0, root);
+
+  int *values = calloc(count, sizeof(int));
+
+  // types, parents, depths, lines
+
+  for (int i = 0; i < count; i++) values[i] = index[i]->type;
+  print_table(out, "char", "types", values, count);
+
+  for (int i = 0; i < count; i++)
   {
-    func = flu_sprintf("before_all_%d", n->nodenumber);
+    node_s *p = index[i]->parent; values[i] = p ? p->nodenumber : -1;
   }
-  else if (t == 'A')
+  print_table(out, "int", "parents", values, count);
+
+  print_table(out, "int", "depths", depths, count);
+
+  for (int i = 0; i < count; i++) values[i] = index[i]->lstart;
+  print_table(out, "int", "lstarts", values, count);
+
+  for (int i = 0; i < count; i++) values[i] = index[i]->ltstart;
+  print_table(out, "int", "ltstarts", values, count);
+
+  for (int i = 0; i < count; i++) values[i] = index[i]->llength;
+  print_table(out, "int", "llengths", values, count);
+
+  // children
+
+  int ccount = 0;
+
+  for (int i = 0; i < count; i++)
   {
-    func = flu_sprintf("after_all_%d", n->nodenumber);
+    values[i] = ccount;
+    for (node_s *cn = index[i]->first; cn != NULL; cn = cn->next) ccount++;
   }
-  else if (t == 'y')
+  print_table(out, "int", "coffsets", values, count);
+
+  for (int i = 0; i < count; i++)
   {
-    func = flu_sprintf("before_each_offline_%d", n->nodenumber);
+    values[i] = 0;
+    for (node_s *cn = index[i]->first; cn != NULL; cn = cn->next) values[i]++;
   }
-  else if (t == 'z')
+  print_table(out, "int", "ccounts", values, count);
+
+  int *children = calloc(ccount + 1, sizeof(int));
+  for (int i = 0, k = 0; i < count; i++)
   {
-    func = flu_sprintf("after_each_offline_%d", n->nodenumber);
+    node_s *cn = index[i]->first;
+    for (; cn != NULL; cn = cn->next) children[k++] = cn->nodenumber;
   }
-  else
+  print_table(out, "int", "children", children, ccount + 1);
+  free(children);
+
+  // string pool, texts and fnames are offsets into it
+
+  int *fnames = calloc(count, sizeof(int));
+  int *deps = calloc(count, sizeof(int));
+  size_t offset = 1; // offset 0 is ""
+
+  fprintf(out, "static const char rdz_t_strings[] =\n");
+  fprintf(out, "  \"\\0\" // 0\n");
+
+  for (int i = 0; i < count; i++)
   {
-    func = strdup("NULL");
+    node_s *n = index[i];
+    char t = n->type;
+
+    values[i] = 0;
+
+    if (t == 'i' || t == 'd' || t == 'c' || t == 'p')
+    {
+      fprintf(out, "  \"%s\\0\" // %zu\n", n->text, offset);
+      values[i] = offset;
+      offset += c_strlen(n->text) + 1;
+    }
+
+    fnames[i] = 0;
+    deps[i] = 0;
+
+    if (n->fname == NULL) continue;
+
+    for (int j = i - 1; j >= 0; j--)
+    {
+      if (index[j]->fname == n->fname)
+      {
+        fnames[i] = fnames[j]; deps[i] = deps[j]; break;
+      }
+    }
+    if (fnames[i] > 0) continue;
+
+    fprintf(out, "  \"%s\\0\" // %zu\n", n->fname, offset);
+    fnames[i] = offset;
+    offset += c_strlen(n->fname) + 1;
+
+    char *d = c->sdeps ? flu_list_get(c->sdeps, "%s", n->fname) : NULL;
+    if (d == NULL) continue;
+
+    fprintf(out, "  \"%s\\0\" // %zu\n", d, offset);
+    deps[i] = offset;
+    offset += c_strlen(d) + 1;
   }
+  fprintf(out, "  ;\n");
 
-  char *tx = "NULL";
-  if (t == 'i' || t == 'd' || t == 'c' || t == 'p') tx = n->text;
+  print_table(out, "int", "texts", values, count);
+  print_table(out, "int", "fnames", fnames, count);
+  print_table(out, "int", "deps", deps, count);
 
-  fprintf(
-    out,
-    "    &(rdz_node)"
-    "{ 0, %d, %d, %zu, %s, '%c', \"%s\", %d, %d, %d, \"%s\", %s },\n",
-    n->nodenumber,
-    n->parent != NULL ? n->parent->nodenumber : -1,
-    depth,
-    children,
-    t,
-    n->fname,
-    n->lstart, n->ltstart, n->llength, tx, func);
+  for (int i = 0; i < count; i++)
+  {
+    values[i] =
+      index[i]->concurrent |
+      (index[i]->threads > 0 ? 2 : 0) |
+      (index[i]->fuzz ? 4 : 0);
+  }
+  print_table(out, "int", "flags", values, count);
 
-  free(children);
-  free(func);
+  // functions
 
-  for (size_t i = 0; n->children[i] != NULL; i++)
+  fprintf(out, "static rdz_func *const rdz_t_funcs[] = {\n");
+  for (int i = 0; i < count; i++)
   {
-    print_nodes(out, depth + 1, n->children[i]);
+    char *func = node_func(index[i]);
+    fprintf(out, "  %s, // %d\n", func, i);
+    free(func);
   }
+  fprintf(out, "};\n");
+
+  fprintf(out, "\n");
+  fprintf(out, "static const rdz_tree rdz_spec_tree = {\n");
+  fprintf(out, "  %d,\n", count);
+  fprintf(out, "  rdz_t_types, rdz_t_parents, rdz_t_depths,\n");
+  fprintf(out, "  rdz_t_lstarts, rdz_t_ltstarts, rdz_t_llengths,\n");
+  fprintf(out, "  rdz_t_coffsets, rdz_t_ccounts, rdz_t_children,\n");
+  fprintf(out, "  rdz_t_texts, rdz_t_fnames, rdz_t_deps, rdz_t_flags,\n");
+  fprintf(out, "  rdz_t_strings,\n");
+  fprintf(out, "  rdz_t_funcs\n");
+  fprintf(out, "};\n");
+
+  free(fnames);
+  free(deps);
+  free(values);
+  free(depths);
+  free(index);
 }
 
 void print_footer(FILE *out, context_s *c)
@@ -941,43 +2038,86 @@ void print_footer(FILE *out, context_s *c)
 
   node_s *n = c->node; while (n->parent != NULL) n = n->parent;
 
-  fprintf(out, "int main(int argc, char *argv[])\n");
+  print_nodes(out, c, n);
+  fprintf(out, "\n");
+
+  fprintf(out, "int rdz_main()\n");
   fprintf(out, "{\n");
 
   fprintf(out, "  rdz_extract_arguments();\n");
   fprintf(out, "\n");
 
-  fprintf(out, "  rdz_nodes = (rdz_node *[]){\n");
-  print_nodes(out, 0, n);
-  fprintf(out, "    NULL };\n");
+  fprintf(out, "  rdz_t = &rdz_spec_tree;\n");
+  fprintf(out, "  rdz_doruns = calloc(%d, sizeof(int));\n", c->nodecount);
   fprintf(out, "\n");
 
   int count = c->encount + c->itcount;
   //
-  fprintf(out, "  rdz_results = calloc(%d, sizeof(rdz_result *));\n", count);
+  fprintf(out, "  rdz_results_size = %d;\n", count);
+  fprintf(out, "  rdz_results = calloc(rdz_results_size, sizeof(rdz_result));\n");
   fprintf(out, "\n");
 
   fprintf(out, "  rdz_determine_dorun();\n");
   fprintf(out, "\n");
   fprintf(out, "  double start = rdz_now();\n");
-  fprintf(out, "  rdz_dorun(rdz_nodes[0]);\n");
+  fprintf(out, "  rdz_run();\n");
   fprintf(out, "  double duration = rdz_duration(start);\n");
 
   fprintf(out, "\n");
   fprintf(out, "  rdz_summary(%d, duration);\n", c->itcount);
+  fprintf(out, "  rdz_coverage_map();\n");
 
   fprintf(out, "\n");
-  fprintf(out, "  for (size_t i = 0; i < rdz_count; i++) rdz_result_free(rdz_results[i]);\n");
+  fprintf(out, "  for (size_t i = 0; i < rdz_count; i++) rdz_result_clear(rdz_results + i);\n");
   fprintf(out, "  free(rdz_results);\n");
+  fprintf(out, "  free(rdz_doruns);\n");
 
   fprintf(out, "\n");
   fprintf(out, "  free(rdz_lines);\n");
+  fprintf(out, "  for (size_t i = 0; rdz_files && rdz_files[i]; i++) free(rdz_files[i]);\n");
+  fprintf(out, "  free(rdz_files);\n");
+
+  fprintf(out, "\n");
+  fprintf(out, "  return rdz_fail_count;\n");
+  fprintf(out, "}\n");
+  fprintf(out, "\n");
+
+  if (c->fuzz) // libFuzzer (or AFL++, honggfuzz, ...) brings its own main()
+  {
+    fprintf(out, "int LLVMFuzzerInitialize(int *argc, char ***argv)\n");
+    fprintf(out, "{\n");
+    fprintf(out, "  (void)argc; (void)argv;\n");
+    fprintf(out, "\n");
+    fprintf(out, "  rdz_extract_arguments();\n");
+    fprintf(out, "\n");
+    fprintf(out, "  rdz_t = &rdz_spec_tree;\n");
+    fprintf(out, "  rdz_doruns = calloc(%d, sizeof(int));\n", c->nodecount);
+    fprintf(out, "  rdz_results_size = %d;\n", count);
+    fprintf(out, "  rdz_results = calloc(rdz_results_size, sizeof(rdz_result));\n");
+    fprintf(out, "\n");
+    fprintf(out, "  rdz_determine_dorun();\n");
+    fprintf(out, "  rdz_fuzz_init();\n");
+    fprintf(out, "\n");
+    fprintf(out, "  return 0;\n");
+    fprintf(out, "}\n");
+    fprintf(out, "\n");
+    fprintf(out, "int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)\n");
+    fprintf(out, "{\n");
+    fprintf(out, "  return rdz_fuzz_one(data, size);\n");
+    fprintf(out, "}\n");
+    fprintf(out, "\n");
+
+    return;
+  }
 
+  fprintf(out, "int main(int argc, char *argv[])\n");
+  fprintf(out, "{\n");
+  fprintf(out, "  rdz_main();\n");
   fprintf(out, "}\n");
   fprintf(out, "\n");
 }
 
-void add_spec_path(flu_list *l, char *path)
+void add_spec_path(flu_list *l, flu_list *dirs, char *path)
 {
   if (flu_strends(path, ".")) return;
 
@@ -990,19 +2130,21 @@ void add_spec_path(flu_list *l, char *path)
 
   if (dir == NULL) return;
 
+  flu_list_add(dirs, strdup(path));
+
   struct dirent *ep;
   while ((ep = readdir(dir)) != NULL)
   {
     char *fn = flu_sprintf(
       path[strlen(path) - 1] == '/' ? "%s%s" : "%s/%s", path, ep->d_name);
 
-    add_spec_path(l, fn);
+    add_spec_path(l, dirs, fn);
   }
 
   closedir(dir);
 }
 
-flu_list *list_spec_files(int argc, char *argv[])
+flu_list *list_spec_files(int argc, char *argv[], flu_list *dirs)
 {
   flu_list *l = flu_list_malloc();
 
@@ -1017,12 +2159,15 @@ flu_list *list_spec_files(int argc, char *argv[])
     glob_t gl;
     glob(argv[i], GLOB_NOSORT, NULL, &gl);
 
-    for (size_t j = 0; j < gl.gl_pathc; j++) add_spec_path(l, gl.gl_pathv[j]);
+    for (size_t j = 0; j < gl.gl_pathc; j++)
+    {
+      add_spec_path(l, dirs, gl.gl_pathv[j]);
+    }
 
     globfree(&gl);
   }
 
-  if (no_args) add_spec_path(l, ".");
+  if (no_args) add_spec_path(l, dirs, ".");
 
   flu_list_isort(l, (int (*)(const void *, const void *))strcmp);
 
@@ -1030,14 +2175,245 @@ flu_list *list_spec_files(int argc, char *argv[])
 }
 
 
-//
-// main
-
-char *record_call(int argc, char **argv)
+int deps_are_fresh(char *entry)
 {
-  flu_sbuffer *b = flu_sbuffer_malloc();
+  // entry is "time file0 file1 ...", it's fresh if none of the files
+  // was modified since (or at the same second as) the time
 
-  for (int i = 0; i < argc; ++i)
+  char *s = entry;
+  long long t = strtoll(s, &s, 10);
+
+  while (1)
+  {
+    while (*s == ' ') ++s;
+    if (*s == '\0') break;
+
+    char *e = strchr(s, ' ');
+    char *path = e ? strndup(s, e - s) : strdup(s);
+
+    struct stat st;
+    int r = stat(path, &st);
+    free(path);
+
+    if (r != 0 || (long long)st.st_mtime >= t) return 0;
+
+    if (e == NULL) break;
+    s = e;
+  }
+
+  return 1;
+}
+
+flu_dict *spec_deps(context_s *c, flu_list *fnames)
+{
+  // maps each spec file to "spec file + what it includes" (cc -MM),
+  // the map is cached in a .deps file next to the out file, only the
+  // spec files that (or whose includes) changed are passed to cc again
+
+  char *fname = strdup(c->out_fname);
+  if (flu_strends(fname, ".c")) fname[strlen(fname) - 2] = '\0';
+
+  char *cfname = flu_sprintf("%s.deps", fname);
+
+  flu_dict *cache = flu_readdict(cfname);
+  flu_dict *r = flu_list_malloc();
+  flu_sbuffer *b = flu_sbuffer_malloc();
+
+  long long now = (long long)time(NULL);
+
+  char *cc = getenv("CC");
+  flu_sbprintf(b, "%s -MM -x c", cc ? cc : "cc");
+  for (flu_node *n = c->includes->first; n != NULL; n = n->next)
+  {
+    flu_sbprintf(b, " %s", (char *)n->item);
+  }
+
+  size_t stale = 0;
+
+  for (flu_node *n = fnames->first; n != NULL; n = n->next)
+  {
+    char *e = cache ? flu_list_get(cache, "%s", n->item) : NULL;
+
+    if (e && deps_are_fresh(e))
+    {
+      flu_list_set(r, "%s", n->item, strdup(e)); continue;
+    }
+
+    flu_sbprintf(b, " %s", (char *)n->item); stale++;
+  }
+
+  char *cmd = flu_sbuffer_to_string(b);
+  char *out = stale > 0 ? flu_plines("%s", cmd) : NULL;
+
+  // "x_spec.o: ../spec/x_spec.c ../src/x.h \\\n ../src/y.h\n"
+
+  for (char *s = out; s && (s = strstr(s, "\\\n")); ) memset(s, ' ', 2);
+
+  for (char *s = out; s && *s; )
+  {
+    char *eol = strchr(s, '\n'); if (eol == NULL) eol = s + strlen(s);
+    char *col = strchr(s, ':');
+
+    if (col && col < eol)
+    {
+      flu_sbuffer *e = flu_sbuffer_malloc();
+      flu_sbprintf(e, "%lld", now);
+
+      char *key = NULL;
+
+      for (char *t = col + 1; t < eol; )
+      {
+        while (t < eol && *t == ' ') ++t;
+        size_t l = strcspn(t, " \n");
+        if (l == 0) break;
+
+        flu_sbputc(e, ' '); flu_sbputs_n(e, t, l);
+        if (key == NULL) key = strndup(t, l);
+
+        t += l;
+      }
+
+      char *v = flu_sbuffer_to_string(e);
+
+      if (key) flu_list_set(r, "%s", key, v); else free(v);
+      free(key);
+    }
+
+    s = *eol ? eol + 1 : eol;
+  }
+
+  // rewrite the cache
+
+  FILE *f = fopen(cfname, "wb");
+
+  if (f == NULL) flu_die(1, "couldn't open %s file for writing", cfname);
+
+  for (flu_node *n = fnames->first; n != NULL; n = n->next)
+  {
+    char *e = flu_list_get(r, "%s", n->item);
+    if (e) fprintf(f, "%s: %s\n", (char *)n->item, e);
+  }
+
+  fclose(f);
+
+  if (stale > 0) printf(". wrote %s (%zu/%zu)\n", cfname, stale, fnames->size);
+
+  // the tree only needs the file list, the time goes
+
+  for (flu_node *n = r->first; n != NULL; n = n->next)
+  {
+    char *e = n->item;
+    char *s = strchr(e, ' ');
+    if (s) memmove(e, s + 1, strlen(s + 1) + 1); else *e = '\0';
+  }
+
+  free(out);
+  free(cmd);
+  if (cache) flu_list_free_all(cache);
+  free(cfname);
+  free(fname);
+
+  return r;
+}
+
+void print_deps(context_s *c, flu_list *fnames, flu_list *dirs)
+{
+  // writes a make dependency file next to the out file, it lists the
+  // spec files (and the dirs they were found in, for new spec files),
+  // and touches a stamp file, s.stamp for s.c, the out file keeps its
+  // mtime when unchanged, the stamp tells make that rodzo did run
+
+  char *fname = strdup(c->out_fname);
+  if (flu_strends(fname, ".c")) fname[strlen(fname) - 2] = '\0';
+
+  char *dfname = flu_sprintf("%s.d", fname);
+
+  FILE *f = fopen(dfname, "wb");
+
+  if (f == NULL) flu_die(1, "couldn't open %s file for writing", dfname);
+
+  fprintf(f, "%s %s.stamp:", c->out_fname, fname);
+  for (flu_node *n = dirs->first; n != NULL; n = n->next)
+  {
+    fprintf(f, " \\\n  %s", (char *)n->item);
+  }
+  for (flu_node *n = fnames->first; n != NULL; n = n->next)
+  {
+    fprintf(f, " \\\n  %s", (char *)n->item);
+  }
+  fprintf(f, "\n");
+
+  for (flu_node *n = fnames->first; n != NULL; n = n->next)
+  {
+    fprintf(f, "\n%s:\n", (char *)n->item); // in case it gets removed
+  }
+
+  if (c->sdeps) // -MH, the spec executable and what the specs include
+  {
+    flu_list *hs = flu_list_malloc();
+
+    for (flu_node *n = fnames->first; n != NULL; n = n->next)
+    {
+      char *d = flu_list_get(c->sdeps, "%s", n->item);
+      if (d == NULL) continue;
+
+      flu_list *l = flu_split(d, " ");
+
+      // the spec file (first) is already a dependency of the out file,
+      // don't let it trigger a recompilation when the out file didn't change
+
+      for (flu_node *m = l->first ? l->first->next : NULL; m; m = m->next)
+      {
+        int seen = 0;
+        for (flu_node *h = hs->first; h != NULL; h = h->next)
+        {
+          if (strcmp(h->item, m->item) == 0) { seen = 1; break; }
+        }
+        if ( ! seen) flu_list_add(hs, strdup(m->item));
+      }
+
+      flu_list_free_all(l);
+    }
+
+    fprintf(f, "\n%s:", fname);
+    for (flu_node *h = hs->first; h != NULL; h = h->next)
+    {
+      fprintf(f, " \\\n  %s", (char *)h->item);
+    }
+    fprintf(f, "\n");
+
+    for (flu_node *h = hs->first; h != NULL; h = h->next)
+    {
+      fprintf(f, "\n%s:\n", (char *)h->item);
+    }
+
+    flu_list_free_all(hs);
+  }
+
+  fclose(f);
+
+  printf(". wrote %s\n", dfname);
+
+  char *sfname = flu_sprintf("%s.stamp", fname);
+
+  f = fopen(sfname, "wb"); // truncating is touching
+  if (f == NULL) flu_die(1, "couldn't open %s file for writing", sfname);
+  fclose(f);
+
+  free(sfname);
+  free(dfname);
+  free(fname);
+}
+
+
+//
+// main
+
+char *record_call(int argc, char **argv)
+{
+  flu_sbuffer *b = flu_sbuffer_malloc();
+
+  for (int i = 0; i < argc; ++i)
   {
     flu_sbputs(b, argv[i]); if (i < argc - 1) flu_sbputc(b, ' ');
   }
@@ -1056,15 +2432,40 @@ char *grab_git_info(char *path)
   return r;
 }
 
+int same_content(char *path0, char *path1)
+{
+  struct stat s0; if (stat(path0, &s0) != 0) return 0;
+  struct stat s1; if (stat(path1, &s1) != 0) return 0;
+
+  if (s0.st_size != s1.st_size) return 0;
+
+  char *c0 = flu_readall("%s", path0);
+  char *c1 = flu_readall("%s", path1);
+
+  int r = (c0 != NULL && c1 != NULL && strcmp(c0, c1) == 0);
+
+  free(c0);
+  free(c1);
+
+  return r;
+}
+
 int print_usage(char *arg0)
 {
   fprintf(stderr, "" "\n");
   fprintf(stderr, "# rodzo" "\n");
   fprintf(stderr, "" "\n");
-  fprintf(stderr, "%s [-o outfile] [-d] [dirs or spec files]" "\n", arg0);
+  fprintf(stderr, "%s [-o outfile] [-d] [-r] [-MD|-MH [-Idir]] [--watch|--list] [--fuzz] [dirs or spec files]" "\n", arg0);
   fprintf(stderr, "" "\n");
   fprintf(stderr, "  turns a spec fileset into a compilable spec.c file" "\n");
   fprintf(stderr, "" "\n");
+  fprintf(stderr, "  -r  reproducible output, no git info, no call line" "\n");
+  fprintf(stderr, "  -MD writes a make dependency file (spec files)" "\n");
+  fprintf(stderr, "  -MH same as -MD, plus the headers included by the spec files ($CC -MM)" "\n");
+  fprintf(stderr, "  --watch  regenerate, make and run the specs when a .c or .h changes" "\n");
+  fprintf(stderr, "  --list   list the describes, contexts and its as JSON lines" "\n");
+  fprintf(stderr, "  --fuzz   emit LLVMFuzzerTestOneInput() (for the fuzz blocks) instead of main()" "\n");
+  fprintf(stderr, "" "\n");
 
   return 1;
 }
@@ -1072,38 +2473,40 @@ int print_usage(char *arg0)
 void print_header(FILE *out);
   // forward declaration ;-)
 
-int main(int argc, char *argv[])
+context_s *parse_arguments(int argc, char *argv[])
 {
-  regcomp(
-    &ensure_operator_rex,
-    " ("
-      "((c|d|e|f|o|i|li|lli|u|zu|zd|lu|llu)(!?={1,3}))" "|"
-      "(!?[=!~\\^\\$>]={2,3}i?[fF]?)"
-    ") ",
-    REG_EXTENDED);
-
-  // deal with arguments
-
   context_s *c = malloc_context();
 
-  char *ginfo = grab_git_info(argv[0]);
-  char *call = record_call(argc, argv);
-
   int badarg = 0;
   for (int i = 1; i < argc; ++i)
   {
     if (*argv[i] != '-') continue;
     if (argv[i][1] == 'o') c->out_fname = strdup(argv[i + 1]);
     else if (argv[i][1] == 'd') c->debug = 1;
+    else if (argv[i][1] == 'r') c->reproducible = 1;
+    else if (strcmp(argv[i], "-MD") == 0) c->deps = 1;
+    else if (strcmp(argv[i], "-MH") == 0) c->deps = 2;
+    else if (argv[i][1] == 'I') flu_list_add(c->includes, argv[i]);
+    else if (strcmp(argv[i], "--watch") == 0) c->watch = 1;
+    else if (strcmp(argv[i], "--list") == 0) c->list = 1;
+    else if (strcmp(argv[i], "--fuzz") == 0) c->fuzz = 1;
     else badarg = 1;
   }
-  if (badarg) return print_usage(argv[0]);
+  if (badarg) { free_context(c); return NULL; }
 
   if (c->out_fname == NULL) c->out_fname = strdup("spec.c");
 
+  return c;
+}
+
+void generate(context_s *c, int argc, char *argv[], flu_list *dirs)
+{
+  char *ginfo = c->reproducible ? NULL : grab_git_info(argv[0]);
+  char *call = c->reproducible ? NULL : record_call(argc, argv);
+
   // reads specs, grow tree
 
-  flu_list *fnames = list_spec_files(argc, argv);
+  flu_list *fnames = list_spec_files(argc, argv, dirs);
 
   for (flu_node *n = fnames->first; n != NULL; n = n->next)
   {
@@ -1111,22 +2514,37 @@ int main(int argc, char *argv[])
     printf(". processing %s\n", fname);
     process_lines(c, fname);
   }
-  flu_list_free_all(fnames);
 
-  // write
+  if (c->deps > 1) c->sdeps = spec_deps(c, fnames);
+
+  // write (to a temp file first)
+
+  char *tmp_fname = flu_sprintf("%s.tmp", c->out_fname);
 
-  FILE *out = fopen(c->out_fname, "wb");
+  FILE *out = fopen(tmp_fname, "wb");
 
   if (out == NULL)
   {
-    flu_die(1, "couldn't open %s file for writing", c->out_fname);
+    flu_die(1, "couldn't open %s file for writing", tmp_fname);
   }
 
   fprintf(out, "\n/* rodzo %s */", RODZO_VERSION);
-  if (ginfo) fprintf(out, "\n/*\n%s*/", ginfo); free(ginfo);
-  fprintf(out, "\n\n// %s", call); free(call);
+  if (ginfo) fprintf(out, "\n/*\n%s*/", ginfo);
+  if (call) fprintf(out, "\n\n// %s", call);
+  free(ginfo);
+  free(call);
+
+  if (c->concurrent) fprintf(out, "\n\n#define RDZ_CONCURRENT 1 // needs -pthread");
+
+  // the runtime sections for fuzz, compare and benchmark blocks are
+  // only compiled in when the specs use them
+
+  if (c->fuzzes || c->fuzz) fprintf(out, "\n#define RDZ_WITH_FUZZ 1");
+  if (c->compares) fprintf(out, "\n#define RDZ_WITH_COMPARE 1");
+  if (c->benchmarks) fprintf(out, "\n#define RDZ_WITH_BENCH 1");
 
   print_header(out);
+  print_sites(out, c);
   print_body(out, c);
   print_footer(out, c);
 
@@ -1134,12 +2552,439 @@ int main(int argc, char *argv[])
 
   fclose(out);
 
-  printf(". wrote %s\n", c->out_fname);
+  // only replace the out file when its content changed,
+  // so that make (or ccache) doesn't rebuild for nothing
+
+  if (same_content(tmp_fname, c->out_fname))
+  {
+    remove(tmp_fname);
+    printf(". %s unchanged\n", c->out_fname);
+  }
+  else if (rename(tmp_fname, c->out_fname) == 0)
+  {
+    printf(". wrote %s\n", c->out_fname);
+  }
+  else
+  {
+    flu_die(1, "couldn't rename %s to %s", tmp_fname, c->out_fname);
+  }
+
+  free(tmp_fname);
+
+  if (c->deps) print_deps(c, fnames, dirs);
+
+  flu_list_free_all(fnames);
+}
+
+
+//
+// list
+
+static char *c_unescape(char *s)
+{
+  // the content of a string literal, with its escapes resolved
+
+  char *r = calloc(strlen(s) + 1, sizeof(char)); char *rr = r;
+
+  for (char *c = s; *c != '\0'; ++c)
+  {
+    if (*c != '\\' || c[1] == '\0') { *(rr++) = *c; continue; }
+
+    ++c;
+
+    if (*c == 'x')
+    {
+      *(rr++) = (char)strtol(c + 1, &c, 16); --c;
+    }
+    else if (*c >= '0' && *c <= '7')
+    {
+      int v = *c - '0';
+      for (int i = 0; i < 2 && c[1] >= '0' && c[1] <= '7'; ++i) v = v * 8 + *(++c) - '0';
+      *(rr++) = (char)v;
+    }
+    else
+    {
+      char *e = strchr("n\nt\tr\ra\ab\bf\fv\v", *c);
+      *(rr++) = e ? e[1] : *c;
+    }
+  }
+
+  return r;
+}
+
+static void json_string(char *s)
+{
+  putchar('"');
+
+  for (unsigned char *c = (unsigned char *)s; *c; c++)
+  {
+    if (*c == '"' || *c == '\\') printf("\\%c", *c);
+    else if (*c < 0x20) printf("\\u%04x", *c);
+    else putchar(*c);
+  }
+
+  putchar('"');
+}
+
+static int is_titled(node_s *n)
+{
+  return n->type == 'd' || n->type == 'c' || n->type == 'i';
+}
+
+static int title_ordinal(node_s *n)
+{
+  // 1 for the first sibling with that title, 2 for the next one, ...
+
+  int o = 1;
+
+  for (node_s *m = n->parent ? n->parent->first : NULL; m && m != n; m = m->next)
+  {
+    if (is_titled(m) && strcmp(m->text, n->text) == 0) o++;
+  }
+
+  return o;
+}
+
+static unsigned long long stable_id(node_s *n, char **texts, int *ordinals, int tl)
+{
+  // FNV-1a over the file name and the titles, from the top down, the
+  // runtime (RDZ_LIST=1) computes the same
+
+  unsigned long long h = rdz_fnv(RDZ_FNV_START, n->fname);
+
+  for (int i = 0; i < tl; i++) h = rdz_fnv_title(h, texts[i], ordinals[i]);
+
+  return h;
+}
+
+typedef struct {
+  unsigned long long id;
+  double duration;
+} duration_s;
+
+static int duration_cmp(const void *a, const void *b)
+{
+  unsigned long long ia = ((const duration_s *)a)->id;
+  unsigned long long ib = ((const duration_s *)b)->id;
+
+  return ia < ib ? -1 : ia > ib;
+}
+
+static duration_s *load_durations(size_t *count)
+{
+  // RDZ_DURATIONS, as written by the spec runs, "id duration" lines,
+  // sorted by id
+
+  *count = 0;
+
+  char *path = getenv("RDZ_DURATIONS");
+  FILE *f = path ? fopen(path, "r") : NULL;
+
+  if (f == NULL) return NULL;
+
+  size_t size = 1024;
+  duration_s *ds = calloc(size, sizeof(duration_s));
+
+  unsigned long long id; double du;
+
+  while (fscanf(f, "%llx %lf", &id, &du) == 2)
+  {
+    if (*count >= size) { size *= 2; ds = realloc(ds, size * sizeof(duration_s)); }
+    ds[*count].id = id; ds[(*count)++].duration = du;
+  }
+  fclose(f);
+
+  qsort(ds, *count, sizeof(duration_s), duration_cmp);
+
+  return ds;
+}
+
+static void list_node(node_s *n, duration_s *ds, size_t dcount)
+{
+  if (n->type == 'd' || n->type == 'c' || n->type == 'i')
+  {
+    char *texts[128]; int ordinals[128]; int tl = 0;
+
+    for (node_s *m = n; m != NULL && tl < 128; m = m->parent)
+    {
+      if (is_titled(m)) tl++;
+    }
+    int i = tl;
+    for (node_s *m = n; m != NULL && i > 0; m = m->parent)
+    {
+      if ( ! is_titled(m)) continue;
+      texts[--i] = c_unescape(m->text); ordinals[i] = title_ordinal(m);
+    }
+
+    unsigned long long id = stable_id(n, texts, ordinals, tl);
+
+    printf(
+      "{\"id\":\"%016llx\",\"n\":%d,\"type\":\"%s\",\"file\":",
+      id, n->nodenumber, type_to_string(n->type));
+    json_string(n->fname);
+    printf(
+      ",\"lstart\":%d,\"ltstart\":%d,\"llength\":%d,\"titles\":[",
+      n->lstart, n->ltstart, n->llength);
+    for (i = 0; i < tl; i++)
+    {
+      if (i > 0) putchar(',');
+      json_string(texts[i]); free(texts[i]);
+    }
+
+    printf("],\"tags\":[");
+    int tc = 0;
+    if (n->type == 'i' && n->first) printf("%s\"pending\"", tc++ ? "," : "");
+    if (n->concurrent) printf("%s\"concurrent\"", tc++ ? "," : "");
+    if (n->threads > 0) printf("%s\"stress\"", tc++ ? "," : "");
+
+    duration_s k = { id, 0.0 };
+    duration_s *d = ds && n->type == 'i' ?
+      bsearch(&k, ds, dcount, sizeof(k), duration_cmp) : NULL;
+
+    if (d) printf("],\"duration\":%f}\n", d->duration);
+    else printf("],\"duration\":null}\n");
+  }
+
+  for (node_s *cn = n->first; cn != NULL; cn = cn->next) list_node(cn, ds, dcount);
+}
+
+void list(context_s *c, int argc, char *argv[])
+{
+  // one JSON line per describe, context and it, no spec file gets written
+
+  flu_list *dirs = flu_list_malloc();
+  flu_list *fnames = list_spec_files(argc, argv, dirs);
+
+  for (flu_node *n = fnames->first; n != NULL; n = n->next)
+  {
+    process_lines(c, (char *)n->item);
+  }
+
+  size_t dcount = 0; duration_s *ds = load_durations(&dcount);
+
+  node_s *root = c->node; while (root->parent != NULL) root = root->parent;
+
+  list_node(root, ds, dcount);
+
+  free(ds);
+  flu_list_free_all(fnames);
+  flu_list_free_all(dirs);
+}
+
+
+//
+// watch
+
+#ifdef __linux__
+
+typedef struct {
+  int fd;
+  char **paths; // indexed by watch descriptor
+  size_t size;
+  char *out; // the generated file, changes to it are ignored
+} watch_s;
+
+static void watch_path(watch_s *w, char *path)
+{
+  int wd = inotify_add_watch(
+    w->fd, path, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE);
+
+  if (wd < 0) return;
+
+  if ((size_t)wd >= w->size)
+  {
+    size_t size = wd + 16;
+    w->paths = realloc(w->paths, size * sizeof(char *));
+    for (size_t i = w->size; i < size; i++) w->paths[i] = NULL;
+    w->size = size;
+  }
+
+  if (w->paths[wd] == NULL) w->paths[wd] = strdup(path);
+}
+
+static int wait_for_changes(watch_s *w, flu_list *changed)
+{
+  // blocks until a .c or .h file changes, then waits for things to settle
+  // (an editor saving triggers a few events), the changed files are
+  // listed in changed, returns 0 if only spec files changed, 1 if sources
+  // changed as well and 2 if a file got removed (run all)
+
+  char buf[4096]
+    __attribute__ ((aligned(__alignof__(struct inotify_event))));
+
+  int r = 0;
+  int timeout = -1;
+
+  while (1)
+  {
+    struct pollfd p = { w->fd, POLLIN, 0 };
+
+    int pr = poll(&p, 1, timeout);
+
+    if (pr == 0) break; // quiet, let's go
+    if (pr < 0) continue;
+
+    ssize_t l = read(w->fd, buf, sizeof(buf));
+
+    for (char *b = buf; l > 0 && b < buf + l; )
+    {
+      struct inotify_event *e = (struct inotify_event *)b;
+      b += sizeof(struct inotify_event) + e->len;
+
+      if (e->len < 1) continue;
+      if ( ! flu_strends(e->name, ".c") && ! flu_strends(e->name, ".h")) continue;
+
+      char *d = w->paths[e->wd];
+      char *path = flu_sprintf(flu_strends(d, "/") ? "%s%s" : "%s/%s", d, e->name);
+
+      struct stat ps, os;
+      if (
+        stat(path, &ps) == 0 && stat(w->out, &os) == 0 &&
+        ps.st_ino == os.st_ino && ps.st_dev == os.st_dev
+      ) { free(path); continue; } // our own output
+
+      timeout = 100; // ms
+
+      if (access(path, F_OK) != 0) r = 2;
+      else if ( ! flu_strends(path, "_spec.c") && r < 1) r = 1;
+
+      int seen = 0;
+      for (flu_node *n = changed->first; n != NULL; n = n->next)
+      {
+        if (strcmp(n->item, path) == 0) { seen = 1; break; }
+      }
+      if (seen) free(path); else flu_list_add(changed, path);
+    }
+  }
+
+  return r;
+}
+
+int watch(context_s *c, int argc, char *argv[])
+{
+  watch_s w = { inotify_init(), NULL, 0, c->out_fname };
+
+  if (w.fd < 0) flu_die(1, "couldn't init inotify");
+
+  char *bin = strdup(c->out_fname);
+  if (flu_strends(bin, ".c")) bin[strlen(bin) - 2] = '\0';
+
+  char *build = getenv("RODZO_BUILD");
+  char *make = build ? strdup(build) : flu_sprintf("make %s", bin);
+  char *run = flu_sprintf(strchr(bin, '/') ? "%s" : "./%s", bin);
+
+  flu_list *changed = flu_list_malloc();
+  int mode = 2;
+
+  while (1)
+  {
+    // regenerate, the out file is only rewritten when it changed
+
+    context_s *cc = parse_arguments(argc, argv);
+    flu_list *dirs = flu_list_malloc();
+
+    generate(cc, argc, argv, dirs);
+
+    for (flu_node *n = dirs->first; n != NULL; n = n->next)
+    {
+      watch_path(&w, n->item);
+    }
+    for (flu_node *n = c->includes->first; n != NULL; n = n->next)
+    {
+      watch_path(&w, (char *)n->item + 2); // -I../src --> ../src
+    }
+
+    flu_list_free_all(dirs);
+    free_context(cc);
+
+    // build and run, only the changed spec files (F=) if no source
+    // changed, else the specs affected by the changes (S=, see -MH)
+
+    printf(". %s\n", make); fflush(stdout);
+
+    if (system(make) == 0)
+    {
+      flu_sbuffer *b = flu_sbuffer_malloc();
+      for (flu_node *n = changed->first; n != NULL; n = n->next)
+      {
+        flu_sbprintf(b, n == changed->first ? "%s" : " %s", (char *)n->item);
+      }
+      char *f = flu_sbuffer_to_string(b);
+
+      unsetenv("F"); unsetenv("S");
+
+      if (mode == 0) setenv("F", f, 1);
+      else if (mode == 1) setenv("S", f, 1);
+
+      if (mode == 2) printf(". %s\n", run);
+      else printf(". %s=\"%s\" %s\n", mode == 0 ? "F" : "S", f, run);
+      fflush(stdout);
+
+      system(run);
+
+      free(f);
+    }
+
+    printf(". watching...\n"); fflush(stdout);
+
+    flu_list_free_all(changed); changed = flu_list_malloc();
+
+    mode = wait_for_changes(&w, changed);
+  }
+
+  return 0; // never reached
+}
+
+#else
+
+int watch(context_s *c, int argc, char *argv[])
+{
+  (void)c; (void)argc; (void)argv;
+
+  flu_die(1, "--watch is only available on Linux (inotify)");
+
+  return 1;
+}
+
+#endif
+
+
+int main(int argc, char *argv[])
+{
+  regcomp(
+    &ensure_operator_rex,
+    " ("
+      "((c|d|e|f|o|i|li|lli|u|zu|zd|lu|llu)(!?={1,3}))" "|"
+      "(!?[=!~\\^\\$>]={2,3}i?[fF]?|===snapf?)"
+    ") ",
+    REG_EXTENDED);
+
+  // deal with arguments
+
+  context_s *c = parse_arguments(argc, argv);
+
+  if (c == NULL) return print_usage(argv[0]);
+
+  int r = 0;
+
+  if (c->watch)
+  {
+    r = watch(c, argc, argv);
+  }
+  else if (c->list)
+  {
+    list(c, argc, argv);
+  }
+  else
+  {
+    flu_list *dirs = flu_list_malloc();
+    generate(c, argc, argv, dirs);
+    flu_list_free_all(dirs);
+  }
 
   free_context(c);
 
   regfree(&ensure_operator_rex);
 
-  return 0;
+  return r;
 }
-
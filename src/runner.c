@@ -0,0 +1,172 @@
+
+//
+// Copyright (c) 2013-2015, John Mettraux, jmettraux+flon@gmail.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// Made in Japan.
+//
+
+// rodzo-runner
+//
+// keeps a spec shared object (s.c compiled with -shared -fPIC) loaded,
+// reads selections (I=6, E=trims, L=12,20, F=str_spec.c, ...) on stdin,
+// one run per line, and reloads the shared object when it got rebuilt
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <dlfcn.h>
+#include <sys/stat.h>
+
+#include "flutil.h"
+
+
+static char *selectors[] = { "E", "L", "I", "F", "S", NULL };
+
+typedef struct {
+  char *path;
+  void *handle;
+  int (*main)();
+  struct stat st;
+} spec_s;
+
+static void load(spec_s *s)
+{
+  if (s->handle)
+  {
+    struct stat st;
+    if (stat(s->path, &st) != 0) return; // being rebuilt, keep the old one
+    if (st.st_ino == s->st.st_ino && st.st_mtime == s->st.st_mtime) return;
+
+    dlclose(s->handle); s->handle = NULL;
+    printf(". reloading %s\n", s->path);
+  }
+
+  if (stat(s->path, &s->st) != 0) flu_die(1, "couldn't stat %s", s->path);
+
+  s->handle = dlopen(s->path, RTLD_NOW);
+  if (s->handle == NULL) flu_die(1, "couldn't load %s: %s", s->path, dlerror());
+
+  *(void **)&s->main = dlsym(s->handle, "rdz_main");
+  if (s->main == NULL) flu_die(1, "no rdz_main() in %s", s->path);
+}
+
+static void run(spec_s *s, char *line)
+{
+  for (size_t i = 0; selectors[i]; i++) unsetenv(selectors[i]);
+
+  // "I=6", "E=trims on the right", "L=12,20 F=str_spec.c"...
+
+  char *eq = NULL;
+
+  for (char *l = line; (eq = strchr(l, '=')) != NULL; )
+  {
+    char *k = eq; while (k > l && k[-1] != ' ') --k;
+    char *v = eq + 1;
+    char *e = v + strlen(v);
+
+    for (size_t i = 0; selectors[i]; i++) // up to the next selector
+    {
+      char *n = flu_sprintf(" %s=", selectors[i]);
+      char *f = strstr(v, n); if (f && f < e) e = f;
+      free(n);
+    }
+
+    char *key = strndup(k, eq - k);
+    char *val = strndup(v, e - v);
+    setenv(key, val, 1);
+    free(key); free(val);
+
+    l = e;
+  }
+
+  load(s);
+
+  int r = s->main();
+
+  printf(". %s\n", r == 0 ? "ok" : "failed"); fflush(stdout);
+}
+
+static int print_usage(char *arg0)
+{
+  fprintf(stderr, "" "\n");
+  fprintf(stderr, "# rodzo-runner" "\n");
+  fprintf(stderr, "" "\n");
+  fprintf(stderr, "%s [-p fixtures.so]* spec.so" "\n", arg0);
+  fprintf(stderr, "" "\n");
+  fprintf(stderr, "  loads the spec.so and runs it for each line read on stdin," "\n");
+  fprintf(stderr, "  lines look like \"I=6\" or \"E=trims L=12\", an empty line" "\n");
+  fprintf(stderr, "  runs all the specs, \"q\" quits" "\n");
+  fprintf(stderr, "" "\n");
+  fprintf(stderr, "  the spec.so is reloaded whenever it changes on disk," "\n");
+  fprintf(stderr, "  the -p shared objects are loaded once and stay loaded" "\n");
+  fprintf(stderr, "" "\n");
+
+  return 1;
+}
+
+int main(int argc, char *argv[])
+{
+  spec_s s = { .path = NULL, .handle = NULL, .main = NULL };
+
+  for (int i = 1; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "-p") == 0 && i + 1 < argc)
+    {
+      // never closed, whatever state they hold survives the reloads
+
+      if (dlopen(argv[++i], RTLD_NOW | RTLD_GLOBAL) == NULL)
+      {
+        flu_die(1, "couldn't load %s: %s", argv[i], dlerror());
+      }
+    }
+    else if (*argv[i] == '-') return print_usage(argv[0]);
+    else s.path = strchr(argv[i], '/') ? strdup(argv[i]) : flu_sprintf("./%s", argv[i]);
+  }
+
+  if (s.path == NULL) return print_usage(argv[0]);
+
+  load(&s);
+
+  char *line = NULL;
+  size_t size = 0;
+
+  printf("> "); fflush(stdout);
+
+  while (getline(&line, &size, stdin) > -1)
+  {
+    line[strcspn(line, "\r\n")] = '\0';
+
+    if (strcmp(line, "q") == 0) break;
+
+    run(&s, line);
+
+    printf("> "); fflush(stdout);
+  }
+
+  free(line);
+  if (s.handle) dlclose(s.handle);
+  free(s.path);
+
+  return 0;
+}
+
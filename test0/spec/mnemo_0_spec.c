@@ -308,6 +308,26 @@ describe "mne_tos()"
       {
         expect(-1 zd== 0);
       }
+      it "fails 'zu'"
+      {
+        expect(strlen("nada") zu== 3);
+      }
+      it "fails 'li'"
+      {
+        expect(-2147483649L li== 0L);
+      }
+      it "fails 'e'"
+      {
+        expect(1.5 e== 2.5);
+      }
+      it "fails 'c'"
+      {
+        expect('a' c== 'b');
+      }
+      it "fails 'i!='"
+      {
+        expect(1 + 1 i!= 2);
+      }
     }
 
     /*
@@ -34,3 +34,14 @@ describe "mne_toi()"
   }
 }
 
+describe "complexity()"
+{
+  benchmark "a quadratic loop (failure)" sizes(1 << 6 .. 1 << 10, x2) complexity("n")
+  {
+    volatile size_t c = 0;
+
+    for (size_t i = 0; i < n; i++) for (size_t j = 0; j < n; j++) c++;
+
+    expect(c zu== n * n);
+  }
+}
@@ -43,3 +43,133 @@ context "functions defined within the specs"
   }
 }
 
+
+context "it ... with rows"
+{
+  it "trims \"%s\" on the right" with rows(s, trimmed) {
+    { "a ", "a" },
+    { "b  ", "b" }
+  } {
+    expect(flu_strrtrim(row->s) ===f row->trimmed);
+  }
+
+  it "is positive" with rows { 1, 2, 3 }
+  {
+    expect(row->c0 > 0);
+  }
+
+  it "has %i between 1 and 8" with rows { 1, 2, 3, 4, 5, 6, 7, 8 }
+  {
+    expect(row->c0 > 0);
+    expect(row->c0 < 9);
+    expect(row->c0 + row->c0 i== 2 * row->c0);
+    expect(row->c0 % 2 i== (row->c0 & 1));
+  }
+}
+
+static int lets_computed = 0;
+static int lets_cleaned = 0;
+
+static int compute_let(int i) { lets_computed++; return i; }
+
+context "let"
+{
+  let trimmed = flu_strrtrim("let  "); free(trimmed);
+  let! count = 1;
+
+  let! computed = lets_computed; // before anything else is computed
+  let! cleaned = lets_cleaned;
+  let seven = compute_let(7); lets_cleaned++;
+
+  it "computes the let on first use"
+  {
+    expect(trimmed === "let");
+    expect(count i== 1);
+  }
+
+  it "doesn't compute a let the example doesn't use"
+  {
+    expect(lets_computed i== computed);
+  }
+
+  it "computes a let once per example"
+  {
+    expect(lets_computed i== computed);
+    expect(seven i== 7);
+    expect(lets_computed i== computed + 1);
+    expect(seven + seven i== 14);
+    expect(lets_computed i== computed + 1);
+  }
+
+  it "computes the let again in the next example"
+  {
+    expect(seven i== 7);
+    expect(lets_computed i== computed + 1);
+  }
+
+  it "has cleaned up each computed let, and only those"
+  {
+    expect(cleaned i== computed);
+    expect(lets_cleaned i== computed);
+  }
+}
+
+context "===snap"
+{
+  it "compares with spec/__snapshots__/"
+  {
+    expect(flu_sprintf("%s\n%5d\n", "trimmed", 42) ===snapf "sprintf.txt");
+  }
+}
+
+context "compare"
+{
+  compare "strlen() vs a known length" faster("known")
+  {
+    char s[1024]; memset(s, 'x', 1023); s[1023] = 0;
+    volatile size_t l = 0;
+
+    variant "strlen"
+    {
+      l = strlen(s);
+    }
+    variant "known"
+    {
+      l = 1023;
+    }
+
+    expect(l zu== 1023);
+  }
+}
+
+context "benchmark"
+{
+  benchmark "strlen()" sizes(1 << 8 .. 1 << 14, x2) complexity("n")
+  {
+    char *s = calloc(n + 1, sizeof(char)); memset(s, 'x', n);
+    volatile size_t l = 0;
+
+    measure
+    {
+      l = strlen(s);
+    }
+
+    free(s);
+
+    expect(l zu== n);
+  }
+}
+
+context "fuzz"
+{
+  fuzz "flu_strrtrim" (const uint8_t *data, size_t size)
+  {
+    char *s = strndup((const char *)data, size);
+    char *t = flu_strrtrim(s);
+    size_t l = strlen(t);
+
+    expect(l == 0 || ! isspace(t[l - 1]));
+
+    free(t); free(s);
+  }
+}
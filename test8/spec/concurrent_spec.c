@@ -0,0 +1,145 @@
+
+//
+// testing rodzo
+//
+// Mon Oct 19 09:12:03 JST 2026
+//
+
+#include "flutil.h"
+
+
+static long fib(long n) { return n < 2 ? n : fib(n - 1) + fib(n - 2); }
+
+describe "fib()" concurrent
+{
+  // the direct "it" children are run on a thread pool,
+  // the output stays in declaration order
+
+  it "computes fib(25)"
+  {
+    expect(fib(25) li== 75025l);
+  }
+  it "computes fib(26)"
+  {
+    expect(fib(26) li== 121393l);
+  }
+  it "computes fib(27)"
+  {
+    expect(fib(27) li== 196418l);
+  }
+  it "computes fib(28)"
+  {
+    expect(fib(28) li== 317811l);
+  }
+  it "has no ensure"
+  {
+  }
+  it "is pending"
+
+  context "nested"
+  {
+    it "runs sequentially"
+    {
+      expect(flu_sprintf("fib %li", fib(10)) ===f "fib 55");
+    }
+  }
+
+  it "computes fib(29)"
+  {
+    expect(fib(29) li== 514229l);
+  }
+}
+
+static long hits = 0;
+
+describe "__sync_fetch_and_add()"
+{
+  it "counts from many threads at once" threads(4) iterations(10000)
+  {
+    long h = __sync_fetch_and_add(&hits, 1);
+
+    expect(h < 40000);
+    expect(rdz_thread < 4);
+  }
+
+  it "counted every iteration of every thread"
+  {
+    expect(hits li== 40000l);
+  }
+}
+
+static long befores = 0;
+static long afters = 0;
+
+describe "threads() and the hooks"
+{
+  before each
+  {
+    long base = 7; (void)base;
+    __sync_fetch_and_add(&befores, 1);
+  }
+  after each
+  {
+    __sync_fetch_and_add(&afters, 1);
+  }
+
+  let seven = 3 + 4;
+
+  it "sees the before each locals and the lets" threads(3) iterations(100)
+  {
+    expect(base li== 7l);
+    expect(seven i== 7);
+  }
+
+  it "ran the before and after each once per thread"
+  {
+    expect(befores li== 4l); // 3 threads, plus this example
+    expect(afters li== 3l);
+  }
+}
+
+static int opened = 0;
+
+describe "before all"
+{
+  before all
+  {
+    opened++;
+  }
+
+  // under RDZ_COORDINATOR, a worker gets several chunks of these,
+  // the before all still runs once (make coordinated)
+
+  it "ran once 0"
+  {
+    expect(opened i== 1);
+  }
+  it "ran once 1"
+  {
+    expect(opened i== 1);
+  }
+  it "ran once 2"
+  {
+    expect(opened i== 1);
+  }
+  it "ran once 3"
+  {
+    expect(opened i== 1);
+  }
+  it "ran once 4"
+  {
+    expect(opened i== 1);
+  }
+  it "ran once 5"
+  {
+    expect(opened i== 1);
+  }
+  it "ran once 6"
+  {
+    expect(opened i== 1);
+  }
+  it "ran once 7"
+  {
+    expect(opened i== 1);
+  }
+}
@@ -0,0 +1,73 @@
+
+//
+// Copyright (c) 2013-2014, John Mettraux, jmettraux+flon@gmail.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// Made in Japan.
+//
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+
+#include "flutil.h"
+
+
+// flutil.c
+
+//
+// str functions
+
+int flu_strends(char *s, char *end)
+{
+  size_t ls = strlen(s);
+  size_t le = strlen(end);
+
+  if (le > ls) return 0;
+
+  return (strncmp(s + ls - le, end, le) == 0);
+}
+
+char *flu_strrtrim(char *s)
+{
+  char *r = strdup(s);
+  for (size_t l = strlen(r); l > 0; l--)
+  {
+    char c = r[l - 1];
+    if (c == ' ' || c == '\t' || c == '\n' || c == '\r') r[l - 1] = '\0';
+    else break;
+  }
+
+  return r;
+}
+
+char *flu_sprintf(const char *format, ...)
+{
+  char *s = calloc(1024, sizeof(char));
+
+  va_list ap; va_start(ap, format);
+  vsprintf(s, format, ap);
+  va_end(ap);
+
+  return s;
+}
+
@@ -0,0 +1,50 @@
+
+//
+// Copyright (c) 2013-2014, John Mettraux, jmettraux+flon@gmail.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// Made in Japan.
+//
+
+// flutil.h
+
+#ifndef FLON_FLUTIL_H
+#define FLON_FLUTIL_H
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdarg.h>
+#include <string.h>
+
+//
+// str functions
+
+/* Returns 1 if the string s ends with the end string. Returns 0 else.
+ */
+int flu_strends(char *s, char *end);
+
+/* Returns a copy of the string, trimmed on the right.
+ */
+char *flu_strrtrim(char *s);
+
+char *flu_sprintf(const char *format, ...);
+
+#endif // FLON_FLUTIL_H
+
@@ -0,0 +1,8988 @@
+
+//
+// Copyright (c) 2013-2015, John Mettraux, jmettraux+flon@gmail.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// Made in Japan.
+//
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <ctype.h>
+#include <regex.h>
+#include <dirent.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <libgen.h>
+#include <glob.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
+
+#include "flutil.h"
+#include "fnv.c" // rdz_fnv(), shared with the runtime
+
+
+#define RODZO_VERSION "1.2.0"
+
+
+
+//
+// context and tree
+
+typedef struct rows_s {
+  size_t count;
+  char **rows; // "{ \"a\", 1 }", one per row
+  int *lines; // the line each row starts on
+  char **titles; // the it text, formatted with the row
+  size_t ccount;
+  char **names; // the column names, "in", "out" or "c0", "c1"
+  char **firsts; // the first row's columns, they give the column types
+} rows_s;
+
+typedef struct node_s {
+  struct node_s *parent;
+  int nodenumber;
+  int indent;
+  short hasbody;
+  short concurrent; // describe "x" concurrent, its run on a thread pool
+  int threads; // it "x" threads(8) iterations(1000), a stress example
+  long iterations;
+  rows_s *rows; // it "x %s" with rows { ... }, held by the first row
+  struct node_s *tmpl; // the first row, for the other rows
+  int row; // row index
+  char *expr; // let x = expr; cleanup;
+  char *cleanup;
+  short eager; // let! x = expr;
+  char *fuzz; // fuzz "x" (const uint8_t *data, size_t size), the parameters
+  short compare; // compare "x" { variant "a" { ... } variant "b" { ... } }
+  char *winner; // compare "x" faster("b")
+  int vcount;
+  char **vnames; // the variant names, in order
+  char *sizes; // benchmark "x" sizes(1<<10 .. 1<<20, x4), "from, to, step, op"
+  char *complexity; // benchmark "x" ... complexity("n log n")
+  char type;
+  char *text;
+  char *fname; // shared, not owned by the node
+  int lstart;
+  int ltstart;
+  int llength;
+  flu_sbuffer *lines;
+  struct node_s *first; // first child
+  struct node_s *last; // last child
+  struct node_s *next; // next sibling
+  struct node_s *eaches; // first "before each" or "after each" child
+  struct node_s *next_each; // next "before each" or "after each" sibling
+} node_s;
+
+typedef struct {
+  int loffset;
+  int nodecount;
+  int itcount; // it count
+  int encount; // ensure count
+  int sitecount; // typed ensure count
+  flu_sbuffer *sites;
+  node_s *node;
+  char *out_fname;
+  int debug;
+  int reproducible;
+  int deps; // 0 no .d file, 1 spec files (-MD), 2 headers as well (-MH)
+  flu_list *includes; // -I dirs, passed to the preprocessor for -MH
+  int watch; // --watch, regenerate, build and run on change
+  flu_dict *sdeps; // spec file -> "spec file and what it includes" (-MH)
+  int concurrent; // 1 if there is at least one concurrent describe or stress it
+  int fuzz; // --fuzz, LLVMFuzzerTestOneInput() instead of main()
+  int fuzzes; // 1 if there is at least one fuzz block (RDZ_WITH_FUZZ)
+  int compares; // 1 if there is at least one compare block (RDZ_WITH_COMPARE)
+  int benchmarks; // 1 if there is at least one benchmark (RDZ_WITH_BENCH)
+  int list; // --list, JSON lines to stdout, no spec file written
+} context_s;
+
+char *type_to_string(char t)
+{
+  if (t == 'd') return "describe";
+  if (t == 'c') return "context";
+  if (t == 'i') return "it";
+  if (t == 'p') return "pending";
+  if (t == 'b') return "before each";
+  if (t == 'y') return "before each offline";
+  if (t == 'B') return "before all";
+  if (t == 'a') return "after each";
+  if (t == 'z') return "after each offline";
+  if (t == 'l') return "let";
+  if (t == 'A') return "after all";
+  if (t == 'g') return "g";
+  if (t == 'G') return "G";
+  return "???";
+}
+
+void node_to_s(flu_sbuffer *b, int level, node_s *n)
+{
+  if (n == NULL) { flu_sbprintf(b, "*** (nil)"); return; }
+
+  int p = n->parent == NULL ? -1 : n->parent->nodenumber;
+  char t = n->type;
+  char *te = flu_strrtrim(n->text != NULL ? n->text : "(nil)");
+
+  for (int i = 0; i < level; i++) flu_sbputs(b, "  ");
+  flu_sbprintf(b, "|-- %s", type_to_string(t));
+  flu_sbprintf(b, " n:%d i:%d ", n->nodenumber, n->indent);
+  flu_sbprintf(b, "fn:%s ", n->fname);
+  flu_sbprintf(b, "ls:%d lts:%d ll:%d ", n->lstart, n->ltstart, n->llength);
+  flu_sbprintf(b, "p:%d\n", p);
+  for (int i = 0; i < level; i++) flu_sbputs(b, "  ");
+  flu_sbprintf(b, "|   te: >%s<\n", te);
+
+  free(te);
+
+  for (node_s *cn = n->first; cn != NULL; cn = cn->next)
+  {
+    node_to_s(b, level + 1, cn);
+  }
+}
+
+char *node_to_string(node_s *n)
+{
+  flu_sbuffer *b = flu_sbuffer_malloc();
+  node_to_s(b, 0, n);
+
+  return flu_sbuffer_to_string(b);
+}
+
+void node_to_p(flu_sbuffer *b, int level, node_s *n)
+{
+  if (n == NULL) { flu_sbprintf(b, "// NULL"); return; }
+
+  char t = n->type;
+  int notg = (t != 'g' && t != 'G');
+  int notba = (t != 'b' && t != 'B' && t != 'a' && t != 'A');
+
+  if (t == 'l')
+  {
+    for (int i = 0; i < level; i++) flu_sbputs(b, "  ");
+    flu_sbprintf(b, "let%s \"%s\"\n", n->eager ? "!" : "", n->text);
+
+    return;
+  }
+
+  if (notg)
+  {
+    char *te = flu_strrtrim(n->text != NULL ? n->text : "(nil)");
+
+    for (int i = 0; i < level; i++) flu_sbputs(b, "  ");
+    char *ts = type_to_string(t);
+    if (n->fuzz) ts = "fuzz"; else if (n->compare) ts = "compare";
+    else if (n->sizes) ts = "benchmark";
+    flu_sbprintf(b, "%s \"%s\"", ts, te);
+    if (n->concurrent) flu_sbprintf(b, " concurrent");
+    if (n->threads) flu_sbprintf(b, " threads(%d)", n->threads);
+    if (n->threads) flu_sbprintf(b, " iterations(%ld)", n->iterations);
+    if (n->winner) flu_sbprintf(b, " faster(\"%s\")", n->winner);
+    if (n->complexity) flu_sbprintf(b, " complexity(\"%s\")", n->complexity);
+    flu_sbprintf(b, "\n");
+
+    free(te);
+  }
+
+  if (t != 'p')
+  {
+    if (notg && notba)
+    {
+      for (int i = 0; i < level; i++) flu_sbputs(b, "  ");
+      flu_sbprintf(b, "{\n");
+    }
+
+    for (int i = 0; i < n->vcount; i++)
+    {
+      for (int j = 0; j <= level; j++) flu_sbputs(b, "  ");
+      flu_sbprintf(b, "variant \"%s\"\n", n->vnames[i]);
+    }
+
+    for (node_s *cn = n->first; cn != NULL; cn = cn->next)
+    {
+      node_to_p(b, level + 1, cn);
+    }
+
+    if (notg && notba)
+    {
+      for (int i = 0; i < level; i++) flu_sbputs(b, "  ");
+      flu_sbprintf(b, "}\n");
+    }
+  }
+}
+
+char *node_to_pseudo(node_s *n)
+{
+  flu_sbuffer *b = flu_sbuffer_malloc();
+  node_to_p(b, 0, n);
+
+  return flu_sbuffer_to_string(b);
+}
+
+void push_line(context_s *c, char *l)
+{
+  node_s *n = c->node;
+  if (n->lines == NULL) n->lines = flu_sbuffer_malloc();
+  flu_sbputs(n->lines, l);
+}
+void push_linef(context_s *c, const char *format, ...)
+{
+  va_list ap;
+  va_start(ap, format);
+  node_s *n = c->node;
+  if (n->lines == NULL) n->lines = flu_sbuffer_malloc();
+  flu_sbvprintf(n->lines, format, ap);
+  va_end(ap);
+}
+
+void push(context_s *c, int ind, char type, char *text, char *fn, int lstart)
+{
+  if (text == NULL && type == 'p') text = "no reason given";
+  if (text != NULL) text = strdup(text);
+
+  if (ind == 0) while (c->node->parent != NULL) c->node = c->node->parent;
+    // if indentation is 0, go back to trunk
+
+  node_s *cn = c->node;
+
+  if (cn && cn->type == 'i' && type != 'p') // "it" without bodies
+  {
+    if (cn->first == NULL)
+    {
+      //push(c, ind, 'p', "not yet implemented 2", fn, cn->lstart);
+      push(c, ind, 'p', "not yet implemented", fn, cn->lstart);
+    }
+    cn = cn->parent;
+  }
+
+  node_s *n = calloc(1, sizeof(node_s));
+  n->parent = cn;
+  n->nodenumber = c->nodecount++;
+  n->indent = ind;
+  n->hasbody = 0;
+  n->concurrent = 0;
+  n->threads = 0;
+  n->iterations = 0;
+  n->rows = NULL;
+  n->tmpl = NULL;
+  n->row = 0;
+  n->expr = NULL;
+  n->cleanup = NULL;
+  n->eager = 0;
+  n->fuzz = NULL;
+  n->compare = 0;
+  n->winner = NULL;
+  n->vcount = 0;
+  n->vnames = NULL;
+  n->sizes = NULL;
+  n->complexity = NULL;
+  n->type = type;
+  n->text = text;
+  n->fname = fn;
+  n->lstart = lstart;
+  n->ltstart = c->loffset + lstart;
+  n->llength = 0;
+  n->lines = NULL;
+  n->first = NULL;
+  n->last = NULL;
+  n->next = NULL;
+  n->eaches = NULL;
+  n->next_each = NULL;
+
+  if (cn != NULL)
+  {
+    if (cn->last == NULL) cn->first = n; else cn->last->next = n;
+    cn->last = n;
+  }
+
+  if (cn != NULL && (type == 'b' || type == 'a' || type == 'l'))
+  {
+    node_s **e = &cn->eaches; while (*e != NULL) e = &(*e)->next_each;
+    *e = n;
+  }
+
+  c->node = n;
+  if (type == 'p' || type == 'l') c->node = cn;
+
+  if (type == 'i') c->itcount++;
+}
+
+context_s *malloc_context()
+{
+  context_s *c = calloc(1, sizeof(context_s));
+  c->loffset = 0;
+  c->nodecount = 0;
+  c->itcount = 0;
+  c->encount = 0;
+  c->sitecount = 0;
+  c->sites = flu_sbuffer_malloc();
+  c->node = NULL;
+  c->out_fname = NULL;
+  c->debug = 0;
+  c->reproducible = 0;
+  c->deps = 0;
+  c->includes = flu_list_malloc();
+  c->watch = 0;
+  c->sdeps = NULL;
+  c->concurrent = 0;
+  c->list = 0;
+  c->fuzz = 0;
+  c->fuzzes = 0;
+  c->compares = 0;
+  c->benchmarks = 0;
+
+  push(c, -1, 'G', NULL, NULL, -1);
+
+  return c;
+}
+
+void free_rows(rows_s *r)
+{
+  if (r == NULL) return;
+
+  for (size_t i = 0; i < r->count; i++) { free(r->rows[i]); free(r->titles[i]); }
+  for (size_t i = 0; i < r->ccount; i++) { free(r->names[i]); free(r->firsts[i]); }
+  free(r->rows); free(r->lines); free(r->titles);
+  free(r->names); free(r->firsts);
+  free(r);
+}
+
+void free_node(node_s *n)
+{
+  free(n->text);
+  free(n->expr);
+  free(n->cleanup);
+  free(n->fuzz);
+  free(n->winner);
+  for (int i = 0; i < n->vcount; i++) free(n->vnames[i]);
+  free(n->vnames);
+  free(n->sizes);
+  free(n->complexity);
+  free_rows(n->rows);
+
+  flu_sbuffer_free(n->lines);
+
+  for (node_s *c = n->first; c != NULL; )
+  {
+    node_s *next = c->next;
+    free_node(c);
+    c = next;
+  }
+
+  free(n);
+}
+
+void clear_tree(context_s *c)
+{
+  while (c->node->parent != NULL) c->node = c->node->parent;
+  free_node(c->node);
+}
+
+void free_context(context_s *c)
+{
+  clear_tree(c);
+
+  flu_sbuffer_free(c->sites);
+  flu_list_free(c->includes);
+  if (c->sdeps) flu_list_free_all(c->sdeps);
+  free(c->out_fname);
+  free(c);
+}
+
+void pull(context_s *c, int indent, int lnumber)
+{
+  (void)indent;
+
+  node_s *n = c->node;
+
+  //printf("0 pull() from %d to %d\n", n->indent, n->parent->indent);
+
+  n->llength = lnumber - n->lstart;
+
+  if (n->type == 'i' && n->hasbody == 0)
+  {
+    push(c, n->indent, 'p', "not yet implemented", n->fname, lnumber);
+    c->node = n->parent->parent; n = n->parent;
+  }
+
+  //printf("1 pull() from %d to %d\n", n->indent, n->parent->indent);
+
+  c->node = n->parent;
+
+  for (size_t i = 1; n->rows && i < n->rows->count; i++) // the other rows
+  {
+    rows_s *r = n->rows;
+
+    push(c, n->indent, 'i', r->titles[i], n->fname, r->lines[i]);
+    c->node->tmpl = n;
+    c->node->row = i;
+    c->node->hasbody = 1;
+    c->node->llength = r->lines[i] == n->lstart ? n->llength : 0;
+    c->node = n->parent;
+  }
+  if (n->rows && n->rows->lines[0] != n->lstart) // rows below the it line
+  {
+    n->ltstart += n->rows->lines[0] - n->lstart;
+    n->lstart = n->rows->lines[0];
+    n->llength = 0;
+  }
+
+  if (c->node->type == 'G')
+  {
+    push(c, 0, 'g', NULL, n->fname, lnumber + 1);
+  }
+}
+
+//
+// processing work
+
+typedef struct line_s {
+  int indent;
+  char *head;
+  char *text;
+  char *line;
+  int comment; // 0 no change, 1 comment started, -1 comment ended
+} line_s;
+
+void line_s_free(line_s *l)
+{
+  free(l->head);
+  free(l->text);
+  free(l->line);
+  free(l);
+}
+
+char *line_s_to_s(line_s *l, int colour)
+{
+  flu_sbuffer *b = flu_sbuffer_malloc();
+
+  char *con = colour ? "[1;33m" : "";
+  char *coff = colour ? "[0;00m" : "";
+
+  flu_sbprintf(
+    b,
+    "(l i%i c%i h>%s%s%s< t>%s%s%s< l>%s%s%s<)",
+    l->indent, l->comment,
+    con, l->head, coff, con, l->text, coff, con, l->line, coff);
+
+  return flu_sbuffer_to_string(b);
+}
+
+line_s *split(int comment, char *line)
+{
+  ssize_t len = strlen(line) + 1;
+  line_s *l = calloc(1, sizeof(line_s));
+  l->indent = 0;
+  l->head = NULL;
+  l->text = NULL;
+  l->line = calloc(len, sizeof(char));
+  l->comment = comment;
+
+  int string = 0;
+  int escape = 0;
+
+  for (ssize_t i = 0, j = 0, k = 0; i < len; ++i)
+  {
+    char c = line[i]; char c1 = line[i + 1];
+
+    if ( ! string && c == '*' && c1 == '/') { l->comment = -1; ++i; continue; }
+
+    if (l->comment == 1) continue;
+
+    if ( ! string && c == '/' && c1 == '/') break;
+    if ( ! string && c == '/' && c1 == '*') { l->comment = 1; ++i; continue; }
+
+    l->line[j++] = c;
+
+    if (l->head == NULL) // measuring indent
+    {
+      if (c == ' ' || c == '\t') { ++l->indent; continue; }
+      l->head = calloc(len, sizeof(char)); l->head[0] = c; k = 1;
+    }
+    else if (l->text == NULL) // gathering head
+    {
+      if (strchr("\"( \t", c)) { l->text = calloc(len, sizeof(char)); k = len; }
+      else { l->head[k++] = c; }
+    }
+    else if (k == len) // space before text
+    {
+      if (strchr("\"() \t", c) == NULL) { k = 0; l->text[k++] = c; }
+      else if (c == ')') k = -1;
+    }
+    else if (k > -1) // gathering text
+    {
+      if (string == 1 && escape == 0 && c == '"') k = -1;
+      else if (string == 0 && c == ')') k = -1;
+      else l->text[k++] = c;
+    }
+
+    if (escape == 0 && c == '"') string = ! string;
+    escape = (c == '\\');
+  }
+
+  flu_rtrim(l->head);
+  flu_rtrim(l->text);
+  flu_rtrim(l->line);
+
+  return l;
+}
+
+int is_block(line_s *l, char *head)
+{
+  // fuzz "x" ..., compare "x" ..., but not fuzz(x) or compare(a, b)
+
+  if (l->head == NULL || strcmp(l->head, head) != 0) return 0;
+
+  char *s = l->line + l->indent + strlen(head);
+  while (*s == ' ' || *s == '\t') s++;
+
+  return *s == '"';
+}
+
+int ends_in_semicolon(char *line)
+{
+  if (*line != 0) for (size_t i = strlen(line) - 1; ; --i)
+  {
+    char c = line[i];
+    if (c == ';') return 1;
+    if (i > 0 && (c == '\r' || c == '\n')) continue;
+    return 0;
+  }
+  return 0;
+}
+
+char *extract_condition(FILE *in, char *line)
+{
+  flu_sbuffer *b = flu_sbuffer_malloc();
+
+  flu_sbputs(b, line);
+
+  if (ends_in_semicolon(line)) return flu_sbuffer_to_string(b);
+
+  char *lin = NULL;
+  size_t len = 0;
+
+  while (1)
+  {
+    if (getline(&lin, &len, in) == -1) break;
+    flu_sbputs(b, lin);
+    if (ends_in_semicolon(lin)) break;
+  }
+
+  free(lin);
+
+  return flu_sbuffer_to_string(b);
+}
+
+size_t count_lines(char *s)
+{
+  size_t count = 0;
+  while (*(s++) != '\0') { if (*s == '\n') count++; }
+
+  return count;
+}
+
+regex_t ensure_operator_rex;
+
+char *chop_right(char *s)
+{
+  char *brackend = strrchr(s, ')');
+  if (brackend) *brackend = 0;
+
+  return s;
+}
+
+char *extract_match(char *s, regmatch_t m)
+{
+  return strndup(s + m.rm_so, m.rm_eo - m.rm_so);
+}
+
+int push_ensure(context_s *c, FILE *in, int indent, int lnumber, char *l)
+{
+  l = strchr(l, 'e');
+  char *con = extract_condition(in, l + 6);
+  lnumber += count_lines(con);
+
+  //printf("con >%s<\n", con);
+
+  char *ind = calloc(indent + 1, sizeof(char));
+  for (int i = 0; i < indent; i++) ind[i] = ' ';
+
+  int typed = 0;
+  regmatch_t ms[6];
+
+  if (regexec(&ensure_operator_rex, con, 6, ms, 0)) // no match
+  {
+    push_linef(c, "%schar *msg%d = NULL;\n", ind, lnumber);
+    push_linef(c, "%sint r%d = %s\n", ind, lnumber, con);
+  }
+  else if (ms[3].rm_eo > ms[3].rm_so) // type
+  {
+    typed = 1;
+
+    char *format = extract_match(con, ms[3]);
+    char *eq = extract_match(con, ms[4]);
+
+    char *left = strndup(con + 1, ms[1].rm_so - 2);
+    //
+    char *right = strndup(con + ms[1].rm_eo + 1, strlen(con) - ms[1].rm_eo - 1);
+    *(strrchr(right, ')')) = '\0';
+
+    char *type = "int";
+    char *fun = "rdz_ensure_i64";
+    //if (strcmp(format, "d") == 0) type = "int";
+    if (strcmp(format, "s") == 0) type = "short";
+    else if (strcmp(format, "c") == 0) type = "char";
+    //else if (strcmp(format, "d") == 0) type = "int";
+    else if (strcmp(format, "f") == 0) type = "double";
+    else if (strcmp(format, "e") == 0) type = "double";
+    else if (strcmp(format, "o") == 0) type = "unsigned int";
+    else if (strcmp(format, "u") == 0) type = "unsigned int";
+    else if (strcmp(format, "li") == 0) type = "long";
+    else if (strcmp(format, "lli") == 0) type = "long long";
+    else if (strcmp(format, "lu") == 0) type = "long unsigned";
+    else if (strcmp(format, "llu") == 0) type = "long long unsigned";
+    else if (strcmp(format, "zu") == 0) type = "size_t";
+    else if (strcmp(format, "zd") == 0) type = "ssize_t";
+
+    if (strcmp(type, "double") == 0) fun = "rdz_ensure_f64";
+    else if (strstr(type, "unsigned")) fun = "rdz_ensure_u64";
+    else if (strcmp(type, "size_t") == 0) fun = "rdz_ensure_u64";
+
+    if (c->node->rows) // the site is per row, the row is a parameter
+    {
+      push_linef(
+        c, "%sif ( ! %s((%s)(%s), (%s)(%s), "
+        "&(rdz_site){ \"%s\", \"%s\", __rdz_it, %d, %d })) goto _over;\n",
+        ind, fun, type, left, type, right,
+        format, eq, lnumber, c->loffset + lnumber);
+    }
+    else
+    {
+      flu_sbprintf(
+        c->sites,
+        "  { \"%s\", \"%s\", %d, %d, %d }, // site %d\n",
+        format, eq, c->node->nodenumber, lnumber, c->loffset + lnumber,
+        c->sitecount);
+
+      push_linef(
+        c, "%sif ( ! %s((%s)(%s), (%s)(%s), rdz_sites + %d)) goto _over;\n",
+        ind, fun, type, left, type, right, c->sitecount);
+
+      c->sitecount++;
+    }
+
+    free(format);
+    free(eq);
+    free(left);
+    free(right);
+  }
+  else // string
+  {
+    char *oper = extract_match(con, ms[5]);
+
+    push_linef(c, "%schar *msg%d = NULL;\n", ind, lnumber);
+
+    con[ms[1].rm_so] = '\0';
+    char *left = flu_strtrim(con);
+    char *right = chop_right(flu_strtrim(con + ms[1].rm_eo));
+
+    char op = oper[0] == '!' && oper[1] != '=' ? oper[1] : oper[0];
+    //
+    char *fun = "rdz_string_eq";
+    if (op == '!') fun = "rdz_string_neq";
+    else if (op == '~') fun = "rdz_string_match";
+    else if (op == '^') fun = "rdz_string_start";
+    else if (op == '$') fun = "rdz_string_end";
+    else if (op == '>') fun = "rdz_string_contains";
+
+    push_linef(
+      c, "%schar *result%d = %s);\n",
+      ind, lnumber, left);
+    push_linef(
+      c, "%schar *expected%d = %s;\n",
+      ind, lnumber, right);
+    if (strstr(oper, "snap")) // the snapshot sits next to the spec file
+    {
+      push_linef(
+        c, "%smsg%d = rdz_string_snap(result%d, expected%d, \"%s\");\n",
+        ind, lnumber, lnumber, lnumber, c->node->fname);
+    }
+    else
+    {
+      push_linef(
+        c, "%smsg%d = %s(\"%s\", result%d, expected%d);\n",
+        ind, lnumber, fun, oper, lnumber, lnumber);
+    }
+    push_linef(
+      c, "%sint r%d = (msg%d == NULL);\n",
+      ind, lnumber, lnumber);
+
+    if (strchr(oper, 'f'))
+    {
+      push_linef(
+        c, "%sfree(result%d);\n",
+        ind, lnumber);
+    }
+    else if (strchr(oper, 'F'))
+    {
+      push_linef(
+        c, "%sfree(result%d); free(expected%d);\n",
+        ind, lnumber, lnumber);
+    }
+
+    free(oper);
+    free(left);
+    free(right);
+  }
+
+  if (typed == 0 && c->node->rows)
+  {
+    push_linef(
+      c, "%srdz_record(r%d, msg%d, __rdz_it, %d, %d); ",
+      ind, lnumber, lnumber, lnumber, c->loffset + lnumber);
+    push_linef(
+      c, "if ( ! r%d) goto _over;\n",
+      lnumber);
+  }
+  else if (typed == 0)
+  {
+    push_linef(
+      c, "%srdz_record(r%d, msg%d, %d, %d, %d); ",
+      ind, lnumber, lnumber, c->node->nodenumber, lnumber, c->loffset + lnumber);
+    push_linef(
+      c, "if ( ! r%d) goto _over;\n",
+      lnumber);
+  }
+
+  free(ind);
+  free(con);
+
+  c->encount++;
+
+  return lnumber;
+}
+
+int push_let(context_s *c, FILE *in, int indent, int lnumber, char *line)
+{
+  // let doc = parse_file("big.json"); free_doc(doc);
+  // let! now = time(NULL);
+
+  char *l = extract_condition(in, strstr(line, "let"));
+  int lstart = lnumber;
+  lnumber += count_lines(l);
+
+  char *s = l + 3;
+  int eager = (*s == '!'); if (eager) s++;
+  while (*s == ' ' || *s == '\t') s++;
+
+  char *name = s; while (isalnum(*s) || *s == '_') s++;
+  char *ne = s;
+  while (*s == ' ' || *s == '\t') s++;
+
+  if (*s != '=' || ne == name)
+  {
+    fprintf(stderr, "%s:%d: expected let name = expr;\n", c->node->fname, lstart);
+    free(l);
+    return lnumber;
+  }
+
+  char *expr = ++s; // up to the first ; outside of strings and parentheses
+  int depth = 0, string = 0, escape = 0;
+
+  for (; *s; s++)
+  {
+    if (string) { if ( ! escape && *s == string) string = 0; }
+    else if (*s == '"' || *s == '\'') string = *s;
+    else if (*s == '(' || *s == '[' || *s == '{') depth++;
+    else if (*s == ')' || *s == ']' || *s == '}') depth--;
+    else if (*s == ';' && depth == 0) break;
+
+    escape = ! escape && *s == '\\';
+  }
+
+  *ne = '\0';
+  char *e = strndup(expr, s - expr);
+
+  for (char *cc = e; *cc; cc++) if (*cc == '\n' || *cc == '\r') *cc = ' ';
+    // the accessor is a #define, on a single line
+
+  push(c, indent, 'l', name, c->node->fname, lstart);
+
+  node_s *n = c->node->last;
+  n->expr = flu_strtrim(e);
+  n->eager = eager;
+  n->llength = lnumber - lstart;
+
+  char *cl = *s ? flu_strtrim(s + 1) : NULL;
+  if (cl && *cl) n->cleanup = cl; else free(cl);
+
+  free(e);
+  free(l);
+
+  return lnumber;
+}
+
+void push_pending(context_s *c, line_s *l, char *fn, int lstart)
+{
+  node_s *cn = c->node;
+
+  if (cn->type == 'i' && cn->indent < l->indent)
+  {
+    push(c, l->indent, 'p', strlen(l->text) > 0 ? l->text : NULL, fn, lstart);
+  }
+  else // lonely p
+  {
+    push(c, l->indent, 'i', l->text, fn, lstart);
+    push(c, l->indent + 2, 'p', NULL, fn, lstart); // "no reason given"
+  }
+}
+
+int is_concurrent(char *line)
+{
+  // describe "x" concurrent
+  // describe "x" concurrent {
+
+  char *q = strrchr(line, '"'); if (q == NULL) return 0;
+  char *s = strstr(q, "concurrent"); if (s == NULL) return 0;
+
+  return strchr(" \t{", s[10]) != NULL;
+}
+
+void parse_stress(context_s *c, char *line)
+{
+  // it "x" threads(8) iterations(100000)
+
+  char *q = strrchr(line, '"'); if (q == NULL) return;
+
+  char *t = strstr(q, "threads(");
+  char *i = strstr(q, "iterations(");
+
+  if (t == NULL && i == NULL) return;
+
+  node_s *n = c->node;
+
+  n->threads = t ? atoi(t + 8) : 1;
+  n->iterations = i ? atol(i + 11) : 1;
+  if (n->threads < 1) n->threads = 1;
+  if (n->iterations < 1) n->iterations = 1;
+
+  c->concurrent = 1;
+}
+
+void parse_fuzz(context_s *c, char *line)
+{
+  // fuzz "x" (const uint8_t *data, size_t size)
+
+  char *q = strrchr(line, '"'); if (q == NULL) q = line;
+
+  char *s = strchr(q, '(');
+  char *e = s ? strrchr(s, ')') : NULL;
+
+  c->node->fuzz = e ?
+    strndup(s + 1, e - s - 1) : strdup("const uint8_t *data, size_t size");
+
+  c->fuzzes = 1;
+}
+
+static char *past_title(char *line)
+{
+  // points right after the first string literal in the line
+
+  char *s = strchr(line, '"'); if (s == NULL) return line + strlen(line);
+
+  for (s++; *s && *s != '"'; s++) if (*s == '\\' && s[1]) s++;
+
+  return *s ? s + 1 : s;
+}
+
+void parse_compare(context_s *c, char *line)
+{
+  // compare "x" faster("b")
+
+  c->node->compare = 1;
+  c->compares = 1;
+
+  char *q = strrchr(line, '"'); if (q == NULL) return;
+  char *f = strstr(line, "faster(\""); if (f == NULL) return;
+
+  f += 8;
+  char *e = strchr(f, '"'); if (e == NULL) return;
+
+  c->node->winner = strndup(f, e - f);
+}
+
+void push_variant(context_s *c, line_s *l)
+{
+  // variant "a" { ... }  -->  if (rdz_variant(__rdz_variant, 0)) { ... }
+
+  node_s *n = c->node;
+
+  n->vnames = realloc(n->vnames, (n->vcount + 1) * sizeof(char *));
+  n->vnames[n->vcount] = strdup(l->text ? l->text : "");
+
+  char *ind = calloc(l->indent + 1, sizeof(char));
+  for (int i = 0; i < l->indent; i++) ind[i] = ' ';
+
+  char *rest = past_title(l->line);
+  while (*rest == ' ' || *rest == '\t') rest++;
+
+  push_linef(
+    c, "%sif (rdz_variant(__rdz_variant, %d))%s%s // variant \"%s\"\n",
+    ind, n->vcount, *rest ? " " : "", rest, n->vnames[n->vcount]);
+
+  n->vcount++;
+
+  free(ind);
+}
+
+void parse_benchmark(context_s *c, char *line)
+{
+  // benchmark "x" sizes(1<<10 .. 1<<20, x4) complexity("n log n")
+  // sizes(100 .. 1000, +100) steps by addition, the step defaults to x2
+
+  node_s *n = c->node;
+
+  c->benchmarks = 1;
+
+  line = past_title(line);
+
+  char *cx = strstr(line, "complexity(\"");
+  if (cx)
+  {
+    cx += 12;
+    char *e = strchr(cx, '"');
+    if (e) n->complexity = strndup(cx, e - cx);
+  }
+
+  char *s = strstr(line, "sizes("); if (s == NULL) return;
+  s += 6;
+
+  char *e = s; // the closing parenthesis
+  for (int depth = 0; *e && (depth > 0 || *e != ')'); e++)
+  {
+    if (*e == '(') depth++; else if (*e == ')') depth--;
+  }
+
+  char *dots = strstr(s, "..");
+  if (dots == NULL || dots > e) return;
+
+  char *comma = NULL; // the last top level comma
+  for (char *cc = dots; cc < e; cc++) if (*cc == ',') comma = cc;
+
+  char *f = strndup(s, dots - s);
+  char *t = strndup(dots + 2, (comma ? comma : e) - dots - 2);
+  char *p = comma ? strndup(comma + 1, e - comma - 1) : strdup("x2");
+
+  char *from = flu_strtrim(f);
+  char *tt = flu_strtrim(t);
+  char *ts = flu_strtrim(p);
+
+  char op = '*';
+  char *st = ts;
+  if (*st == 'x' || *st == '*') st++;
+  else if (*st == '+') { op = '+'; st++; }
+
+  n->sizes = flu_sprintf("(size_t)(%s), (size_t)(%s), (double)(%s), '%c'", from, tt, st, op);
+
+  free(f); free(t); free(p); free(from); free(tt); free(ts);
+}
+
+void push_measure(context_s *c, line_s *l)
+{
+  // measure { ... }  -->  if (rdz_measure()) { ... }
+
+  char *ind = calloc(l->indent + 1, sizeof(char));
+  for (int i = 0; i < l->indent; i++) ind[i] = ' ';
+
+  char *rest = l->line + l->indent + 7;
+  while (*rest == ' ' || *rest == '\t') rest++;
+
+  push_linef(
+    c, "%sif (rdz_measure())%s%s // measure\n", ind, *rest ? " " : "", rest);
+
+  free(ind);
+}
+
+static char *row_title(char *format, char **cols, size_t ccount, size_t row)
+{
+  // "parses %s" and { "a", 1 } -> "parses a", the title is a C string
+
+  flu_sbuffer *b = flu_sbuffer_malloc();
+  size_t ci = 0;
+
+  for (char *s = format; *s; s++)
+  {
+    if (*s != '%') { flu_sbputc(b, *s); continue; }
+    if (s[1] == '%') { flu_sbputc(b, '%'); s++; continue; }
+
+    char *e = s + 1; while (*e && strchr("-+ #0123456789.hlLqjzt", *e)) e++;
+    if (*e == '\0') { flu_sbputs(b, s); break; }
+
+    char *v = ci < ccount ? cols[ci++] : "";
+    size_t l = strlen(v);
+
+    if (l > 1 && v[0] == '"' && v[l - 1] == '"') // string literal
+    {
+      flu_sbwrite(b, v + 1, l - 2);
+    }
+    else
+    {
+      for (char *cc = v; *cc; cc++)
+      {
+        if (*cc == '"' || *cc == '\\') flu_sbputc(b, '\\');
+        flu_sbputc(b, *cc);
+      }
+    }
+
+    s = e;
+  }
+
+  if (ci == 0) flu_sbprintf(b, " (row %zu)", row + 1); // no conversion
+
+  return flu_sbuffer_to_string(b);
+}
+
+static size_t split_row(char *row, char ***cols)
+{
+  // "{ \"a, b\", f(1, 2) }" -> [ "\"a, b\"", "f(1, 2)" ]
+
+  flu_list *l = flu_list_malloc();
+
+  char *s = row + 1; // past the '{'
+  int depth = 0, string = 0, escape = 0;
+
+  for (char *c = s; *c; c++)
+  {
+    if (string) { if ( ! escape && *c == string) string = 0; }
+    else if (*c == '"' || *c == '\'') string = *c;
+    else if (*c == '(' || *c == '[' || *c == '{') depth++;
+    else if ((*c == ')' || *c == ']' || *c == '}') && depth > 0) depth--;
+    else if (depth == 0 && (*c == ',' || *c == '}'))
+    {
+      char *col = strndup(s, c - s);
+      char *t = flu_strtrim(col); free(col);
+      if (*t) flu_list_add(l, t); else free(t);
+      s = c + 1;
+      if (*c == '}') break;
+    }
+
+    escape = ! escape && *c == '\\';
+  }
+
+  size_t count = l->size;
+  *cols = (char **)flu_list_to_array(l, 0);
+  flu_list_free(l);
+
+  return count;
+}
+
+rows_s *parse_rows(FILE *in, int *lnumber, char *line, char *text, int *hasbody)
+{
+  // it "parses %s" with rows { { "a", 1 }, { "b", 2 } } {
+  // it "parses %s" with rows(in, out) {
+  //   { "a", 1 },
+  //   { "b", 2 }
+  // } {
+
+  char *q = strchr(line, '"'); if (q == NULL) return NULL;
+  for (q++; *q && *q != '"'; q++) if (*q == '\\' && q[1]) q++;
+  if (*q == '\0') return NULL;
+
+  char *w = q + 1; while (*w == ' ' || *w == '\t') w++;
+  if (strncmp(w, "with", 4) != 0) return NULL;
+  w += 4; while (*w == ' ' || *w == '\t') w++;
+  if (strncmp(w, "rows", 4) != 0) return NULL;
+  w += 4; while (*w == ' ' || *w == '\t') w++;
+
+  rows_s *r = calloc(1, sizeof(rows_s));
+
+  char **names = NULL;
+  size_t ncount = 0;
+
+  if (*w == '(') // names
+  {
+    char *e = strchr(w, ')'); if (e == NULL) e = w + strlen(w);
+    char *ns = flu_sprintf("{%.*s}", (int)(e - w - 1), w + 1);
+    ncount = split_row(ns, &names);
+    free(ns);
+    w = *e ? e + 1 : e;
+  }
+
+  flu_sbuffer *b = NULL;
+  flu_list *rows = flu_list_malloc();
+  flu_list *lines = flu_list_malloc();
+  int depth = 0, string = 0, escape = 0, bare = 0;
+  char *lin = NULL; size_t len = 0;
+
+  for (char *c = w; ; c++)
+  {
+    if (*c == '\0' || *c == '\n' || *c == '\r') // next line
+    {
+      if (depth == 0 && rows->size > 0) break;
+      if (getline(&lin, &len, in) == -1) break;
+      (*lnumber)++;
+      c = lin - 1; continue;
+    }
+
+    if ( ! string && *c == '/' && c[1] == '/') // comment, till the end of line
+    {
+      c += strlen(c) - 1; continue;
+    }
+
+    int ended = 0;
+
+    if (string) { if ( ! escape && *c == string) string = 0; }
+    else if (*c == '"' || *c == '\'') string = *c;
+    else if (*c == '{' || *c == '(' || *c == '[') depth++;
+    else if (*c == '}' || *c == ')' || *c == ']') depth--;
+
+    escape = ! escape && *c == '\\';
+
+    if (depth == 1 && b == NULL) // between rows
+    {
+      if (strchr("{ \t,", *c)) continue;
+      bare = 1; // rows { 1, 2, 3 }, a single column
+      b = flu_sbuffer_malloc(); flu_sbputs(b, "{ ");
+      flu_list_add(lines, (void *)(long)*lnumber);
+    }
+    else if (depth == 2 && b == NULL && *c == '{')
+    {
+      b = flu_sbuffer_malloc();
+      flu_list_add(lines, (void *)(long)*lnumber);
+    }
+
+    if (b && bare && depth <= 1 && ! string && (*c == ',' || *c == '}'))
+    {
+      ended = 1; flu_sbputs(b, " }");
+    }
+    else if (b)
+    {
+      flu_sbputc(b, *c);
+      ended = ! bare && depth == 1 && *c == '}';
+    }
+
+    if (ended) { flu_list_add(rows, flu_sbuffer_to_string(b)); b = NULL; bare = 0; }
+
+    if (depth == 0 && rows->size > 0) // past the rows, a body?
+    {
+      *hasbody = strchr(c + 1, '{') != NULL; break;
+    }
+  }
+
+  free(lin);
+  if (b) flu_sbuffer_free(b);
+
+  r->count = rows->size;
+  r->rows = (char **)flu_list_to_array(rows, 0);
+  r->lines = calloc(r->count + 1, sizeof(int));
+  r->titles = calloc(r->count + 1, sizeof(char *));
+
+  size_t i = 0;
+  for (flu_node *fn = lines->first; fn; fn = fn->next) r->lines[i++] = (int)(long)fn->item;
+
+  flu_list_free(rows);
+  flu_list_free(lines);
+
+  for (i = 0; i < r->count; i++)
+  {
+    char **cols = NULL;
+    size_t cc = split_row(r->rows[i], &cols);
+
+    r->titles[i] = row_title(text, cols, cc, i);
+
+    if (i == 0) { r->firsts = cols; r->ccount = cc; continue; }
+
+    for (size_t j = 0; j < cc; j++) free(cols[j]);
+    free(cols);
+  }
+
+  r->names = calloc(r->ccount + 1, sizeof(char *));
+
+  for (i = 0; i < r->ccount; i++)
+  {
+    r->names[i] = i < ncount ? strdup(names[i]) : flu_sprintf("c%zu", i);
+  }
+
+  for (i = 0; i < ncount; i++) free(names[i]);
+  free(names);
+
+  if (r->count < 1) { free_rows(r); return NULL; }
+
+  return r;
+}
+
+void process_lines(context_s *c, char *path)
+{
+  push(c, 0, 'g', NULL, path, 0);
+
+  FILE *in = fopen(path, "r");
+  if (in == NULL) return;
+
+  int lnumber = 0;
+  char *line = NULL;
+  size_t len = 0;
+  int comment = 0;
+
+  while (getline(&line, &len, in) != -1)
+  {
+    lnumber++;
+
+    line_s *l = split(comment, line);
+
+    //printf("** >[1;33m%s[0;00m<\n", line);
+    //char *ls = line_s_to_s(l, 1); printf("   %s\n", ls); free(ls);
+
+    comment = l->comment;
+
+    int cindent = -1;
+    if (c->node != NULL) cindent = c->node->indent;
+
+    char *head = l->head ? l->head : "";
+
+    if (strcmp(head, "{") == 0 && l->indent == cindent)
+    {
+      c->node->hasbody = 1;
+    }
+    else if (strcmp(head, "}") == 0 && l->indent <= cindent)
+    {
+      //printf("i: %d, ci: %d, ct: %c\n", indent, cindent, ctype);
+      pull(c, l->indent, lnumber);
+    }
+    else if (strcmp(head, "before") == 0 || strcmp(head, "after") == 0)
+    {
+      char *tline = flu_sprintf("%s %s", l->head, l->text);
+      char t = 'b'; // "before each"
+      if (strcmp(tline, "before all") == 0) t = 'B';
+      else if (strcmp(tline, "before each offline") == 0) t = 'y';
+      else if (strcmp(tline, "after each offline") == 0) t = 'z';
+      else if (strcmp(tline, "after each") == 0) t = 'a';
+      else if (strcmp(tline, "after all") == 0) t = 'A';
+      push(c, l->indent, t, tline, path, lnumber);
+      free(tline);
+    }
+    else if (strcmp(head, "describe") == 0 || strcmp(head, "context") == 0)
+    {
+      push(c, l->indent, *head, l->text, path, lnumber);
+      if (is_concurrent(l->line)) { c->node->concurrent = 1; c->concurrent = 1; }
+    }
+    else if (strcmp(head, "it") == 0 || strcmp(head, "they") == 0)
+    {
+      int hasbody = flu_strends(l->line, "{");
+      int lstart = lnumber;
+      rows_s *rows = parse_rows(in, &lnumber, l->line, l->text, &hasbody);
+      push(c, l->indent, 'i', rows ? rows->titles[0] : l->text, path, lstart);
+      if (hasbody) c->node->hasbody = 1;
+      if (rows) c->node->rows = rows; else parse_stress(c, l->line);
+    }
+    else if (is_block(l, "fuzz"))
+    {
+      push(c, l->indent, 'i', l->text, path, lnumber);
+      if (flu_strends(l->line, "{")) c->node->hasbody = 1;
+      parse_fuzz(c, l->line);
+    }
+    else if (is_block(l, "compare"))
+    {
+      push(c, l->indent, 'i', l->text, path, lnumber);
+      if (flu_strends(l->line, "{")) c->node->hasbody = 1;
+      parse_compare(c, l->line);
+    }
+    else if (is_block(l, "variant") && c->node->compare)
+    {
+      push_variant(c, l);
+    }
+    else if (is_block(l, "benchmark"))
+    {
+      push(c, l->indent, 'i', l->text, path, lnumber);
+      if (flu_strends(l->line, "{")) c->node->hasbody = 1;
+      parse_benchmark(c, l->line);
+      if (c->node->sizes == NULL) c->node->sizes = strdup("1, 1, 2.0, '*'");
+    }
+    else if (
+      strcmp(head, "measure") == 0 && c->node->sizes &&
+      strchr(" \t{", l->line[l->indent + 7])
+    )
+    {
+      push_measure(c, l);
+    }
+    else if (strcmp(head, "ensure") == 0 || strcmp(head, "expect") == 0)
+    {
+      lnumber = push_ensure(c, in, l->indent, lnumber, l->line);
+    }
+    else if (
+      (strcmp(head, "let") == 0 || strcmp(head, "let!") == 0) &&
+      strchr("dcg", c->node->type)
+    )
+    {
+      lnumber = push_let(c, in, l->indent, lnumber, l->line);
+    }
+    else if (strcmp(head, "pending") == 0)
+    {
+      push_pending(c, l, path, lnumber);
+    }
+    else
+    {
+      push_line(c, line);
+    }
+
+    line_s_free(l);
+  }
+
+  free(line);
+  fclose(in);
+
+  c->loffset += lnumber;
+}
+
+//#include "header.c"
+
+void print_eaches(FILE *out, char *indent, char t, node_s *n)
+{
+  if (n == NULL) return;
+
+  if (t == 'b') print_eaches(out, indent, t, n->parent);
+
+  for (node_s *cn = n->eaches; cn != NULL; cn = cn->next_each)
+  {
+    if (cn->type != t) continue;
+
+    flu_sbuffer_close(cn->lines);
+
+    if (t == 'a') fputs("\n", out);
+    fprintf(out, "%s  // %s li%d\n", indent, cn->text, cn->lstart);
+    fputs(cn->lines->string, out);
+    if (t == 'b') fputs("\n", out);
+  }
+
+  if (t == 'a') print_eaches(out, indent, t, n->parent);
+}
+
+static size_t gather_lets(node_s *n, node_s **lets, size_t count)
+{
+  // from the root down, in declaration order, an inner let takes the
+  // place of an outer one with the same name
+
+  if (n == NULL) return count;
+
+  count = gather_lets(n->parent, lets, count);
+
+  for (node_s *cn = n->eaches; cn != NULL; cn = cn->next_each)
+  {
+    if (cn->type != 'l') continue;
+
+    size_t i = 0;
+    while (i < count && strcmp(lets[i]->text, cn->text) != 0) i++;
+
+    lets[i] = cn; if (i == count) count++;
+  }
+
+  return count;
+}
+
+static size_t count_lets(node_s *n)
+{
+  size_t count = 0;
+
+  for (; n != NULL; n = n->parent)
+  {
+    for (node_s *cn = n->eaches; cn != NULL; cn = cn->next_each)
+    {
+      if (cn->type == 'l') count++;
+    }
+  }
+
+  return count;
+}
+
+static void print_lets(FILE *out, char *indent, node_s *n, int define)
+{
+  // lazy, memoized, fixtures, each let is a #define around a local
+  // variable, computed on first use (stored via rdz_let_set()),
+  // cleaned up after the example
+
+  size_t count = count_lets(n); if (count < 1) return;
+
+  node_s **lets = calloc(count, sizeof(node_s *));
+  count = gather_lets(n, lets, 0);
+
+  if ( ! define) fputs("\n", out);
+
+  for (size_t i = 0; i < count; i++)
+  {
+    node_s *l = lets[define ? i : count - 1 - i];
+    char *na = l->text;
+
+    if (define)
+    {
+      fprintf(out, "%s  // let%s %s li%d\n", indent, l->eager ? "!" : "", na, l->lstart);
+      fprintf(
+        out, "%s  __typeof__(((void)0, %s)) __let_%s __attribute__((unused));\n",
+        indent, l->expr, na);
+      fprintf(
+        out, "%s  int __let_%s_set __attribute__((unused)) = 0;\n",
+        indent, na);
+      fprintf(
+        out, "%s#define %s (*(__let_%s_set ? &__let_%s : "
+        "(__typeof__(__let_%s) *)rdz_let_set(&__let_%s_set, &__let_%s, "
+        "(__typeof__(__let_%s)[1]){ (%s) }, sizeof(__let_%s))))\n",
+        indent, na, na, na, na, na, na, na, l->expr, na);
+      if (l->eager) fprintf(out, "%s  (void)%s;\n", indent, na);
+    }
+    else
+    {
+      if (l->cleanup)
+      {
+        fprintf(out, "%s  if (__let_%s_set) { %s }\n", indent, na, l->cleanup);
+      }
+      fprintf(out, "%s#undef %s\n", indent, na);
+    }
+  }
+
+  free(lets);
+}
+
+static char *neutralize(char *fname)
+{
+  char *r = strdup(fname);
+  size_t l = strlen(fname);
+
+  for (size_t i = 0; i < l; i++)
+  {
+    char c = r[i];
+    if (c >= 48 && c <= 57) continue; // 0-9
+    if (c >= 65 && c <= 90) continue; // A-Z
+    if (c >= 97 && c <= 122) continue; // a-z
+    r[i] = '_';
+  }
+
+  return r;
+}
+
+void print_node(FILE *out, node_s *n)
+{
+  char t = n->type;
+
+  if (t == 'b' || t == 'a' || t == 'l') return;
+  if (t == 'i' && n->first != NULL) return;
+
+  char *ind;
+  if (n->indent > 0)
+  {
+    ind = calloc(n->indent + 1, sizeof(char));
+    for (int i = 0; i < n->indent; i++) ind[i] = ' ';
+  }
+  else
+  {
+    ind = strdup("");
+  }
+
+  char *i_func = NULL;
+  if (t == 'i')
+  {
+    char *nfname = neutralize(n->fname);
+    i_func = flu_sprintf("it_%d__%s__l%d", n->nodenumber, nfname, n->lstart);
+    free(nfname);
+  }
+
+  if (t == 'g' && n->lstart == 0)
+  {
+    fprintf(
+      out, "// file %s\n", n->fname);
+  }
+  else if (t == 'd' || t == 'c' || t == 'i')
+  {
+    fprintf(
+      out, "\n");
+    fprintf(
+      out, "%s// %s \"%s\" li%d\n", ind, type_to_string(t), n->text, n->lstart);
+    fprintf(
+      out, "%s// file %s\n", ind, n->fname);
+
+    if (t == 'i') fprintf(out, "%s//\n", ind);
+  }
+
+  if (t == 'i' && n->tmpl) // another row, calls the first row's function
+  {
+    char *nfname = neutralize(n->fname);
+    char *t_func = flu_sprintf(
+      "it_%d__%s__l%d", n->tmpl->nodenumber, nfname, n->tmpl->lstart);
+    free(nfname);
+
+    fprintf(
+      out, "%sdouble %s() { return %s__rows(%d, %s_rows + %d); }\n",
+      ind, i_func, t_func, n->nodenumber, t_func, n->row);
+
+    free(t_func); free(i_func); free(ind);
+
+    return;
+  }
+
+  int offline = (t == 'B' || t == 'A' || t == 'y' || t == 'z');
+  char *type = "none";
+
+  if (n->lines != NULL) flu_sbuffer_close(n->lines);
+
+  int over =
+    n->lines != NULL && strstr(n->lines->string, ") goto _over;\n") != NULL;
+
+  if (t == 'i' && n->threads > 0)
+  {
+    // the body goes into its own function, run by each of the threads
+
+    fprintf(out, "%sstatic void %s_thread(rdz_stress_thread *__st)\n", ind, i_func);
+    fprintf(out, "%s{\n", ind);
+    fprintf(out, "%s  int rdz_thread = __st->thread; (void)rdz_thread;\n", ind);
+    fprintf(out, "%s  long rdz_iteration = 0;\n", ind);
+
+    print_lets(out, ind, n->parent, 1);
+    print_eaches(out, ind, 'b', n->parent);
+      // each thread gets its lets and its before/after each
+
+    fprintf(out, "%s  for (; rdz_iteration < __st->iterations; __st->done = ++rdz_iteration)\n", ind);
+    fprintf(out, "%s  {\n", ind);
+    if (n->lines != NULL) fputs(n->lines->string, out);
+    fprintf(out, "%s  }\n", ind);
+    if (over) fprintf(out, "%s_over:\n", ind);
+    fprintf(out, "%s  __st->done = rdz_iteration;\n", ind);
+
+    print_eaches(out, ind, 'a', n->parent);
+    print_lets(out, ind, n->parent, 0);
+
+    fprintf(out, "%s} // %s_thread()\n", ind, i_func);
+    fprintf(out, "\n");
+
+    fprintf(out, "%sdouble %s()\n", ind, i_func);
+    fprintf(out, "%s{\n", ind);
+    fprintf(out, "%s  double __start = rdz_now();", ind);
+    fprintf(out, " double __duration = 0.0;\n");
+
+    fprintf(out,
+      "%s  rdz_stress_run(%s_thread, %d, %ldL, %d);\n",
+      ind, i_func, n->threads, n->iterations, n->nodenumber);
+
+    over = 0;
+  }
+  else if (t == 'i' && n->rows)
+  {
+    // one function for all the rows, each row gets a tiny function calling
+    // it with the row and its own node number
+
+    rows_s *r = n->rows;
+
+    fprintf(out, "%stypedef struct %s_row {\n", ind, i_func);
+    for (size_t i = 0; i < r->ccount; i++)
+    {
+      fprintf(
+        out, "%s  __typeof__(((void)0, %s)) %s;\n", ind, r->firsts[i], r->names[i]);
+    }
+    fprintf(out, "%s} %s_row;\n", ind, i_func);
+    fprintf(out, "%sstatic const %s_row %s_rows[] = {\n", ind, i_func, i_func);
+    for (size_t i = 0; i < r->count; i++)
+    {
+      fprintf(out, "%s  %s, // li%d\n", ind, r->rows[i], r->lines[i]);
+    }
+    fprintf(out, "%s};\n", ind);
+    fprintf(out, "\n");
+
+    fprintf(
+      out, "%sstatic double %s__rows(int __rdz_it, const %s_row *row)\n",
+      ind, i_func, i_func);
+    fprintf(out, "%s{\n", ind);
+    fprintf(out, "%s  (void)__rdz_it; (void)row;\n", ind);
+    fprintf(out, "%s  double __start = rdz_now();", ind);
+    fprintf(out, " double __duration = 0.0;\n");
+
+    print_lets(out, ind, n->parent, 1);
+    print_eaches(out, ind, 'b', n->parent);
+  }
+  else if (t == 'i' && n->compare)
+  {
+    // the body takes the variant to run, rdz_compare_run() interleaves them
+
+    fprintf(out, "%sstatic double %s__compare(int __rdz_variant)\n", ind, i_func);
+    fprintf(out, "%s{\n", ind);
+    fprintf(out, "%s  double __start = rdz_now();", ind);
+    fprintf(out, " double __duration = 0.0;\n");
+
+    print_lets(out, ind, n->parent, 1);
+    print_eaches(out, ind, 'b', n->parent);
+  }
+  else if (t == 'i' && n->sizes)
+  {
+    // the body takes the size, rdz_benchmark_run() times it for each size
+
+    fprintf(out, "%sstatic double %s__bench(size_t n)\n", ind, i_func);
+    fprintf(out, "%s{\n", ind);
+    fprintf(out, "%s  (void)n;\n", ind);
+    fprintf(out, "%s  double __start = rdz_now();", ind);
+    fprintf(out, " double __duration = 0.0;\n");
+
+    print_lets(out, ind, n->parent, 1);
+    print_eaches(out, ind, 'b', n->parent);
+  }
+  else if (t == 'i' && n->fuzz)
+  {
+    // the body takes the input, rdz_fuzz_run() replays the corpus through it
+
+    fprintf(out, "%sstatic double %s__fuzz(%s)\n", ind, i_func, n->fuzz);
+    fprintf(out, "%s{\n", ind);
+    fprintf(out, "%s  double __start = rdz_now();", ind);
+    fprintf(out, " double __duration = 0.0;\n");
+
+    print_lets(out, ind, n->parent, 1);
+    print_eaches(out, ind, 'b', n->parent);
+  }
+  else if (t == 'i')
+  {
+    fprintf(out, "%sdouble %s()\n", ind, i_func);
+    fprintf(out, "%s{\n", ind);
+    fprintf(out, "%s  double __start = rdz_now();", ind);
+    fprintf(out, " double __duration = 0.0;\n");
+
+    print_lets(out, ind, n->parent, 1);
+    print_eaches(out, ind, 'b', n->parent);
+  }
+  else if (offline)
+  {
+    type = "before_all";
+    if (t == 'A') type = "after_all";
+    else if (t == 'y') type = "before_each_offline";
+    else if (t == 'z') type = "after_each_offline";
+
+    fprintf(out, "\n");
+    fprintf(out, "%sdouble %s_%d()", ind, type, n->nodenumber);
+    fprintf(out, " // li%d\n", n->lstart);
+    fprintf(out, "%s{\n", ind);
+  }
+
+  if (n->lines != NULL && (t != 'i' || n->threads < 1))
+  {
+    fputs(n->lines->string, out);
+  }
+
+  if (t == 'i')
+  {
+    fprintf(out, "\n");
+
+    if (over) fprintf(out, "%s_over:\n", ind);
+
+    if (n->compare || n->sizes) fprintf(out, "%s  rdz_variant_stop();\n", ind);
+
+    fprintf(out, "\n%s  __duration = rdz_duration(__start);", ind);
+
+    if (n->threads < 1) // else done in the thread function
+    {
+      print_eaches(out, ind, 'a', n->parent);
+      print_lets(out, ind, n->parent, 0);
+    }
+
+    fprintf(out, "\n");
+    fprintf(out, "%s  return __duration;\n", ind);
+
+    if (n->rows)
+    {
+      fprintf(out, "%s} // %s__rows()\n", ind, i_func);
+      fprintf(out, "\n");
+      fprintf(
+        out, "%sdouble %s() { return %s__rows(%d, %s_rows + 0); }\n",
+        ind, i_func, i_func, n->nodenumber, i_func);
+    }
+    else if (n->compare)
+    {
+      int w = -1;
+      for (int i = 0; w < 0 && n->winner && i < n->vcount; i++)
+      {
+        if (strcmp(n->vnames[i], n->winner) == 0) w = i;
+      }
+      if (n->winner && w < 0) w = -2; // faster("x") names no variant
+
+      fprintf(out, "%s} // %s__compare()\n", ind, i_func);
+      fprintf(out, "\n");
+      fprintf(out, "%sstatic const char *%s_variants[] = {", ind, i_func);
+      for (int i = 0; i < n->vcount; i++) fprintf(out, " \"%s\",", n->vnames[i]);
+      fprintf(out, " NULL };\n");
+      fprintf(
+        out, "%sdouble %s() { return rdz_compare_run(%d, %s__compare, %s_variants, %d, %d); }\n",
+        ind, i_func, n->nodenumber, i_func, i_func, n->vcount, w);
+    }
+    else if (n->sizes)
+    {
+      fprintf(out, "%s} // %s__bench()\n", ind, i_func);
+      fprintf(out, "\n");
+      fprintf(
+        out, "%sdouble %s() { return rdz_benchmark_run(%d, %s__bench, %s, ",
+        ind, i_func, n->nodenumber, i_func, n->sizes);
+      if (n->complexity) fprintf(out, "\"%s\"); }\n", n->complexity);
+      else fprintf(out, "NULL); }\n");
+    }
+    else if (n->fuzz)
+    {
+      fprintf(out, "%s} // %s__fuzz()\n", ind, i_func);
+      fprintf(out, "\n");
+      fprintf(
+        out, "%sdouble %s() { return rdz_fuzz_run(%d, %s__fuzz); }\n",
+        ind, i_func, n->nodenumber, i_func);
+    }
+    else
+    {
+      fprintf(out, "%s} // %s()\n", ind, i_func);
+    }
+  }
+  else if (offline)
+  {
+    fprintf(out, "%s  return 0.0;\n", ind);
+    fprintf(out, "%s} // %s_%d()\n", ind, type, n->nodenumber);
+  }
+
+  free(i_func);
+  free(ind);
+
+  for (node_s *cn = n->first; cn != NULL; cn = cn->next)
+  {
+    print_node(out, cn);
+  }
+}
+
+void print_sites(FILE *out, context_s *c)
+{
+  if (c->sitecount < 1) return;
+
+  flu_sbuffer_close(c->sites);
+
+  fprintf(out, "\n");
+  fprintf(out, "static const rdz_site rdz_sites[] = {\n");
+  fputs(c->sites->string, out);
+  fprintf(out, "};\n");
+}
+
+void print_body(FILE *out, context_s *c)
+{
+  node_s *n = c->node; while (n->parent != NULL) n = n->parent;
+
+  print_node(out, n);
+
+  if (c->debug == 0) return; // -d or return
+
+  // print tree to ./spec_tree.txt
+
+  FILE *f = fopen("spec_tree.txt", "wb");
+  char *s = node_to_string(n);
+  fputs("\n", f); fputs(s, f); fputs("\n", f);
+  //puts("\n"); puts(s); // print to stdout as well
+  free(s);
+  fclose(f);
+
+  // print pseudo to ./spec_pseudo.txt
+
+  f = fopen("spec_pseudo.txt", "wb");
+  s = node_to_pseudo(n);
+  fputs("\n", f); fputs(s, f); fputs("\n", f);
+  free(s);
+  fclose(f);
+}
+
+char *node_func(node_s *n)
+{
+  char t = n->type;
+
+  if (t == 'i' && n->first != NULL) return strdup("NULL");
+
+  if (t == 'i')
+  {
+    char *nfname = neutralize(n->fname);
+    char *r = flu_sprintf("it_%d__%s__l%d", n->nodenumber, nfname, n->lstart);
+    free(nfname);
+
+    return r;
+  }
+
+  if (t == 'B') return flu_sprintf("before_all_%d", n->nodenumber);
+  if (t == 'A') return flu_sprintf("after_all_%d", n->nodenumber);
+  if (t == 'y') return flu_sprintf("before_each_offline_%d", n->nodenumber);
+  if (t == 'z') return flu_sprintf("after_each_offline_%d", n->nodenumber);
+
+  return strdup("NULL");
+}
+
+static size_t c_strlen(char *s)
+{
+  // length of the string literal content s, once its escapes are resolved
+
+  size_t l = 0;
+
+  for (char *c = s; *c != '\0'; ++c, ++l)
+  {
+    if (*c != '\\' || c[1] == '\0') continue;
+
+    ++c;
+
+    if (*c == 'x')
+    {
+      while (isxdigit(c[1])) ++c;
+    }
+    else if (*c >= '0' && *c <= '7')
+    {
+      for (int i = 0; i < 2 && c[1] >= '0' && c[1] <= '7'; ++i) ++c;
+    }
+  }
+
+  return l;
+}
+
+void index_nodes(node_s **index, int *depths, int depth, node_s *n)
+{
+  index[n->nodenumber] = n;
+  depths[n->nodenumber] = depth;
+
+  for (node_s *cn = n->first; cn != NULL; cn = cn->next)
+  {
+    index_nodes(index, depths, depth + 1, cn);
+  }
+}
+
+void print_table(FILE *out, char *type, char *name, int *values, int count)
+{
+  fprintf(out, "static const %s rdz_t_%s[] = {", type, name);
+
+  for (int i = 0; i < count; i++)
+  {
+    if (i % 16 == 0) fputs("\n ", out);
+    if (*type == 'c') fprintf(out, " '%c',", values[i]);
+    else fprintf(out, " %d,", values[i]);
+  }
+
+  fprintf(out, "\n};\n");
+}
+
+void print_nodes(FILE *out, context_s *c, node_s *root)
+{
+  int count = c->nodecount;
+
+  node_s **index = calloc(count, sizeof(node_s *));
+  int *depths = calloc(count, sizeof(int));
+
+  index_nodes(index, depths, 0, root);
+
+  int *values = calloc(count, sizeof(int));
+
+  // types, parents, depths, lines
+
+  for (int i = 0; i < count; i++) values[i] = index[i]->type;
+  print_table(out, "char", "types", values, count);
+
+  for (int i = 0; i < count; i++)
+  {
+    node_s *p = index[i]->parent; values[i] = p ? p->nodenumber : -1;
+  }
+  print_table(out, "int", "parents", values, count);
+
+  print_table(out, "int", "depths", depths, count);
+
+  for (int i = 0; i < count; i++) values[i] = index[i]->lstart;
+  print_table(out, "int", "lstarts", values, count);
+
+  for (int i = 0; i < count; i++) values[i] = index[i]->ltstart;
+  print_table(out, "int", "ltstarts", values, count);
+
+  for (int i = 0; i < count; i++) values[i] = index[i]->llength;
+  print_table(out, "int", "llengths", values, count);
+
+  // children
+
+  int ccount = 0;
+
+  for (int i = 0; i < count; i++)
+  {
+    values[i] = ccount;
+    for (node_s *cn = index[i]->first; cn != NULL; cn = cn->next) ccount++;
+  }
+  print_table(out, "int", "coffsets", values, count);
+
+  for (int i = 0; i < count; i++)
+  {
+    values[i] = 0;
+    for (node_s *cn = index[i]->first; cn != NULL; cn = cn->next) values[i]++;
+  }
+  print_table(out, "int", "ccounts", values, count);
+
+  int *children = calloc(ccount + 1, sizeof(int));
+  for (int i = 0, k = 0; i < count; i++)
+  {
+    node_s *cn = index[i]->first;
+    for (; cn != NULL; cn = cn->next) children[k++] = cn->nodenumber;
+  }
+  print_table(out, "int", "children", children, ccount + 1);
+  free(children);
+
+  // string pool, texts and fnames are offsets into it
+
+  int *fnames = calloc(count, sizeof(int));
+  int *deps = calloc(count, sizeof(int));
+  size_t offset = 1; // offset 0 is ""
+
+  fprintf(out, "static const char rdz_t_strings[] =\n");
+  fprintf(out, "  \"\\0\" // 0\n");
+
+  for (int i = 0; i < count; i++)
+  {
+    node_s *n = index[i];
+    char t = n->type;
+
+    values[i] = 0;
+
+    if (t == 'i' || t == 'd' || t == 'c' || t == 'p')
+    {
+      fprintf(out, "  \"%s\\0\" // %zu\n", n->text, offset);
+      values[i] = offset;
+      offset += c_strlen(n->text) + 1;
+    }
+
+    fnames[i] = 0;
+    deps[i] = 0;
+
+    if (n->fname == NULL) continue;
+
+    for (int j = i - 1; j >= 0; j--)
+    {
+      if (index[j]->fname == n->fname)
+      {
+        fnames[i] = fnames[j]; deps[i] = deps[j]; break;
+      }
+    }
+    if (fnames[i] > 0) continue;
+
+    fprintf(out, "  \"%s\\0\" // %zu\n", n->fname, offset);
+    fnames[i] = offset;
+    offset += c_strlen(n->fname) + 1;
+
+    char *d = c->sdeps ? flu_list_get(c->sdeps, "%s", n->fname) : NULL;
+    if (d == NULL) continue;
+
+    fprintf(out, "  \"%s\\0\" // %zu\n", d, offset);
+    deps[i] = offset;
+    offset += c_strlen(d) + 1;
+  }
+  fprintf(out, "  ;\n");
+
+  print_table(out, "int", "texts", values, count);
+  print_table(out, "int", "fnames", fnames, count);
+  print_table(out, "int", "deps", deps, count);
+
+  for (int i = 0; i < count; i++)
+  {
+    values[i] =
+      index[i]->concurrent |
+      (index[i]->threads > 0 ? 2 : 0) |
+      (index[i]->fuzz ? 4 : 0);
+  }
+  print_table(out, "int", "flags", values, count);
+
+  // functions
+
+  fprintf(out, "static rdz_func *const rdz_t_funcs[] = {\n");
+  for (int i = 0; i < count; i++)
+  {
+    char *func = node_func(index[i]);
+    fprintf(out, "  %s, // %d\n", func, i);
+    free(func);
+  }
+  fprintf(out, "};\n");
+
+  fprintf(out, "\n");
+  fprintf(out, "static const rdz_tree rdz_spec_tree = {\n");
+  fprintf(out, "  %d,\n", count);
+  fprintf(out, "  rdz_t_types, rdz_t_parents, rdz_t_depths,\n");
+  fprintf(out, "  rdz_t_lstarts, rdz_t_ltstarts, rdz_t_llengths,\n");
+  fprintf(out, "  rdz_t_coffsets, rdz_t_ccounts, rdz_t_children,\n");
+  fprintf(out, "  rdz_t_texts, rdz_t_fnames, rdz_t_deps, rdz_t_flags,\n");
+  fprintf(out, "  rdz_t_strings,\n");
+  fprintf(out, "  rdz_t_funcs\n");
+  fprintf(out, "};\n");
+
+  free(fnames);
+  free(deps);
+  free(values);
+  free(depths);
+  free(index);
+}
+
+void print_footer(FILE *out, context_s *c)
+{
+  fprintf(out, "\n");
+  fprintf(out, "  /*\n");
+  fprintf(out, "   * rodzo footer\n");
+  fprintf(out, "   */\n\n");
+
+  node_s *n = c->node; while (n->parent != NULL) n = n->parent;
+
+  print_nodes(out, c, n);
+  fprintf(out, "\n");
+
+  fprintf(out, "int rdz_main()\n");
+  fprintf(out, "{\n");
+
+  fprintf(out, "  rdz_extract_arguments();\n");
+  fprintf(out, "\n");
+
+  fprintf(out, "  rdz_t = &rdz_spec_tree;\n");
+  fprintf(out, "  rdz_doruns = calloc(%d, sizeof(int));\n", c->nodecount);
+  fprintf(out, "\n");
+
+  int count = c->encount + c->itcount;
+  //
+  fprintf(out, "  rdz_results_size = %d;\n", count);
+  fprintf(out, "  rdz_results = calloc(rdz_results_size, sizeof(rdz_result));\n");
+  fprintf(out, "\n");
+
+  fprintf(out, "  rdz_determine_dorun();\n");
+  fprintf(out, "\n");
+  fprintf(out, "  double start = rdz_now();\n");
+  fprintf(out, "  rdz_run();\n");
+  fprintf(out, "  double duration = rdz_duration(start);\n");
+
+  fprintf(out, "\n");
+  fprintf(out, "  rdz_summary(%d, duration);\n", c->itcount);
+  fprintf(out, "  rdz_coverage_map();\n");
+
+  fprintf(out, "\n");
+  fprintf(out, "  for (size_t i = 0; i < rdz_count; i++) rdz_result_clear(rdz_results + i);\n");
+  fprintf(out, "  free(rdz_results);\n");
+  fprintf(out, "  free(rdz_doruns);\n");
+
+  fprintf(out, "\n");
+  fprintf(out, "  free(rdz_lines);\n");
+  fprintf(out, "  for (size_t i = 0; rdz_files && rdz_files[i]; i++) free(rdz_files[i]);\n");
+  fprintf(out, "  free(rdz_files);\n");
+
+  fprintf(out, "\n");
+  fprintf(out, "  return rdz_fail_count;\n");
+  fprintf(out, "}\n");
+  fprintf(out, "\n");
+
+  if (c->fuzz) // libFuzzer (or AFL++, honggfuzz, ...) brings its own main()
+  {
+    fprintf(out, "int LLVMFuzzerInitialize(int *argc, char ***argv)\n");
+    fprintf(out, "{\n");
+    fprintf(out, "  (void)argc; (void)argv;\n");
+    fprintf(out, "\n");
+    fprintf(out, "  rdz_extract_arguments();\n");
+    fprintf(out, "\n");
+    fprintf(out, "  rdz_t = &rdz_spec_tree;\n");
+    fprintf(out, "  rdz_doruns = calloc(%d, sizeof(int));\n", c->nodecount);
+    fprintf(out, "  rdz_results_size = %d;\n", count);
+    fprintf(out, "  rdz_results = calloc(rdz_results_size, sizeof(rdz_result));\n");
+    fprintf(out, "\n");
+    fprintf(out, "  rdz_determine_dorun();\n");
+    fprintf(out, "  rdz_fuzz_init();\n");
+    fprintf(out, "\n");
+    fprintf(out, "  return 0;\n");
+    fprintf(out, "}\n");
+    fprintf(out, "\n");
+    fprintf(out, "int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)\n");
+    fprintf(out, "{\n");
+    fprintf(out, "  return rdz_fuzz_one(data, size);\n");
+    fprintf(out, "}\n");
+    fprintf(out, "\n");
+
+    return;
+  }
+
+  fprintf(out, "int main(int argc, char *argv[])\n");
+  fprintf(out, "{\n");
+  fprintf(out, "  rdz_main();\n");
+  fprintf(out, "}\n");
+  fprintf(out, "\n");
+}
+
+void add_spec_path(flu_list *l, flu_list *dirs, char *path)
+{
+  if (flu_strends(path, ".")) return;
+
+  if (flu_strends(path, "_spec.c")) {
+    if (access(path, F_OK) == 0) flu_list_add_unique(l, strdup(path));
+    return;
+  }
+
+  DIR *dir = opendir(path);
+
+  if (dir == NULL) return;
+
+  flu_list_add(dirs, strdup(path));
+
+  struct dirent *ep;
+  while ((ep = readdir(dir)) != NULL)
+  {
+    char *fn = flu_sprintf(
+      path[strlen(path) - 1] == '/' ? "%s%s" : "%s/%s", path, ep->d_name);
+
+    add_spec_path(l, dirs, fn);
+  }
+
+  closedir(dir);
+}
+
+flu_list *list_spec_files(int argc, char *argv[], flu_list *dirs)
+{
+  flu_list *l = flu_list_malloc();
+
+  int no_args = 1;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (*argv[i] == '-') continue;
+
+    no_args = 0;
+
+    glob_t gl;
+    glob(argv[i], GLOB_NOSORT, NULL, &gl);
+
+    for (size_t j = 0; j < gl.gl_pathc; j++)
+    {
+      add_spec_path(l, dirs, gl.gl_pathv[j]);
+    }
+
+    globfree(&gl);
+  }
+
+  if (no_args) add_spec_path(l, dirs, ".");
+
+  flu_list_isort(l, (int (*)(const void *, const void *))strcmp);
+
+  return l;
+}
+
+
+int deps_are_fresh(char *entry)
+{
+  // entry is "time file0 file1 ...", it's fresh if none of the files
+  // was modified since (or at the same second as) the time
+
+  char *s = entry;
+  long long t = strtoll(s, &s, 10);
+
+  while (1)
+  {
+    while (*s == ' ') ++s;
+    if (*s == '\0') break;
+
+    char *e = strchr(s, ' ');
+    char *path = e ? strndup(s, e - s) : strdup(s);
+
+    struct stat st;
+    int r = stat(path, &st);
+    free(path);
+
+    if (r != 0 || (long long)st.st_mtime >= t) return 0;
+
+    if (e == NULL) break;
+    s = e;
+  }
+
+  return 1;
+}
+
+flu_dict *spec_deps(context_s *c, flu_list *fnames)
+{
+  // maps each spec file to "spec file + what it includes" (cc -MM),
+  // the map is cached in a .deps file next to the out file, only the
+  // spec files that (or whose includes) changed are passed to cc again
+
+  char *fname = strdup(c->out_fname);
+  if (flu_strends(fname, ".c")) fname[strlen(fname) - 2] = '\0';
+
+  char *cfname = flu_sprintf("%s.deps", fname);
+
+  flu_dict *cache = flu_readdict(cfname);
+  flu_dict *r = flu_list_malloc();
+  flu_sbuffer *b = flu_sbuffer_malloc();
+
+  long long now = (long long)time(NULL);
+
+  char *cc = getenv("CC");
+  flu_sbprintf(b, "%s -MM -x c", cc ? cc : "cc");
+  for (flu_node *n = c->includes->first; n != NULL; n = n->next)
+  {
+    flu_sbprintf(b, " %s", (char *)n->item);
+  }
+
+  size_t stale = 0;
+
+  for (flu_node *n = fnames->first; n != NULL; n = n->next)
+  {
+    char *e = cache ? flu_list_get(cache, "%s", n->item) : NULL;
+
+    if (e && deps_are_fresh(e))
+    {
+      flu_list_set(r, "%s", n->item, strdup(e)); continue;
+    }
+
+    flu_sbprintf(b, " %s", (char *)n->item); stale++;
+  }
+
+  char *cmd = flu_sbuffer_to_string(b);
+  char *out = stale > 0 ? flu_plines("%s", cmd) : NULL;
+
+  // "x_spec.o: ../spec/x_spec.c ../src/x.h \\\n ../src/y.h\n"
+
+  for (char *s = out; s && (s = strstr(s, "\\\n")); ) memset(s, ' ', 2);
+
+  for (char *s = out; s && *s; )
+  {
+    char *eol = strchr(s, '\n'); if (eol == NULL) eol = s + strlen(s);
+    char *col = strchr(s, ':');
+
+    if (col && col < eol)
+    {
+      flu_sbuffer *e = flu_sbuffer_malloc();
+      flu_sbprintf(e, "%lld", now);
+
+      char *key = NULL;
+
+      for (char *t = col + 1; t < eol; )
+      {
+        while (t < eol && *t == ' ') ++t;
+        size_t l = strcspn(t, " \n");
+        if (l == 0) break;
+
+        flu_sbputc(e, ' '); flu_sbputs_n(e, t, l);
+        if (key == NULL) key = strndup(t, l);
+
+        t += l;
+      }
+
+      char *v = flu_sbuffer_to_string(e);
+
+      if (key) flu_list_set(r, "%s", key, v); else free(v);
+      free(key);
+    }
+
+    s = *eol ? eol + 1 : eol;
+  }
+
+  // rewrite the cache
+
+  FILE *f = fopen(cfname, "wb");
+
+  if (f == NULL) flu_die(1, "couldn't open %s file for writing", cfname);
+
+  for (flu_node *n = fnames->first; n != NULL; n = n->next)
+  {
+    char *e = flu_list_get(r, "%s", n->item);
+    if (e) fprintf(f, "%s: %s\n", (char *)n->item, e);
+  }
+
+  fclose(f);
+
+  if (stale > 0) printf(". wrote %s (%zu/%zu)\n", cfname, stale, fnames->size);
+
+  // the tree only needs the file list, the time goes
+
+  for (flu_node *n = r->first; n != NULL; n = n->next)
+  {
+    char *e = n->item;
+    char *s = strchr(e, ' ');
+    if (s) memmove(e, s + 1, strlen(s + 1) + 1); else *e = '\0';
+  }
+
+  free(out);
+  free(cmd);
+  if (cache) flu_list_free_all(cache);
+  free(cfname);
+  free(fname);
+
+  return r;
+}
+
+void print_deps(context_s *c, flu_list *fnames, flu_list *dirs)
+{
+  // writes a make dependency file next to the out file, it lists the
+  // spec files (and the dirs they were found in, for new spec files),
+  // and touches a stamp file, s.stamp for s.c, the out file keeps its
+  // mtime when unchanged, the stamp tells make that rodzo did run
+
+  char *fname = strdup(c->out_fname);
+  if (flu_strends(fname, ".c")) fname[strlen(fname) - 2] = '\0';
+
+  char *dfname = flu_sprintf("%s.d", fname);
+
+  FILE *f = fopen(dfname, "wb");
+
+  if (f == NULL) flu_die(1, "couldn't open %s file for writing", dfname);
+
+  fprintf(f, "%s %s.stamp:", c->out_fname, fname);
+  for (flu_node *n = dirs->first; n != NULL; n = n->next)
+  {
+    fprintf(f, " \\\n  %s", (char *)n->item);
+  }
+  for (flu_node *n = fnames->first; n != NULL; n = n->next)
+  {
+    fprintf(f, " \\\n  %s", (char *)n->item);
+  }
+  fprintf(f, "\n");
+
+  for (flu_node *n = fnames->first; n != NULL; n = n->next)
+  {
+    fprintf(f, "\n%s:\n", (char *)n->item); // in case it gets removed
+  }
+
+  if (c->sdeps) // -MH, the spec executable and what the specs include
+  {
+    flu_list *hs = flu_list_malloc();
+
+    for (flu_node *n = fnames->first; n != NULL; n = n->next)
+    {
+      char *d = flu_list_get(c->sdeps, "%s", n->item);
+      if (d == NULL) continue;
+
+      flu_list *l = flu_split(d, " ");
+
+      // the spec file (first) is already a dependency of the out file,
+      // don't let it trigger a recompilation when the out file didn't change
+
+      for (flu_node *m = l->first ? l->first->next : NULL; m; m = m->next)
+      {
+        int seen = 0;
+        for (flu_node *h = hs->first; h != NULL; h = h->next)
+        {
+          if (strcmp(h->item, m->item) == 0) { seen = 1; break; }
+        }
+        if ( ! seen) flu_list_add(hs, strdup(m->item));
+      }
+
+      flu_list_free_all(l);
+    }
+
+    fprintf(f, "\n%s:", fname);
+    for (flu_node *h = hs->first; h != NULL; h = h->next)
+    {
+      fprintf(f, " \\\n  %s", (char *)h->item);
+    }
+    fprintf(f, "\n");
+
+    for (flu_node *h = hs->first; h != NULL; h = h->next)
+    {
+      fprintf(f, "\n%s:\n", (char *)h->item);
+    }
+
+    flu_list_free_all(hs);
+  }
+
+  fclose(f);
+
+  printf(". wrote %s\n", dfname);
+
+  char *sfname = flu_sprintf("%s.stamp", fname);
+
+  f = fopen(sfname, "wb"); // truncating is touching
+  if (f == NULL) flu_die(1, "couldn't open %s file for writing", sfname);
+  fclose(f);
+
+  free(sfname);
+  free(dfname);
+  free(fname);
+}
+
+
+//
+// main
+
+char *record_call(int argc, char **argv)
+{
+  flu_sbuffer *b = flu_sbuffer_malloc();
+
+  for (int i = 0; i < argc; ++i)
+  {
+    flu_sbputs(b, argv[i]); if (i < argc - 1) flu_sbputc(b, ' ');
+  }
+
+  return flu_sbuffer_to_string(b);
+}
+
+char *grab_git_info(char *path)
+{
+  char *dir = flu_dirname(path);
+  char *r = flu_plines("cd %s && git show | head -5", dir);
+  free(dir);
+
+  if (strncmp(r, "fatal:", 6) == 0) { free(r); return NULL; }
+  if (strlen(r) < 1) { free(r); return NULL; }
+  return r;
+}
+
+int same_content(char *path0, char *path1)
+{
+  struct stat s0; if (stat(path0, &s0) != 0) return 0;
+  struct stat s1; if (stat(path1, &s1) != 0) return 0;
+
+  if (s0.st_size != s1.st_size) return 0;
+
+  char *c0 = flu_readall("%s", path0);
+  char *c1 = flu_readall("%s", path1);
+
+  int r = (c0 != NULL && c1 != NULL && strcmp(c0, c1) == 0);
+
+  free(c0);
+  free(c1);
+
+  return r;
+}
+
+int print_usage(char *arg0)
+{
+  fprintf(stderr, "" "\n");
+  fprintf(stderr, "# rodzo" "\n");
+  fprintf(stderr, "" "\n");
+  fprintf(stderr, "%s [-o outfile] [-d] [-r] [-MD|-MH [-Idir]] [--watch|--list] [--fuzz] [dirs or spec files]" "\n", arg0);
+  fprintf(stderr, "" "\n");
+  fprintf(stderr, "  turns a spec fileset into a compilable spec.c file" "\n");
+  fprintf(stderr, "" "\n");
+  fprintf(stderr, "  -r  reproducible output, no git info, no call line" "\n");
+  fprintf(stderr, "  -MD writes a make dependency file (spec files)" "\n");
+  fprintf(stderr, "  -MH same as -MD, plus the headers included by the spec files ($CC -MM)" "\n");
+  fprintf(stderr, "  --watch  regenerate, make and run the specs when a .c or .h changes" "\n");
+  fprintf(stderr, "  --list   list the describes, contexts and its as JSON lines" "\n");
+  fprintf(stderr, "  --fuzz   emit LLVMFuzzerTestOneInput() (for the fuzz blocks) instead of main()" "\n");
+  fprintf(stderr, "" "\n");
+
+  return 1;
+}
+
+void print_header(FILE *out);
+  // forward declaration ;-)
+
+context_s *parse_arguments(int argc, char *argv[])
+{
+  context_s *c = malloc_context();
+
+  int badarg = 0;
+  for (int i = 1; i < argc; ++i)
+  {
+    if (*argv[i] != '-') continue;
+    if (argv[i][1] == 'o') c->out_fname = strdup(argv[i + 1]);
+    else if (argv[i][1] == 'd') c->debug = 1;
+    else if (argv[i][1] == 'r') c->reproducible = 1;
+    else if (strcmp(argv[i], "-MD") == 0) c->deps = 1;
+    else if (strcmp(argv[i], "-MH") == 0) c->deps = 2;
+    else if (argv[i][1] == 'I') flu_list_add(c->includes, argv[i]);
+    else if (strcmp(argv[i], "--watch") == 0) c->watch = 1;
+    else if (strcmp(argv[i], "--list") == 0) c->list = 1;
+    else if (strcmp(argv[i], "--fuzz") == 0) c->fuzz = 1;
+    else badarg = 1;
+  }
+  if (badarg) { free_context(c); return NULL; }
+
+  if (c->out_fname == NULL) c->out_fname = strdup("spec.c");
+
+  return c;
+}
+
+void generate(context_s *c, int argc, char *argv[], flu_list *dirs)
+{
+  char *ginfo = c->reproducible ? NULL : grab_git_info(argv[0]);
+  char *call = c->reproducible ? NULL : record_call(argc, argv);
+
+  // reads specs, grow tree
+
+  flu_list *fnames = list_spec_files(argc, argv, dirs);
+
+  for (flu_node *n = fnames->first; n != NULL; n = n->next)
+  {
+    char *fname = (char *)n->item;
+    printf(". processing %s\n", fname);
+    process_lines(c, fname);
+  }
+
+  if (c->deps > 1) c->sdeps = spec_deps(c, fnames);
+
+  // write (to a temp file first)
+
+  char *tmp_fname = flu_sprintf("%s.tmp", c->out_fname);
+
+  FILE *out = fopen(tmp_fname, "wb");
+
+  if (out == NULL)
+  {
+    flu_die(1, "couldn't open %s file for writing", tmp_fname);
+  }
+
+  fprintf(out, "\n/* rodzo %s */", RODZO_VERSION);
+  if (ginfo) fprintf(out, "\n/*\n%s*/", ginfo);
+  if (call) fprintf(out, "\n\n// %s", call);
+  free(ginfo);
+  free(call);
+
+  if (c->concurrent) fprintf(out, "\n\n#define RDZ_CONCURRENT 1 // needs -pthread");
+
+  // the runtime sections for fuzz, compare and benchmark blocks are
+  // only compiled in when the specs use them
+
+  if (c->fuzzes || c->fuzz) fprintf(out, "\n#define RDZ_WITH_FUZZ 1");
+  if (c->compares) fprintf(out, "\n#define RDZ_WITH_COMPARE 1");
+  if (c->benchmarks) fprintf(out, "\n#define RDZ_WITH_BENCH 1");
+
+  print_header(out);
+  print_sites(out, c);
+  print_body(out, c);
+  print_footer(out, c);
+
+  // over
+
+  fclose(out);
+
+  // only replace the out file when its content changed,
+  // so that make (or ccache) doesn't rebuild for nothing
+
+  if (same_content(tmp_fname, c->out_fname))
+  {
+    remove(tmp_fname);
+    printf(". %s unchanged\n", c->out_fname);
+  }
+  else if (rename(tmp_fname, c->out_fname) == 0)
+  {
+    printf(". wrote %s\n", c->out_fname);
+  }
+  else
+  {
+    flu_die(1, "couldn't rename %s to %s", tmp_fname, c->out_fname);
+  }
+
+  free(tmp_fname);
+
+  if (c->deps) print_deps(c, fnames, dirs);
+
+  flu_list_free_all(fnames);
+}
+
+
+//
+// list
+
+static char *c_unescape(char *s)
+{
+  // the content of a string literal, with its escapes resolved
+
+  char *r = calloc(strlen(s) + 1, sizeof(char)); char *rr = r;
+
+  for (char *c = s; *c != '\0'; ++c)
+  {
+    if (*c != '\\' || c[1] == '\0') { *(rr++) = *c; continue; }
+
+    ++c;
+
+    if (*c == 'x')
+    {
+      *(rr++) = (char)strtol(c + 1, &c, 16); --c;
+    }
+    else if (*c >= '0' && *c <= '7')
+    {
+      int v = *c - '0';
+      for (int i = 0; i < 2 && c[1] >= '0' && c[1] <= '7'; ++i) v = v * 8 + *(++c) - '0';
+      *(rr++) = (char)v;
+    }
+    else
+    {
+      char *e = strchr("n\nt\tr\ra\ab\bf\fv\v", *c);
+      *(rr++) = e ? e[1] : *c;
+    }
+  }
+
+  return r;
+}
+
+static void json_string(char *s)
+{
+  putchar('"');
+
+  for (unsigned char *c = (unsigned char *)s; *c; c++)
+  {
+    if (*c == '"' || *c == '\\') printf("\\%c", *c);
+    else if (*c < 0x20) printf("\\u%04x", *c);
+    else putchar(*c);
+  }
+
+  putchar('"');
+}
+
+static int is_titled(node_s *n)
+{
+  return n->type == 'd' || n->type == 'c' || n->type == 'i';
+}
+
+static int title_ordinal(node_s *n)
+{
+  // 1 for the first sibling with that title, 2 for the next one, ...
+
+  int o = 1;
+
+  for (node_s *m = n->parent ? n->parent->first : NULL; m && m != n; m = m->next)
+  {
+    if (is_titled(m) && strcmp(m->text, n->text) == 0) o++;
+  }
+
+  return o;
+}
+
+static unsigned long long stable_id(node_s *n, char **texts, int *ordinals, int tl)
+{
+  // FNV-1a over the file name and the titles, from the top down, the
+  // runtime (RDZ_LIST=1) computes the same
+
+  unsigned long long h = rdz_fnv(RDZ_FNV_START, n->fname);
+
+  for (int i = 0; i < tl; i++) h = rdz_fnv_title(h, texts[i], ordinals[i]);
+
+  return h;
+}
+
+typedef struct {
+  unsigned long long id;
+  double duration;
+} duration_s;
+
+static int duration_cmp(const void *a, const void *b)
+{
+  unsigned long long ia = ((const duration_s *)a)->id;
+  unsigned long long ib = ((const duration_s *)b)->id;
+
+  return ia < ib ? -1 : ia > ib;
+}
+
+static duration_s *load_durations(size_t *count)
+{
+  // RDZ_DURATIONS, as written by the spec runs, "id duration" lines,
+  // sorted by id
+
+  *count = 0;
+
+  char *path = getenv("RDZ_DURATIONS");
+  FILE *f = path ? fopen(path, "r") : NULL;
+
+  if (f == NULL) return NULL;
+
+  size_t size = 1024;
+  duration_s *ds = calloc(size, sizeof(duration_s));
+
+  unsigned long long id; double du;
+
+  while (fscanf(f, "%llx %lf", &id, &du) == 2)
+  {
+    if (*count >= size) { size *= 2; ds = realloc(ds, size * sizeof(duration_s)); }
+    ds[*count].id = id; ds[(*count)++].duration = du;
+  }
+  fclose(f);
+
+  qsort(ds, *count, sizeof(duration_s), duration_cmp);
+
+  return ds;
+}
+
+static void list_node(node_s *n, duration_s *ds, size_t dcount)
+{
+  if (n->type == 'd' || n->type == 'c' || n->type == 'i')
+  {
+    char *texts[128]; int ordinals[128]; int tl = 0;
+
+    for (node_s *m = n; m != NULL && tl < 128; m = m->parent)
+    {
+      if (is_titled(m)) tl++;
+    }
+    int i = tl;
+    for (node_s *m = n; m != NULL && i > 0; m = m->parent)
+    {
+      if ( ! is_titled(m)) continue;
+      texts[--i] = c_unescape(m->text); ordinals[i] = title_ordinal(m);
+    }
+
+    unsigned long long id = stable_id(n, texts, ordinals, tl);
+
+    printf(
+      "{\"id\":\"%016llx\",\"n\":%d,\"type\":\"%s\",\"file\":",
+      id, n->nodenumber, type_to_string(n->type));
+    json_string(n->fname);
+    printf(
+      ",\"lstart\":%d,\"ltstart\":%d,\"llength\":%d,\"titles\":[",
+      n->lstart, n->ltstart, n->llength);
+    for (i = 0; i < tl; i++)
+    {
+      if (i > 0) putchar(',');
+      json_string(texts[i]); free(texts[i]);
+    }
+
+    printf("],\"tags\":[");
+    int tc = 0;
+    if (n->type == 'i' && n->first) printf("%s\"pending\"", tc++ ? "," : "");
+    if (n->concurrent) printf("%s\"concurrent\"", tc++ ? "," : "");
+    if (n->threads > 0) printf("%s\"stress\"", tc++ ? "," : "");
+
+    duration_s k = { id, 0.0 };
+    duration_s *d = ds && n->type == 'i' ?
+      bsearch(&k, ds, dcount, sizeof(k), duration_cmp) : NULL;
+
+    if (d) printf("],\"duration\":%f}\n", d->duration);
+    else printf("],\"duration\":null}\n");
+  }
+
+  for (node_s *cn = n->first; cn != NULL; cn = cn->next) list_node(cn, ds, dcount);
+}
+
+void list(context_s *c, int argc, char *argv[])
+{
+  // one JSON line per describe, context and it, no spec file gets written
+
+  flu_list *dirs = flu_list_malloc();
+  flu_list *fnames = list_spec_files(argc, argv, dirs);
+
+  for (flu_node *n = fnames->first; n != NULL; n = n->next)
+  {
+    process_lines(c, (char *)n->item);
+  }
+
+  size_t dcount = 0; duration_s *ds = load_durations(&dcount);
+
+  node_s *root = c->node; while (root->parent != NULL) root = root->parent;
+
+  list_node(root, ds, dcount);
+
+  free(ds);
+  flu_list_free_all(fnames);
+  flu_list_free_all(dirs);
+}
+
+
+//
+// watch
+
+#ifdef __linux__
+
+typedef struct {
+  int fd;
+  char **paths; // indexed by watch descriptor
+  size_t size;
+  char *out; // the generated file, changes to it are ignored
+} watch_s;
+
+static void watch_path(watch_s *w, char *path)
+{
+  int wd = inotify_add_watch(
+    w->fd, path, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE);
+
+  if (wd < 0) return;
+
+  if ((size_t)wd >= w->size)
+  {
+    size_t size = wd + 16;
+    w->paths = realloc(w->paths, size * sizeof(char *));
+    for (size_t i = w->size; i < size; i++) w->paths[i] = NULL;
+    w->size = size;
+  }
+
+  if (w->paths[wd] == NULL) w->paths[wd] = strdup(path);
+}
+
+static int wait_for_changes(watch_s *w, flu_list *changed)
+{
+  // blocks until a .c or .h file changes, then waits for things to settle
+  // (an editor saving triggers a few events), the changed files are
+  // listed in changed, returns 0 if only spec files changed, 1 if sources
+  // changed as well and 2 if a file got removed (run all)
+
+  char buf[4096]
+    __attribute__ ((aligned(__alignof__(struct inotify_event))));
+
+  int r = 0;
+  int timeout = -1;
+
+  while (1)
+  {
+    struct pollfd p = { w->fd, POLLIN, 0 };
+
+    int pr = poll(&p, 1, timeout);
+
+    if (pr == 0) break; // quiet, let's go
+    if (pr < 0) continue;
+
+    ssize_t l = read(w->fd, buf, sizeof(buf));
+
+    for (char *b = buf; l > 0 && b < buf + l; )
+    {
+      struct inotify_event *e = (struct inotify_event *)b;
+      b += sizeof(struct inotify_event) + e->len;
+
+      if (e->len < 1) continue;
+      if ( ! flu_strends(e->name, ".c") && ! flu_strends(e->name, ".h")) continue;
+
+      char *d = w->paths[e->wd];
+      char *path = flu_sprintf(flu_strends(d, "/") ? "%s%s" : "%s/%s", d, e->name);
+
+      struct stat ps, os;
+      if (
+        stat(path, &ps) == 0 && stat(w->out, &os) == 0 &&
+        ps.st_ino == os.st_ino && ps.st_dev == os.st_dev
+      ) { free(path); continue; } // our own output
+
+      timeout = 100; // ms
+
+      if (access(path, F_OK) != 0) r = 2;
+      else if ( ! flu_strends(path, "_spec.c") && r < 1) r = 1;
+
+      int seen = 0;
+      for (flu_node *n = changed->first; n != NULL; n = n->next)
+      {
+        if (strcmp(n->item, path) == 0) { seen = 1; break; }
+      }
+      if (seen) free(path); else flu_list_add(changed, path);
+    }
+  }
+
+  return r;
+}
+
+int watch(context_s *c, int argc, char *argv[])
+{
+  watch_s w = { inotify_init(), NULL, 0, c->out_fname };
+
+  if (w.fd < 0) flu_die(1, "couldn't init inotify");
+
+  char *bin = strdup(c->out_fname);
+  if (flu_strends(bin, ".c")) bin[strlen(bin) - 2] = '\0';
+
+  char *build = getenv("RODZO_BUILD");
+  char *make = build ? strdup(build) : flu_sprintf("make %s", bin);
+  char *run = flu_sprintf(strchr(bin, '/') ? "%s" : "./%s", bin);
+
+  flu_list *changed = flu_list_malloc();
+  int mode = 2;
+
+  while (1)
+  {
+    // regenerate, the out file is only rewritten when it changed
+
+    context_s *cc = parse_arguments(argc, argv);
+    flu_list *dirs = flu_list_malloc();
+
+    generate(cc, argc, argv, dirs);
+
+    for (flu_node *n = dirs->first; n != NULL; n = n->next)
+    {
+      watch_path(&w, n->item);
+    }
+    for (flu_node *n = c->includes->first; n != NULL; n = n->next)
+    {
+      watch_path(&w, (char *)n->item + 2); // -I../src --> ../src
+    }
+
+    flu_list_free_all(dirs);
+    free_context(cc);
+
+    // build and run, only the changed spec files (F=) if no source
+    // changed, else the specs affected by the changes (S=, see -MH)
+
+    printf(". %s\n", make); fflush(stdout);
+
+    if (system(make) == 0)
+    {
+      flu_sbuffer *b = flu_sbuffer_malloc();
+      for (flu_node *n = changed->first; n != NULL; n = n->next)
+      {
+        flu_sbprintf(b, n == changed->first ? "%s" : " %s", (char *)n->item);
+      }
+      char *f = flu_sbuffer_to_string(b);
+
+      unsetenv("F"); unsetenv("S");
+
+      if (mode == 0) setenv("F", f, 1);
+      else if (mode == 1) setenv("S", f, 1);
+
+      if (mode == 2) printf(". %s\n", run);
+      else printf(". %s=\"%s\" %s\n", mode == 0 ? "F" : "S", f, run);
+      fflush(stdout);
+
+      system(run);
+
+      free(f);
+    }
+
+    printf(". watching...\n"); fflush(stdout);
+
+    flu_list_free_all(changed); changed = flu_list_malloc();
+
+    mode = wait_for_changes(&w, changed);
+  }
+
+  return 0; // never reached
+}
+
+#else
+
+int watch(context_s *c, int argc, char *argv[])
+{
+  (void)c; (void)argc; (void)argv;
+
+  flu_die(1, "--watch is only available on Linux (inotify)");
+
+  return 1;
+}
+
+#endif
+
+
+int main(int argc, char *argv[])
+{
+  regcomp(
+    &ensure_operator_rex,
+    " ("
+      "((c|d|e|f|o|i|li|lli|u|zu|zd|lu|llu)(!?={1,3}))" "|"
+      "(!?[=!~\\^\\$>]={2,3}i?[fF]?|===snapf?)"
+    ") ",
+    REG_EXTENDED);
+
+  // deal with arguments
+
+  context_s *c = parse_arguments(argc, argv);
+
+  if (c == NULL) return print_usage(argv[0]);
+
+  int r = 0;
+
+  if (c->watch)
+  {
+    r = watch(c, argc, argv);
+  }
+  else if (c->list)
+  {
+    list(c, argc, argv);
+  }
+  else
+  {
+    flu_list *dirs = flu_list_malloc();
+    generate(c, argc, argv, dirs);
+    flu_list_free_all(dirs);
+  }
+
+  free_context(c);
+
+  regfree(&ensure_operator_rex);
+
+  return r;
+}
+void print_header(FILE *out)
+{
+  fputs(
+    "\n"
+    "\n"
+    "  /*\n"
+    "   * rodzo header\n"
+    "   */\n"
+    "\n"
+    "  // the specs are compiled as c99 (see test*/tmp/Makefile), the runtime\n"
+    "  // needs POSIX.1-2008 (sockets, clock_gettime(), open_memstream()...)\n"
+    "  // and a few extensions (backtrace(), strsignal())\n"
+    "\n"
+    "#ifndef _POSIX_C_SOURCE\n"
+    "#define _POSIX_C_SOURCE 200809L\n"
+    "#endif\n"
+    "#ifndef _DEFAULT_SOURCE\n"
+    "#define _DEFAULT_SOURCE\n"
+    "#endif\n"
+    "#ifndef _DARWIN_C_SOURCE\n"
+    "#define _DARWIN_C_SOURCE\n"
+    "#endif\n"
+    "\n"
+    "#include <ctype.h>\n"
+    "#include <stdio.h>\n"
+    "#include <stdint.h>\n"
+    "#include <stdlib.h>\n"
+    "#include <string.h>\n"
+    "#include <strings.h>\n"
+    "#include <unistd.h> // for isatty()\n"
+    "#include <regex.h>\n"
+    "#include <glob.h>\n"
+    "#include <errno.h>\n"
+    "#include <sys/time.h>\n"
+    "#include <sys/wait.h>\n"
+    "#include <signal.h>\n"
+    "#include <time.h>\n"
+    "#include <fcntl.h>\n"
+    "#include <dirent.h>\n"
+    "#include <sys/mman.h>\n"
+    "#include <sys/stat.h>\n"
+    "#ifdef RDZ_CONCURRENT\n"
+    "#include <pthread.h>\n"
+    "#endif\n"
+    "\n"
+    "  // the runtime sections run from environment variables but only some\n"
+    "  // specs need are compiled in when the spec is built with -DRDZ_WITH_x\n"
+    "\n"
+    "#if defined(RDZ_LEAKS) && ! defined(RDZ_WITH_MEMCHECK)\n"
+    "#define RDZ_WITH_MEMCHECK 1 // the block count is only read by memcheck\n"
+    "#endif\n"
+    "#ifdef RDZ_WITH_REMOTE\n"
+    "#include <sys/socket.h>\n"
+    "#include <sys/un.h>\n"
+    "#include <netdb.h>\n"
+    "#include <poll.h>\n"
+    "#endif\n"
+    "#if defined(RDZ_WITH_SAMPLE) && (defined(__GLIBC__) || defined(__APPLE__))\n"
+    "#define RDZ_SAMPLING 1\n"
+    "#include <execinfo.h> // backtrace_symbols()\n"
+    "#include <sys/ucontext.h>\n"
+    "#ifdef __APPLE__\n"
+    "#include <pthread.h> // pthread_get_stackaddr_np()\n"
+    "#endif\n"
+    "#endif\n"
+    "#if defined(RDZ_WITH_BISECT) || defined(RDZ_WITH_MEMCHECK)\n"
+    "#define RDZ_RERUN 1 // the spec re-executes itself\n"
+    "#ifdef __APPLE__\n"
+    "#include <mach-o/dyld.h> // _NSGetExecutablePath()\n"
+    "#endif\n"
+    "#endif\n"
+    "\n"
+    "\n"
+    "int rdz_hexdump_on = 0;\n"
+    "\n"
+    "  // avoiding strdup (and strlcpy, absent from older glibcs)...\n"
+    "char *rdz_strdup(char *s)\n"
+    "{\n"
+    "  size_t l = strlen(s) + 1;\n"
+    "  char *r = calloc(l, sizeof(char));\n"
+    "  memcpy(r, s, l);\n"
+    "  return r;\n"
+    "}\n"
+    "char *rdz_strndup(char *s, size_t n)\n"
+    "{\n"
+    "  char *r = calloc(n + 1, sizeof(char));\n"
+    "  for (size_t i = 0; i < n; i++) r[i] = s[i];\n"
+    "  return r;\n"
+    "}\n"
+    "\n"
+    "void *rdz_let_set(int *set, void *let, const void *value, size_t size)\n"
+    "{\n"
+    "  // stores a let's value from within a call, two uses of a let in the\n"
+    "  // same expression are then not unsequenced modifications\n"
+    "\n"
+    "  memcpy(let, value, size); *set = 1;\n"
+    "  return let;\n"
+    "}\n"
+    "\n"
+    "typedef double rdz_func();\n"
+    "\n"
+    "  // the spec tree is emitted by rodzo as flat static const tables,\n"
+    "  // a node is known by its nodenumber, its index in each of the tables\n"
+    "\n"
+    "typedef struct rdz_tree {\n"
+    "  int count;\n"
+    "  const char *types;\n"
+    "  const int *parents;\n"
+    "  const int *depths;\n"
+    "  const int *lstarts;\n"
+    "  const int *ltstarts;\n"
+    "  const int *llengths;\n"
+    "  const int *coffsets; // where the node's children start in ->children\n"
+    "  const int *ccounts; // how many children the node has\n"
+    "  const int *children;\n"
+    "  const int *texts; // offsets in ->strings\n"
+    "  const int *fnames; // offsets in ->strings\n"
+    "  const int *deps; // offsets in ->strings, the file and what it includes\n"
+    "  const int *flags; // RDZ_F_CONCURRENT\n"
+    "  const char *strings;\n"
+    "  rdz_func *const *funcs;\n"
+    "} rdz_tree;\n"
+    "\n"
+    "#define RDZ_F_CONCURRENT 1\n"
+    "#define RDZ_F_STRESS 2\n"
+    "#define RDZ_F_FUZZ 4\n"
+    "\n"
+    "const rdz_tree *rdz_t = NULL;\n"
+    "int *rdz_doruns = NULL; // the only mutable part, one per node\n"
+    "\n"
+    "char *rdz_text(int n) { return (char *)rdz_t->strings + rdz_t->texts[n]; }\n"
+    "char *rdz_fname(int n) { return (char *)rdz_t->strings + rdz_t->fnames[n]; }\n"
+    "char *rdz_deps(int n) { return (char *)rdz_t->strings + rdz_t->deps[n]; }\n"
+    "\n"
+    "const int *rdz_children(int n) { return rdz_t->children + rdz_t->coffsets[n]; }\n"
+    "\n"
+    "\n"
+    "typedef struct rdz_result {\n"
+    "  int success;\n"
+    "  char *message;\n"
+    "  char *title;\n"
+    "  int itnumber;\n"
+    "  int lnumber;\n"
+    "  int ltnumber;\n"
+    "  char *memcheck; // the valgrind report, RDZ_VALGRIND=1\n"
+    "} rdz_result;\n"
+    "\n"
+    "double rdz_now()\n"
+    "{\n"
+    "  struct timeval tv;\n"
+    "\n"
+    "  if (gettimeofday(&tv, NULL) != 0) return 0.0;\n"
+    "\n"
+    "  return 1000.0 * tv.tv_sec + tv.tv_usec / 1000.0; // turn to ms\n"
+    "}\n"
+    "\n"
+    "double rdz_duration(double start)\n"
+    "{\n"
+    "  return rdz_now() - start; // still ms\n"
+    "}\n"
+    "\n"
+    "char *rdz_determine_title(int n)\n"
+    "{\n"
+    "  char **texts = calloc(128, sizeof(char *));\n"
+    "  int nn = n;\n"
+    "  size_t i = 0;\n"
+    "  size_t l = 0;\n"
+    "\n"
+    "  while (1)\n"
+    "  {\n"
+    "    texts[i++] = rdz_text(nn);\n"
+    "    l = l + strlen(rdz_text(nn)) + 1;\n"
+    "    if (rdz_t->parents[nn] < 1) break;\n"
+    "    nn = rdz_t->parents[nn];\n"
+    "  }\n"
+    "\n"
+    "  char *title = calloc(l + 1, sizeof(char));\n"
+    "  char *t = title;\n"
+    "\n"
+    "  for (size_t ii = i - 1; ; ii--)\n"
+    "  {\n"
+    "    l = strlen(texts[ii]);\n"
+    "    memcpy(t, texts[ii], l);\n"
+    "    t = t + l;\n"
+    "    *t = ' ';\n"
+    "    t = t + 1;\n"
+    "    if (ii == 0) break;\n"
+    "  }\n"
+    "\n"
+    "  free(texts);\n"
+    "\n"
+    "  return title;\n"
+    "}\n"
+    "\n"
+    "rdz_result *rdz_result_init(\n"
+    "  rdz_result *r,\n"
+    "  int success, char *msg, int itnumber, int lnumber, int ltnumber)\n"
+    "{\n"
+    "  r->success = success;\n"
+    "  r->message = msg;\n"
+    "  r->title = NULL;\n"
+    "  r->itnumber = itnumber;\n"
+    "  r->lnumber = lnumber;\n"
+    "  r->ltnumber = ltnumber;\n"
+    "  r->memcheck = NULL;\n"
+    "\n"
+    "  if (success != 1) r->title = rdz_determine_title(itnumber);\n"
+    "    // only pending and failures get their title listed in the summary\n"
+    "\n"
+    "  return r;\n"
+    "}\n"
+    "\n"
+    "void rdz_result_clear(rdz_result *r)\n"
+    "{\n"
+    "  free(r->message);\n"
+    "  free(r->title);\n"
+    "  free(r->memcheck);\n"
+    "}\n"
+    "\n"
+    "#define RDZ_LINES_MAX 32\n"
+    "int *rdz_lines = NULL;\n"
+    "char *rdz_example = NULL;\n"
+    "#define RDZ_FILES_MAX 16\n"
+    "char **rdz_files = NULL;\n"
+    "char *rdz_sources = NULL;\n"
+    "char *rdz_coverage = NULL;\n"
+    "char *rdz_its = NULL; // I=6 or I=6,14,27\n"
+    "int rdz_jobs = 1;\n"
+    "int rdz_worker = 0;\n"
+    "char *rdz_coordinator = NULL; // RDZ_COORDINATOR=/tmp/s.sock or :7001\n"
+    "char *rdz_remote = NULL; // RDZ_WORKER=/tmp/s.sock or localhost:7001\n"
+    "int rdz_remote_fd = -1; // the connection to the coordinator\n"
+    "int rdz_list = 0; // RDZ_LIST=1, list the nodes, run nothing\n"
+    "char *rdz_durations = NULL; // RDZ_DURATIONS=file, remembers the durations\n"
+    "double *rdz_ran = NULL; // the durations of this run, one per node\n"
+    "long rdz_repeat = 0; // RDZ_REPEAT=500\n"
+    "int rdz_sample_hz = 0; // RDZ_SAMPLE=997\n"
+    "char *rdz_trace = NULL; // RDZ_TRACE=trace.json\n"
+    "#ifdef RDZ_CONCURRENT\n"
+    "__thread\n"
+    "#endif\n"
+    "volatile int rdz_sample_node = 0; // what the samples get attributed to\n"
+    "int rdz_until_fail = 0; // RDZ_UNTIL_FAIL=1\n"
+    "int rdz_bisect = -1; // RDZ_BISECT=14, the failing example\n"
+    "int rdz_bisect_fd = -1; // where a bisection run tells what failed\n"
+    "int rdz_bisect_it = -1; // in a bisection run, the example bisected\n"
+    "int rdz_valgrind = 0; // RDZ_VALGRIND=1\n"
+    "char *rdz_leaky = NULL; // the examples that left the heap bigger\n"
+    "char *rdz_corpus = NULL; // RDZ_CORPUS=dir, where the fuzz blocks find inputs\n"
+    "double rdz_fuzz_timeout = 1000.0; // RDZ_FUZZ_TIMEOUT=ms, budget per input\n"
+    "int rdz_update_snapshots = 0; // RDZ_UPDATE_SNAPSHOTS=1\n"
+    "double rdz_bench_time = 300.0; // RDZ_BENCH_TIME=ms, per compare/benchmark\n"
+    "int rdz_snap_written = 0;\n"
+    "int rdz_snap_updated = 0;\n"
+    "double rdz_conc_work = 0.0; // sum of the durations of the concurrent its\n"
+    "double rdz_conc_wall = 0.0; // time it took to run them\n"
+    "\n"
+    "int rdz_count = 0;\n"
+    "int rdz_fail_count = 0;\n"
+    "int rdz_pending_count = 0;\n"
+    "rdz_result *rdz_results = NULL;\n"
+    "int rdz_results_size = 0;\n"
+    "\n"
+    "rdz_result *rdz_results_push()\n"
+    "{\n"
+    "  // the table is sized by rodzo from the ensure count, but a \"with rows\"\n"
+    "  // or a looping ensure records more, so it grows as needed\n"
+    "\n"
+    "  if (rdz_count >= rdz_results_size)\n"
+    "  {\n"
+    "    rdz_results_size = rdz_results_size * 2 + 4;\n"
+    "    rdz_results = realloc(rdz_results, rdz_results_size * sizeof(rdz_result));\n"
+    "  }\n"
+    "\n"
+    "  return rdz_results + rdz_count++;\n"
+    "}\n"
+    "\n"
+    "\n"
+    "static int rdz_tty = -1;\n"
+    "\n"
+    "static int istty()\n"
+    "{\n"
+    "  if (rdz_tty > -1) return rdz_tty;\n"
+    "    // determined once, workers (RDZ_JOBS) write to a file but stay colourful\n"
+    "\n"
+    "  int rno = errno;\n"
+    "  rdz_tty = isatty(1);\n"
+    "  errno = rno;\n"
+    "\n"
+    "  return rdz_tty;\n"
+    "}\n"
+    "\n"
+    "char *rdz_rd() { return istty() ? \"[0;31m\" : \"\"; }\n"
+    "char *rdz_gn() { return istty() ? \"[0;32m\" : \"\"; }\n"
+    "char *rdz_yl() { return istty() ? \"[0;33m\" : \"\"; }\n"
+    "char *rdz_cy() { return istty() ? \"[0;36m\" : \"\"; }\n"
+    "char *rdz_gr() { return istty() ? \"[0;90m\" : \"\"; }\n"
+    "char *rdz_bl() { return istty() ? \"[1;34m\" : \"\"; }\n"
+    "char *rdz_cl() { return istty() ? \"[0;0m\" : \"\"; }\n"
+    "\n"
+    "void rdz_print_level(int nodenumber)//, int min)\n"
+    "{\n"
+    "  if (nodenumber < 0) return;\n"
+    "\n"
+    "  int depth = rdz_t->depths[nodenumber];\n"
+    "  if (depth == 0) return;\n"
+    "\n"
+    "  for (int i = 0; i < depth - 1; i++) printf(\"  \"); // indent\n"
+    "\n"
+    "  printf(\"\%s\", rdz_text(nodenumber));\n"
+    "  printf(\n"
+    "    \" \%sL=\%d I=\%d\%s\\n\",\n"
+    "    rdz_gr(), rdz_t->ltstarts[nodenumber], nodenumber, rdz_cl());\n"
+    "}\n"
+    "\n"
+    "void rdz_duration_to_s(double duration, char *ca)\n"
+    "{\n"
+    "  *ca = 0;\n"
+    "\n"
+    "  if (duration < 0.0) return;\n"
+    "\n"
+    "  char *e = getenv(\"RDZ_NO_DURATION\");\n"
+    "  if (e && (strcmp(e, \"1\") == 0 || strcmp(e, \"true\"))) return;\n"
+    "\n"
+    "  if (duration < 1000.0) { snprintf(ca, 14, \"\%fms \", duration); return; }\n"
+    "\n"
+    "  double s = duration / 1000.0;\n"
+    "  snprintf(ca, 14, \"\%.6f \", s);\n"
+    "  for (size_t i = 0; ; ++i) { if (ca[i] == '.') { ca[i] = 's'; break; } }\n"
+    "}\n"
+    "\n"
+    "void rdz_print_result(rdz_result *r, double duration)\n"
+    "{\n"
+    "  if (r == NULL) return;\n"
+    "\n"
+    "  int depth = rdz_t->depths[r->itnumber];\n"
+    "\n"
+    "  for (int i = 0; i < depth - 1; i++) printf(\"  \"); // indent\n"
+    "\n"
+    "  char *co = rdz_gn();\n"
+    "  if (r->success == -1) co = rdz_yl();\n"
+    "  else if (r->success == 0) co = rdz_rd();\n"
+    "\n"
+    "  printf(\"\%s\%s\", co, rdz_text(r->itnumber));\n"
+    "\n"
+    "  if (r->success == -1) printf(\" (PENDING: \%s)\", r->message);\n"
+    "  if (r->success == 0) printf(\" (FAILED)\");\n"
+    "\n"
+    "  if (rdz_ran && duration >= 0.0) rdz_ran[r->itnumber] = duration;\n"
+    "\n"
+    "  char du[77]; rdz_duration_to_s(duration, du);\n"
+    "\n"
+    "  printf(\n"
+    "    \" \%s\%sL=\%d I=\%d\%s\\n\", rdz_gr(), du, r->ltnumber, r->itnumber, rdz_cl());\n"
+    "}\n"
+    "\n"
+    "char *rdz_truncate(char *s, size_t l, int soe)\n"
+    "{\n"
+    "  if (s == NULL) return NULL;\n"
+    "\n"
+    "  size_t ls = strlen(s);\n"
+    "\n"
+    "  if (soe == 1)\n"
+    "  {\n"
+    "    char *r = calloc(ls + 3, sizeof(char));\n"
+    "    snprintf(r, ls + 3, \"\\\"\%s\\\"\", s);\n"
+    "    return r;\n"
+    "  }\n"
+    "\n"
+    "  int ll = l; // \"\%.*s\" wants an int and not a size_t...\n"
+    "\n"
+    "  char *r = calloc(l + 6 + 1, sizeof(char));\n"
+    "\n"
+    "  if (ls <= l) snprintf(r, l + 6, \"\\\"\%s\\\"\", s);\n"
+    "  else if (soe <= 0) snprintf(r, l + 6, \"\\\"\%.*s...\\\"\", ll, s);\n"
+    "  else snprintf(r, l + 6, \"\\\"...\%.*s\\\"\", ll, s + l + 1);\n"
+    "\n"
+    "  return r;\n"
+    "}\n"
+    "\n"
+    "char *rdz_string_expected(char *result, char *verb, char *expected)\n"
+    "{\n"
+    "  if (expected == NULL) verb = \"to be\";\n"
+    "\n"
+    "  size_t l = strlen(verb); if (l < 8) l = 8;\n"
+    "  int ll = l; // \"\%.*s\" wants an int and not a size_t...\n"
+    "\n"
+    "  int soe = 0; if (verb[3] == 's') soe = -1; else if (verb[3] == 'e') soe = 1;\n"
+    "\n"
+    "  char *res = rdz_truncate(result, 49, soe);\n"
+    "\n"
+    "  char *s = calloc(4096, sizeof(char));\n"
+    "\n"
+    "  if (expected)\n"
+    "    snprintf(\n"
+    "      s, 4096,\n"
+    "      \"     \%*s \%s\\n\"\n"
+    "      \"     \%*s \\\"\%s\\\"\",\n"
+    "      ll, \"expected\", res, ll, verb, expected);\n"
+    "  else\n"
+    "    snprintf(\n"
+    "      s, 4096,\n"
+    "      \"     \%*s \%s\\n\"\n"
+    "      \"     \%*s NULL\",\n"
+    "      ll, \"expected\", res, ll, verb);\n"
+    "\n"
+    "  if (res) free(res);\n"
+    "\n"
+    "  return s;\n"
+    "}\n"
+    "\n"
+    "int rdz_hexdump(const void *d, ssize_t len, size_t line, int second)\n"
+    "{\n"
+    "  char *s = (char *)d;\n"
+    "  ssize_t l = len;\n"
+    "  if (len < 0) len = strlen(s);\n"
+    "\n"
+    "  ssize_t line_length = 15;\n"
+    "  ssize_t j = line * line_length;\n"
+    "\n"
+    "  printf(\"\%s\%-10p\%s \", j == 0 ? rdz_cl() : rdz_gr(), s, rdz_cl());\n"
+    "\n"
+    "  short over = (j >= len);\n"
+    "\n"
+    "  for (ssize_t i = j; i < j + line_length; ++i)\n"
+    "  {\n"
+    "    if (over) printf(\"   \");\n"
+    "    else if (s[i] >= 32 && s[i] <= 126) printf(\"\%02x \", s[i]);\n"
+    "    else printf(\"\%s\%02x\%s \", rdz_bl(), s[i], rdz_cl());\n"
+    "    if (l < 0) { if (s[i] == 0) over = 1; } else { if (i >= l) over = 1; }\n"
+    "    int m = i - j + 1; if (m == 5 || m == 10) printf(\" \");\n"
+    "  }\n"
+    "\n"
+    "  over = (j >= len);\n"
+    "  printf(\" \%s|\%s\", second ? rdz_cl() : rdz_bl(), rdz_cl());\n"
+    "  for (ssize_t i = j; i < j + line_length; ++i)\n"
+    "  {\n"
+    "    if (l < 0) { if (s[i] == 0) over = 1; } else { if (i >= l) over = 1; }\n"
+    "    if (over) printf(\" \");\n"
+    "    else if (s[i] >= 32 && s[i] <= 126) printf(\"\%c\", s[i]);\n"
+    "    else printf(\"\%s.\%s\", rdz_bl(), rdz_cl());\n"
+    "    int m = i - j + 1;\n"
+    "    if (m == 5 || m == 10) printf(\"\%s-\%s\", rdz_gr(), rdz_cl());\n"
+    "  }\n"
+    "  printf(\"\%s|\%s\\n\", second ? rdz_cl() : rdz_bl(), rdz_cl());\n"
+    "\n"
+    "  if (over) return 1; // over\n"
+    "\n"
+    "  return 0;\n"
+    "}\n"
+    "\n"
+    "void rdz_hexshow(const char *a, const char *b, ssize_t n)\n"
+    "{\n"
+    "  for (size_t line = 0; ; ++line)\n"
+    "  {\n"
+    "    int oa = rdz_hexdump(a, n, line, 0);\n"
+    "    int ob = rdz_hexdump(b, n, line, 1);\n"
+    "    if (oa && ob) break;\n"
+    "  }\n"
+    "}\n"
+    "\n"
+    "int rdz_strcmp(char *op, char *a, char *b, ssize_t n)\n"
+    "{\n"
+    "  short i = (strchr(op, 'i') != NULL);\n"
+    "\n"
+    "  if (rdz_hexdump_on) rdz_hexshow(a, b, n);\n"
+    "\n"
+    "  if (n > -1) return i ? strncasecmp(a, b, n) : strncmp(a, b, n);\n"
+    "  return i ? strcasecmp(a, b) : strcmp(a, b);\n"
+    "}\n"
+    "\n"
+    "char *rdz_string_eq(char *operator, char *result, char *expected)\n"
+    "{\n"
+    "  if (expected == NULL && result == NULL) return NULL;\n"
+    "\n"
+    "  //if (expected == NULL) return rdz_strdup(\"     expected NULL\");\n"
+    "  if (result == NULL) return rdz_strdup(\"     result is NULL\");\n"
+    "\n"
+    "  if (expected && rdz_strcmp(operator, result, expected, -1) == 0) return NULL;\n"
+    "\n"
+    "  return rdz_string_expected(result, \"to equal\", expected);\n"
+    "}\n"
+    "\n"
+    "char *rdz_string_neq(char *operator, char *result, char *not_expected)\n"
+    "{\n"
+    "  if (result == NULL) return rdz_strdup(\"     result is NULL\");\n"
+    "\n"
+    "  if (not_expected == NULL) return NULL;\n"
+    "  if (rdz_strcmp(operator, result, not_expected, -1) != 0) return NULL;\n"
+    "\n"
+    "  size_t l = strlen(not_expected) + 22;\n"
+    "\n"
+    "  char *s = calloc(l, sizeof(char));\n"
+    "  snprintf(s, l, \"     didn't expect \\\"\%s\\\"\", not_expected);\n"
+    "\n"
+    "  return s;\n"
+    "}\n"
+    "\n"
+    "char *rdz_string_match(char *operator, char *result, char *expected)\n"
+    "{\n"
+    "  if (result == NULL) return rdz_strdup(\"     result is NULL\");\n"
+    "\n"
+    "  char *s = NULL;\n"
+    "\n"
+    "  int flags = REG_EXTENDED;\n"
+    "  if (strchr(operator, 'i')) flags = flags | REG_ICASE;\n"
+    "\n"
+    "  regex_t *r = calloc(1, sizeof(regex_t));\n"
+    "  regcomp(r, expected, flags);\n"
+    "  regmatch_t ms[1];\n"
+    "\n"
+    "  if (regexec(r, result, 0, ms, 0)) // no match\n"
+    "  {\n"
+    "    if (operator[0] != '!')\n"
+    "      s = rdz_string_expected(result, \"to match\", expected);\n"
+    "  }\n"
+    "  else // match\n"
+    "  {\n"
+    "    if (operator[0] == '!')\n"
+    "      s = rdz_string_expected(result, \"not to match\", expected);\n"
+    "  }\n"
+    "  regfree(r); free(r);\n"
+    "\n"
+    "  return s;\n"
+    "}\n"
+    "\n"
+    "char *rdz_string_start(char *operator, char *result, char *expected)\n"
+    "{\n"
+    "  int success =\n"
+    "    result &&\n"
+    "    rdz_strcmp(operator, result, expected, strlen(expected)) == 0;\n"
+    "\n"
+    "  if (operator[0] == '!')\n"
+    "  {\n"
+    "    return success ?\n"
+    "      rdz_string_expected(result, \"not to start with\", expected) : NULL;\n"
+    "  }\n"
+    "  return success ?\n"
+    "    NULL : rdz_string_expected(result, \"to start with\", expected);\n"
+    "}\n"
+    "\n"
+    "char *rdz_string_end(char *operator, char *result, char *expected)\n"
+    "{\n"
+    "  int success =\n"
+    "    result &&\n"
+    "    rdz_strcmp(\n"
+    "      operator, result + strlen(result) - strlen(expected), expected, -1) == 0;\n"
+    "\n"
+    "  if (operator[0] == '!')\n"
+    "  {\n"
+    "    return success ?\n"
+    "      rdz_string_expected(result, \"not to end with\", expected) : NULL;\n"
+    "  }\n"
+    "  return success ?\n"
+    "    NULL : rdz_string_expected(result, \"to end with\", expected);\n"
+    "}\n"
+    "\n"
+    "static char *lower_case(char *s)\n"
+    "{\n"
+    "  char *r = calloc(strlen(s) + 1, sizeof(char));\n"
+    "  for (size_t i = 0; s[i]; ++i) r[i] = tolower(s[i]);\n"
+    "\n"
+    "  return r;\n"
+    "}\n"
+    "\n"
+    "char *rdz_string_contains(char *operator, char *result, char *expected)\n"
+    "{\n"
+    "  char *re = result;\n"
+    "  char *ex = expected;\n"
+    "\n"
+    "  if (result && strchr(operator, 'i'))\n"
+    "  {\n"
+    "    re = lower_case(result);\n"
+    "    ex = lower_case(expected);\n"
+    "  }\n"
+    "\n"
+    "  char *r = re ? strstr(re, ex) : NULL;\n"
+    "\n"
+    "  if (re && rdz_hexdump_on) rdz_hexshow(re, ex, -1);\n"
+    "\n"
+    "  if (re != result) free(re);\n"
+    "  if (ex != expected) free(ex);\n"
+    "\n"
+    "  if (operator[0] == '!')\n"
+    "    return r ? rdz_string_expected(result, \"not to contain\", expected) : NULL;\n"
+    "  else\n"
+    "    return r ? NULL : rdz_string_expected(result, \"to contain\", expected);\n"
+    "}\n"
+    "\n"
+    "typedef struct rdz_job { // an \"it\" run on the thread pool\n"
+    "  int n;\n"
+    "  int count;\n"
+    "  int size;\n"
+    "  rdz_result *results; // its own, replayed in order once all are done\n"
+    "  double duration;\n"
+    "} rdz_job;\n"
+    "\n"
+    "#ifdef RDZ_CONCURRENT\n"
+    "__thread rdz_job *rdz_job_current = NULL;\n"
+    "\n"
+    "typedef struct rdz_stress_site { // one per ensure line, not per iteration\n"
+    "  int success;\n"
+    "  char *message;\n"
+    "  int itnumber;\n"
+    "  int lnumber;\n"
+    "  int ltnumber;\n"
+    "  long iteration; // where it failed\n"
+    "} rdz_stress_site;\n"
+    "\n"
+    "#define RDZ_STRESS_SITES_MAX 32\n"
+    "\n"
+    "typedef struct rdz_stress_thread { // an \"it\" threads(8) iterations(1000)\n"
+    "  int thread;\n"
+    "  long iterations;\n"
+    "  long done;\n"
+    "  double duration;\n"
+    "  int count;\n"
+    "  rdz_stress_site sites[RDZ_STRESS_SITES_MAX];\n"
+    "  struct rdz_stress *stress;\n"
+    "} rdz_stress_thread;\n"
+    "\n"
+    "__thread rdz_stress_thread *rdz_stress_current = NULL;\n"
+    "\n"
+    "static void rdz_stress_site_record(\n"
+    "  rdz_stress_site *ss, int *count, long iteration,\n"
+    "  int success, char *msg, int itnumber, int lnumber, int ltnumber)\n"
+    "{\n"
+    "  // keeps the first failure for the line, else the first success\n"
+    "\n"
+    "  for (int i = 0; i < *count; i++)\n"
+    "  {\n"
+    "    rdz_stress_site *s = ss + i;\n"
+    "\n"
+    "    if (s->lnumber != lnumber) continue;\n"
+    "\n"
+    "    if (s->success != 1 || success == 1) { free(msg); return; }\n"
+    "\n"
+    "    free(s->message); s->success = success; s->message = msg;\n"
+    "    s->iteration = iteration;\n"
+    "\n"
+    "    return;\n"
+    "  }\n"
+    "\n"
+    "  if (*count >= RDZ_STRESS_SITES_MAX) { free(msg); return; }\n"
+    "\n"
+    "  rdz_stress_site *s = ss + (*count)++;\n"
+    "  s->success = success; s->message = msg; s->iteration = iteration;\n"
+    "  s->itnumber = itnumber; s->lnumber = lnumber; s->ltnumber = ltnumber;\n"
+    "}\n"
+    "#endif\n"
+    "\n"
+    "void rdz_record(int success, char *msg, int itnumber, int lnumber, int ltnumber)\n"
+    "{\n"
+    "#ifdef RDZ_CONCURRENT\n"
+    "  rdz_stress_thread *st = rdz_stress_current;\n"
+    "\n"
+    "  if (st)\n"
+    "  {\n"
+    "    rdz_stress_site_record(\n"
+    "      st->sites, &st->count, st->done,\n"
+    "      success, msg, itnumber, lnumber, ltnumber);\n"
+    "\n"
+    "    return;\n"
+    "  }\n"
+    "\n"
+    "  rdz_job *j = rdz_job_current;\n"
+    "\n"
+    "  if (j)\n"
+    "  {\n"
+    "    if (j->count >= j->size)\n"
+    "    {\n"
+    "      j->size = j->size * 2 + 4;\n"
+    "      j->results = realloc(j->results, j->size * sizeof(rdz_result));\n"
+    "    }\n"
+    "    rdz_result_init(\n"
+    "      j->results + j->count++, success, msg, itnumber, lnumber, ltnumber);\n"
+    "\n"
+    "    return;\n"
+    "  }\n"
+    "#endif\n"
+    "\n"
+    "  rdz_result_init(\n"
+    "    rdz_results_push(), success, msg, itnumber, lnumber, ltnumber);\n"
+    "\n"
+    "  if (success == -1) rdz_pending_count++;\n"
+    "  if (success == 0) rdz_fail_count++;\n"
+    "}\n"
+    "\n"
+    "typedef struct rdz_site {\n"
+    "  char *format;\n"
+    "  char *operator;\n"
+    "  int itnumber;\n"
+    "  int lnumber;\n"
+    "  int ltnumber;\n"
+    "} rdz_site;\n"
+    "\n"
+    "static void rdz_format_i64(char *s, size_t n, const char *format, long long v)\n"
+    "{\n"
+    "  if (strcmp(format, \"li\") == 0) snprintf(s, n, \"\%li\", (long)v);\n"
+    "  else if (strcmp(format, \"lli\") == 0) snprintf(s, n, \"\%lli\", v);\n"
+    "  else if (strcmp(format, \"zd\") == 0) snprintf(s, n, \"\%zd\", (ssize_t)v);\n"
+    "  else if (strcmp(format, \"c\") == 0) snprintf(s, n, \"\%c\", (int)v);\n"
+    "  else snprintf(s, n, \"\%d\", (int)v);\n"
+    "}\n"
+    "\n"
+    "static void rdz_format_u64(\n"
+    "  char *s, size_t n, const char *format, unsigned long long v)\n"
+    "{\n"
+    "  if (strcmp(format, \"lu\") == 0) snprintf(s, n, \"\%lu\", (unsigned long)v);\n"
+    "  else if (strcmp(format, \"llu\") == 0) snprintf(s, n, \"\%llu\", v);\n"
+    "  else if (strcmp(format, \"zu\") == 0) snprintf(s, n, \"\%zu\", (size_t)v);\n"
+    "  else if (strcmp(format, \"o\") == 0) snprintf(s, n, \"\%o\", (unsigned int)v);\n"
+    "  else snprintf(s, n, \"\%u\", (unsigned int)v);\n"
+    "}\n"
+    "\n"
+    "static void rdz_format_f64(char *s, size_t n, const char *format, double v)\n"
+    "{\n"
+    "  if (strcmp(format, \"e\") == 0) snprintf(s, n, \"\%e\", v);\n"
+    "  else snprintf(s, n, \"\%f\", v);\n"
+    "}\n"
+    "\n"
+    "static int rdz_ensure_record(int success, char *l, char *r, const rdz_site *s)\n"
+    "{\n"
+    "  char *msg = NULL;\n"
+    "\n"
+    "  if ( ! success)\n"
+    "  {\n"
+    "    char verb[8]; snprintf(verb, 8, \"to \%s\", s->operator);\n"
+    "\n"
+    "    msg = calloc(2048, sizeof(char));\n"
+    "    snprintf(\n"
+    "      msg, 2048,\n"
+    "      \"     expected \%s\\n\"\n"
+    "      \"     \%8s \%s\",\n"
+    "      l, verb, r);\n"
+    "  }\n"
+    "\n"
+    "  rdz_record(success, msg, s->itnumber, s->lnumber, s->ltnumber);\n"
+    "\n"
+    "  return success;\n"
+    "}\n"
+    "\n"
+    "  // typed ensures (i==, zu!=, f==, ...) are turned into a call to\n"
+    "  // one of the three functions below, no allocation unless they fail\n"
+    "\n"
+    "int rdz_ensure_i64(long long l, long long r, const rdz_site *s)\n"
+    "{\n"
+    "  int success = (s->operator[0] == '!') ? (l != r) : (l == r);\n"
+    "  if (success) return rdz_ensure_record(1, NULL, NULL, s);\n"
+    "\n"
+    "  char sl[64]; rdz_format_i64(sl, 64, s->format, l);\n"
+    "  char sr[64]; rdz_format_i64(sr, 64, s->format, r);\n"
+    "\n"
+    "  return rdz_ensure_record(0, sl, sr, s);\n"
+    "}\n"
+    "\n"
+    "int rdz_ensure_u64(unsigned long long l, unsigned long long r, const rdz_site *s)\n"
+    "{\n"
+    "  int success = (s->operator[0] == '!') ? (l != r) : (l == r);\n"
+    "  if (success) return rdz_ensure_record(1, NULL, NULL, s);\n"
+    "\n"
+    "  char sl[64]; rdz_format_u64(sl, 64, s->format, l);\n"
+    "  char sr[64]; rdz_format_u64(sr, 64, s->format, r);\n"
+    "\n"
+    "  return rdz_ensure_record(0, sl, sr, s);\n"
+    "}\n"
+    "\n"
+    "int rdz_ensure_f64(double l, double r, const rdz_site *s)\n"
+    "{\n"
+    "  int success = (s->operator[0] == '!') ? (l != r) : (l == r);\n"
+    "  if (success) return rdz_ensure_record(1, NULL, NULL, s);\n"
+    "\n"
+    "  char sl[512]; rdz_format_f64(sl, 512, s->format, l);\n"
+    "  char sr[512]; rdz_format_f64(sr, 512, s->format, r);\n"
+    "\n"
+    "  return rdz_ensure_record(0, sl, sr, s);\n"
+    "}\n"
+    "\n"
+    "void rdz_extract_arguments()\n"
+    "{\n"
+    "  // start from scratch (rodzo-runner calls rdz_main() repeatedly)\n"
+    "\n"
+    "  rdz_lines = NULL; rdz_files = NULL; rdz_its = NULL;\n"
+    "  rdz_count = 0; rdz_fail_count = 0; rdz_pending_count = 0;\n"
+    "  rdz_conc_work = 0.0; rdz_conc_wall = 0.0;\n"
+    "\n"
+    "  // E=example\n"
+    "\n"
+    "  rdz_example = getenv(\"E\");\n"
+    "\n"
+    "  // L=12,67\n"
+    "\n"
+    "  char *l = getenv(\"L\");\n"
+    "\n"
+    "  if (l != NULL)\n"
+    "  {\n"
+    "    rdz_example = NULL;\n"
+    "\n"
+    "    rdz_lines = calloc(RDZ_LINES_MAX + 1, sizeof(int));\n"
+    "\n"
+    "    for (size_t i = 0; i < RDZ_LINES_MAX; i++)\n"
+    "    {\n"
+    "      if (l == NULL) { rdz_lines[i] = -1; continue; }\n"
+    "\n"
+    "      char *c = strpbrk(l, \",\");\n"
+    "      rdz_lines[i] = atoi(l);\n"
+    "\n"
+    "      if (c == NULL) { l = NULL; continue; }\n"
+    "\n"
+    "      l = c + 1;\n"
+    "    }\n"
+    "  }\n"
+    "\n"
+    "  // I=6 or I=6,14\n"
+    "\n"
+    "  char *i = getenv(\"I\");\n"
+    "\n"
+    "  if (i != NULL)\n"
+    "  {\n"
+    "    rdz_example = NULL;\n"
+    "\n"
+    "    rdz_its = i;\n"
+    "  }\n"
+    "\n"
+    "  // F=fname\n"
+    "\n"
+    "  char *f = getenv(\"F\");\n"
+    "\n"
+    "  if (f != NULL)\n"
+    "  {\n"
+    "    rdz_files = calloc(RDZ_FILES_MAX + 1, sizeof(char *));\n"
+    "\n"
+    "    for (size_t i = 0; i < RDZ_FILES_MAX; ++i)\n"
+    "    {\n"
+    "      char *ff = strpbrk(f, \" \\t\");\n"
+    "      size_t l = ff ? ff - f : strlen(f);\n"
+    "      char *fn = NULL;\n"
+    "      if (f[0] == '.')\n"
+    "      {\n"
+    "        fn = rdz_strndup(f, l);\n"
+    "      }\n"
+    "      else\n"
+    "      {\n"
+    "        fn = calloc(l + 9, sizeof(char));\n"
+    "        memcpy(fn, \"../spec/\", 8); memcpy(fn + 8, f, l);\n"
+    "      }\n"
+    "\n"
+    "      glob_t gl;\n"
+    "      glob(fn, GLOB_NOSORT, NULL, &gl);\n"
+    "\n"
+    "      rdz_files[i] = rdz_strdup(gl.gl_pathv[0]);\n"
+    "\n"
+    "      globfree(&gl);\n"
+    "      free(fn);\n"
+    "\n"
+    "      f = ff; if (f == NULL) break;\n"
+    "      while (1) if (f[0] != ' ' && f[0] != '\\t') break; else ++f;\n"
+    "    }\n"
+    "  }\n"
+    "\n"
+    "  // S=\"src/flutil.c src/flutil.h\"\n"
+    "\n"
+    "  rdz_sources = getenv(\"S\");\n"
+    "\n"
+    "  // RDZ_JOBS=4\n"
+    "\n"
+    "  char *j = getenv(\"RDZ_JOBS\");\n"
+    "\n"
+    "  rdz_jobs = j ? atoi(j) : 1;\n"
+    "\n"
+    "  // RDZ_COORDINATOR=/tmp/s.sock and RDZ_WORKER=/tmp/s.sock\n"
+    "\n"
+    "  rdz_coordinator = getenv(\"RDZ_COORDINATOR\");\n"
+    "  rdz_remote = getenv(\"RDZ_WORKER\");\n"
+    "\n"
+    "#ifndef RDZ_WITH_REMOTE\n"
+    "  if (rdz_coordinator || rdz_remote)\n"
+    "  {\n"
+    "    fprintf(stderr, \"RDZ_COORDINATOR and RDZ_WORKER need a spec built with -DRDZ_WITH_REMOTE\\n\");\n"
+    "    exit(1);\n"
+    "  }\n"
+    "#endif\n"
+    "\n"
+    "  // RDZ_LIST=1 and RDZ_DURATIONS=.durations\n"
+    "\n"
+    "  char *li = getenv(\"RDZ_LIST\");\n"
+    "\n"
+    "  rdz_list = li && (strcmp(li, \"1\") == 0 || strcmp(li, \"true\") == 0);\n"
+    "  rdz_durations = getenv(\"RDZ_DURATIONS\");\n"
+    "\n"
+    "  // RDZ_REPEAT=500 and RDZ_UNTIL_FAIL=1\n"
+    "\n"
+    "  char *re = getenv(\"RDZ_REPEAT\");\n"
+    "  char *uf = getenv(\"RDZ_UNTIL_FAIL\");\n"
+    "\n"
+    "  rdz_repeat = re ? atol(re) : 0;\n"
+    "  rdz_until_fail = uf && (strcmp(uf, \"1\") == 0 || strcmp(uf, \"true\") == 0);\n"
+    "\n"
+    "  // RDZ_BISECT=14\n"
+    "\n"
+    "  char *bi = getenv(\"RDZ_BISECT\");\n"
+    "  char *bf = getenv(\"RDZ_BISECT_FD\"); // set for the bisection runs\n"
+    "\n"
+    "  rdz_bisect = bi ? atoi(bi) : -1;\n"
+    "  rdz_bisect_fd = bf ? atoi(bf) : -1;\n"
+    "\n"
+    "#ifndef RDZ_WITH_BISECT\n"
+    "  if (rdz_bisect > -1)\n"
+    "  {\n"
+    "    fprintf(stderr, \"RDZ_BISECT needs a spec built with -DRDZ_WITH_BISECT\\n\");\n"
+    "    exit(1);\n"
+    "  }\n"
+    "#endif\n"
+    "\n"
+    "  // a bisection run reads its I= from a file, not from the environment\n"
+    "  // where tens of thousands of examples would overflow the exec\n"
+    "\n"
+    "  char *bs = getenv(\"RDZ_BISECT_SET\");\n"
+    "  FILE *bsf = bf && bs ? fdopen(atoi(bs), \"r\") : NULL;\n"
+    "\n"
+    "  if (bsf)\n"
+    "  {\n"
+    "    char *s = NULL; size_t sl = 0;\n"
+    "\n"
+    "    if (getline(&s, &sl, bsf) > 0)\n"
+    "    {\n"
+    "      s[strcspn(s, \"\\n\")] = '\\0';\n"
+    "      rdz_example = NULL; rdz_its = s; // the bisected example comes last\n"
+    "\n"
+    "      char *c = strrchr(s, ','); rdz_bisect_it = atoi(c ? c + 1 : s);\n"
+    "    }\n"
+    "    else\n"
+    "    {\n"
+    "      free(s);\n"
+    "    }\n"
+    "    fclose(bsf);\n"
+    "  }\n"
+    "\n"
+    "  // RDZ_VALGRIND=1\n"
+    "\n"
+    "  char *va = getenv(\"RDZ_VALGRIND\");\n"
+    "\n"
+    "  rdz_valgrind = va && (strcmp(va, \"1\") == 0 || strcmp(va, \"true\") == 0);\n"
+    "\n"
+    "#ifndef RDZ_WITH_MEMCHECK\n"
+    "  if (rdz_valgrind)\n"
+    "  {\n"
+    "    fprintf(stderr, \"RDZ_VALGRIND needs a spec built with -DRDZ_WITH_MEMCHECK\\n\");\n"
+    "    rdz_valgrind = 0;\n"
+    "  }\n"
+    "#endif\n"
+    "\n"
+    "  // RDZ_CORPUS=fuzz/corpus and RDZ_FUZZ_TIMEOUT=250\n"
+    "\n"
+    "  char *ft = getenv(\"RDZ_FUZZ_TIMEOUT\");\n"
+    "\n"
+    "  rdz_corpus = getenv(\"RDZ_CORPUS\");\n"
+    "  rdz_fuzz_timeout = ft ? atof(ft) : 1000.0;\n"
+    "  if (rdz_fuzz_timeout <= 0.0) rdz_fuzz_timeout = 1000.0;\n"
+    "\n"
+    "  // RDZ_BENCH_TIME=1000\n"
+    "\n"
+    "  char *bt = getenv(\"RDZ_BENCH_TIME\");\n"
+    "\n"
+    "  rdz_bench_time = bt ? atof(bt) : 300.0;\n"
+    "  if (rdz_bench_time <= 0.0) rdz_bench_time = 300.0;\n"
+    "\n"
+    "  // RDZ_UPDATE_SNAPSHOTS=1\n"
+    "\n"
+    "  char *us = getenv(\"RDZ_UPDATE_SNAPSHOTS\");\n"
+    "\n"
+    "  rdz_update_snapshots = us && (strcmp(us, \"1\") == 0 || strcmp(us, \"true\") == 0);\n"
+    "  rdz_snap_written = 0; rdz_snap_updated = 0;\n"
+    "\n"
+    "  // RDZ_TRACE=trace.json\n"
+    "\n"
+    "  rdz_trace = getenv(\"RDZ_TRACE\");\n"
+    "\n"
+    "  // RDZ_SAMPLE=997\n"
+    "\n"
+    "  char *sa = getenv(\"RDZ_SAMPLE\");\n"
+    "\n"
+    "  rdz_sample_hz = sa ? atoi(sa) : 0;\n"
+    "\n"
+    "#ifndef RDZ_SAMPLING\n"
+    "  if (rdz_sample_hz > 0)\n"
+    "  {\n"
+    "    fprintf(stderr, \"RDZ_SAMPLE needs a spec built with -DRDZ_WITH_SAMPLE (glibc or macOS)\\n\");\n"
+    "    rdz_sample_hz = 0;\n"
+    "  }\n"
+    "#endif\n"
+    "\n"
+    "  // RDZ_COVERAGE=cov\n"
+    "\n"
+    "  rdz_coverage = getenv(\"RDZ_COVERAGE\");\n"
+    "\n"
+    "#ifndef RDZ_GCOV\n"
+    "  if (rdz_coverage)\n"
+    "  {\n"
+    "    fprintf(stderr, \"RDZ_COVERAGE needs a spec built with --coverage -DRDZ_GCOV\\n\");\n"
+    "    rdz_coverage = NULL;\n"
+    "  }\n"
+    "#endif\n"
+    "\n"
+    "  // RDZ_HEXDUMP\n"
+    "\n"
+    "  char *rh = getenv(\"RDZ_HEXDUMP\");\n"
+    "\n"
+    "  rdz_hexdump_on =\n"
+    "    rh &&\n"
+    "    (\n"
+    "      strcmp(rh, \"1\") == 0 ||\n"
+    "      strcasecmp(rh, \"on\") == 0 ||\n"
+    "      strcasecmp(rh, \"yes\") == 0 ||\n"
+    "      strcasecmp(rh, \"true\") == 0\n"
+    "    );\n"
+    "}\n"
+    "\n"
+    "void rdz_run_all_children(int n)\n"
+    "{\n"
+    "  const int *cs = rdz_children(n);\n"
+    "\n"
+    "  for (int i = 0; i < rdz_t->ccounts[n]; i++)\n"
+    "  {\n"
+    "    int cn = cs[i];\n"
+    "    char ct = rdz_t->types[cn];\n"
+    "    if (ct != 'd' && ct != 'c' && ct != 'i' && ct != 'p') continue;\n"
+    "    if (rdz_doruns[cn] < 1) rdz_doruns[cn] = 1;\n"
+    "    if (ct != 'i' || ct != 'p') rdz_run_all_children(cn);\n"
+    "  }\n"
+    "}\n"
+    "void rdz_run_all_parents(int parentnumber)\n"
+    "{\n"
+    "  if (parentnumber < 0) return;\n"
+    "\n"
+    "  if (rdz_doruns[parentnumber] < 1) rdz_doruns[parentnumber] = 1;\n"
+    "\n"
+    "  rdz_run_all_parents(rdz_t->parents[parentnumber]);\n"
+    "}\n"
+    "\n"
+    "int rdz_determine_dorun_l(int n)\n"
+    "{\n"
+    "  if (rdz_lines == NULL) return -1;\n"
+    "\n"
+    "  int ltstart = rdz_t->ltstarts[n];\n"
+    "  int llength = rdz_t->llengths[n];\n"
+    "\n"
+    "  for (size_t i = 0; rdz_lines[i] > -1; i++)\n"
+    "  {\n"
+    "    int l = rdz_lines[i];\n"
+    "    if (l >= ltstart && l <= ltstart + llength) return 1;\n"
+    "  }\n"
+    "\n"
+    "  return 0;\n"
+    "}\n"
+    "\n"
+    "int rdz_determine_dorun_i(int n)\n"
+    "{\n"
+    "  if (rdz_its == NULL) return -1;\n"
+    "\n"
+    "  for (char *i = rdz_its; ; i++)\n"
+    "  {\n"
+    "    if (atoi(i) == n) return 1;\n"
+    "\n"
+    "    i = strchr(i, ','); if (i == NULL) break;\n"
+    "  }\n"
+    "\n"
+    "  return 0;\n"
+    "}\n"
+    "\n"
+    "int rdz_determine_dorun_e(int n)\n"
+    "{\n"
+    "  if (rdz_example == NULL) return -1;\n"
+    "  return (strstr(rdz_text(n), rdz_example) != NULL);\n"
+    "}\n"
+    "\n"
+    "int rdz_determine_dorun_f(int n)\n"
+    "{\n"
+    "  if (rdz_files == NULL) return -1;\n"
+    "\n"
+    "  for (size_t i = 0; ; i++)\n"
+    "  {\n"
+    "    char *fn = rdz_files[i];\n"
+    "    if (fn == NULL) break;\n"
+    "    if (strcmp(fn, rdz_fname(n)) == 0) return 1;\n"
+    "  }\n"
+    "\n"
+    "  return 0;\n"
+    "}\n"
+    "\n"
+    "size_t rdz_stem_length(const char *s, size_t l)\n"
+    "{\n"
+    "  for (size_t i = l; i > 0; i--)\n"
+    "  {\n"
+    "    if (s[i - 1] == '/') break;\n"
+    "    if (s[i - 1] == '.') return i - 1;\n"
+    "  }\n"
+    "  return l;\n"
+    "}\n"
+    "\n"
+    "int rdz_path_match(const char *a, size_t al, const char *b, size_t bl)\n"
+    "{\n"
+    "  // \"src/flutil.c\" matches \"../src/flutil.h\", the extensions and the\n"
+    "  // leading ./ and ../ are ignored, the shorter path has to be the tail\n"
+    "  // of the longer one\n"
+    "\n"
+    "  while (al > 1 && a[0] == '.' && a[1] == '/') { a += 2; al -= 2; }\n"
+    "  while (al > 2 && strncmp(a, \"../\", 3) == 0) { a += 3; al -= 3; }\n"
+    "  while (bl > 1 && b[0] == '.' && b[1] == '/') { b += 2; bl -= 2; }\n"
+    "  while (bl > 2 && strncmp(b, \"../\", 3) == 0) { b += 3; bl -= 3; }\n"
+    "\n"
+    "  al = rdz_stem_length(a, al);\n"
+    "  bl = rdz_stem_length(b, bl);\n"
+    "\n"
+    "  if (al > bl) { const char *s = a; a = b; b = s; size_t l = al; al = bl; bl = l; }\n"
+    "\n"
+    "  if (al < 1) return 0;\n"
+    "  if (strncmp(a, b + bl - al, al) != 0) return 0;\n"
+    "\n"
+    "  return al == bl || b[bl - al - 1] == '/';\n"
+    "}\n"
+    "\n"
+    "int rdz_determine_dorun_s(int n)\n"
+    "{\n"
+    "  if (rdz_sources == NULL) return -1;\n"
+    "\n"
+    "  char *d = rdz_deps(n);\n"
+    "\n"
+    "  if (*d == '\\0') return 1; // no dependency info (no -MH), let it run\n"
+    "\n"
+    "  for (char *s = rdz_sources; *s; )\n"
+    "  {\n"
+    "    s += strspn(s, \" \\t\"); size_t sl = strcspn(s, \" \\t\");\n"
+    "    if (sl < 1) break;\n"
+    "\n"
+    "    for (char *e = d; *e; )\n"
+    "    {\n"
+    "      e += strspn(e, \" \"); size_t el = strcspn(e, \" \");\n"
+    "      if (el < 1) break;\n"
+    "\n"
+    "      if (rdz_path_match(s, sl, e, el)) return 1;\n"
+    "\n"
+    "      e += el;\n"
+    "    }\n"
+    "\n"
+    "    s += sl;\n"
+    "  }\n"
+    "\n"
+    "  return 0;\n"
+    "}\n"
+    "\n"
+    "void rdz_determine_dorun()\n"
+    "{\n"
+    "  // first pass, determine if a node should get run on its own\n"
+    "\n"
+    "  for (int n = 0; n < rdz_t->count; n++)\n"
+    "  {\n"
+    "    char t = rdz_t->types[n];\n"
+    "\n"
+    "    //if (t == 'B' || t == 'b' || t == 'A' || t == 'a') continue;\n"
+    "    if (t == 'G' || t == 'g') rdz_doruns[n] = 1;\n"
+    "    if (t != 'd' && t != 'c' && t != 'i' && t != 'p') continue;\n"
+    "\n"
+    "    int re = rdz_determine_dorun_e(n);\n"
+    "    int rl = rdz_determine_dorun_l(n);\n"
+    "    int rf = rdz_determine_dorun_f(n);\n"
+    "    int ri = rdz_determine_dorun_i(n);\n"
+    "    int rs = rdz_determine_dorun_s(n);\n"
+    "\n"
+    "    if (rl < 0 && re < 0 && rf < 0 && ri < 0 && rs < 0) rdz_doruns[n] = 1;\n"
+    "    if (rf > 0) rdz_doruns[n] = 1;\n"
+    "    if (rs > 0) rdz_doruns[n] = 1;\n"
+    "    if (rl > 0) rdz_doruns[n] = 2; // all children if they're all 0\n"
+    "    if (re > 0) rdz_doruns[n] = 3; // ancestors and all children\n"
+    "    if (ri > 0) rdz_doruns[n] = 3;\n"
+    "\n"
+    "    //printf(\n"
+    "    //  \"\%d) re: \%d, rl: \%d, rf: \%d dorun: \%d\\n\",\n"
+    "    //  n, re, rl, rf, rdz_doruns[n]);\n"
+    "  }\n"
+    "\n"
+    "  // second pass, ancestors and children are brought in\n"
+    "\n"
+    "  for (int n = 0; n < rdz_t->count; n++)\n"
+    "  {\n"
+    "    if (rdz_doruns[n] < 2) continue;\n"
+    "\n"
+    "    int run_parents = 0;\n"
+    "    int run_children = 0;\n"
+    "\n"
+    "    if (rdz_doruns[n] == 2)\n"
+    "    {\n"
+    "      run_children = 1;\n"
+    "\n"
+    "      const int *cs = rdz_children(n);\n"
+    "\n"
+    "      for (int j = 0; j < rdz_t->ccounts[n]; j++)\n"
+    "      {\n"
+    "        if (rdz_doruns[cs[j]] > 1) run_children = 0;\n"
+    "      }\n"
+    "    }\n"
+    "    else //if (rdz_doruns[n] == 3)\n"
+    "    {\n"
+    "      run_parents = 1;\n"
+    "      run_children = 1;\n"
+    "    }\n"
+    "\n"
+    "    if (run_parents) rdz_run_all_parents(rdz_t->parents[n]);\n"
+    "    if (run_children) rdz_run_all_children(n);\n"
+    "  }\n"
+    "}\n"
+    "\n"
+    "  //\n"
+    "  // RDZ_TRACE\n"
+    "\n"
+    "static void rdz_json_string(FILE *f, const char *s)\n"
+    "{\n"
+    "  fputc('\"', f);\n"
+    "\n"
+    "  for (const unsigned char *c = (const unsigned char *)s; *c; c++)\n"
+    "  {\n"
+    "    if (*c == '\"' || *c == '\\\\') fprintf(f, \"\\\\\%c\", *c);\n"
+    "    else if (*c < 0x20) fprintf(f, \"\\\\u\%04x\", *c);\n"
+    "    else fputc(*c, f);\n"
+    "  }\n"
+    "\n"
+    "  fputc('\"', f);\n"
+    "}\n"
+    "\n"
+    "typedef struct rdz_trace_event {\n"
+    "  char ph; // 'B'egin or 'E'nd\n"
+    "  int n;\n"
+    "  double ts; // microseconds, monotonic\n"
+    "} rdz_trace_event;\n"
+    "\n"
+    "typedef struct rdz_trace_buf { // one per thread, no locking when recording\n"
+    "  int tid;\n"
+    "  size_t from; // in a forked worker, what was recorded before the fork\n"
+    "  size_t count;\n"
+    "  size_t size;\n"
+    "  rdz_trace_event *events;\n"
+    "  struct rdz_trace_buf *next;\n"
+    "} rdz_trace_buf;\n"
+    "\n"
+    "static rdz_trace_buf *rdz_trace_bufs = NULL;\n"
+    "static int rdz_trace_tids = 0;\n"
+    "static char *rdz_trace_forked = NULL; // what the forked workers recorded\n"
+    "static size_t rdz_trace_forked_length = 0;\n"
+    "#ifdef RDZ_CONCURRENT\n"
+    "__thread\n"
+    "#endif\n"
+    "rdz_trace_buf *rdz_trace_local = NULL;\n"
+    "\n"
+    "void rdz_trace_record(char ph, int n)\n"
+    "{\n"
+    "  struct timespec t; clock_gettime(CLOCK_MONOTONIC, &t);\n"
+    "\n"
+    "  rdz_trace_buf *b = rdz_trace_local;\n"
+    "\n"
+    "  if (b == NULL) // first event for this thread, register its buffer\n"
+    "  {\n"
+    "    b = calloc(1, sizeof(rdz_trace_buf));\n"
+    "    b->tid = __atomic_add_fetch(&rdz_trace_tids, 1, __ATOMIC_RELAXED);\n"
+    "    b->next = __atomic_load_n(&rdz_trace_bufs, __ATOMIC_ACQUIRE);\n"
+    "    while ( ! __atomic_compare_exchange_n(\n"
+    "      &rdz_trace_bufs, &b->next, b, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));\n"
+    "    rdz_trace_local = b;\n"
+    "  }\n"
+    "\n"
+    "  if (b->count >= b->size)\n"
+    "  {\n"
+    "    b->size = b->size ? b->size * 2 : 1024;\n"
+    "    b->events = realloc(b->events, b->size * sizeof(rdz_trace_event));\n"
+    "  }\n"
+    "\n"
+    "  rdz_trace_event *e = b->events + b->count++;\n"
+    "  e->ph = ph; e->n = n;\n"
+    "  e->ts = t.tv_sec * 1000000.0 + t.tv_nsec / 1000.0;\n"
+    "}\n"
+    "\n"
+    "double rdz_call_traced(int n)\n"
+    "{\n"
+    "  rdz_trace_record('B', n);\n"
+    "  double r = rdz_t->funcs[n]();\n"
+    "  rdz_trace_record('E', n);\n"
+    "\n"
+    "  return r;\n"
+    "}\n"
+    "\n"
+    "static void rdz_write(int fd, const char *s, size_t l); // see below\n"
+    "\n"
+    "double rdz_call(int n)\n"
+    "{\n"
+    "  // runs an \"it\" or a hook, traced or not, a bisection run tells when\n"
+    "  // the bisected example starts and ends, in case it doesn't end\n"
+    "\n"
+    "  int b = n == rdz_bisect_it;\n"
+    "\n"
+    "  if (b) rdz_write(rdz_bisect_fd, \"start\\n\", 6);\n"
+    "\n"
+    "  double r = rdz_trace ? rdz_call_traced(n) : rdz_t->funcs[n]();\n"
+    "\n"
+    "  if (b) rdz_write(rdz_bisect_fd, \"end\\n\", 4);\n"
+    "\n"
+    "  return r;\n"
+    "}\n"
+    "\n"
+    "static const char *rdz_trace_category(char t)\n"
+    "{\n"
+    "  if (t == 'd') return \"describe\";\n"
+    "  if (t == 'c') return \"context\";\n"
+    "  if (t == 'i') return \"it\";\n"
+    "  if (t == 'B') return \"before all\";\n"
+    "  if (t == 'A') return \"after all\";\n"
+    "  if (t == 'y') return \"before each offline\";\n"
+    "  if (t == 'z') return \"after each offline\";\n"
+    "  return \"rodzo\";\n"
+    "}\n"
+    "\n"
+    "static void rdz_trace_write_events(FILE *f, int *first)\n"
+    "{\n"
+    "  // the events recorded by this process (since the fork, for a worker)\n"
+    "\n"
+    "  int pid = (int)getpid();\n"
+    "\n"
+    "  for (rdz_trace_buf *b = rdz_trace_bufs; b; b = b->next)\n"
+    "  {\n"
+    "    if (b->count <= b->from) continue;\n"
+    "\n"
+    "    fprintf(\n"
+    "      f, \"\%s{\\\"name\\\":\\\"thread_name\\\",\\\"ph\\\":\\\"M\\\",\\\"pid\\\":\%d,\\\"tid\\\":\%d,\"\n"
+    "      \"\\\"args\\\":{\\\"name\\\":\\\"\%s \%d\\\"}}\",\n"
+    "      *first ? \"\" : \",\\n\", pid, b->tid, b->tid == 1 ? \"main\" : \"thread\", b->tid);\n"
+    "    *first = 0;\n"
+    "\n"
+    "    for (size_t i = b->from; i < b->count; i++)\n"
+    "    {\n"
+    "      rdz_trace_event *e = b->events + i;\n"
+    "      char t = rdz_t->types[e->n];\n"
+    "      const char *cat = rdz_trace_category(t);\n"
+    "\n"
+    "      fprintf(f, \",\\n{\\\"name\\\":\");\n"
+    "      rdz_json_string(f, t == 'd' || t == 'c' || t == 'i' ? rdz_text(e->n) : cat);\n"
+    "      fprintf(\n"
+    "        f, \",\\\"cat\\\":\\\"\%s\\\",\\\"ph\\\":\\\"\%c\\\",\\\"ts\\\":\%.3f,\\\"pid\\\":\%d,\\\"tid\\\":\%d,\"\n"
+    "        \"\\\"args\\\":{\\\"I\\\":\%d,\\\"L\\\":\%d}}\",\n"
+    "        cat, e->ph, e->ts, pid, b->tid, e->n, rdz_t->ltstarts[e->n]);\n"
+    "    }\n"
+    "  }\n"
+    "}\n"
+    "\n"
+    "void rdz_trace_fork()\n"
+    "{\n"
+    "  // in a freshly forked worker, only what comes next is the worker's\n"
+    "\n"
+    "  for (rdz_trace_buf *b = rdz_trace_bufs; b; b = b->next) b->from = b->count;\n"
+    "}\n"
+    "\n"
+    "void rdz_trace_gather(const char *s, size_t l)\n"
+    "{\n"
+    "  // keeps what a forked worker recorded, for rdz_trace_write()\n"
+    "\n"
+    "  if (l < 1) return;\n"
+    "\n"
+    "  rdz_trace_forked = realloc(rdz_trace_forked, rdz_trace_forked_length + l + 3);\n"
+    "  memcpy(rdz_trace_forked + rdz_trace_forked_length, \",\\n\", 2);\n"
+    "  memcpy(rdz_trace_forked + rdz_trace_forked_length + 2, s, l);\n"
+    "  rdz_trace_forked_length += l + 2;\n"
+    "  rdz_trace_forked[rdz_trace_forked_length] = '\\0';\n"
+    "}\n"
+    "\n"
+    "void rdz_trace_write()\n"
+    "{\n"
+    "  // the trace event format, as loaded by chrome://tracing or Perfetto\n"
+    "\n"
+    "  if (rdz_trace == NULL) return;\n"
+    "\n"
+    "  FILE *f = fopen(rdz_trace, \"w\");\n"
+    "\n"
+    "  if (f == NULL) { fprintf(stderr, \"couldn't write \%s\\n\", rdz_trace); return; }\n"
+    "\n"
+    "  int first = 1;\n"
+    "\n"
+    "  fprintf(f, \"[\\n\");\n"
+    "  rdz_trace_write_events(f, &first);\n"
+    "  if (rdz_trace_forked) fputs(first ? rdz_trace_forked + 2 : rdz_trace_forked, f);\n"
+    "  fprintf(f, \"\\n]\\n\");\n"
+    "\n"
+    "  fclose(f);\n"
+    "\n"
+    "  while (rdz_trace_bufs)\n"
+    "  {\n"
+    "    rdz_trace_buf *b = rdz_trace_bufs; rdz_trace_bufs = b->next;\n"
+    "    free(b->events); free(b);\n"
+    "  }\n"
+    "  rdz_trace_local = NULL; rdz_trace_tids = 0;\n"
+    "  free(rdz_trace_forked); rdz_trace_forked = NULL; rdz_trace_forked_length = 0;\n"
+    "}\n"
+    "\n"
+    "void rdz_run_offlines(int nodenumber, char type)\n"
+    "{\n"
+    "  if (nodenumber == -1) return;\n"
+    "\n"
+    "  // before each offline\n"
+    "  if (type == 'y') rdz_run_offlines(rdz_t->parents[nodenumber], type);\n"
+    "\n"
+    "  const int *cs = rdz_children(nodenumber);\n"
+    "\n"
+    "  for (int i = 0; i < rdz_t->ccounts[nodenumber]; i++)\n"
+    "  {\n"
+    "    if (rdz_t->types[cs[i]] == type) rdz_call(cs[i]);\n"
+    "  }\n"
+    "\n"
+    "  // after each offline\n"
+    "  if (type == 'z') rdz_run_offlines(rdz_t->parents[nodenumber], type);\n"
+    "}\n"
+    "\n"
+    "int rdz_has_offlines(int nodenumber)\n"
+    "{\n"
+    "  for (int n = nodenumber; n > -1; n = rdz_t->parents[n])\n"
+    "  {\n"
+    "    const int *cs = rdz_children(n);\n"
+    "\n"
+    "    for (int i = 0; i < rdz_t->ccounts[n]; i++)\n"
+    "    {\n"
+    "      char t = rdz_t->types[cs[i]]; if (t == 'y' || t == 'z') return 1;\n"
+    "    }\n"
+    "  }\n"
+    "\n"
+    "  return 0;\n"
+    "}\n"
+    "\n"
+    "#ifdef RDZ_GCOV\n"
+    "void __gcov_reset(void);\n"
+    "void __gcov_dump(void);\n"
+    "#endif\n"
+    "\n"
+    "void rdz_coverage_start()\n"
+    "{\n"
+    "#ifdef RDZ_GCOV\n"
+    "  if (rdz_coverage) __gcov_reset();\n"
+    "#endif\n"
+    "}\n"
+    "\n"
+    "void rdz_coverage_stop(int n)\n"
+    "{\n"
+    "#ifdef RDZ_GCOV\n"
+    "  if (rdz_coverage == NULL) return;\n"
+    "\n"
+    "  // the .gcda files for example n go under cov/n/\n"
+    "\n"
+    "  char prefix[1024]; snprintf(prefix, 1024, \"\%s/\%d\", rdz_coverage, n);\n"
+    "\n"
+    "  setenv(\"GCOV_PREFIX\", prefix, 1);\n"
+    "  __gcov_dump();\n"
+    "  unsetenv(\"GCOV_PREFIX\");\n"
+    "\n"
+    "  __gcov_reset(); // and the final (at exit) dump will be empty\n"
+    "#else\n"
+    "  (void)n;\n"
+    "#endif\n"
+    "}\n"
+    "\n"
+    "#ifdef RDZ_GCOV\n"
+    "void rdz_coverage_lines(FILE *out, char *gcda)\n"
+    "{\n"
+    "  // runs gcov on the .gcda, writes \" file:1-3,7\" for each source\n"
+    "\n"
+    "  char cmd[2048]; snprintf(cmd, 2048, \"gcov -t '\%s' 2>/dev/null\", gcda);\n"
+    "\n"
+    "  FILE *in = popen(cmd, \"r\"); if (in == NULL) return;\n"
+    "\n"
+    "  char line[4096];\n"
+    "  int first = -1; int last = -1;\n"
+    "\n"
+    "  while (fgets(line, 4096, in))\n"
+    "  {\n"
+    "    char *c = strchr(line, ':'); if (c == NULL) continue;\n"
+    "    char *c1 = strchr(c + 1, ':'); if (c1 == NULL) continue;\n"
+    "\n"
+    "    int l = atoi(c + 1);\n"
+    "\n"
+    "    if (l == 0 && strncmp(c1 + 1, \"Source:\", 7) == 0)\n"
+    "    {\n"
+    "      if (first > -1) fprintf(out, last > first ? \"\%d-\%d\" : \"\%d\", first, last);\n"
+    "      first = -1; last = -1;\n"
+    "      c1[strcspn(c1, \"\\n\")] = '\\0';\n"
+    "      fprintf(out, \" \%s:\", c1 + 8);\n"
+    "      continue;\n"
+    "    }\n"
+    "\n"
+    "    char *s = line; while (*s == ' ') ++s;\n"
+    "    if (*s < '1' || *s > '9') continue; // \"-\", \"#####\" or \"=====\"\n"
+    "\n"
+    "    if (l == last + 1 && first > -1) { last = l; continue; }\n"
+    "\n"
+    "    if (first > -1) fprintf(out, last > first ? \"\%d-\%d,\" : \"\%d,\", first, last);\n"
+    "    first = l; last = l;\n"
+    "  }\n"
+    "  if (first > -1) fprintf(out, last > first ? \"\%d-\%d\" : \"\%d\", first, last);\n"
+    "\n"
+    "  pclose(in);\n"
+    "}\n"
+    "#endif\n"
+    "\n"
+    "void rdz_coverage_map()\n"
+    "{\n"
+    "#ifdef RDZ_GCOV\n"
+    "  if (rdz_coverage == NULL) return;\n"
+    "\n"
+    "  // writes cov/map.txt, one line per example,\n"
+    "  // \"node_number file:lines file:lines...\"\n"
+    "\n"
+    "  char path[1024]; snprintf(path, 1024, \"\%s/map.txt\", rdz_coverage);\n"
+    "\n"
+    "  FILE *out = fopen(path, \"wb\"); if (out == NULL) return;\n"
+    "\n"
+    "  for (int n = 0; n < rdz_t->count; n++)\n"
+    "  {\n"
+    "    if (rdz_t->types[n] != 'i' || ! rdz_doruns[n]) continue;\n"
+    "\n"
+    "    char cmd[1024];\n"
+    "    snprintf(cmd, 1024, \"find '\%s/\%d' -name '*.gcda' 2>/dev/null\", rdz_coverage, n);\n"
+    "\n"
+    "    FILE *in = popen(cmd, \"r\"); if (in == NULL) continue;\n"
+    "\n"
+    "    fprintf(out, \"\%d\", n);\n"
+    "\n"
+    "    char gcda[1024];\n"
+    "\n"
+    "    while (fgets(gcda, 1024, in))\n"
+    "    {\n"
+    "      gcda[strcspn(gcda, \"\\n\")] = '\\0';\n"
+    "\n"
+    "      // the .gcno sits where the spec got compiled,\n"
+    "      // cov/6/home/x/spec/s.gcda --> /home/x/spec/s.gcno\n"
+    "\n"
+    "      char gcno[1024]; strcpy(gcno, gcda);\n"
+    "      strcpy(gcno + strlen(gcno) - 5, \".gcno\");\n"
+    "      char *g = gcno + strlen(rdz_coverage) + 1; g = strchr(g, '/');\n"
+    "\n"
+    "      if (g) symlink(g, gcno);\n"
+    "\n"
+    "      rdz_coverage_lines(out, gcda);\n"
+    "    }\n"
+    "\n"
+    "    fprintf(out, \"\\n\");\n"
+    "\n"
+    "    pclose(in);\n"
+    "  }\n"
+    "\n"
+    "  fclose(out);\n"
+    "\n"
+    "  printf(\"\\n\%scoverage map written to \%s\%s\\n\", rdz_gr(), path, rdz_cl());\n"
+    "#endif\n"
+    "}\n"
+    "\n"
+    "  //\n"
+    "  // RDZ_SAMPLE\n"
+    "\n"
+    "#ifdef RDZ_SAMPLING\n"
+    "\n"
+    "#define RDZ_SAMPLE_DEPTH 64\n"
+    "#define RDZ_SAMPLE_RING 8192\n"
+    "\n"
+    "typedef struct rdz_sample {\n"
+    "  volatile unsigned long seq; // index + 1, once written\n"
+    "  int node;\n"
+    "  int depth;\n"
+    "  void *pcs[RDZ_SAMPLE_DEPTH];\n"
+    "} rdz_sample;\n"
+    "\n"
+    "static rdz_sample *rdz_sample_ring = NULL; // preallocated, written by the handler\n"
+    "static volatile unsigned long rdz_sample_head = 0;\n"
+    "static unsigned long rdz_sample_tail = 0;\n"
+    "static unsigned long rdz_sample_dropped = 0;\n"
+    "static unsigned long rdz_sample_total = 0;\n"
+    "\n"
+    "typedef struct rdz_stack { // samples aggregated per node and stack\n"
+    "  unsigned long count;\n"
+    "  int node;\n"
+    "  int depth;\n"
+    "  void *pcs[RDZ_SAMPLE_DEPTH];\n"
+    "} rdz_stack;\n"
+    "\n"
+    "static rdz_stack *rdz_stacks = NULL;\n"
+    "static size_t rdz_stacks_size = 0;\n"
+    "static size_t rdz_stacks_count = 0;\n"
+    "static unsigned long *rdz_sample_counts = NULL; // per node\n"
+    "\n"
+    "static char *rdz_sample_stack_lo = NULL; // the main thread stack, the\n"
+    "static char *rdz_sample_stack_hi = NULL; // frame walk doesn't read past it\n"
+    "\n"
+    "static int rdz_sample_regs(void *uc, void **pc, char **fp)\n"
+    "{\n"
+    "  // the pc and the frame pointer of the interrupted code\n"
+    "\n"
+    "  (void)uc; (void)pc; (void)fp;\n"
+    "\n"
+    "#if defined(__APPLE__) && defined(__x86_64__)\n"
+    "  *pc = (void *)((ucontext_t *)uc)->uc_mcontext->__ss.__rip;\n"
+    "  *fp = (char *)((ucontext_t *)uc)->uc_mcontext->__ss.__rbp;\n"
+    "  return 1;\n"
+    "#elif defined(__APPLE__) && defined(__aarch64__)\n"
+    "  *pc = (void *)((ucontext_t *)uc)->uc_mcontext->__ss.__pc;\n"
+    "  *fp = (char *)((ucontext_t *)uc)->uc_mcontext->__ss.__fp;\n"
+    "  return 1;\n"
+    "#elif defined(__linux__) && defined(__x86_64__)\n"
+    "  *pc = (void *)((ucontext_t *)uc)->uc_mcontext.gregs[16]; // REG_RIP\n"
+    "  *fp = (char *)((ucontext_t *)uc)->uc_mcontext.gregs[10]; // REG_RBP\n"
+    "  return 1;\n"
+    "#elif defined(__linux__) && defined(__aarch64__)\n"
+    "  *pc = (void *)((ucontext_t *)uc)->uc_mcontext.pc;\n"
+    "  *fp = (char *)((ucontext_t *)uc)->uc_mcontext.regs[29];\n"
+    "  return 1;\n"
+    "#else\n"
+    "  return 0;\n"
+    "#endif\n"
+    "}\n"
+    "\n"
+    "static void rdz_sample_handler(int sig, siginfo_t *si, void *uc)\n"
+    "{\n"
+    "  // async-signal-safe: no backtrace() (it may lock or allocate, in the\n"
+    "  // middle of a malloc() it may deadlock), the stack is walked by following\n"
+    "  // the saved frame pointers, each frame is [ previous fp, return address ].\n"
+    "  // The walk stays within the main thread stack and only goes up, other\n"
+    "  // threads get their leaf pc only. Code compiled without frame pointers\n"
+    "  // yields short or partial stacks, never a fault.\n"
+    "\n"
+    "  (void)sig; (void)si;\n"
+    "\n"
+    "  int e = errno;\n"
+    "\n"
+    "  unsigned long i = __atomic_fetch_add(&rdz_sample_head, 1, __ATOMIC_ACQ_REL);\n"
+    "  rdz_sample *s = rdz_sample_ring + (i \% RDZ_SAMPLE_RING);\n"
+    "\n"
+    "  __atomic_store_n(&s->seq, 0, __ATOMIC_RELEASE);\n"
+    "  s->node = rdz_sample_node;\n"
+    "\n"
+    "  int d = 0;\n"
+    "  void *pc = NULL; char *fp = NULL;\n"
+    "\n"
+    "  if (rdz_sample_regs(uc, &pc, &fp))\n"
+    "  {\n"
+    "    s->pcs[d++] = pc;\n"
+    "\n"
+    "    char *lo = (char *)&d; // below the interrupted frames\n"
+    "    char *hi = rdz_sample_stack_hi;\n"
+    "\n"
+    "    if (lo < rdz_sample_stack_lo || lo >= hi) fp = NULL; // not the main thread\n"
+    "\n"
+    "    while (\n"
+    "      d < RDZ_SAMPLE_DEPTH &&\n"
+    "      fp >= lo && fp + 2 * sizeof(void *) <= hi &&\n"
+    "      ((size_t)fp & (sizeof(void *) - 1)) == 0\n"
+    "    ) {\n"
+    "      void **fr = (void **)fp;\n"
+    "      if (fr[1] == NULL) break;\n"
+    "      s->pcs[d++] = fr[1];\n"
+    "      if ((char *)fr[0] <= fp) break;\n"
+    "      fp = fr[0];\n"
+    "    }\n"
+    "  }\n"
+    "\n"
+    "  s->depth = d;\n"
+    "  __atomic_store_n(&s->seq, i + 1, __ATOMIC_RELEASE);\n"
+    "\n"
+    "  errno = e;\n"
+    "}\n"
+    "\n"
+    "static size_t rdz_stack_hash(int node, int depth, void **pcs)\n"
+    "{\n"
+    "  size_t h = 14695981039346656037ULL ^ (size_t)node;\n"
+    "  for (int i = 0; i < depth; i++) { h ^= (size_t)pcs[i]; h *= 1099511628211ULL; }\n"
+    "  return h;\n"
+    "}\n"
+    "\n"
+    "static void rdz_stack_add(int node, int depth, void **pcs, unsigned long count)\n"
+    "{\n"
+    "  if (rdz_stacks_count * 2 >= rdz_stacks_size) // grow and rehash\n"
+    "  {\n"
+    "    rdz_stack *old = rdz_stacks; size_t os = rdz_stacks_size;\n"
+    "\n"
+    "    rdz_stacks_size = os ? os * 2 : 1024;\n"
+    "    rdz_stacks = calloc(rdz_stacks_size, sizeof(rdz_stack));\n"
+    "    rdz_stacks_count = 0;\n"
+    "\n"
+    "    for (size_t i = 0; i < os; i++)\n"
+    "    {\n"
+    "      if (old[i].count) rdz_stack_add(old[i].node, old[i].depth, old[i].pcs, old[i].count);\n"
+    "    }\n"
+    "    free(old);\n"
+    "  }\n"
+    "\n"
+    "  size_t m = rdz_stacks_size - 1;\n"
+    "\n"
+    "  for (size_t i = rdz_stack_hash(node, depth, pcs) & m; ; i = (i + 1) & m)\n"
+    "  {\n"
+    "    rdz_stack *st = rdz_stacks + i;\n"
+    "\n"
+    "    if (st->count == 0)\n"
+    "    {\n"
+    "      st->node = node; st->depth = depth;\n"
+    "      memcpy(st->pcs, pcs, depth * sizeof(void *));\n"
+    "      rdz_stacks_count++;\n"
+    "    }\n"
+    "    else if (\n"
+    "      st->node != node || st->depth != depth ||\n"
+    "      memcmp(st->pcs, pcs, depth * sizeof(void *)) != 0\n"
+    "    ) continue;\n"
+    "\n"
+    "    st->count += count;\n"
+    "    return;\n"
+    "  }\n"
+    "}\n"
+    "\n"
+    "void rdz_sample_drain()\n"
+    "{\n"
+    "  // moves the samples from the ring to the stack table, called from\n"
+    "  // rdz_dorun() between examples, not from the handler\n"
+    "\n"
+    "  if (rdz_sample_ring == NULL) return;\n"
+    "\n"
+    "  unsigned long head = __atomic_load_n(&rdz_sample_head, __ATOMIC_ACQUIRE);\n"
+    "\n"
+    "  if (head - rdz_sample_tail > RDZ_SAMPLE_RING) // overrun\n"
+    "  {\n"
+    "    rdz_sample_dropped += head - rdz_sample_tail - RDZ_SAMPLE_RING;\n"
+    "    rdz_sample_tail = head - RDZ_SAMPLE_RING;\n"
+    "  }\n"
+    "\n"
+    "  for (; rdz_sample_tail < head; rdz_sample_tail++)\n"
+    "  {\n"
+    "    unsigned long i = rdz_sample_tail;\n"
+    "    rdz_sample *s = rdz_sample_ring + (i \% RDZ_SAMPLE_RING);\n"
+    "\n"
+    "    if (__atomic_load_n(&s->seq, __ATOMIC_ACQUIRE) != i + 1) { rdz_sample_dropped++; continue; }\n"
+    "\n"
+    "    rdz_sample c; memcpy(&c, s, sizeof(rdz_sample));\n"
+    "\n"
+    "    if (__atomic_load_n(&s->seq, __ATOMIC_ACQUIRE) != i + 1) { rdz_sample_dropped++; continue; }\n"
+    "\n"
+    "    if (c.depth > RDZ_SAMPLE_DEPTH) c.depth = RDZ_SAMPLE_DEPTH;\n"
+    "\n"
+    "    rdz_stack_add(c.node, c.depth, c.pcs, 1);\n"
+    "    rdz_sample_total++;\n"
+    "  }\n"
+    "}\n"
+    "\n"
+    "static void rdz_sample_stack_bounds()\n"
+    "{\n"
+    "  // where the main thread stack lies, read once, out of the handler\n"
+    "\n"
+    "#ifdef __APPLE__\n"
+    "  rdz_sample_stack_hi = pthread_get_stackaddr_np(pthread_self());\n"
+    "  rdz_sample_stack_lo = rdz_sample_stack_hi - pthread_get_stacksize_np(pthread_self());\n"
+    "#else\n"
+    "  FILE *f = fopen(\"/proc/self/maps\", \"r\"); if (f == NULL) return;\n"
+    "\n"
+    "  char *line = NULL; size_t n = 0;\n"
+    "\n"
+    "  while (getline(&line, &n, f) > 0)\n"
+    "  {\n"
+    "    if (strstr(line, \"[stack]\") == NULL) continue;\n"
+    "    unsigned long a, b;\n"
+    "    if (sscanf(line, \"\%lx-\%lx\", &a, &b) != 2) continue;\n"
+    "    rdz_sample_stack_lo = (char *)a; rdz_sample_stack_hi = (char *)b;\n"
+    "    break;\n"
+    "  }\n"
+    "  free(line);\n"
+    "  fclose(f);\n"
+    "#endif\n"
+    "}\n"
+    "\n"
+    "void rdz_sample_start()\n"
+    "{\n"
+    "  if (rdz_sample_hz < 1) return;\n"
+    "\n"
+    "  rdz_sample_stack_bounds();\n"
+    "\n"
+    "  rdz_sample_ring = calloc(RDZ_SAMPLE_RING, sizeof(rdz_sample));\n"
+    "  rdz_sample_head = 0; rdz_sample_tail = 0;\n"
+    "  rdz_sample_dropped = 0; rdz_sample_total = 0;\n"
+    "\n"
+    "  struct sigaction sa; memset(&sa, 0, sizeof(sa));\n"
+    "  sa.sa_sigaction = rdz_sample_handler;\n"
+    "  sa.sa_flags = SA_RESTART | SA_SIGINFO;\n"
+    "  sigemptyset(&sa.sa_mask);\n"
+    "  sigaction(SIGPROF, &sa, NULL);\n"
+    "\n"
+    "  long us = 1000000L / rdz_sample_hz; if (us < 1) us = 1;\n"
+    "  struct itimerval it = { { us / 1000000L, us \% 1000000L }, { us / 1000000L, us \% 1000000L } };\n"
+    "  setitimer(ITIMER_PROF, &it, NULL);\n"
+    "}\n"
+    "\n"
+    "static char *rdz_frame_name(const char *sym)\n"
+    "{\n"
+    "  // \"./s(rdz_dorun+0x2a) [0x55d1c]\" --> \"rdz_dorun\"\n"
+    "  // \"./s(+0x2a3c) [0x55d1c]\" --> \"0x55d1c\" (build with -rdynamic)\n"
+    "\n"
+    "  const char *o = strchr(sym, '(');\n"
+    "  const char *p = o ? strpbrk(o, \"+)\") : NULL;\n"
+    "  if (o && p && p > o + 1) return rdz_strndup((char *)o + 1, p - o - 1);\n"
+    "\n"
+    "  const char *b = strrchr(sym, '[');\n"
+    "  const char *c = b ? strchr(b, ']') : NULL;\n"
+    "  if (b && c) return rdz_strndup((char *)b + 1, c - b - 1);\n"
+    "\n"
+    "  return rdz_strdup((char *)sym);\n"
+    "}\n"
+    "\n"
+    "static int rdz_strptr_cmp(const void *a, const void *b)\n"
+    "{\n"
+    "  return strcmp(*(char *const *)a, *(char *const *)b);\n"
+    "}\n"
+    "\n"
+    "void rdz_sample_stop()\n"
+    "{\n"
+    "  // writes the folded stacks, \"title;main;...;leaf count\" lines, to\n"
+    "  // RDZ_SAMPLE_FILE (rdz_sample.folded), ready for flamegraph.pl\n"
+    "\n"
+    "  if (rdz_sample_ring == NULL) return;\n"
+    "\n"
+    "  struct itimerval it; memset(&it, 0, sizeof(it));\n"
+    "  setitimer(ITIMER_PROF, &it, NULL);\n"
+    "  signal(SIGPROF, SIG_IGN);\n"
+    "\n"
+    "  rdz_sample_drain();\n"
+    "\n"
+    "  rdz_sample_counts = calloc(rdz_t->count, sizeof(unsigned long));\n"
+    "\n"
+    "  char **lines = calloc(rdz_stacks_count + 1, sizeof(char *)); size_t lc = 0;\n"
+    "\n"
+    "  for (size_t i = 0; i < rdz_stacks_size; i++)\n"
+    "  {\n"
+    "    rdz_stack *st = rdz_stacks + i;\n"
+    "\n"
+    "    if (st->count == 0) continue;\n"
+    "\n"
+    "    rdz_sample_counts[st->node] += st->count;\n"
+    "\n"
+    "    char *s = NULL; size_t l = 0; FILE *f = open_memstream(&s, &l);\n"
+    "\n"
+    "    char *title = st->node > 0 ? rdz_determine_title(st->node) : rdz_strdup(\"rodzo\");\n"
+    "    for (char *c = title; *c; c++) if (*c == ';') *c = ',';\n"
+    "    size_t tl = strlen(title); while (tl > 0 && title[tl - 1] == ' ') title[--tl] = '\\0';\n"
+    "    char t = rdz_t->types[st->node];\n"
+    "    fprintf(f, \"\%s\%s\", title, st->node > 0 && t != 'i' ? \" (hooks)\" : \"\");\n"
+    "    free(title);\n"
+    "\n"
+    "    int skip = 0; // the walk starts at the interrupted pc\n"
+    "    char **syms = st->depth > skip ? backtrace_symbols(st->pcs, st->depth) : NULL;\n"
+    "    char **names = calloc(st->depth + 1, sizeof(char *));\n"
+    "\n"
+    "    int top = st->depth - 1; // the frames above the runtime are left out\n"
+    "\n"
+    "    for (int j = skip; syms && j < st->depth; j++)\n"
+    "    {\n"
+    "      names[j] = rdz_frame_name(syms[j]);\n"
+    "      for (char *c = names[j]; *c; c++) if (*c == ';' || *c == ' ') *c = '_';\n"
+    "      if (top == st->depth - 1 && strncmp(names[j], \"rdz_\", 4) == 0) top = j - 1;\n"
+    "    }\n"
+    "    if (syms && top == st->depth - 1 && st->depth == RDZ_SAMPLE_DEPTH)\n"
+    "    {\n"
+    "      fprintf(f, \";[truncated]\");\n"
+    "    }\n"
+    "    for (int j = top; syms && j >= skip; j--) fprintf(f, \";\%s\", names[j]);\n"
+    "\n"
+    "    for (int j = 0; j < st->depth; j++) free(names[j]);\n"
+    "    free(names);\n"
+    "    free(syms);\n"
+    "\n"
+    "    fprintf(f, \" \%lu\", st->count);\n"
+    "    fclose(f);\n"
+    "\n"
+    "    lines[lc++] = s;\n"
+    "  }\n"
+    "\n"
+    "  qsort(lines, lc, sizeof(char *), rdz_strptr_cmp);\n"
+    "\n"
+    "  char *path = getenv(\"RDZ_SAMPLE_FILE\"); if (path == NULL) path = \"rdz_sample.folded\";\n"
+    "  FILE *out = fopen(path, \"w\");\n"
+    "\n"
+    "  for (size_t i = 0; i < lc; )\n"
+    "  {\n"
+    "    // different return addresses may fold to the same line, sum them\n"
+    "\n"
+    "    char *sp = strrchr(lines[i], ' ');\n"
+    "    size_t kl = sp - lines[i];\n"
+    "    unsigned long count = 0; size_t j = i;\n"
+    "\n"
+    "    for (; j < lc; j++)\n"
+    "    {\n"
+    "      char *spj = strrchr(lines[j], ' ');\n"
+    "      if ((size_t)(spj - lines[j]) != kl || strncmp(lines[i], lines[j], kl) != 0) break;\n"
+    "      count += strtoul(spj + 1, NULL, 10);\n"
+    "    }\n"
+    "\n"
+    "    if (out) fprintf(out, \"\%.*s \%lu\\n\", (int)kl, lines[i], count);\n"
+    "\n"
+    "    for (; i < j; i++) free(lines[i]);\n"
+    "  }\n"
+    "\n"
+    "  if (out) fclose(out);\n"
+    "  free(lines);\n"
+    "\n"
+    "  free(rdz_stacks); rdz_stacks = NULL; rdz_stacks_size = 0; rdz_stacks_count = 0;\n"
+    "  free((void *)rdz_sample_ring); rdz_sample_ring = NULL;\n"
+    "}\n"
+    "\n"
+    "static int rdz_sample_cmp(const void *a, const void *b)\n"
+    "{\n"
+    "  unsigned long ca = rdz_sample_counts[*(const int *)a];\n"
+    "  unsigned long cb = rdz_sample_counts[*(const int *)b];\n"
+    "\n"
+    "  return ca > cb ? -1 : ca < cb;\n"
+    "}\n"
+    "\n"
+    "void rdz_sample_summary()\n"
+    "{\n"
+    "  if (rdz_sample_counts == NULL) return;\n"
+    "\n"
+    "  char *path = getenv(\"RDZ_SAMPLE_FILE\"); if (path == NULL) path = \"rdz_sample.folded\";\n"
+    "\n"
+    "  if (rdz_fail_count > 0) printf(\"\\n\"); // after the failures\n"
+    "\n"
+    "  printf(\n"
+    "    \"Samples: \%lu at \%dhz, \%lu dropped, folded stacks in \%s\\n\\n\",\n"
+    "    rdz_sample_total, rdz_sample_hz, rdz_sample_dropped, path);\n"
+    "\n"
+    "  int *ns = calloc(rdz_t->count, sizeof(int)); int nc = 0;\n"
+    "  for (int n = 0; n < rdz_t->count; n++) if (rdz_sample_counts[n]) ns[nc++] = n;\n"
+    "\n"
+    "  qsort(ns, nc, sizeof(int), rdz_sample_cmp);\n"
+    "\n"
+    "  for (int i = 0; i < nc && i < 10; i++) // the top ten\n"
+    "  {\n"
+    "    int n = ns[i];\n"
+    "    char *title = n > 0 ? rdz_determine_title(n) : rdz_strdup(\"rodzo\");\n"
+    "    printf(\n"
+    "      \"  \%5.1f\%\%  \%s\%s\%sI=\%d\%s\\n\",\n"
+    "      100.0 * rdz_sample_counts[n] / (rdz_sample_total ? rdz_sample_total : 1),\n"
+    "      title, n > 0 && rdz_t->types[n] != 'i' ? \"(hooks) \" : \"\",\n"
+    "      rdz_gr(), n, rdz_cl());\n"
+    "    free(title);\n"
+    "  }\n"
+    "  printf(\"\\n\");\n"
+    "\n"
+    "  free(ns);\n"
+    "  free(rdz_sample_counts); rdz_sample_counts = NULL;\n"
+    "}\n"
+    "\n"
+    "#else\n"
+    "\n"
+    "void rdz_sample_drain() {}\n"
+    "void rdz_sample_start() {}\n"
+    "void rdz_sample_stop() {}\n"
+    "void rdz_sample_summary() {}\n"
+    "\n"
+    "#endif\n"
+    "\n"
+    "  //\n"
+    "  // RDZ_VALGRIND, the native leak counter\n"
+    "\n"
+    "#if defined(RDZ_LEAKS) && defined(__GLIBC__)\n"
+    "\n"
+    "\n"
+    "extern void *__libc_malloc(size_t s);\n"
+    "extern void *__libc_calloc(size_t n, size_t s);\n"
+    "extern void *__libc_realloc(void *p, size_t s);\n"
+    "extern void *__libc_memalign(size_t a, size_t s);\n"
+    "extern void __libc_free(void *p);\n"
+    "\n"
+    "long rdz_blocks = 0;\n"
+    "\n"
+    "static void *rdz_counted(void *p)\n"
+    "{\n"
+    "  if (p) __atomic_add_fetch(&rdz_blocks, 1, __ATOMIC_RELAXED);\n"
+    "\n"
+    "  return p;\n"
+    "}\n"
+    "\n"
+    "void *malloc(size_t s) { return rdz_counted(__libc_malloc(s)); }\n"
+    "void *calloc(size_t n, size_t s) { return rdz_counted(__libc_calloc(n, s)); }\n"
+    "void *memalign(size_t a, size_t s) { return rdz_counted(__libc_memalign(a, s)); }\n"
+    "void *aligned_alloc(size_t a, size_t s) { return memalign(a, s); }\n"
+    "void *valloc(size_t s) { return memalign(sysconf(_SC_PAGESIZE), s); }\n"
+    "\n"
+    "void *pvalloc(size_t s)\n"
+    "{\n"
+    "  size_t ps = sysconf(_SC_PAGESIZE);\n"
+    "\n"
+    "  return memalign(ps, (s + ps - 1) / ps * ps);\n"
+    "}\n"
+    "\n"
+    "int posix_memalign(void **r, size_t a, size_t s)\n"
+    "{\n"
+    "  void *p = memalign(a, s); if (p == NULL) return ENOMEM;\n"
+    "\n"
+    "  *r = p;\n"
+    "\n"
+    "  return 0;\n"
+    "}\n"
+    "\n"
+    "void *realloc(void *p, size_t s)\n"
+    "{\n"
+    "  void *r = __libc_realloc(p, s);\n"
+    "\n"
+    "  if (p == NULL) rdz_counted(r);\n"
+    "  else if (s == 0 && r == NULL) __atomic_sub_fetch(&rdz_blocks, 1, __ATOMIC_RELAXED);\n"
+    "\n"
+    "  return r;\n"
+    "}\n"
+    "\n"
+    "void free(void *p)\n"
+    "{\n"
+    "  if (p) __atomic_sub_fetch(&rdz_blocks, 1, __ATOMIC_RELAXED);\n"
+    "\n"
+    "  __libc_free(p);\n"
+    "}\n"
+    "\n"
+    "#define RDZ_BLOCKS() rdz_blocks\n"
+    "#else\n"
+    "#define RDZ_BLOCKS() 0\n"
+    "#endif\n"
+    "\n"
+    "void rdz_leak_check(int n, int from, long blocks)\n"
+    "{\n"
+    "  // flags the example if it left more blocks than the results it recorded\n"
+    "\n"
+    "  for (int i = from; i < rdz_count; i++)\n"
+    "  {\n"
+    "    if (rdz_results[i].message) blocks++;\n"
+    "    if (rdz_results[i].title) blocks++;\n"
+    "  }\n"
+    "\n"
+    "  if (RDZ_BLOCKS() > blocks) rdz_leaky[n] = 1;\n"
+    "}\n"
+    "\n"
+    "void rdz_dorun(int n);\n"
+    "\n"
+    "static int rdz_tmpfd(const char *kind, int w)\n"
+    "{\n"
+    "  char *d = getenv(\"TMPDIR\"); if (d == NULL || *d == '\\0') d = \"/tmp\";\n"
+    "\n"
+    "  char path[1024];\n"
+    "  snprintf(path, 1024, \"\%s/rdz_\%d_\%s_\%d\", d, (int)getpid(), kind, w);\n"
+    "\n"
+    "  int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);\n"
+    "  unlink(path);\n"
+    "\n"
+    "  return fd;\n"
+    "}\n"
+    "\n"
+    "static void rdz_write(int fd, const char *s, size_t l)\n"
+    "{\n"
+    "  while (l > 0)\n"
+    "  {\n"
+    "    ssize_t w = write(fd, s, l); if (w < 1) return;\n"
+    "    s += w; l -= w;\n"
+    "  }\n"
+    "}\n"
+    "\n"
+    "static char *rdz_read(int fd, size_t *l)\n"
+    "{\n"
+    "  size_t size = 4096; *l = 0;\n"
+    "  char *r = calloc(size, sizeof(char));\n"
+    "\n"
+    "  lseek(fd, 0, SEEK_SET);\n"
+    "\n"
+    "  while (1)\n"
+    "  {\n"
+    "    if (*l + 1 >= size) { size *= 2; r = realloc(r, size); }\n"
+    "    ssize_t rr = read(fd, r + *l, size - *l - 1); if (rr < 1) break;\n"
+    "    *l += rr;\n"
+    "  }\n"
+    "  r[*l] = '\\0';\n"
+    "\n"
+    "  return r;\n"
+    "}\n"
+    "\n"
+    "static void rdz_snap_window(char *s, size_t n, const char *d, size_t l, size_t at)\n"
+    "{\n"
+    "  // up to 64 bytes around the offset, from the start of its line if close,\n"
+    "  // escaped, so that text and binary snapshots read the same\n"
+    "\n"
+    "  size_t from = at > 32 ? at - 32 : 0;\n"
+    "  for (size_t i = at; i > from; i--) if (d[i - 1] == '\\n') { from = i; break; }\n"
+    "\n"
+    "  size_t to = from + 64; if (to > l) to = l;\n"
+    "\n"
+    "  size_t j = 0;\n"
+    "  if (j < n) j += snprintf(s + j, n - j, \"\%s\\\"\", from > 0 ? \"...\" : \"\");\n"
+    "\n"
+    "  for (size_t i = from; i < to && j + 8 < n; i++)\n"
+    "  {\n"
+    "    unsigned char c = d[i];\n"
+    "\n"
+    "    if (c == '\\n') j += snprintf(s + j, n - j, \"\\\\n\");\n"
+    "    else if (c == '\"' || c == '\\\\') j += snprintf(s + j, n - j, \"\\\\\%c\", c);\n"
+    "    else if (c >= 32 && c <= 126) s[j++] = c;\n"
+    "    else j += snprintf(s + j, n - j, \"\\\\x\%02x\", c);\n"
+    "  }\n"
+    "\n"
+    "  if (j < n) snprintf(s + j, n - j, \"\\\"\%s\", to < l ? \"...\" : \"\");\n"
+    "}\n"
+    "\n"
+    "static int rdz_snap_write(const char *path, const char *data, size_t l)\n"
+    "{\n"
+    "  // writes to a temporary file next to the snapshot, then renames it over\n"
+    "\n"
+    "  char *tmp = calloc(strlen(path) + 32, sizeof(char));\n"
+    "  sprintf(tmp, \"\%s.\%d.tmp\", path, (int)getpid());\n"
+    "\n"
+    "  for (char *s = tmp + 1; (s = strchr(s, '/')) != NULL; s++) // mkdir -p\n"
+    "  {\n"
+    "    *s = '\\0'; mkdir(tmp, 0755); *s = '/';\n"
+    "  }\n"
+    "\n"
+    "  int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);\n"
+    "  int r = fd > -1 ? 0 : -1;\n"
+    "\n"
+    "  if (fd > -1) { rdz_write(fd, data, l); if (close(fd) != 0) r = -1; }\n"
+    "  if (r == 0) r = rename(tmp, path);\n"
+    "  if (r != 0) unlink(tmp);\n"
+    "\n"
+    "  free(tmp);\n"
+    "\n"
+    "  return r;\n"
+    "}\n"
+    "\n"
+    "char *rdz_string_snap(char *result, char *name, const char *fname)\n"
+    "{\n"
+    "  // ensure(out ===snap \"name\"), compares with __snapshots__/name next to\n"
+    "  // the spec file, RDZ_UPDATE_SNAPSHOTS=1 (re)writes it when it differs\n"
+    "\n"
+    "  if (result == NULL) return rdz_strdup(\"     result is NULL\");\n"
+    "  if (name == NULL) return rdz_strdup(\"     snapshot name is NULL\");\n"
+    "\n"
+    "  const char *sl = strrchr(fname, '/');\n"
+    "  int dl = sl ? (int)(sl - fname + 1) : 0;\n"
+    "\n"
+    "  char *path = calloc(dl + strlen(name) + 16, sizeof(char));\n"
+    "  sprintf(path, \"\%.*s__snapshots__/\%s\", dl, fname, name);\n"
+    "\n"
+    "  size_t rl = strlen(result);\n"
+    "  size_t sz = 0;\n"
+    "  char *d = NULL;\n"
+    "  struct stat st;\n"
+    "\n"
+    "  int fd = open(path, O_RDONLY);\n"
+    "  int found = fd > -1 && fstat(fd, &st) == 0;\n"
+    "\n"
+    "  if (found) sz = st.st_size;\n"
+    "  if (found && sz > 0 && sz == rl) // the length first, no need to map else\n"
+    "  {\n"
+    "    d = mmap(NULL, sz, PROT_READ, MAP_PRIVATE, fd, 0);\n"
+    "    if (d == MAP_FAILED) d = NULL;\n"
+    "  }\n"
+    "  if (fd > -1) close(fd);\n"
+    "\n"
+    "  int same = found && sz == rl && (rl == 0 || (d && memcmp(d, result, rl) == 0));\n"
+    "\n"
+    "  if (d) munmap(d, sz);\n"
+    "\n"
+    "  if (same) { free(path); return NULL; }\n"
+    "\n"
+    "  char *s = calloc(2048, sizeof(char));\n"
+    "\n"
+    "  if (rdz_update_snapshots)\n"
+    "  {\n"
+    "    if (rdz_snap_write(path, result, rl) == 0)\n"
+    "    {\n"
+    "      __atomic_fetch_add(found ? &rdz_snap_updated : &rdz_snap_written, 1, __ATOMIC_SEQ_CST);\n"
+    "      free(s); s = NULL;\n"
+    "    }\n"
+    "    else\n"
+    "    {\n"
+    "      snprintf(s, 2048, \"     couldn't write snapshot \%s: \%s\", path, strerror(errno));\n"
+    "    }\n"
+    "  }\n"
+    "  else if ( ! found)\n"
+    "  {\n"
+    "    snprintf(\n"
+    "      s, 2048,\n"
+    "      \"     no snapshot at \%s\\n\"\n"
+    "      \"     (RDZ_UPDATE_SNAPSHOTS=1 writes it)\", path);\n"
+    "  }\n"
+    "  else\n"
+    "  {\n"
+    "    // map again, the whole thing this time, to show where it differs\n"
+    "\n"
+    "    fd = open(path, O_RDONLY);\n"
+    "    d = fd > -1 && sz > 0 ? mmap(NULL, sz, PROT_READ, MAP_PRIVATE, fd, 0) : NULL;\n"
+    "    if (d == MAP_FAILED) d = NULL;\n"
+    "    if (fd > -1) close(fd);\n"
+    "\n"
+    "    size_t l = sz < rl ? sz : rl;\n"
+    "    size_t at = 0;\n"
+    "    if (d)\n"
+    "    {\n"
+    "      while (at + 64 <= l && memcmp(d + at, result + at, 64) == 0) at += 64;\n"
+    "      while (at < l && d[at] == result[at]) at++;\n"
+    "    }\n"
+    "\n"
+    "    size_t line = 1;\n"
+    "    for (size_t i = 0; i < at; i++) if (result[i] == '\\n') line++;\n"
+    "\n"
+    "    char ew[512]; rdz_snap_window(ew, 512, d ? d : \"\", d ? sz : 0, at);\n"
+    "    char rw[512]; rdz_snap_window(rw, 512, result, rl, at);\n"
+    "\n"
+    "    snprintf(\n"
+    "      s, 2048,\n"
+    "      \"     snapshot \%s differs at byte \%zu, line \%zu\\n\"\n"
+    "      \"     expected \%zu bytes, got \%zu\\n\"\n"
+    "      \"     expected \%s\\n\"\n"
+    "      \"          got \%s\",\n"
+    "      path, at, line, sz, rl, ew, rw);\n"
+    "\n"
+    "    if (d) munmap(d, sz);\n"
+    "  }\n"
+    "\n"
+    "  free(path);\n"
+    "\n"
+    "  return s;\n"
+    "}\n"
+    "\n"
+    "static void rdz_trace_dump(int fd)\n"
+    "{\n"
+    "  // a forked worker hands its trace events over to the parent process\n"
+    "\n"
+    "  char *o = NULL; size_t l = 0;\n"
+    "  FILE *f = open_memstream(&o, &l);\n"
+    "\n"
+    "  int first = 1; rdz_trace_write_events(f, &first);\n"
+    "\n"
+    "  fclose(f);\n"
+    "  rdz_write(fd, o, l);\n"
+    "  free(o);\n"
+    "}\n"
+    "\n"
+    "static void rdz_write_results(int fd, int from)\n"
+    "{\n"
+    "  // \"success itnumber lnumber ltnumber msglength\\nmsg\\n\"...\n"
+    "\n"
+    "  for (int i = from; i < rdz_count; i++)\n"
+    "  {\n"
+    "    rdz_result *r = rdz_results + i;\n"
+    "\n"
+    "    char h[128];\n"
+    "    int l = snprintf(\n"
+    "      h, 128, \"\%d \%d \%d \%d \%d\\n\",\n"
+    "      r->success, r->itnumber, r->lnumber, r->ltnumber,\n"
+    "      r->message ? (int)strlen(r->message) : -1);\n"
+    "\n"
+    "    rdz_write(fd, h, l);\n"
+    "    if (r->message) rdz_write(fd, r->message, strlen(r->message));\n"
+    "    rdz_write(fd, \"\\n\", 1);\n"
+    "  }\n"
+    "}\n"
+    "\n"
+    "#define RDZ_REP_SAMPLES 1024\n"
+    "\n"
+    "typedef struct rdz_rep { // RDZ_REPEAT, the tally for one \"it\"\n"
+    "  long passes;\n"
+    "  long fails;\n"
+    "  double min;\n"
+    "  double max;\n"
+    "  double total;\n"
+    "  long seen;\n"
+    "  int count;\n"
+    "  double *samples; // a reservoir, for the median and the p90\n"
+    "} rdz_rep;\n"
+    "\n"
+    "rdz_rep *rdz_reps = NULL;\n"
+    "long rdz_rep_runs = 0;\n"
+    "long rdz_rep_failed_runs = 0;\n"
+    "volatile sig_atomic_t rdz_rep_stop = 0;\n"
+    "\n"
+    "static void rdz_rep_sample(rdz_rep *r, double du)\n"
+    "{\n"
+    "  if (du < 0.0) return;\n"
+    "\n"
+    "  if (r->seen == 0 || du < r->min) r->min = du;\n"
+    "  if (r->seen == 0 || du > r->max) r->max = du;\n"
+    "  r->total += du;\n"
+    "  r->seen++;\n"
+    "\n"
+    "  if (r->samples == NULL) r->samples = calloc(RDZ_REP_SAMPLES, sizeof(double));\n"
+    "\n"
+    "  if (r->count < RDZ_REP_SAMPLES) { r->samples[r->count++] = du; return; }\n"
+    "\n"
+    "  long j = rand() \% r->seen; if (j < RDZ_REP_SAMPLES) r->samples[j] = du;\n"
+    "}\n"
+    "\n"
+    "static void rdz_repeat_record(int n, int from, double duration)\n"
+    "{\n"
+    "  if (rdz_reps == NULL) return;\n"
+    "\n"
+    "  int failed = 0;\n"
+    "  for (int i = from; i < rdz_count; i++) if (rdz_results[i].success == 0) failed = 1;\n"
+    "\n"
+    "  if (failed) rdz_reps[n].fails++; else rdz_reps[n].passes++;\n"
+    "\n"
+    "  rdz_rep_sample(rdz_reps + n, duration);\n"
+    "}\n"
+    "\n"
+    "static void rdz_remote_send(int n, int from, double duration)\n"
+    "{\n"
+    "  // as a RDZ_WORKER, streams the results of an \"it\" to the coordinator,\n"
+    "  // \"it itnumber count duration\\n\" followed by the results\n"
+    "\n"
+    "  if (rdz_remote_fd < 0) return;\n"
+    "\n"
+    "  char h[128];\n"
+    "  int l = snprintf(h, 128, \"it \%d \%d \%f\\n\", n, rdz_count - from, duration);\n"
+    "\n"
+    "  rdz_write(rdz_remote_fd, h, l);\n"
+    "  rdz_write_results(rdz_remote_fd, from);\n"
+    "\n"
+    "  for (int i = from; i < rdz_count; i++) rdz_result_clear(rdz_results + i);\n"
+    "  rdz_count = from; // keeps the worker's result table from growing\n"
+    "}\n"
+    "\n"
+    "static char *rdz_record_results(char *ss, char *e)\n"
+    "{\n"
+    "  while (ss < e)\n"
+    "  {\n"
+    "    int success, itnumber, lnumber, ltnumber, ml, hl;\n"
+    "    if (sscanf(\n"
+    "      ss, \"\%d \%d \%d \%d \%d\%n\",\n"
+    "      &success, &itnumber, &lnumber, &ltnumber, &ml, &hl) < 5) break;\n"
+    "\n"
+    "    ss += hl + 1; // the message may start with spaces, don't let scanf eat them\n"
+    "    char *msg = ml > -1 ? rdz_strndup(ss, ml) : NULL;\n"
+    "    ss += (ml > -1 ? ml : 0) + 1;\n"
+    "\n"
+    "    rdz_record(success, msg, itnumber, lnumber, ltnumber);\n"
+    "  }\n"
+    "\n"
+    "  return ss;\n"
+    "}\n"
+    "\n"
+    "static void rdz_read_results(int fd)\n"
+    "{\n"
+    "  size_t l = 0; char *s = rdz_read(fd, &l);\n"
+    "\n"
+    "  rdz_record_results(s, s + l);\n"
+    "\n"
+    "  free(s);\n"
+    "}\n"
+    "\n"
+    "static int rdz_record_lost(int n, const char *seen, const char *msg)\n"
+    "{\n"
+    "  // records a failure for each \"it\" under n the dead worker didn't report\n"
+    "\n"
+    "  if ( ! rdz_doruns[n]) return 0;\n"
+    "\n"
+    "  char t = rdz_t->types[n];\n"
+    "  const int *cs = rdz_children(n);\n"
+    "  int cc = rdz_t->ccounts[n];\n"
+    "\n"
+    "  if (t == 'i')\n"
+    "  {\n"
+    "    if (seen[n]) return 0; // reported\n"
+    "    if (cc > 0) { rdz_dorun(cs[0]); return 0; } // pending, nothing to run\n"
+    "\n"
+    "    rdz_record(0, rdz_strdup((char *)msg), n, rdz_t->lstarts[n], rdz_t->ltstarts[n]);\n"
+    "    rdz_print_result(rdz_results + rdz_count - 1, -1.0);\n"
+    "\n"
+    "    return 1;\n"
+    "  }\n"
+    "  if (t != 'd' && t != 'c' && t != 'G' && t != 'g') return 0;\n"
+    "\n"
+    "  int lost = 0;\n"
+    "  for (int i = 0; i < cc; i++) lost += rdz_record_lost(cs[i], seen, msg);\n"
+    "\n"
+    "  return lost;\n"
+    "}\n"
+    "\n"
+    "int rdz_dorun_forked(int n, const int *cs, int cc, int offlines)\n"
+    "{\n"
+    "  // the before all has run, fork workers that inherit its state and\n"
+    "  // split the children among them, their output and results are gathered\n"
+    "  // back in order, returns 0 if there is no point in forking\n"
+    "\n"
+    "  int *runnable = calloc(cc + 1, sizeof(int)); int rc = 0;\n"
+    "\n"
+    "  for (int i = 0; i < cc; i++)\n"
+    "  {\n"
+    "    char ct = rdz_t->types[cs[i]];\n"
+    "    if (ct != 'd' && ct != 'c' && ct != 'i') continue;\n"
+    "    if (rdz_doruns[cs[i]]) runnable[rc++] = cs[i];\n"
+    "  }\n"
+    "\n"
+    "  int jobs = rdz_jobs < rc ? rdz_jobs : rc;\n"
+    "\n"
+    "  if (jobs < 2) { free(runnable); return 0; }\n"
+    "\n"
+    "  int *outs = calloc(jobs, sizeof(int));\n"
+    "  int *ress = calloc(jobs, sizeof(int));\n"
+    "  int *tras = calloc(jobs, sizeof(int));\n"
+    "  pid_t *pids = calloc(jobs, sizeof(pid_t));\n"
+    "\n"
+    "  istty(); fflush(stdout);\n"
+    "\n"
+    "  for (int w = 0; w < jobs; w++)\n"
+    "  {\n"
+    "    outs[w] = rdz_tmpfd(\"out\", w);\n"
+    "    ress[w] = rdz_tmpfd(\"res\", w);\n"
+    "    if (rdz_trace) tras[w] = rdz_tmpfd(\"trace\", w);\n"
+    "\n"
+    "    pids[w] = fork();\n"
+    "\n"
+    "    if (pids[w] != 0) continue;\n"
+    "\n"
+    "    // worker, contiguous slices keep the output in declaration order\n"
+    "\n"
+    "    rdz_worker = 1;\n"
+    "    dup2(outs[w], 1);\n"
+    "    if (rdz_trace) rdz_trace_fork();\n"
+    "\n"
+    "    int from = rdz_count;\n"
+    "\n"
+    "    for (int i = w * rc / jobs; i < (w + 1) * rc / jobs; i++)\n"
+    "    {\n"
+    "      if (offlines) rdz_run_offlines(n, 'y');\n"
+    "      rdz_dorun(runnable[i]);\n"
+    "      if (offlines) rdz_run_offlines(n, 'z');\n"
+    "    }\n"
+    "\n"
+    "    fflush(stdout);\n"
+    "    rdz_write_results(ress[w], from);\n"
+    "    if (rdz_trace) rdz_trace_dump(tras[w]);\n"
+    "\n"
+    "    _exit(0);\n"
+    "  }\n"
+    "\n"
+    "  for (int w = 0; w < jobs; w++)\n"
+    "  {\n"
+    "    int status = 0;\n"
+    "    if (pids[w] > 0) waitpid(pids[w], &status, 0);\n"
+    "\n"
+    "    size_t l = 0; char *o = rdz_read(outs[w], &l);\n"
+    "    fwrite(o, sizeof(char), l, stdout);\n"
+    "    free(o);\n"
+    "\n"
+    "    int from = rdz_count;\n"
+    "    rdz_read_results(ress[w]);\n"
+    "\n"
+    "    if (rdz_trace)\n"
+    "    {\n"
+    "      o = rdz_read(tras[w], &l); rdz_trace_gather(o, l); free(o);\n"
+    "      close(tras[w]);\n"
+    "    }\n"
+    "\n"
+    "    if (pids[w] < 0 || ! WIFEXITED(status) || WEXITSTATUS(status) != 0)\n"
+    "    {\n"
+    "      printf(\n"
+    "        \"\%sworker \%d (I=\%d) failed, status \%d\%s\\n\",\n"
+    "        rdz_rd(), w, runnable[w * rc / jobs], status, rdz_cl());\n"
+    "\n"
+    "      char *seen = calloc(rdz_t->count, sizeof(char));\n"
+    "      for (int i = from; i < rdz_count; i++) seen[rdz_results[i].itnumber] = 1;\n"
+    "\n"
+    "      char msg[80];\n"
+    "      snprintf(msg, 80, \"     worker \%d failed (status \%d) before reporting it\", w, status);\n"
+    "\n"
+    "      int lost = 0;\n"
+    "      for (int i = w * rc / jobs; i < (w + 1) * rc / jobs; i++)\n"
+    "      {\n"
+    "        lost += rdz_record_lost(runnable[i], seen, msg);\n"
+    "      }\n"
+    "      if (lost == 0) rdz_fail_count++; // it died after reporting, still a failure\n"
+    "\n"
+    "      free(seen);\n"
+    "    }\n"
+    "\n"
+    "    close(outs[w]); close(ress[w]);\n"
+    "  }\n"
+    "\n"
+    "  fflush(stdout);\n"
+    "\n"
+    "  free(pids); free(tras); free(ress); free(outs); free(runnable);\n"
+    "\n"
+    "  return 1;\n"
+    "}\n"
+    "\n"
+    "void rdz_replay(rdz_job *j)\n"
+    "{\n"
+    "  int from = rdz_count;\n"
+    "\n"
+    "  for (int i = 0; i < j->count; i++)\n"
+    "  {\n"
+    "    rdz_result *r = j->results + i;\n"
+    "\n"
+    "    *rdz_results_push() = *r;\n"
+    "\n"
+    "    if (r->success == -1) rdz_pending_count++;\n"
+    "    if (r->success == 0) rdz_fail_count++;\n"
+    "  }\n"
+    "\n"
+    "  if (j->count == 0) // no ensure in the example, record a success...\n"
+    "  {\n"
+    "    rdz_record(\n"
+    "      1, rdz_strdup(rdz_text(j->n)),\n"
+    "      j->n, rdz_t->lstarts[j->n], rdz_t->ltstarts[j->n]);\n"
+    "  }\n"
+    "\n"
+    "  rdz_print_result(rdz_results + rdz_count - 1, j->duration);\n"
+    "\n"
+    "  rdz_repeat_record(j->n, from, j->duration);\n"
+    "  rdz_remote_send(j->n, from, j->duration);\n"
+    "\n"
+    "  free(j->results); j->results = NULL;\n"
+    "}\n"
+    "\n"
+    "#ifdef RDZ_CONCURRENT\n"
+    "\n"
+    "typedef struct rdz_pool {\n"
+    "  pthread_mutex_t mutex;\n"
+    "  int next;\n"
+    "  int count;\n"
+    "  rdz_job **jobs;\n"
+    "  int n; // parent node number\n"
+    "  int offlines;\n"
+    "} rdz_pool;\n"
+    "\n"
+    "static void *rdz_pool_work(void *a)\n"
+    "{\n"
+    "  rdz_pool *p = a;\n"
+    "\n"
+    "  while (1)\n"
+    "  {\n"
+    "    pthread_mutex_lock(&p->mutex); int i = p->next++; pthread_mutex_unlock(&p->mutex);\n"
+    "\n"
+    "    if (i >= p->count) break;\n"
+    "\n"
+    "    rdz_job *j = p->jobs[i];\n"
+    "\n"
+    "    rdz_job_current = j;\n"
+    "\n"
+    "    if (p->offlines) rdz_run_offlines(p->n, 'y');\n"
+    "    rdz_sample_node = j->n;\n"
+    "    j->duration = rdz_call(j->n);\n"
+    "    if (p->offlines) rdz_run_offlines(p->n, 'z');\n"
+    "    rdz_sample_node = p->n;\n"
+    "\n"
+    "    rdz_job_current = NULL;\n"
+    "  }\n"
+    "\n"
+    "  return NULL;\n"
+    "}\n"
+    "\n"
+    "rdz_job *rdz_run_concurrently(int n, const int *cs, int cc, int offlines)\n"
+    "{\n"
+    "  // runs the direct \"it\" children of n on a pool of RDZ_THREADS threads\n"
+    "  // (defaults to the number of cores), returns one job per child,\n"
+    "  // j->n is -1 for the children that are left to rdz_dorun()\n"
+    "\n"
+    "  rdz_job *jobs = calloc(cc, sizeof(rdz_job));\n"
+    "  rdz_job **todo = calloc(cc, sizeof(rdz_job *));\n"
+    "  int count = 0;\n"
+    "\n"
+    "  for (int i = 0; i < cc; i++)\n"
+    "  {\n"
+    "    int cn = cs[i];\n"
+    "    jobs[i].n = -1;\n"
+    "    if (rdz_t->types[cn] != 'i' || ! rdz_doruns[cn]) continue;\n"
+    "    if (rdz_t->ccounts[cn] > 0) continue; // pending\n"
+    "    jobs[i].n = cn; todo[count++] = jobs + i;\n"
+    "  }\n"
+    "\n"
+    "  char *e = getenv(\"RDZ_THREADS\");\n"
+    "  long threads = e ? atol(e) : 4;\n"
+    "#ifdef _SC_NPROCESSORS_ONLN\n"
+    "  if (e == NULL) threads = sysconf(_SC_NPROCESSORS_ONLN);\n"
+    "#endif\n"
+    "  if (threads > count) threads = count;\n"
+    "  if (threads < 1) threads = 1;\n"
+    "\n"
+    "  rdz_pool p;\n"
+    "  pthread_mutex_init(&p.mutex, NULL);\n"
+    "  p.next = 0; p.count = count; p.jobs = todo; p.n = n; p.offlines = offlines;\n"
+    "\n"
+    "  pthread_t *ts = calloc(threads, sizeof(pthread_t));\n"
+    "\n"
+    "  double start = rdz_now();\n"
+    "\n"
+    "  long started = 1; // this thread works as well\n"
+    "\n"
+    "  for (; started < threads; started++)\n"
+    "  {\n"
+    "    int r = pthread_create(ts + started, NULL, rdz_pool_work, &p);\n"
+    "    if (r == 0) continue;\n"
+    "\n"
+    "    static int warned = 0;\n"
+    "    if ( ! warned++) fprintf(\n"
+    "      stderr, \"couldn't start thread \%ld of \%ld (\%s), running on \%ld\\n\",\n"
+    "      started + 1, threads, strerror(r), started);\n"
+    "    break;\n"
+    "  }\n"
+    "\n"
+    "  rdz_pool_work(&p);\n"
+    "  for (long i = 1; i < started; i++) pthread_join(ts[i], NULL);\n"
+    "\n"
+    "  rdz_conc_wall += rdz_duration(start);\n"
+    "  for (int i = 0; i < count; i++) rdz_conc_work += todo[i]->duration;\n"
+    "\n"
+    "  pthread_mutex_destroy(&p.mutex);\n"
+    "  free(ts);\n"
+    "  free(todo);\n"
+    "\n"
+    "  return jobs;\n"
+    "}\n"
+    "\n"
+    "typedef struct rdz_stress {\n"
+    "  pthread_mutex_t mutex;\n"
+    "  pthread_cond_t cond;\n"
+    "  int ready;\n"
+    "  int go;\n"
+    "  void (*func)(rdz_stress_thread *);\n"
+    "} rdz_stress;\n"
+    "\n"
+    "typedef struct rdz_stress_report {\n"
+    "  int n;\n"
+    "  int threads;\n"
+    "  int asked; // more than threads when some couldn't be started\n"
+    "  long done;\n"
+    "  double wall;\n"
+    "  double *ops; // per thread, ops/s\n"
+    "} rdz_stress_report;\n"
+    "\n"
+    "rdz_stress_report *rdz_stresses = NULL;\n"
+    "int rdz_stress_count = 0;\n"
+    "\n"
+    "static void *rdz_stress_work(void *a)\n"
+    "{\n"
+    "  rdz_stress_thread *t = a;\n"
+    "  rdz_stress *s = t->stress;\n"
+    "\n"
+    "  pthread_mutex_lock(&s->mutex); // wait for all the threads to be ready\n"
+    "  s->ready++;\n"
+    "  pthread_cond_broadcast(&s->cond);\n"
+    "  while ( ! s->go) pthread_cond_wait(&s->cond, &s->mutex);\n"
+    "  pthread_mutex_unlock(&s->mutex);\n"
+    "\n"
+    "  rdz_stress_current = t;\n"
+    "\n"
+    "  double start = rdz_now();\n"
+    "  s->func(t);\n"
+    "  t->duration = rdz_duration(start);\n"
+    "\n"
+    "  rdz_stress_current = NULL;\n"
+    "\n"
+    "  return NULL;\n"
+    "}\n"
+    "\n"
+    "void rdz_stress_run(\n"
+    "  void (*func)(rdz_stress_thread *), int threads, long iterations, int n)\n"
+    "{\n"
+    "  // runs the body of the \"it\" on threads, all released at once,\n"
+    "  // the results are folded per ensure line, a failure in any thread wins\n"
+    "\n"
+    "  rdz_stress s;\n"
+    "  pthread_mutex_init(&s.mutex, NULL);\n"
+    "  pthread_cond_init(&s.cond, NULL);\n"
+    "  s.ready = 0; s.go = 0; s.func = func;\n"
+    "\n"
+    "  rdz_stress_thread *ts = calloc(threads, sizeof(rdz_stress_thread));\n"
+    "  pthread_t *ps = calloc(threads, sizeof(pthread_t));\n"
+    "\n"
+    "  int asked = threads;\n"
+    "\n"
+    "  for (int i = 0; i < asked; i++)\n"
+    "  {\n"
+    "    ts[i].thread = i; ts[i].iterations = iterations; ts[i].stress = &s;\n"
+    "\n"
+    "    int r = pthread_create(ps + i, NULL, rdz_stress_work, ts + i);\n"
+    "    if (r == 0) continue;\n"
+    "\n"
+    "    fprintf(\n"
+    "      stderr, \"couldn't start stress thread \%d of \%d (\%s), running on \%d\\n\",\n"
+    "      i + 1, asked, strerror(r), i > 0 ? i : 1);\n"
+    "    threads = i; // only wait for the threads that started\n"
+    "    break;\n"
+    "  }\n"
+    "\n"
+    "  pthread_mutex_lock(&s.mutex);\n"
+    "  while (s.ready < threads) pthread_cond_wait(&s.cond, &s.mutex);\n"
+    "  double start = rdz_now();\n"
+    "  s.go = 1;\n"
+    "  pthread_cond_broadcast(&s.cond);\n"
+    "  pthread_mutex_unlock(&s.mutex);\n"
+    "\n"
+    "  for (int i = 0; i < threads; i++) pthread_join(ps[i], NULL);\n"
+    "\n"
+    "  if (threads == 0) { rdz_stress_work(ts); threads = 1; } // on this thread\n"
+    "\n"
+    "  double wall = rdz_duration(start);\n"
+    "\n"
+    "  rdz_stress_site sites[RDZ_STRESS_SITES_MAX]; int count = 0;\n"
+    "\n"
+    "  for (int i = 0; i < threads; i++)\n"
+    "  {\n"
+    "    for (int j = 0; j < ts[i].count; j++)\n"
+    "    {\n"
+    "      rdz_stress_site *ss = ts[i].sites + j;\n"
+    "      char *m = ss->message;\n"
+    "\n"
+    "      if (ss->success == 0)\n"
+    "      {\n"
+    "        size_t l = (m ? strlen(m) : 0) + 64; char *mm = calloc(l, sizeof(char));\n"
+    "        snprintf(\n"
+    "          mm, l, \"\%s\%s     in thread \%d, iteration \%ld\",\n"
+    "          m ? m : \"\", m ? \"\\n\" : \"\", i, ss->iteration);\n"
+    "        free(m); m = mm;\n"
+    "      }\n"
+    "\n"
+    "      rdz_stress_site_record(\n"
+    "        sites, &count, ss->iteration,\n"
+    "        ss->success, m, ss->itnumber, ss->lnumber, ss->ltnumber);\n"
+    "    }\n"
+    "  }\n"
+    "\n"
+    "  for (int i = 0; i < count; i++)\n"
+    "  {\n"
+    "    rdz_stress_site *ss = sites + i;\n"
+    "    rdz_record(ss->success, ss->message, ss->itnumber, ss->lnumber, ss->ltnumber);\n"
+    "  }\n"
+    "\n"
+    "  rdz_stresses = realloc(\n"
+    "    rdz_stresses, (rdz_stress_count + 1) * sizeof(rdz_stress_report));\n"
+    "  rdz_stress_report *r = rdz_stresses + rdz_stress_count++;\n"
+    "  r->n = n; r->threads = threads; r->asked = asked; r->done = 0; r->wall = wall;\n"
+    "  r->ops = calloc(threads, sizeof(double));\n"
+    "\n"
+    "  for (int i = 0; i < threads; i++)\n"
+    "  {\n"
+    "    r->done += ts[i].done;\n"
+    "    r->ops[i] = ts[i].duration > 0.0 ? ts[i].done * 1000.0 / ts[i].duration : 0.0;\n"
+    "  }\n"
+    "\n"
+    "  pthread_cond_destroy(&s.cond);\n"
+    "  pthread_mutex_destroy(&s.mutex);\n"
+    "  free(ps);\n"
+    "  free(ts);\n"
+    "}\n"
+    "\n"
+    "void rdz_stress_summary(int print)\n"
+    "{\n"
+    "  for (int i = 0; print && i < rdz_stress_count; i++)\n"
+    "  {\n"
+    "    rdz_stress_report *r = rdz_stresses + i;\n"
+    "\n"
+    "    if (i == 0) printf(rdz_fail_count > 0 ? \"\\nStress:\\n\\n\" : \"Stress:\\n\\n\");\n"
+    "\n"
+    "    char *title = rdz_determine_title(r->n);\n"
+    "    double ops = r->wall > 0.0 ? r->done * 1000.0 / r->wall : 0.0;\n"
+    "\n"
+    "    printf(\"  \%s\\n\", title);\n"
+    "    char of[32] = \"\";\n"
+    "    if (r->asked > r->threads) snprintf(of, sizeof(of), \" (of \%d asked)\", r->asked);\n"
+    "    printf(\n"
+    "      \"     \%s\%d threads\%s, \%ld iterations, \%.0f ops/s\%s\\n\",\n"
+    "      rdz_gr(), r->threads, of, r->done, ops, rdz_cl());\n"
+    "    for (int j = 0; j < r->threads; j++)\n"
+    "    {\n"
+    "      printf(\"       \%sthread \%d: \%.0f ops/s\%s\\n\", rdz_gr(), j, r->ops[j], rdz_cl());\n"
+    "    }\n"
+    "\n"
+    "    free(title);\n"
+    "  }\n"
+    "\n"
+    "  if (print && rdz_stress_count > 0) printf(\"\\n\");\n"
+    "\n"
+    "  for (int i = 0; i < rdz_stress_count; i++) free(rdz_stresses[i].ops);\n"
+    "  free(rdz_stresses); rdz_stresses = NULL; rdz_stress_count = 0;\n"
+    "}\n"
+    "\n"
+    "#endif\n"
+    "\n"
+    "static int *rdz_opened = NULL; // RDZ_WORKER, the groups entered, in order\n"
+    "static int rdz_opened_count = 0;\n"
+    "\n"
+    "void rdz_dorun(int n)\n"
+    "{\n"
+    "  if (n == 0) printf(\"\\n\"); // initial blank line\n"
+    "\n"
+    "  if ( ! rdz_doruns[n]) return;\n"
+    "\n"
+    "  char t = rdz_t->types[n];\n"
+    "  const int *cs = rdz_children(n);\n"
+    "  int cc = rdz_t->ccounts[n];\n"
+    "\n"
+    "  if (t != 'p') rdz_sample_node = n;\n"
+    "\n"
+    "  if (t == 'i')\n"
+    "  {\n"
+    "    if (cc > 0) { rdz_dorun(cs[0]); return; }\n"
+    "\n"
+    "    int rc = rdz_count;\n"
+    "\n"
+    "    rdz_coverage_start();\n"
+    "\n"
+    "    long blocks = RDZ_BLOCKS();\n"
+    "\n"
+    "    double du = rdz_call(n); // run the \"it\"\n"
+    "\n"
+    "    if (rdz_leaky) rdz_leak_check(n, rc, blocks);\n"
+    "\n"
+    "    rdz_coverage_stop(n);\n"
+    "\n"
+    "    rdz_sample_node = rdz_t->parents[n];\n"
+    "    if (rdz_sample_hz) rdz_sample_drain();\n"
+    "\n"
+    "    if (rdz_count == rc) // no ensure in the example, record a success...\n"
+    "    {\n"
+    "      rdz_record(\n"
+    "        1, rdz_strdup(rdz_text(n)),\n"
+    "        n, rdz_t->lstarts[n], rdz_t->ltstarts[n]);\n"
+    "    }\n"
+    "\n"
+    "    rdz_print_result(rdz_results + rdz_count - 1, du);\n"
+    "\n"
+    "    rdz_repeat_record(n, rc, du);\n"
+    "    rdz_remote_send(n, rc, du);\n"
+    "\n"
+    "    for (int i = rc; n == rdz_bisect_it && i < rdz_count; i++) // right away\n"
+    "    {\n"
+    "      if (rdz_results[i].success != 0) continue;\n"
+    "      char s[32]; int l = snprintf(s, 32, \"\%d\\n\", n); rdz_write(rdz_bisect_fd, s, l);\n"
+    "    }\n"
+    "  }\n"
+    "  else if (t == 'p')\n"
+    "  {\n"
+    "    rdz_record(\n"
+    "      -1, rdz_strdup(rdz_text(n)),\n"
+    "      rdz_t->parents[n], rdz_t->lstarts[n], rdz_t->ltstarts[n]);\n"
+    "\n"
+    "    rdz_print_result(rdz_results + rdz_count - 1, -1.0);\n"
+    "  }\n"
+    "  else if (t == 'G' || t == 'g' || t == 'd' || t == 'c')\n"
+    "  {\n"
+    "    rdz_print_level(n);\n"
+    "    if (rdz_trace && (t == 'd' || t == 'c')) rdz_trace_record('B', n);\n"
+    "    int offlines = rdz_has_offlines(n); // spare a scan per child if none\n"
+    "    int befores = 0;\n"
+    "    int open = 0; // a worker's later chunk entering the group again\n"
+    "    for (int i = 0; rdz_opened && i < rdz_opened_count; i++)\n"
+    "    {\n"
+    "      if (rdz_opened[i] == n) open = 1;\n"
+    "    }\n"
+    "    if (rdz_opened && ! open) rdz_opened[rdz_opened_count++] = n;\n"
+    "    for (int i = 0; ! open && i < cc; i++) // before all\n"
+    "    {\n"
+    "      if (rdz_t->types[cs[i]] == 'B') { rdz_call(cs[i]); befores++; }\n"
+    "    }\n"
+    "    int forked = 0;\n"
+    "    if (befores && rdz_jobs > 1 && ! rdz_worker) // RDZ_JOBS=4\n"
+    "    {\n"
+    "      forked = rdz_dorun_forked(n, cs, cc, offlines);\n"
+    "    }\n"
+    "    rdz_job *jobs = NULL;\n"
+    "#ifdef RDZ_CONCURRENT\n"
+    "    if ( ! forked && (rdz_t->flags[n] & RDZ_F_CONCURRENT))\n"
+    "    {\n"
+    "      jobs = rdz_run_concurrently(n, cs, cc, offlines);\n"
+    "    }\n"
+    "#endif\n"
+    "    for (int i = 0; ! forked && i < cc; i++) // children\n"
+    "    {\n"
+    "      char ct = rdz_t->types[cs[i]];\n"
+    "      if (ct != 'd' && ct != 'c' && ct != 'i') continue;\n"
+    "      if (jobs && jobs[i].n > -1) { rdz_replay(jobs + i); continue; }\n"
+    "      if (offlines) rdz_run_offlines(n, 'y'); // before each offline\n"
+    "      rdz_dorun(cs[i]);\n"
+    "      rdz_sample_node = n;\n"
+    "      if (offlines) rdz_run_offlines(n, 'z'); // after each offline\n"
+    "    }\n"
+    "    free(jobs);\n"
+    "    for (int i = 0; ! rdz_opened && i < cc; i++) // after all\n"
+    "    {\n"
+    "      if (rdz_t->types[cs[i]] == 'A') rdz_call(cs[i]);\n"
+    "    }\n"
+    "    if (rdz_trace && (t == 'd' || t == 'c')) rdz_trace_record('E', n);\n"
+    "  }\n"
+    "}\n"
+    "\n"
+    "int rdz_reachable(int n)\n"
+    "{\n"
+    "  // would rdz_dorun(0) reach the node?\n"
+    "\n"
+    "  for (int m = n; m > -1; m = rdz_t->parents[m]) if ( ! rdz_doruns[m]) return 0;\n"
+    "\n"
+    "  return 1;\n"
+    "}\n"
+    "\n"
+    "  //\n"
+    "  // RDZ_LIST / RDZ_DURATIONS\n"
+    "\n"
+    "\n"
+    "\n"
+    "  // FNV-1a (64 bits), the stable ids of the examples, one implementation\n"
+    "  // compiled into rodzo (--list) and spliced into the runtime\n"
+    "  // (rdz_stable_id(), RDZ_LIST=1), both must yield the same ids\n"
+    "\n"
+    "#define RDZ_FNV_START 14695981039346656037ULL\n"
+    "\n"
+    "static unsigned long long rdz_fnv(unsigned long long h, const char *s)\n"
+    "{\n"
+    "  for (; *s; s++) { h ^= (unsigned char)*s; h *= 1099511628211ULL; }\n"
+    "\n"
+    "  return h;\n"
+    "}\n"
+    "\n"
+    "static unsigned long long rdz_fnv_title(\n"
+    "  unsigned long long h, const char *title, int ordinal)\n"
+    "{\n"
+    "  // a title, preceded by a separator (a 0 byte), followed by \"#2\", \"#3\",\n"
+    "  // ... when an earlier sibling bears the same title\n"
+    "\n"
+    "  h *= 1099511628211ULL;\n"
+    "  h = rdz_fnv(h, title);\n"
+    "\n"
+    "  if (ordinal < 2) return h;\n"
+    "\n"
+    "  char o[16]; int l = 0; o[l++] = '#';\n"
+    "  char d[12]; int dl = 0; for (; ordinal > 0; ordinal /= 10) d[dl++] = '0' + ordinal \% 10;\n"
+    "  while (dl > 0) o[l++] = d[--dl];\n"
+    "  o[l] = '\\0';\n"
+    "\n"
+    "  return rdz_fnv(h, o);\n"
+    "}\n"
+    "\n"
+    "static int rdz_title_ordinal(int n)\n"
+    "{\n"
+    "  // 1 for the first sibling with that title, 2 for the next one, ...\n"
+    "\n"
+    "  int p = rdz_t->parents[n]; if (p < 0) return 1;\n"
+    "\n"
+    "  const int *cs = rdz_children(p);\n"
+    "  int o = 1;\n"
+    "\n"
+    "  for (int i = 0; i < rdz_t->ccounts[p] && cs[i] != n; i++)\n"
+    "  {\n"
+    "    char t = rdz_t->types[cs[i]];\n"
+    "    if (t != 'd' && t != 'c' && t != 'i') continue;\n"
+    "    if (strcmp(rdz_text(cs[i]), rdz_text(n)) == 0) o++;\n"
+    "  }\n"
+    "\n"
+    "  return o;\n"
+    "}\n"
+    "\n"
+    "unsigned long long rdz_stable_id(int n)\n"
+    "{\n"
+    "  // FNV-1a over the file name and the titles, from the top down, it\n"
+    "  // survives lines moving around, rodzo --list computes the same,\n"
+    "  // siblings bearing the same title are told apart by their ordinal\n"
+    "\n"
+    "  unsigned long long h = rdz_fnv(RDZ_FNV_START, rdz_fname(n));\n"
+    "\n"
+    "  int chain[128]; int cl = 0;\n"
+    "\n"
+    "  for (int m = n; m > -1 && cl < 128; m = rdz_t->parents[m])\n"
+    "  {\n"
+    "    char t = rdz_t->types[m];\n"
+    "    if (t == 'd' || t == 'c' || t == 'i') chain[cl++] = m;\n"
+    "  }\n"
+    "\n"
+    "  for (int i = cl - 1; i >= 0; i--)\n"
+    "  {\n"
+    "    h = rdz_fnv_title(h, rdz_text(chain[i]), rdz_title_ordinal(chain[i]));\n"
+    "  }\n"
+    "\n"
+    "  return h;\n"
+    "}\n"
+    "\n"
+    "typedef struct rdz_known_duration {\n"
+    "  unsigned long long id;\n"
+    "  double duration; // ms\n"
+    "} rdz_known_duration;\n"
+    "\n"
+    "static int rdz_known_duration_cmp(const void *a, const void *b)\n"
+    "{\n"
+    "  unsigned long long ia = ((const rdz_known_duration *)a)->id;\n"
+    "  unsigned long long ib = ((const rdz_known_duration *)b)->id;\n"
+    "\n"
+    "  return ia < ib ? -1 : ia > ib;\n"
+    "}\n"
+    "\n"
+    "static rdz_known_duration *rdz_durations_load(size_t *count)\n"
+    "{\n"
+    "  // reads the \"id duration\" lines of the RDZ_DURATIONS file, sorted by id\n"
+    "\n"
+    "  *count = 0;\n"
+    "\n"
+    "  FILE *f = rdz_durations ? fopen(rdz_durations, \"r\") : NULL;\n"
+    "  if (f == NULL) return NULL;\n"
+    "\n"
+    "  size_t size = 1024;\n"
+    "  rdz_known_duration *ds = calloc(size, sizeof(rdz_known_duration));\n"
+    "\n"
+    "  unsigned long long id; double du;\n"
+    "\n"
+    "  while (fscanf(f, \"\%llx \%lf\", &id, &du) == 2)\n"
+    "  {\n"
+    "    if (*count >= size) { size *= 2; ds = realloc(ds, size * sizeof(*ds)); }\n"
+    "    ds[*count].id = id; ds[(*count)++].duration = du;\n"
+    "  }\n"
+    "  fclose(f);\n"
+    "\n"
+    "  qsort(ds, *count, sizeof(rdz_known_duration), rdz_known_duration_cmp);\n"
+    "\n"
+    "  return ds;\n"
+    "}\n"
+    "\n"
+    "static double rdz_durations_find(rdz_known_duration *ds, size_t count, int n)\n"
+    "{\n"
+    "  rdz_known_duration k = { rdz_stable_id(n), 0.0 };\n"
+    "\n"
+    "  rdz_known_duration *d = ds ?\n"
+    "    bsearch(&k, ds, count, sizeof(k), rdz_known_duration_cmp) : NULL;\n"
+    "\n"
+    "  return d ? d->duration : -1.0;\n"
+    "}\n"
+    "\n"
+    "void rdz_durations_save()\n"
+    "{\n"
+    "  // merges the durations of this run into the RDZ_DURATIONS file\n"
+    "\n"
+    "  if (rdz_durations == NULL || rdz_ran == NULL) return;\n"
+    "\n"
+    "  size_t count = 0; rdz_known_duration *ds = rdz_durations_load(&count);\n"
+    "\n"
+    "  char *tmp = calloc(strlen(rdz_durations) + 5, sizeof(char));\n"
+    "  strcpy(tmp, rdz_durations); strcat(tmp, \".tmp\");\n"
+    "\n"
+    "  FILE *f = fopen(tmp, \"w\");\n"
+    "\n"
+    "  if (f == NULL) { free(tmp); free(ds); return; }\n"
+    "\n"
+    "  for (int n = 0; n < rdz_t->count; n++)\n"
+    "  {\n"
+    "    if (rdz_ran[n] < 0.0) continue;\n"
+    "\n"
+    "    unsigned long long id = rdz_stable_id(n);\n"
+    "    rdz_known_duration k = { id, 0.0 };\n"
+    "    rdz_known_duration *d = ds ?\n"
+    "      bsearch(&k, ds, count, sizeof(k), rdz_known_duration_cmp) : NULL;\n"
+    "\n"
+    "    if (d) d->duration = -1.0; // superseded\n"
+    "    fprintf(f, \"\%016llx \%f\\n\", id, rdz_ran[n]);\n"
+    "  }\n"
+    "  for (size_t i = 0; i < count; i++)\n"
+    "  {\n"
+    "    if (ds[i].duration >= 0.0) fprintf(f, \"\%016llx \%f\\n\", ds[i].id, ds[i].duration);\n"
+    "  }\n"
+    "\n"
+    "  fclose(f);\n"
+    "  rename(tmp, rdz_durations);\n"
+    "\n"
+    "  free(tmp); free(ds);\n"
+    "}\n"
+    "\n"
+    "void rdz_list_nodes()\n"
+    "{\n"
+    "  // one JSON line per describe, context and it, in run order, honours\n"
+    "  // E=, L=, I=, F= and S=, runs nothing (not even the before alls)\n"
+    "\n"
+    "  size_t dcount = 0; rdz_known_duration *ds = rdz_durations_load(&dcount);\n"
+    "\n"
+    "  for (int n = 0; n < rdz_t->count; n++)\n"
+    "  {\n"
+    "    char t = rdz_t->types[n];\n"
+    "\n"
+    "    if (t != 'd' && t != 'c' && t != 'i') continue;\n"
+    "    if ( ! rdz_reachable(n)) continue;\n"
+    "\n"
+    "    printf(\n"
+    "      \"{\\\"id\\\":\\\"\%016llx\\\",\\\"n\\\":\%d,\\\"type\\\":\\\"\%s\\\",\\\"file\\\":\",\n"
+    "      rdz_stable_id(n), n,\n"
+    "      t == 'd' ? \"describe\" : (t == 'c' ? \"context\" : \"it\"));\n"
+    "    rdz_json_string(stdout, rdz_fname(n));\n"
+    "    printf(\n"
+    "      \",\\\"lstart\\\":\%d,\\\"ltstart\\\":\%d,\\\"llength\\\":\%d,\\\"titles\\\":[\",\n"
+    "      rdz_t->lstarts[n], rdz_t->ltstarts[n], rdz_t->llengths[n]);\n"
+    "\n"
+    "    int chain[128]; int cl = 0;\n"
+    "    for (int m = n; m > -1 && cl < 128; m = rdz_t->parents[m])\n"
+    "    {\n"
+    "      char mt = rdz_t->types[m];\n"
+    "      if (mt == 'd' || mt == 'c' || mt == 'i') chain[cl++] = m;\n"
+    "    }\n"
+    "    for (int i = cl - 1; i >= 0; i--)\n"
+    "    {\n"
+    "      if (i < cl - 1) putchar(',');\n"
+    "      rdz_json_string(stdout, rdz_text(chain[i]));\n"
+    "    }\n"
+    "\n"
+    "    printf(\"],\\\"tags\\\":[\");\n"
+    "    int tc = 0;\n"
+    "    if (t == 'i' && rdz_t->ccounts[n] > 0) printf(\"\%s\\\"pending\\\"\", tc++ ? \",\" : \"\");\n"
+    "    if (rdz_t->flags[n] & RDZ_F_CONCURRENT) printf(\"\%s\\\"concurrent\\\"\", tc++ ? \",\" : \"\");\n"
+    "    if (rdz_t->flags[n] & RDZ_F_STRESS) printf(\"\%s\\\"stress\\\"\", tc++ ? \",\" : \"\");\n"
+    "\n"
+    "    double du = t == 'i' ? rdz_durations_find(ds, dcount, n) : -1.0;\n"
+    "    if (du < 0.0) printf(\"],\\\"duration\\\":null}\\n\");\n"
+    "    else printf(\"],\\\"duration\\\":\%f}\\n\", du);\n"
+    "  }\n"
+    "\n"
+    "  free(ds);\n"
+    "}\n"
+    "\n"
+    "  //\n"
+    "  // RDZ_COORDINATOR / RDZ_WORKER\n"
+    "\n"
+    "#ifdef RDZ_WITH_REMOTE\n"
+    "\n"
+    "static int rdz_socket(const char *addr, int listening)\n"
+    "{\n"
+    "  // \"/tmp/s.sock\" is a unix socket, \"localhost:7001\" or \":7001\" is tcp,\n"
+    "  // \":7001\" listens on the loopback only, the protocol isn't authenticated,\n"
+    "  // \"*:7001\" (or \"0.0.0.0:7001\") is needed to listen on every interface\n"
+    "\n"
+    "  int fd = -1;\n"
+    "\n"
+    "  if (strchr(addr, '/'))\n"
+    "  {\n"
+    "    struct sockaddr_un sa; memset(&sa, 0, sizeof(sa));\n"
+    "    sa.sun_family = AF_UNIX;\n"
+    "    snprintf(sa.sun_path, sizeof(sa.sun_path), \"\%s\", addr);\n"
+    "\n"
+    "    fd = socket(AF_UNIX, SOCK_STREAM, 0); if (fd < 0) return -1;\n"
+    "\n"
+    "    if (listening) unlink(addr);\n"
+    "\n"
+    "    int r = listening ?\n"
+    "      bind(fd, (struct sockaddr *)&sa, sizeof(sa)) || listen(fd, 64) :\n"
+    "      connect(fd, (struct sockaddr *)&sa, sizeof(sa));\n"
+    "\n"
+    "    if (r != 0) { close(fd); return -1; }\n"
+    "\n"
+    "    return fd;\n"
+    "  }\n"
+    "\n"
+    "  char *c = strrchr(addr, ':');\n"
+    "  char host[256]; snprintf(host, 256, \"\%.*s\", c ? (int)(c - addr) : 0, addr);\n"
+    "\n"
+    "  struct addrinfo hints, *ai = NULL;\n"
+    "  memset(&hints, 0, sizeof(hints));\n"
+    "  hints.ai_family = AF_UNSPEC;\n"
+    "  hints.ai_socktype = SOCK_STREAM;\n"
+    "\n"
+    "  const char *h = *host ? host : NULL;\n"
+    "  if (listening && h == NULL) h = \"127.0.0.1\"; // \":7001\", the loopback only\n"
+    "  if (h && strcmp(h, \"*\") == 0) { h = NULL; hints.ai_flags = AI_PASSIVE; }\n"
+    "\n"
+    "  if (getaddrinfo(h, c ? c + 1 : addr, &hints, &ai) != 0)\n"
+    "  {\n"
+    "    return -1;\n"
+    "  }\n"
+    "\n"
+    "  for (struct addrinfo *a = ai; a; a = a->ai_next)\n"
+    "  {\n"
+    "    fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);\n"
+    "    if (fd < 0) continue;\n"
+    "\n"
+    "    int one = 1;\n"
+    "    if (listening) setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));\n"
+    "\n"
+    "    int r = listening ?\n"
+    "      bind(fd, a->ai_addr, a->ai_addrlen) || listen(fd, 64) :\n"
+    "      connect(fd, a->ai_addr, a->ai_addrlen);\n"
+    "\n"
+    "    if (r == 0) break;\n"
+    "\n"
+    "    close(fd); fd = -1;\n"
+    "  }\n"
+    "\n"
+    "  freeaddrinfo(ai);\n"
+    "\n"
+    "  return fd;\n"
+    "}\n"
+    "\n"
+    "typedef struct rdz_unit { // an \"it\" handed out by the coordinator\n"
+    "  int n;\n"
+    "  int state; // 0 queued, 1 handed out, 2 done\n"
+    "  int owners; // how many workers have it (2 when stolen)\n"
+    "  int tries;\n"
+    "  double duration;\n"
+    "  int count;\n"
+    "  rdz_result *results;\n"
+    "} rdz_unit;\n"
+    "\n"
+    "typedef struct rdz_peer { // a connected worker\n"
+    "  int fd;\n"
+    "  char *buf;\n"
+    "  size_t len;\n"
+    "  size_t size;\n"
+    "  int *units; // the units handed to the worker, in order\n"
+    "  int ucount;\n"
+    "  int usize;\n"
+    "  double seen; // last time it sent something, ms\n"
+    "  int busy;\n"
+    "} rdz_peer;\n"
+    "\n"
+    "#define RDZ_PEERS_MAX 256\n"
+    "#define RDZ_CHUNK_MAX 16\n"
+    "#define RDZ_UNIT_RESULTS_MAX 1048576 // per example, more is a protocol error\n"
+    "\n"
+    "static char *rdz_parse_results(\n"
+    "  char *s, char *e, int count, rdz_result *rs, int *bad)\n"
+    "{\n"
+    "  // parses count results written by rdz_write_results(), returns a pointer\n"
+    "  // past them, or NULL if they're not all there yet (rs is NULL: check only)\n"
+    "  // or if they don't make sense (*bad is set then)\n"
+    "\n"
+    "  for (int i = 0; i < count; i++)\n"
+    "  {\n"
+    "    if (memchr(s, '\\n', e - s) == NULL) return NULL;\n"
+    "\n"
+    "    int success, itnumber, lnumber, ltnumber, ml, hl;\n"
+    "    if (\n"
+    "      sscanf(\n"
+    "        s, \"\%d \%d \%d \%d \%d\%n\",\n"
+    "        &success, &itnumber, &lnumber, &ltnumber, &ml, &hl) < 5 ||\n"
+    "      success < -1 || success > 1 ||\n"
+    "      itnumber < 0 || itnumber >= rdz_t->count || ml < -1\n"
+    "    ) { *bad = 1; return NULL; }\n"
+    "\n"
+    "    s += hl + 1;\n"
+    "    if ((ml > -1 ? ml : 0) + 1 > e - s) return NULL;\n"
+    "\n"
+    "    if (rs)\n"
+    "    {\n"
+    "      char *msg = ml > -1 ? rdz_strndup(s, ml) : NULL;\n"
+    "      rdz_result_init(rs + i, success, msg, itnumber, lnumber, ltnumber);\n"
+    "    }\n"
+    "\n"
+    "    s += (ml > -1 ? ml : 0) + 1;\n"
+    "  }\n"
+    "\n"
+    "  return s;\n"
+    "}\n"
+    "\n"
+    "static void rdz_unit_done(rdz_unit *u, int count, rdz_result *rs, double du)\n"
+    "{\n"
+    "  u->state = 2; u->count = count; u->results = rs; u->duration = du;\n"
+    "}\n"
+    "\n"
+    "static int rdz_peer_assign(rdz_peer *p, rdz_unit *us, int uc, int live)\n"
+    "{\n"
+    "  // hands a chunk to the worker, chunks shrink as the queue empties,\n"
+    "  // once it's empty the idle worker steals the tail of the biggest\n"
+    "  // outstanding chunk (first result wins), returns 0 if nothing to hand\n"
+    "\n"
+    "  int queued = 0;\n"
+    "  for (int i = 0; i < uc; i++) if (us[i].state == 0) queued++;\n"
+    "\n"
+    "  int chunk = queued / (2 * (live > 0 ? live : 1));\n"
+    "  if (chunk > RDZ_CHUNK_MAX) chunk = RDZ_CHUNK_MAX;\n"
+    "  if (chunk < 1) chunk = 1;\n"
+    "\n"
+    "  int *picks = calloc(chunk, sizeof(int)); int k = 0;\n"
+    "\n"
+    "  for (int i = 0; i < uc && k < chunk; i++)\n"
+    "  {\n"
+    "    if (us[i].state == 0) picks[k++] = i;\n"
+    "  }\n"
+    "\n"
+    "  if (k == 0) // steal\n"
+    "  {\n"
+    "    for (int i = uc - 1; i >= 0 && k < chunk; i--)\n"
+    "    {\n"
+    "      if (us[i].state != 1 || us[i].owners > 1) continue;\n"
+    "\n"
+    "      int mine = 0;\n"
+    "      for (int j = 0; j < p->ucount; j++) if (p->units[j] == i) mine = 1;\n"
+    "\n"
+    "      if ( ! mine) picks[k++] = i;\n"
+    "    }\n"
+    "    for (int i = 0; i < k / 2; i++) // back in tree order\n"
+    "    {\n"
+    "      int x = picks[i]; picks[i] = picks[k - 1 - i]; picks[k - 1 - i] = x;\n"
+    "    }\n"
+    "  }\n"
+    "\n"
+    "  if (k == 0) { free(picks); p->busy = 0; return 0; }\n"
+    "\n"
+    "  size_t l = 8 + 12 * k; char *line = calloc(l, sizeof(char));\n"
+    "  strcpy(line, \"run\"); char *ll = line + 3;\n"
+    "\n"
+    "  for (int i = 0; i < k; i++)\n"
+    "  {\n"
+    "    rdz_unit *u = us + picks[i];\n"
+    "    u->state = 1; u->owners++;\n"
+    "\n"
+    "    if (p->ucount >= p->usize)\n"
+    "    {\n"
+    "      p->usize = p->usize * 2 + RDZ_CHUNK_MAX;\n"
+    "      p->units = realloc(p->units, p->usize * sizeof(int));\n"
+    "    }\n"
+    "    p->units[p->ucount++] = picks[i];\n"
+    "\n"
+    "    ll += snprintf(ll, l - (ll - line), \" \%d\", u->n);\n"
+    "  }\n"
+    "  strcat(ll, \"\\n\");\n"
+    "\n"
+    "  rdz_write(p->fd, line, strlen(line));\n"
+    "\n"
+    "  p->busy = 1; p->seen = rdz_now();\n"
+    "\n"
+    "  free(line); free(picks);\n"
+    "\n"
+    "  return k;\n"
+    "}\n"
+    "\n"
+    "static int rdz_peer_lost(rdz_peer *p, rdz_unit *us, int retries)\n"
+    "{\n"
+    "  // the worker crashed, hung up or timed out, its undone units are\n"
+    "  // requeued, the one it was probably running counts a try,\n"
+    "  // returns how many units got done (given up on)\n"
+    "\n"
+    "  int done = 0;\n"
+    "  int first = 1;\n"
+    "\n"
+    "  for (int i = 0; i < p->ucount; i++)\n"
+    "  {\n"
+    "    rdz_unit *u = us + p->units[i];\n"
+    "\n"
+    "    if (u->state == 2) continue;\n"
+    "\n"
+    "    if (--u->owners > 0) { first = 0; continue; }\n"
+    "\n"
+    "    if (first) u->tries++;\n"
+    "    first = 0;\n"
+    "\n"
+    "    u->state = 0;\n"
+    "\n"
+    "    if (u->tries <= retries) continue;\n"
+    "\n"
+    "    rdz_result *r = calloc(1, sizeof(rdz_result));\n"
+    "    char *msg = calloc(128, sizeof(char));\n"
+    "    snprintf(msg, 128, \"     worker lost \%d times (crash or timeout)\", u->tries);\n"
+    "    rdz_result_init(\n"
+    "      r, 0, msg, u->n, rdz_t->lstarts[u->n], rdz_t->ltstarts[u->n]);\n"
+    "\n"
+    "    rdz_unit_done(u, 1, r, -1.0);\n"
+    "    done++;\n"
+    "  }\n"
+    "\n"
+    "  close(p->fd); p->fd = -1;\n"
+    "  free(p->buf); p->buf = NULL; p->len = 0; p->size = 0;\n"
+    "  free(p->units); p->units = NULL; p->ucount = 0; p->usize = 0;\n"
+    "  p->busy = 0;\n"
+    "\n"
+    "  return done;\n"
+    "}\n"
+    "\n"
+    "static int rdz_peer_read(rdz_peer *p, rdz_unit *us, const int *lookup, int *done)\n"
+    "{\n"
+    "  // reads what the worker sent, returns -1 if it's gone, 1 if it finished\n"
+    "  // its chunk, 0 else\n"
+    "\n"
+    "  if (p->len + 4097 > p->size)\n"
+    "  {\n"
+    "    p->size = p->size * 2 + 4097; p->buf = realloc(p->buf, p->size);\n"
+    "  }\n"
+    "\n"
+    "  ssize_t r = read(p->fd, p->buf + p->len, p->size - p->len - 1);\n"
+    "  if (r < 1) return -1;\n"
+    "\n"
+    "  p->len += r; p->buf[p->len] = '\\0';\n"
+    "  p->seen = rdz_now();\n"
+    "\n"
+    "  int finished = 0;\n"
+    "  char *s = p->buf;\n"
+    "  char *e = p->buf + p->len;\n"
+    "\n"
+    "  while (s < e && memchr(s, '\\n', e - s))\n"
+    "  {\n"
+    "    if (strncmp(s, \"done\\n\", 5) == 0) { s += 5; finished = 1; continue; }\n"
+    "\n"
+    "    int n, count, hl, bad = 0; double du;\n"
+    "    if (\n"
+    "      sscanf(s, \"it \%d \%d \%lf\%n\", &n, &count, &du, &hl) < 3 ||\n"
+    "      n < 0 || n >= rdz_t->count || lookup[n] < 0 ||\n"
+    "      count < 0 || count > RDZ_UNIT_RESULTS_MAX\n"
+    "    ) return -1; // protocol error, let it go\n"
+    "\n"
+    "    char *ss = s + hl + 1;\n"
+    "    if (rdz_parse_results(ss, e, count, NULL, &bad) == NULL)\n"
+    "    {\n"
+    "      if (bad) return -1;\n"
+    "      break; // wait for more\n"
+    "    }\n"
+    "\n"
+    "    rdz_unit *u = us + lookup[n];\n"
+    "    rdz_result *rs = calloc(count > 0 ? count : 1, sizeof(rdz_result));\n"
+    "\n"
+    "    s = rdz_parse_results(ss, e, count, rs, &bad);\n"
+    "\n"
+    "    if (u->state == 2) // stolen and already done, first result wins\n"
+    "    {\n"
+    "      for (int i = 0; i < count; i++) rdz_result_clear(rs + i);\n"
+    "      free(rs);\n"
+    "    }\n"
+    "    else\n"
+    "    {\n"
+    "      rdz_unit_done(u, count, rs, du); (*done)++;\n"
+    "    }\n"
+    "  }\n"
+    "\n"
+    "  p->len = e - s; memmove(p->buf, s, p->len); p->buf[p->len] = '\\0';\n"
+    "\n"
+    "  return finished;\n"
+    "}\n"
+    "\n"
+    "static void rdz_coordinate_print(int n, rdz_unit *us, const int *lookup)\n"
+    "{\n"
+    "  // the tree is printed as for a local run, the results are those\n"
+    "  // streamed back by the workers\n"
+    "\n"
+    "  if (n == 0) printf(\"\\n\"); // initial blank line\n"
+    "\n"
+    "  if ( ! rdz_doruns[n]) return;\n"
+    "\n"
+    "  char t = rdz_t->types[n];\n"
+    "  const int *cs = rdz_children(n);\n"
+    "  int cc = rdz_t->ccounts[n];\n"
+    "\n"
+    "  if (t == 'i' && lookup[n] > -1)\n"
+    "  {\n"
+    "    rdz_unit *u = us + lookup[n];\n"
+    "\n"
+    "    for (int i = 0; i < u->count; i++)\n"
+    "    {\n"
+    "      rdz_result *r = u->results + i;\n"
+    "\n"
+    "      *rdz_results_push() = *r;\n"
+    "\n"
+    "      if (r->success == -1) rdz_pending_count++;\n"
+    "      if (r->success == 0) rdz_fail_count++;\n"
+    "    }\n"
+    "\n"
+    "    if (u->count == 0)\n"
+    "    {\n"
+    "      rdz_record(\n"
+    "        1, rdz_strdup(rdz_text(n)), n, rdz_t->lstarts[n], rdz_t->ltstarts[n]);\n"
+    "    }\n"
+    "\n"
+    "    rdz_print_result(rdz_results + rdz_count - 1, u->duration);\n"
+    "\n"
+    "    free(u->results); u->results = NULL;\n"
+    "  }\n"
+    "  else if (t == 'i' || t == 'p')\n"
+    "  {\n"
+    "    rdz_dorun(n); // pending, nothing gets run\n"
+    "  }\n"
+    "  else if (t == 'G' || t == 'g' || t == 'd' || t == 'c')\n"
+    "  {\n"
+    "    rdz_print_level(n);\n"
+    "\n"
+    "    for (int i = 0; i < cc; i++)\n"
+    "    {\n"
+    "      char ct = rdz_t->types[cs[i]];\n"
+    "      if (ct == 'd' || ct == 'c' || ct == 'i') rdz_coordinate_print(cs[i], us, lookup);\n"
+    "    }\n"
+    "  }\n"
+    "}\n"
+    "\n"
+    "void rdz_coordinate()\n"
+    "{\n"
+    "  // serves the selected \"it\"s to the RDZ_WORKERs connecting, runs none\n"
+    "  // of them, not even the before alls, then prints the gathered results\n"
+    "\n"
+    "  signal(SIGPIPE, SIG_IGN); // a worker may die while being written to\n"
+    "\n"
+    "  int lfd = rdz_socket(rdz_coordinator, 1);\n"
+    "\n"
+    "  if (lfd < 0)\n"
+    "  {\n"
+    "    fprintf(stderr, \"couldn't listen on \%s\\n\", rdz_coordinator);\n"
+    "    exit(1);\n"
+    "  }\n"
+    "\n"
+    "  char *e = getenv(\"RDZ_TIMEOUT\"); // seconds\n"
+    "  double timeout = (e ? atof(e) : 60.0) * 1000.0;\n"
+    "  e = getenv(\"RDZ_RETRIES\");\n"
+    "  int retries = e ? atoi(e) : 2;\n"
+    "\n"
+    "  int *lookup = calloc(rdz_t->count, sizeof(int));\n"
+    "  rdz_unit *us = calloc(rdz_t->count, sizeof(rdz_unit));\n"
+    "  int uc = 0;\n"
+    "\n"
+    "  for (int n = 0; n < rdz_t->count; n++)\n"
+    "  {\n"
+    "    lookup[n] = -1;\n"
+    "\n"
+    "    if (rdz_t->types[n] != 'i' || rdz_t->ccounts[n] > 0) continue;\n"
+    "    if ( ! rdz_reachable(n)) continue;\n"
+    "\n"
+    "    us[uc].n = n; lookup[n] = uc++;\n"
+    "  }\n"
+    "\n"
+    "  rdz_peer *ps = calloc(RDZ_PEERS_MAX, sizeof(rdz_peer)); int pc = 0;\n"
+    "  struct pollfd *fds = calloc(RDZ_PEERS_MAX + 1, sizeof(struct pollfd));\n"
+    "\n"
+    "  int done = 0;\n"
+    "\n"
+    "  while (done < uc)\n"
+    "  {\n"
+    "    int live = 0;\n"
+    "    for (int i = 0; i < pc; i++) if (ps[i].fd > -1) live++;\n"
+    "\n"
+    "    for (int i = 0; i < pc; i++) // idle workers get work\n"
+    "    {\n"
+    "      if (ps[i].fd > -1 && ! ps[i].busy) rdz_peer_assign(ps + i, us, uc, live);\n"
+    "    }\n"
+    "\n"
+    "    fds[0].fd = lfd; fds[0].events = POLLIN; fds[0].revents = 0;\n"
+    "    for (int i = 0; i < pc; i++)\n"
+    "    {\n"
+    "      fds[i + 1].fd = ps[i].fd; fds[i + 1].events = POLLIN; fds[i + 1].revents = 0;\n"
+    "    }\n"
+    "\n"
+    "    if (poll(fds, pc + 1, 1000) < 0 && errno != EINTR) break;\n"
+    "\n"
+    "    if ((fds[0].revents & POLLIN) && pc < RDZ_PEERS_MAX)\n"
+    "    {\n"
+    "      int fd = accept(lfd, NULL, NULL);\n"
+    "\n"
+    "      if (fd > -1) { ps[pc].fd = fd; ps[pc].seen = rdz_now(); pc++; }\n"
+    "    }\n"
+    "\n"
+    "    for (int i = 0; i < pc; i++)\n"
+    "    {\n"
+    "      rdz_peer *p = ps + i;\n"
+    "\n"
+    "      if (p->fd < 0) continue;\n"
+    "\n"
+    "      int r = 0;\n"
+    "\n"
+    "      if (fds[i + 1].revents) r = rdz_peer_read(p, us, lookup, &done);\n"
+    "\n"
+    "      if (r == 0 && p->busy && rdz_now() - p->seen > timeout) r = -1;\n"
+    "\n"
+    "      if (r < 0) done += rdz_peer_lost(p, us, retries);\n"
+    "      else if (r > 0) p->busy = 0;\n"
+    "    }\n"
+    "  }\n"
+    "\n"
+    "  for (int i = 0; i < pc; i++)\n"
+    "  {\n"
+    "    if (ps[i].fd < 0) continue;\n"
+    "\n"
+    "    rdz_write(ps[i].fd, \"quit\\n\", 5);\n"
+    "    close(ps[i].fd);\n"
+    "    free(ps[i].buf); free(ps[i].units);\n"
+    "  }\n"
+    "\n"
+    "  close(lfd);\n"
+    "  if (strchr(rdz_coordinator, '/')) unlink(rdz_coordinator);\n"
+    "\n"
+    "  rdz_coordinate_print(0, us, lookup);\n"
+    "\n"
+    "  free(fds); free(ps);\n"
+    "  free(us); free(lookup);\n"
+    "}\n"
+    "\n"
+    "void rdz_work()\n"
+    "{\n"
+    "  // connects to the RDZ_COORDINATOR and runs the chunks it hands out,\n"
+    "  // \"run 3 5 7\\n\", until it says \"quit\\n\" or hangs up\n"
+    "\n"
+    "  int fd = -1;\n"
+    "\n"
+    "  for (int i = 0; fd < 0 && i < 50; i++) // the coordinator may be starting\n"
+    "  {\n"
+    "    fd = rdz_socket(rdz_remote, 0);\n"
+    "\n"
+    "    struct timespec ts = { 0, 100 * 1000 * 1000 };\n"
+    "    if (fd < 0) nanosleep(&ts, NULL);\n"
+    "  }\n"
+    "\n"
+    "  if (fd < 0)\n"
+    "  {\n"
+    "    fprintf(stderr, \"couldn't connect to \%s\\n\", rdz_remote);\n"
+    "    rdz_fail_count++;\n"
+    "    return;\n"
+    "  }\n"
+    "\n"
+    "  rdz_remote_fd = fd;\n"
+    "  rdz_worker = 1; // no RDZ_JOBS forking under a coordinator\n"
+    "\n"
+    "  // the chunks are run one after the other, the before alls of a group\n"
+    "  // are run when a chunk enters it for the first time, the after alls\n"
+    "  // when the coordinator is done with the worker, as for a serial run\n"
+    "\n"
+    "  rdz_opened = calloc(rdz_t->count, sizeof(int));\n"
+    "  rdz_opened_count = 0;\n"
+    "\n"
+    "  size_t size = 1024; char *line = calloc(size, sizeof(char));\n"
+    "\n"
+    "  while (1)\n"
+    "  {\n"
+    "    size_t l = 0;\n"
+    "\n"
+    "    while (1)\n"
+    "    {\n"
+    "      if (l + 1 >= size) { size *= 2; line = realloc(line, size); }\n"
+    "      if (read(fd, line + l, 1) < 1) { l = 0; break; }\n"
+    "      if (line[l] == '\\n') break;\n"
+    "      l++;\n"
+    "    }\n"
+    "    line[l] = '\\0';\n"
+    "\n"
+    "    if (strncmp(line, \"run \", 4) != 0) break; // \"quit\" or gone\n"
+    "\n"
+    "    memset(rdz_doruns, 0, rdz_t->count * sizeof(int));\n"
+    "\n"
+    "    for (char *s = line + 4; *s; )\n"
+    "    {\n"
+    "      int n = (int)strtol(s, &s, 10);\n"
+    "      if (n < 1 || n >= rdz_t->count) break;\n"
+    "\n"
+    "      for (int m = n; m > -1; m = rdz_t->parents[m]) rdz_doruns[m] = 1;\n"
+    "    }\n"
+    "\n"
+    "    rdz_dorun(0);\n"
+    "    fflush(stdout);\n"
+    "\n"
+    "    rdz_write(fd, \"done\\n\", 5);\n"
+    "  }\n"
+    "\n"
+    "  for (int o = rdz_opened_count - 1; o >= 0; o--) // after all, innermost first\n"
+    "  {\n"
+    "    int n = rdz_opened[o];\n"
+    "    const int *cs = rdz_children(n);\n"
+    "\n"
+    "    for (int i = 0; i < rdz_t->ccounts[n]; i++)\n"
+    "    {\n"
+    "      if (rdz_t->types[cs[i]] == 'A') rdz_call(cs[i]);\n"
+    "    }\n"
+    "  }\n"
+    "  fflush(stdout);\n"
+    "\n"
+    "  free(rdz_opened); rdz_opened = NULL;\n"
+    "\n"
+    "  free(line);\n"
+    "  close(fd);\n"
+    "  rdz_remote_fd = -1;\n"
+    "}\n"
+    "\n"
+    "#else\n"
+    "\n"
+    "void rdz_coordinate() {}\n"
+    "void rdz_work() {}\n"
+    "\n"
+    "#endif // RDZ_WITH_REMOTE\n"
+    "\n"
+    "  //\n"
+    "  // RDZ_REPEAT / RDZ_UNTIL_FAIL\n"
+    "\n"
+    "static void rdz_rep_on_signal(int sig) { (void)sig; rdz_rep_stop = 1; }\n"
+    "\n"
+    "static void rdz_results_clear()\n"
+    "{\n"
+    "  for (int i = 0; i < rdz_count; i++) rdz_result_clear(rdz_results + i);\n"
+    "  rdz_count = 0; rdz_fail_count = 0; rdz_pending_count = 0;\n"
+    "}\n"
+    "\n"
+    "static void rdz_results_recount()\n"
+    "{\n"
+    "  rdz_fail_count = 0; rdz_pending_count = 0;\n"
+    "\n"
+    "  for (int i = 0; i < rdz_count; i++)\n"
+    "  {\n"
+    "    if (rdz_results[i].success == -1) rdz_pending_count++;\n"
+    "    if (rdz_results[i].success == 0) rdz_fail_count++;\n"
+    "  }\n"
+    "}\n"
+    "\n"
+    "static void rdz_repeat_loop(long reps)\n"
+    "{\n"
+    "  // runs the selection reps times, the output goes nowhere, the\n"
+    "  // results of the first failing run are kept for the summary,\n"
+    "  // else those of the last run\n"
+    "\n"
+    "  rdz_result *kept = NULL; int kc = 0; // the first failing run's results\n"
+    "\n"
+    "  for (long r = 0; r < reps && ! rdz_rep_stop; r++)\n"
+    "  {\n"
+    "    if (r > 0 && kept == NULL && rdz_fail_count > 0) // keep them aside\n"
+    "    {\n"
+    "      kept = calloc(rdz_count + 1, sizeof(rdz_result)); kc = rdz_count;\n"
+    "      memcpy(kept, rdz_results, kc * sizeof(rdz_result));\n"
+    "      rdz_count = 0; rdz_fail_count = 0; rdz_pending_count = 0;\n"
+    "    }\n"
+    "    else if (r > 0)\n"
+    "    {\n"
+    "      rdz_results_clear();\n"
+    "    }\n"
+    "\n"
+    "    rdz_dorun(0);\n"
+    "    fflush(stdout);\n"
+    "\n"
+    "    rdz_rep_runs++;\n"
+    "\n"
+    "    if (rdz_fail_count < 1) continue;\n"
+    "\n"
+    "    rdz_rep_failed_runs++;\n"
+    "\n"
+    "    if (rdz_until_fail) break;\n"
+    "  }\n"
+    "\n"
+    "  if (kept)\n"
+    "  {\n"
+    "    rdz_results_clear();\n"
+    "    memcpy(rdz_results, kept, kc * sizeof(rdz_result)); rdz_count = kc;\n"
+    "    free(kept);\n"
+    "  }\n"
+    "\n"
+    "  rdz_results_recount();\n"
+    "}\n"
+    "\n"
+    "static void rdz_repeat_write(int fd)\n"
+    "{\n"
+    "  // \"runs failed\\n\", then \"n passes fails min max total seen samples...\\n\"\n"
+    "  // per \"it\", then \"--\\n\" and the kept results\n"
+    "\n"
+    "  char *s = NULL; size_t l = 0; FILE *f = open_memstream(&s, &l);\n"
+    "\n"
+    "  fprintf(f, \"\%ld \%ld\\n\", rdz_rep_runs, rdz_rep_failed_runs);\n"
+    "\n"
+    "  for (int n = 0; n < rdz_t->count; n++)\n"
+    "  {\n"
+    "    rdz_rep *r = rdz_reps + n;\n"
+    "\n"
+    "    if (r->passes + r->fails < 1) continue;\n"
+    "\n"
+    "    fprintf(\n"
+    "      f, \"\%d \%ld \%ld \%f \%f \%f \%ld\",\n"
+    "      n, r->passes, r->fails, r->min, r->max, r->total, r->seen);\n"
+    "    for (int i = 0; i < r->count; i++) fprintf(f, \" \%f\", r->samples[i]);\n"
+    "    fprintf(f, \"\\n\");\n"
+    "  }\n"
+    "  fprintf(f, \"--\\n\");\n"
+    "  fclose(f);\n"
+    "\n"
+    "  rdz_write(fd, s, l);\n"
+    "  free(s);\n"
+    "\n"
+    "  rdz_write_results(fd, 0);\n"
+    "}\n"
+    "\n"
+    "static int rdz_repeat_read(int fd, int keep)\n"
+    "{\n"
+    "  // merges what a worker wrote, returns 1 if it kept failing results\n"
+    "\n"
+    "  size_t l = 0; char *s = rdz_read(fd, &l); char *e = s + l;\n"
+    "\n"
+    "  char *ss = s;\n"
+    "  long runs = strtol(ss, &ss, 10); rdz_rep_runs += runs;\n"
+    "  long failed = strtol(ss, &ss, 10); rdz_rep_failed_runs += failed;\n"
+    "\n"
+    "  while (ss < e)\n"
+    "  {\n"
+    "    ss += strspn(ss, \" \\n\");\n"
+    "    if (strncmp(ss, \"--\\n\", 3) == 0) { ss += 3; break; }\n"
+    "\n"
+    "    int n = (int)strtol(ss, &ss, 10);\n"
+    "    rdz_rep *r = rdz_reps + n;\n"
+    "\n"
+    "    r->passes += strtol(ss, &ss, 10);\n"
+    "    r->fails += strtol(ss, &ss, 10);\n"
+    "    double mi = strtod(ss, &ss); double ma = strtod(ss, &ss);\n"
+    "    double to = strtod(ss, &ss); long se = strtol(ss, &ss, 10);\n"
+    "\n"
+    "    if (se > 0 && (r->seen == 0 || mi < r->min)) r->min = mi;\n"
+    "    if (se > 0 && (r->seen == 0 || ma > r->max)) r->max = ma;\n"
+    "    r->total += to; r->seen += se;\n"
+    "\n"
+    "    if (r->samples == NULL) r->samples = calloc(RDZ_REP_SAMPLES, sizeof(double));\n"
+    "\n"
+    "    while (*ss == ' ')\n"
+    "    {\n"
+    "      double d = strtod(ss, &ss);\n"
+    "      if (r->count < RDZ_REP_SAMPLES) r->samples[r->count++] = d;\n"
+    "    }\n"
+    "  }\n"
+    "\n"
+    "  int kept = (failed > 0);\n"
+    "\n"
+    "  if (keep) rdz_record_results(ss, e);\n"
+    "\n"
+    "  free(s);\n"
+    "\n"
+    "  return kept;\n"
+    "}\n"
+    "\n"
+    "static void rdz_repeat_run()\n"
+    "{\n"
+    "  istty(); // determine it before stdout gets redirected\n"
+    "\n"
+    "  long reps = rdz_repeat > 0 ? rdz_repeat : (rdz_until_fail ? 0x7fffffffL : 1);\n"
+    "  int jobs = rdz_jobs > 1 ? rdz_jobs : 1;\n"
+    "  if (jobs > reps) jobs = (int)reps;\n"
+    "\n"
+    "  rdz_reps = calloc(rdz_t->count, sizeof(rdz_rep));\n"
+    "\n"
+    "  signal(SIGINT, rdz_rep_on_signal); // ctrl-c stops and summarizes\n"
+    "\n"
+    "  fflush(stdout);\n"
+    "  int out = dup(1);\n"
+    "  int nul = open(\"/dev/null\", O_WRONLY); dup2(nul, 1); close(nul);\n"
+    "\n"
+    "  if (jobs < 2)\n"
+    "  {\n"
+    "    rdz_repeat_loop(reps);\n"
+    "  }\n"
+    "  else\n"
+    "  {\n"
+    "    // the repetitions are spread over forked workers, with RDZ_UNTIL_FAIL\n"
+    "    // the first failing worker stops the others (SIGUSR1)\n"
+    "\n"
+    "    int *fds = calloc(jobs, sizeof(int));\n"
+    "    pid_t *pids = calloc(jobs, sizeof(pid_t));\n"
+    "\n"
+    "    for (int w = 0; w < jobs; w++)\n"
+    "    {\n"
+    "      fds[w] = rdz_tmpfd(\"rep\", w);\n"
+    "      pids[w] = fork();\n"
+    "\n"
+    "      if (pids[w] != 0) continue;\n"
+    "\n"
+    "      rdz_worker = 1;\n"
+    "      signal(SIGUSR1, rdz_rep_on_signal);\n"
+    "      srand(getpid());\n"
+    "\n"
+    "      rdz_repeat_loop(reps / jobs + (w < reps \% jobs ? 1 : 0));\n"
+    "\n"
+    "      fflush(stdout);\n"
+    "      rdz_repeat_write(fds[w]);\n"
+    "\n"
+    "      _exit(rdz_rep_failed_runs > 0 ? 1 : 0);\n"
+    "    }\n"
+    "\n"
+    "    for (int left = jobs; left > 0; left--)\n"
+    "    {\n"
+    "      int status = 0;\n"
+    "      pid_t pid = wait(&status);\n"
+    "\n"
+    "      if (pid < 0 && errno == EINTR) { left++; continue; }\n"
+    "      if (pid < 0) break;\n"
+    "\n"
+    "      if ( ! rdz_until_fail || ! WIFEXITED(status) || WEXITSTATUS(status) == 0)\n"
+    "      {\n"
+    "        continue;\n"
+    "      }\n"
+    "\n"
+    "      for (int w = 0; w < jobs; w++) if (pids[w] != pid) kill(pids[w], SIGUSR1);\n"
+    "    }\n"
+    "\n"
+    "    int kept = 0; // the results of the first failing worker, else the last\n"
+    "\n"
+    "    for (int w = 0; w < jobs; w++)\n"
+    "    {\n"
+    "      if ( ! kept) rdz_results_clear();\n"
+    "      if (rdz_repeat_read(fds[w], ! kept)) kept = 1;\n"
+    "      close(fds[w]);\n"
+    "    }\n"
+    "\n"
+    "    rdz_results_recount();\n"
+    "\n"
+    "    free(fds); free(pids);\n"
+    "  }\n"
+    "\n"
+    "  fflush(stdout);\n"
+    "  dup2(out, 1); close(out);\n"
+    "\n"
+    "  signal(SIGINT, SIG_DFL);\n"
+    "}\n"
+    "\n"
+    "static int rdz_double_cmp(const void *a, const void *b)\n"
+    "{\n"
+    "  double da = *(const double *)a; double db = *(const double *)b;\n"
+    "\n"
+    "  return da < db ? -1 : da > db;\n"
+    "}\n"
+    "\n"
+    "void rdz_repeat_summary(int durations)\n"
+    "{\n"
+    "  if (rdz_reps == NULL) return;\n"
+    "\n"
+    "  if (rdz_fail_count > 0) printf(\"\\n\"); // after the failures\n"
+    "\n"
+    "  printf(\n"
+    "    \"Repeat: \%ld runs, \%s\%ld failed\%s\",\n"
+    "    rdz_rep_runs,\n"
+    "    rdz_rep_failed_runs > 0 ? rdz_rd() : \"\", rdz_rep_failed_runs, rdz_cl());\n"
+    "  if (rdz_until_fail && rdz_rep_failed_runs > 0) printf(\" (until the first failure)\");\n"
+    "  printf(\"\\n\\n\");\n"
+    "\n"
+    "  for (int n = 0; n < rdz_t->count; n++)\n"
+    "  {\n"
+    "    rdz_rep *r = rdz_reps + n;\n"
+    "\n"
+    "    if (r->passes + r->fails < 1) continue;\n"
+    "\n"
+    "    char *title = rdz_determine_title(n);\n"
+    "\n"
+    "    printf(\"  \%s\%s\%s\", r->fails > 0 ? rdz_rd() : \"\", title, rdz_cl());\n"
+    "    printf(\" \%sL=\%d I=\%d\%s\\n\", rdz_gr(), rdz_t->ltstarts[n], n, rdz_cl());\n"
+    "    printf(\"     \%ld passed, \%ld failed\", r->passes, r->fails);\n"
+    "\n"
+    "    if (durations && r->count > 0)\n"
+    "    {\n"
+    "      qsort(r->samples, r->count, sizeof(double), rdz_double_cmp);\n"
+    "\n"
+    "      printf(\n"
+    "        \"\%s  min \%.3fms median \%.3fms p90 \%.3fms max \%.3fms mean \%.3fms\%s\",\n"
+    "        rdz_gr(),\n"
+    "        r->min, r->samples[r->count / 2], r->samples[r->count * 9 / 10],\n"
+    "        r->max, r->total / r->seen, rdz_cl());\n"
+    "    }\n"
+    "    printf(\"\\n\");\n"
+    "\n"
+    "    free(title);\n"
+    "  }\n"
+    "\n"
+    "  printf(\"\\n\");\n"
+    "\n"
+    "  for (int n = 0; n < rdz_t->count; n++) free(rdz_reps[n].samples);\n"
+    "  free(rdz_reps); rdz_reps = NULL;\n"
+    "  rdz_rep_runs = 0; rdz_rep_failed_runs = 0; rdz_rep_stop = 0;\n"
+    "}\n"
+    "\n"
+    "  //\n"
+    "  // RDZ_BISECT\n"
+    "\n"
+    "#ifdef RDZ_RERUN\n"
+    "\n"
+    "static char *rdz_rerun_unset[] = {\n"
+    "  \"E\", \"L\", \"F\", \"S\", \"RDZ_BISECT\", \"RDZ_REPEAT\", \"RDZ_UNTIL_FAIL\",\n"
+    "  \"RDZ_LIST\", \"RDZ_DURATIONS\", \"RDZ_COVERAGE\", \"RDZ_SAMPLE\", \"RDZ_TRACE\",\n"
+    "  \"RDZ_COORDINATOR\", \"RDZ_WORKER\", \"RDZ_VALGRIND\", \"RDZ_UPDATE_SNAPSHOTS\",\n"
+    "  \"RDZ_BISECT_FD\", \"RDZ_BISECT_SET\",\n"
+    "  NULL };\n"
+    "\n"
+    "static char *rdz_self_exe()\n"
+    "{\n"
+    "  char *r = calloc(4096, sizeof(char));\n"
+    "\n"
+    "#ifdef __APPLE__\n"
+    "  uint32_t size = 4096;\n"
+    "  if (_NSGetExecutablePath(r, &size) == 0) return r;\n"
+    "#else\n"
+    "  if (readlink(\"/proc/self/exe\", r, 4095) > 0) return r;\n"
+    "#endif\n"
+    "\n"
+    "  free(r);\n"
+    "\n"
+    "  return NULL;\n"
+    "}\n"
+    "\n"
+    "#endif // RDZ_RERUN\n"
+    "\n"
+    "#ifdef RDZ_WITH_BISECT\n"
+    "\n"
+    "static void rdz_bisect_report()\n"
+    "{\n"
+    "  // in a bisection run, tells the bisecting process what failed\n"
+    "\n"
+    "  for (int i = 0; i < rdz_count; i++)\n"
+    "  {\n"
+    "    rdz_result *r = rdz_results + i;\n"
+    "    if (r->success != 0) continue;\n"
+    "\n"
+    "    char s[32]; int l = snprintf(s, 32, \"\%d\\n\", r->itnumber);\n"
+    "    rdz_write(rdz_bisect_fd, s, l);\n"
+    "  }\n"
+    "\n"
+    "  rdz_write(rdz_bisect_fd, \"done\\n\", 5);\n"
+    "  close(rdz_bisect_fd); rdz_bisect_fd = -1;\n"
+    "}\n"
+    "\n"
+    "static pid_t rdz_bisect_spawn(char *exe, int *ns, size_t count, int w, int *fd)\n"
+    "{\n"
+    "  // fork + exec of the spec itself, with I=n0,n1,...,bisect passed in\n"
+    "  // a file (RDZ_BISECT_SET), the results come back through a pipe\n"
+    "\n"
+    "  char *is = calloc((count + 1) * 12 + 2, sizeof(char));\n"
+    "  char *s = is;\n"
+    "  for (size_t i = 0; i < count; i++) s += sprintf(s, \"\%d,\", ns[i]);\n"
+    "  sprintf(s, \"\%d\\n\", rdz_bisect);\n"
+    "\n"
+    "  int sfd = rdz_tmpfd(\"bisect\", w);\n"
+    "  if (sfd < 0) { free(is); return -1; }\n"
+    "  rdz_write(sfd, is, strlen(is)); lseek(sfd, 0, SEEK_SET);\n"
+    "  free(is);\n"
+    "\n"
+    "  int ps[2]; if (pipe(ps) != 0) { close(sfd); return -1; }\n"
+    "\n"
+    "  fflush(stdout);\n"
+    "\n"
+    "  pid_t pid = fork();\n"
+    "\n"
+    "  if (pid == 0)\n"
+    "  {\n"
+    "    close(ps[0]);\n"
+    "\n"
+    "    int dn = open(\"/dev/null\", O_RDWR);\n"
+    "    dup2(dn, 0); dup2(dn, 1); dup2(dn, 2);\n"
+    "\n"
+    "    for (size_t i = 0; rdz_rerun_unset[i]; i++) unsetenv(rdz_rerun_unset[i]);\n"
+    "    unsetenv(\"I\");\n"
+    "\n"
+    "    char sf[16]; snprintf(sf, 16, \"\%d\", ps[1]);\n"
+    "    setenv(\"RDZ_BISECT_FD\", sf, 1);\n"
+    "    snprintf(sf, 16, \"\%d\", sfd);\n"
+    "    setenv(\"RDZ_BISECT_SET\", sf, 1);\n"
+    "\n"
+    "    execl(exe, exe, (char *)NULL);\n"
+    "    _exit(127);\n"
+    "  }\n"
+    "\n"
+    "  close(ps[1]); close(sfd);\n"
+    "\n"
+    "  if (pid < 0) { close(ps[0]); return -1; }\n"
+    "\n"
+    "  *fd = ps[0];\n"
+    "\n"
+    "  return pid;\n"
+    "}\n"
+    "\n"
+    "static int rdz_bisect_test(\n"
+    "  char *exe, int **sets, size_t *counts, size_t sc, int *died)\n"
+    "{\n"
+    "  // runs the candidate sets, as many at once as there are cores, returns\n"
+    "  // the index of the first set reproducing the failure, -1 if none does,\n"
+    "  // -2 if the spec executable couldn't be run\n"
+    "  //\n"
+    "  // a run reproduces the failure if it reports the bisected example as\n"
+    "  // failed or if it died while running it, a run dying elsewhere\n"
+    "  // (another example crashing on its own) doesn't count\n"
+    "\n"
+    "  long cores = rdz_jobs > 1 ? rdz_jobs : sysconf(_SC_NPROCESSORS_ONLN);\n"
+    "  if (cores < 1) cores = 1;\n"
+    "\n"
+    "  pid_t *pids = calloc(cores, sizeof(pid_t));\n"
+    "  int *fds = calloc(cores, sizeof(int));\n"
+    "\n"
+    "  int r = -1;\n"
+    "\n"
+    "  for (size_t from = 0; r == -1 && from < sc; from += cores)\n"
+    "  {\n"
+    "    size_t to = from + cores; if (to > sc) to = sc;\n"
+    "\n"
+    "    for (size_t i = from; i < to; i++)\n"
+    "    {\n"
+    "      pids[i - from] = rdz_bisect_spawn(\n"
+    "        exe, sets[i], counts[i], i - from, fds + i - from);\n"
+    "    }\n"
+    "\n"
+    "    for (size_t i = from; i < to; i++)\n"
+    "    {\n"
+    "      if (pids[i - from] < 0) continue;\n"
+    "\n"
+    "      size_t l = 0; char *o = rdz_read(fds[i - from], &l);\n"
+    "      close(fds[i - from]);\n"
+    "\n"
+    "      int status = 0; waitpid(pids[i - from], &status, 0);\n"
+    "\n"
+    "      if (l == 0 && WIFEXITED(status) && WEXITSTATUS(status) == 127)\n"
+    "      {\n"
+    "        r = -2; // the exec failed\n"
+    "      }\n"
+    "\n"
+    "      int failed = // died while running it\n"
+    "        strstr(o, \"start\\n\") && ! strstr(o, \"end\\n\") && ! strstr(o, \"done\\n\");\n"
+    "\n"
+    "      if (died && ! strstr(o, \"start\\n\")) (*died)++; // before reaching it\n"
+    "\n"
+    "      for (char *c = o; c && ! failed; c = strchr(c, '\\n'), c = c ? c + 1 : c)\n"
+    "      {\n"
+    "        if (atoi(c) == rdz_bisect) failed = 1;\n"
+    "      }\n"
+    "\n"
+    "      free(o);\n"
+    "\n"
+    "      if (failed && r == -1) r = i;\n"
+    "    }\n"
+    "  }\n"
+    "\n"
+    "  free(fds); free(pids);\n"
+    "\n"
+    "  return r;\n"
+    "}\n"
+    "\n"
+    "void rdz_bisect_run()\n"
+    "{\n"
+    "  // delta debugging (ddmin) over the examples preceding the failing one,\n"
+    "  // the subsets and complements of each round are tried concurrently\n"
+    "\n"
+    "  if (rdz_bisect >= rdz_t->count || rdz_t->types[rdz_bisect] != 'i')\n"
+    "  {\n"
+    "    printf(\"\%sRDZ_BISECT=\%d isn't an example\%s\\n\", rdz_rd(), rdz_bisect, rdz_cl());\n"
+    "    return;\n"
+    "  }\n"
+    "\n"
+    "  char *exe = rdz_self_exe();\n"
+    "\n"
+    "  if (exe == NULL)\n"
+    "  {\n"
+    "    printf(\"\%sRDZ_BISECT couldn't locate the spec executable\%s\\n\", rdz_rd(), rdz_cl());\n"
+    "    return;\n"
+    "  }\n"
+    "\n"
+    "  char *title = rdz_determine_title(rdz_bisect);\n"
+    "\n"
+    "  int *set = calloc(rdz_t->count, sizeof(int));\n"
+    "  size_t len = 0;\n"
+    "\n"
+    "  for (int n = 1; n < rdz_bisect; n++)\n"
+    "  {\n"
+    "    if (rdz_t->types[n] == 'i' && rdz_reachable(n)) set[len++] = n;\n"
+    "  }\n"
+    "  size_t before = len;\n"
+    "\n"
+    "  printf(\"\\nBisect: \%s \%sI=\%d\%s\\n\\n\", title, rdz_gr(), rdz_bisect, rdz_cl());\n"
+    "\n"
+    "  int **sets = calloc(2 * len + 2, sizeof(int *));\n"
+    "  size_t *counts = calloc(2 * len + 2, sizeof(size_t));\n"
+    "  size_t runs = 2;\n"
+    "\n"
+    "  sets[0] = set; counts[0] = 0; // on its own\n"
+    "  sets[1] = set; counts[1] = len; // after all the preceding examples\n"
+    "\n"
+    "  int died = 0;\n"
+    "  int r = rdz_bisect_test(exe, sets, counts, 2, &died);\n"
+    "\n"
+    "  if (r == -2)\n"
+    "  {\n"
+    "    printf(\"  \%scouldn't run \%s\%s\\n\\n\", rdz_rd(), exe, rdz_cl());\n"
+    "    len = 0;\n"
+    "  }\n"
+    "  else if (r == 0)\n"
+    "  {\n"
+    "    printf(\"  fails on its own\\n\\n\");\n"
+    "    len = 0;\n"
+    "  }\n"
+    "  else if (r < 0 && died)\n"
+    "  {\n"
+    "    printf(\n"
+    "      \"  \%sthe run dies before reaching it, \"\n"
+    "      \"an example preceding it crashes on its own\%s\\n\\n\", rdz_rd(), rdz_cl());\n"
+    "    len = 0;\n"
+    "  }\n"
+    "  else if (r < 0)\n"
+    "  {\n"
+    "    printf(\"  doesn't fail after the \%zu examples preceding it\\n\\n\", len);\n"
+    "    len = 0;\n"
+    "  }\n"
+    "\n"
+    "  for (size_t k = 2; len > 1; )\n"
+    "  {\n"
+    "    if (k > len) k = len;\n"
+    "\n"
+    "    size_t sc = 0;\n"
+    "\n"
+    "    for (size_t i = 0; i < k; i++) // subsets\n"
+    "    {\n"
+    "      size_t f = i * len / k, t = (i + 1) * len / k;\n"
+    "      sets[sc] = calloc(t - f + 1, sizeof(int));\n"
+    "      memcpy(sets[sc], set + f, (t - f) * sizeof(int));\n"
+    "      counts[sc++] = t - f;\n"
+    "    }\n"
+    "    for (size_t i = 0; k > 2 && i < k; i++) // complements\n"
+    "    {\n"
+    "      size_t f = i * len / k, t = (i + 1) * len / k;\n"
+    "      sets[sc] = calloc(len - (t - f) + 1, sizeof(int));\n"
+    "      memcpy(sets[sc], set, f * sizeof(int));\n"
+    "      memcpy(sets[sc] + f, set + t, (len - t) * sizeof(int));\n"
+    "      counts[sc++] = len - (t - f);\n"
+    "    }\n"
+    "\n"
+    "    r = rdz_bisect_test(exe, sets, counts, sc, NULL);\n"
+    "    runs += sc;\n"
+    "\n"
+    "    if (r == -2)\n"
+    "    {\n"
+    "      printf(\"  \%scouldn't run \%s\%s\\n\\n\", rdz_rd(), exe, rdz_cl());\n"
+    "      for (size_t i = 0; i < sc; i++) free(sets[i]);\n"
+    "      len = 0; break;\n"
+    "    }\n"
+    "\n"
+    "    printf(\n"
+    "      \"  \%zu examples, \%zu candidates, \%s\\n\",\n"
+    "      len, sc, r < 0 ? \"none fails\" : \"one fails\");\n"
+    "\n"
+    "    if (r > -1)\n"
+    "    {\n"
+    "      memcpy(set, sets[r], counts[r] * sizeof(int));\n"
+    "      len = counts[r];\n"
+    "      k = (size_t)r < k ? 2 : (k > 2 ? k - 1 : 2);\n"
+    "    }\n"
+    "\n"
+    "    for (size_t i = 0; i < sc; i++) free(sets[i]);\n"
+    "\n"
+    "    if (r > -1) continue;\n"
+    "    if (k >= len) break;\n"
+    "    k = k * 2;\n"
+    "  }\n"
+    "\n"
+    "  if (len > 0)\n"
+    "  {\n"
+    "    printf(\n"
+    "      \"\\n  fails after \%zu of the \%zu examples preceding it (\%zu runs):\\n\\n\",\n"
+    "      len, before, runs);\n"
+    "\n"
+    "    for (size_t i = 0; i < len; i++)\n"
+    "    {\n"
+    "      char *t = rdz_determine_title(set[i]);\n"
+    "      printf(\"    \%s \%sL=\%d I=\%d\%s\\n\", t, rdz_gr(), rdz_t->ltstarts[set[i]], set[i], rdz_cl());\n"
+    "      free(t);\n"
+    "    }\n"
+    "\n"
+    "    printf(\"\\n\%smake spec I=\", rdz_rd());\n"
+    "    for (size_t i = 0; i < len; i++) printf(\"\%d,\", set[i]);\n"
+    "    printf(\"\%d\%s\\n\\n\", rdz_bisect, rdz_cl());\n"
+    "  }\n"
+    "\n"
+    "  free(counts); free(sets); free(set); free(title); free(exe);\n"
+    "}\n"
+    "\n"
+    "#else\n"
+    "\n"
+    "static void rdz_bisect_report() {}\n"
+    "void rdz_bisect_run() {}\n"
+    "\n"
+    "#endif // RDZ_WITH_BISECT\n"
+    "\n"
+    "  //\n"
+    "  // RDZ_VALGRIND\n"
+    "\n"
+    "#ifdef RDZ_WITH_MEMCHECK\n"
+    "\n"
+    "static char *rdz_memcheck_parse(char *log)\n"
+    "{\n"
+    "  // \"==123== Invalid read of size 4\" ... \"==123== ERROR SUMMARY: 1 errors\"\n"
+    "  // turned into a short report\n"
+    "\n"
+    "  char *r = NULL; size_t rl = 0;\n"
+    "  FILE *f = open_memstream(&r, &rl);\n"
+    "\n"
+    "  long errors = -1;\n"
+    "  long lost[3] = { 0, 0, 0 };\n"
+    "  char *kinds[3] = { \"definitely lost: \", \"indirectly lost: \", \"possibly lost: \" };\n"
+    "  int blocks = 0; int frame = 0;\n"
+    "\n"
+    "  for (char *l = log; l && *l; )\n"
+    "  {\n"
+    "    char *e = strchr(l, '\\n'); if (e) *e = '\\0';\n"
+    "\n"
+    "    char *c = l;\n"
+    "    if (*c == '=') { c = strchr(c + 2, '='); c = c ? c + 2 : l; if (*c == ' ') c++; }\n"
+    "\n"
+    "    char *k = NULL;\n"
+    "\n"
+    "    if (strncmp(c, \"ERROR SUMMARY: \", 15) == 0)\n"
+    "    {\n"
+    "      errors = atol(c + 15);\n"
+    "    }\n"
+    "    else if ((k = strstr(c, \" lost: \")) != NULL)\n"
+    "    {\n"
+    "      for (size_t i = 0; i < 3; i++)\n"
+    "      {\n"
+    "        char *kk = strstr(c, kinds[i]); if (kk == NULL) continue;\n"
+    "\n"
+    "        long v = 0; // \"1,024 bytes in 2 blocks\"\n"
+    "        for (char *d = kk + strlen(kinds[i]); *d && *d != ' '; d++)\n"
+    "        {\n"
+    "          if (*d >= '0' && *d <= '9') v = v * 10 + (*d - '0');\n"
+    "        }\n"
+    "        lost[i] = v;\n"
+    "      }\n"
+    "    }\n"
+    "    else if (\n"
+    "      strncmp(c, \"Invalid \", 8) == 0 ||\n"
+    "      strncmp(c, \"Conditional jump\", 16) == 0 ||\n"
+    "      strncmp(c, \"Use of uninitialised\", 20) == 0 ||\n"
+    "      strncmp(c, \"Syscall param\", 13) == 0 ||\n"
+    "      strncmp(c, \"Mismatched \", 11) == 0 ||\n"
+    "      strncmp(c, \"Source and destination overlap\", 30) == 0 ||\n"
+    "      strncmp(c, \"Process terminating\", 19) == 0 ||\n"
+    "      strstr(c, \" are definitely lost in loss record\") ||\n"
+    "      strstr(c, \" are possibly lost in loss record\"))\n"
+    "    {\n"
+    "      if (++blocks <= 5) fprintf(f, \"  \%s\\n\", c);\n"
+    "      else if (blocks == 6) fprintf(f, \"  ...\\n\");\n"
+    "      frame = blocks <= 5;\n"
+    "    }\n"
+    "    else if (frame && (strncmp(c, \"   at \", 6) == 0 || strncmp(c, \"   by \", 6) == 0))\n"
+    "    {\n"
+    "      char *fn = strstr(c, \": \"); fn = fn ? fn + 2 : c + 6;\n"
+    "\n"
+    "      if (strstr(fn, \"vg_replace_\") == NULL) // skip malloc() and co\n"
+    "      {\n"
+    "        fprintf(f, \"    at \%s\\n\", fn); frame = 0;\n"
+    "      }\n"
+    "    }\n"
+    "    else if (*c == '\\0')\n"
+    "    {\n"
+    "      frame = 0;\n"
+    "    }\n"
+    "\n"
+    "    l = e ? e + 1 : NULL;\n"
+    "  }\n"
+    "\n"
+    "  fclose(f);\n"
+    "\n"
+    "  char *s = NULL;\n"
+    "\n"
+    "  if (errors < 0)\n"
+    "  {\n"
+    "    s = rdz_strdup(\"memcheck: no report (is valgrind installed?)\\n\");\n"
+    "  }\n"
+    "  else\n"
+    "  {\n"
+    "    char *s0 = NULL; size_t sl = 0;\n"
+    "    FILE *ff = open_memstream(&s0, &sl);\n"
+    "\n"
+    "    fprintf(ff, \"memcheck: \%ld error\%s\", errors, errors == 1 ? \"\" : \"s\");\n"
+    "    for (size_t i = 0; i < 3; i++)\n"
+    "    {\n"
+    "      if (lost[i] > 0) fprintf(ff, \", \%ld bytes \%.*s\", lost[i], (int)strlen(kinds[i]) - 2, kinds[i]);\n"
+    "    }\n"
+    "    fprintf(ff, \"\\n\%s\", r);\n"
+    "    fclose(ff);\n"
+    "\n"
+    "    s = s0;\n"
+    "  }\n"
+    "\n"
+    "  free(r);\n"
+    "\n"
+    "  return s;\n"
+    "}\n"
+    "\n"
+    "static void rdz_memcheck_attach(int n, char *report)\n"
+    "{\n"
+    "  // to the failing result of the example, else to its last result\n"
+    "\n"
+    "  rdz_result *r = NULL;\n"
+    "\n"
+    "  for (int i = 0; i < rdz_count; i++)\n"
+    "  {\n"
+    "    rdz_result *rr = rdz_results + i;\n"
+    "\n"
+    "    if (rr->itnumber != n) continue;\n"
+    "    if (r == NULL || r->success != 0) r = rr;\n"
+    "  }\n"
+    "\n"
+    "  if (r == NULL) { free(report); return; }\n"
+    "\n"
+    "  free(r->memcheck); r->memcheck = report;\n"
+    "}\n"
+    "\n"
+    "void rdz_memcheck_run()\n"
+    "{\n"
+    "  // reruns the failing examples and the ones flagged by rdz_leak_check()\n"
+    "  // under valgrind, one example per process, as many at once as cores\n"
+    "\n"
+    "  int *ns = calloc(rdz_t->count, sizeof(int));\n"
+    "  int nc = 0;\n"
+    "\n"
+    "  for (int n = 0; n < rdz_t->count; n++)\n"
+    "  {\n"
+    "    if (rdz_t->types[n] != 'i') continue;\n"
+    "\n"
+    "    int flagged = rdz_leaky && rdz_leaky[n];\n"
+    "\n"
+    "    for (int i = 0; ! flagged && i < rdz_count; i++)\n"
+    "    {\n"
+    "      flagged = rdz_results[i].itnumber == n && rdz_results[i].success == 0;\n"
+    "    }\n"
+    "\n"
+    "    if (flagged) ns[nc++] = n;\n"
+    "  }\n"
+    "\n"
+    "  char *exe = nc > 0 ? rdz_self_exe() : NULL;\n"
+    "\n"
+    "  long cores = rdz_jobs > 1 ? rdz_jobs : sysconf(_SC_NPROCESSORS_ONLN);\n"
+    "  if (cores < 1) cores = 1;\n"
+    "\n"
+    "  pid_t *pids = calloc(cores, sizeof(pid_t));\n"
+    "  int *fds = calloc(cores, sizeof(int));\n"
+    "\n"
+    "  for (int from = 0; exe && from < nc; from += cores)\n"
+    "  {\n"
+    "    int to = from + cores; if (to > nc) to = nc;\n"
+    "\n"
+    "    fflush(stdout);\n"
+    "\n"
+    "    for (int i = from; i < to; i++)\n"
+    "    {\n"
+    "      int fd = fds[i - from] = rdz_tmpfd(\"vg\", i - from);\n"
+    "\n"
+    "      pids[i - from] = fork();\n"
+    "\n"
+    "      if (pids[i - from] != 0) continue;\n"
+    "\n"
+    "      int dn = open(\"/dev/null\", O_RDWR);\n"
+    "      dup2(dn, 0); dup2(dn, 1); dup2(dn, 2);\n"
+    "\n"
+    "      for (size_t j = 0; rdz_rerun_unset[j]; j++) unsetenv(rdz_rerun_unset[j]);\n"
+    "\n"
+    "      char si[16]; snprintf(si, 16, \"\%d\", ns[i]);\n"
+    "      setenv(\"I\", si, 1);\n"
+    "      char sl[32]; snprintf(sl, 32, \"--log-fd=\%d\", fd);\n"
+    "\n"
+    "      execlp(\n"
+    "        \"valgrind\", \"valgrind\", \"--leak-check=full\", sl, exe, (char *)NULL);\n"
+    "      _exit(127);\n"
+    "    }\n"
+    "\n"
+    "    for (int i = from; i < to; i++)\n"
+    "    {\n"
+    "      if (pids[i - from] > 0) waitpid(pids[i - from], NULL, 0);\n"
+    "\n"
+    "      size_t l = 0; char *o = rdz_read(fds[i - from], &l);\n"
+    "      close(fds[i - from]);\n"
+    "\n"
+    "      rdz_memcheck_attach(ns[i], rdz_memcheck_parse(o));\n"
+    "      free(o);\n"
+    "    }\n"
+    "  }\n"
+    "\n"
+    "  free(fds); free(pids); free(exe); free(ns);\n"
+    "}\n"
+    "\n"
+    "void rdz_memcheck_summary()\n"
+    "{\n"
+    "  int seen = 0;\n"
+    "\n"
+    "  for (int i = 0; i < rdz_count; i++)\n"
+    "  {\n"
+    "    rdz_result *r = rdz_results + i;\n"
+    "\n"
+    "    if (r->memcheck == NULL) continue;\n"
+    "\n"
+    "    if ( ! seen) printf(\"\%sMemcheck:\\n\\n\", rdz_fail_count > 0 ? \"\\n\" : \"\");\n"
+    "    seen = 1;\n"
+    "\n"
+    "    char *title = rdz_determine_title(r->itnumber);\n"
+    "    int clean = strncmp(r->memcheck, \"memcheck: 0 errors\\n\", 19) == 0;\n"
+    "\n"
+    "    printf(\"  \%s\%s\%s\", clean ? \"\" : rdz_rd(), title, rdz_cl());\n"
+    "    printf(\" \%sL=\%d I=\%d\%s\\n\", rdz_gr(), r->ltnumber, r->itnumber, rdz_cl());\n"
+    "\n"
+    "    for (char *l = r->memcheck; *l; ) // indented, line by line\n"
+    "    {\n"
+    "      char *e = strchr(l, '\\n'); size_t ll = e ? (size_t)(e - l) : strlen(l);\n"
+    "      printf(\"     \%s\%.*s\%s\\n\", rdz_cy(), (int)ll, l, rdz_cl());\n"
+    "      l += ll + (e ? 1 : 0);\n"
+    "    }\n"
+    "\n"
+    "    free(title);\n"
+    "  }\n"
+    "\n"
+    "  if (seen) printf(\"\\n\");\n"
+    "}\n"
+    "\n"
+    "#else\n"
+    "\n"
+    "void rdz_memcheck_run() {}\n"
+    "void rdz_memcheck_summary() {}\n"
+    "\n"
+    "#endif // RDZ_WITH_MEMCHECK\n"
+    "\n"
+    "\n"
+    "#ifdef RDZ_WITH_FUZZ // the generated file defines it when needed\n"
+    "\n"
+    "#define RDZ_FUZZ_WORKERS_MAX 64\n"
+    "#define RDZ_FUZZ_LISTED 10\n"
+    "\n"
+    "typedef double rdz_fuzz_func(const uint8_t *data, size_t size);\n"
+    "\n"
+    "typedef struct rdz_fuzz_flag { // an input that failed, crashed or ran too long\n"
+    "  long input;\n"
+    "  char kind[16]; // \"ensure\", \"crash\", \"timeout\" or \"slow\"\n"
+    "  int lnumber;\n"
+    "  int ltnumber;\n"
+    "  char *message;\n"
+    "} rdz_fuzz_flag;\n"
+    "\n"
+    "typedef struct rdz_fuzz_report { // one per fuzz block, for the summary\n"
+    "  int n;\n"
+    "  char *corpus;\n"
+    "  char **paths; // a single NULL path when there is no corpus\n"
+    "  long inputs;\n"
+    "  long execs;\n"
+    "  int workers;\n"
+    "  double duration;\n"
+    "  size_t count;\n"
+    "  size_t size;\n"
+    "  rdz_fuzz_flag *flags;\n"
+    "  struct rdz_fuzz_report *next;\n"
+    "} rdz_fuzz_report;\n"
+    "\n"
+    "typedef struct rdz_fuzz_shared { // mapped, the workers and the parent see it\n"
+    "  long next; // the next input to hand out\n"
+    "  long execs;\n"
+    "  long current[RDZ_FUZZ_WORKERS_MAX]; // the input being run, -1 if none\n"
+    "  volatile double started[RDZ_FUZZ_WORKERS_MAX];\n"
+    "} rdz_fuzz_shared;\n"
+    "\n"
+    "static rdz_fuzz_report *rdz_fuzz_reports = NULL; // pushed from any thread\n"
+    "int rdz_fuzz_entry = 0; // 1 when driven by LLVMFuzzerTestOneInput()\n"
+    "static const uint8_t *rdz_fuzz_data = NULL;\n"
+    "static size_t rdz_fuzz_size = 0;\n"
+    "\n"
+    "static int rdz_fuzz_path_cmp(const void *a, const void *b)\n"
+    "{\n"
+    "  return strcmp(*(char **)a, *(char **)b);\n"
+    "}\n"
+    "\n"
+    "static char **rdz_fuzz_corpus(int n, char **dir, long *count)\n"
+    "{\n"
+    "  // RDZ_CORPUS=dir holding a name/ per fuzz block or directly the inputs,\n"
+    "  // else corpus/name/ next to the spec file\n"
+    "\n"
+    "  char *name = rdz_text(n);\n"
+    "  size_t l = strlen(name);\n"
+    "  struct stat st;\n"
+    "\n"
+    "  if (rdz_corpus)\n"
+    "  {\n"
+    "    *dir = calloc(strlen(rdz_corpus) + l + 2, sizeof(char));\n"
+    "    sprintf(*dir, \"\%s/\%s\", rdz_corpus, name);\n"
+    "    if (stat(*dir, &st) != 0 || ! S_ISDIR(st.st_mode)) strcpy(*dir, rdz_corpus);\n"
+    "  }\n"
+    "  else\n"
+    "  {\n"
+    "    char *f = rdz_fname(n); char *s = strrchr(f, '/');\n"
+    "    int fl = s ? (int)(s - f + 1) : 0;\n"
+    "\n"
+    "    *dir = calloc(fl + l + 8, sizeof(char));\n"
+    "    sprintf(*dir, \"\%.*scorpus/\%s\", fl, f, name);\n"
+    "  }\n"
+    "\n"
+    "  size_t size = 16; *count = 0;\n"
+    "  char **paths = calloc(size, sizeof(char *));\n"
+    "\n"
+    "  DIR *d = opendir(*dir);\n"
+    "  struct dirent *de = NULL;\n"
+    "\n"
+    "  while (d && (de = readdir(d)) != NULL)\n"
+    "  {\n"
+    "    if (de->d_name[0] == '.') continue;\n"
+    "\n"
+    "    char *p = calloc(strlen(*dir) + strlen(de->d_name) + 2, sizeof(char));\n"
+    "    sprintf(p, \"\%s/\%s\", *dir, de->d_name);\n"
+    "\n"
+    "    if (stat(p, &st) != 0 || ! S_ISREG(st.st_mode)) { free(p); continue; }\n"
+    "\n"
+    "    if (*count + 1 >= (long)size)\n"
+    "    {\n"
+    "      size *= 2; paths = realloc(paths, size * sizeof(char *));\n"
+    "    }\n"
+    "    paths[(*count)++] = p;\n"
+    "  }\n"
+    "  if (d) closedir(d);\n"
+    "\n"
+    "  qsort(paths, *count, sizeof(char *), rdz_fuzz_path_cmp);\n"
+    "\n"
+    "  if (*count == 0) { paths[0] = NULL; *count = 1; } // the empty input\n"
+    "\n"
+    "  return paths;\n"
+    "}\n"
+    "\n"
+    "static void rdz_fuzz_work(\n"
+    "  rdz_fuzz_func *f, char **paths, long count,\n"
+    "  rdz_fuzz_shared *sh, int w, int fd)\n"
+    "{\n"
+    "  // a forked worker, takes the next input until there are none left,\n"
+    "  // reports the ones that failed or were slow, \"input kind l lt ml\\nmsg\\n\"\n"
+    "\n"
+    "  rdz_worker = 1;\n"
+    "#ifdef RDZ_CONCURRENT\n"
+    "  rdz_job_current = NULL; // the results stay here\n"
+    "#endif\n"
+    "\n"
+    "  int dn = open(\"/dev/null\", O_WRONLY); dup2(dn, 1); close(dn);\n"
+    "\n"
+    "  while (1)\n"
+    "  {\n"
+    "    long i = __atomic_fetch_add(&sh->next, 1, __ATOMIC_SEQ_CST);\n"
+    "    if (i >= count) break;\n"
+    "\n"
+    "    void *m = NULL; size_t size = 0;\n"
+    "    int ifd = paths[i] ? open(paths[i], O_RDONLY) : -1;\n"
+    "    struct stat st;\n"
+    "\n"
+    "    if (ifd > -1 && fstat(ifd, &st) == 0 && st.st_size > 0)\n"
+    "    {\n"
+    "      size = st.st_size;\n"
+    "      m = mmap(NULL, size, PROT_READ, MAP_PRIVATE, ifd, 0);\n"
+    "      if (m == MAP_FAILED) { m = NULL; size = 0; }\n"
+    "    }\n"
+    "    if (ifd > -1) close(ifd);\n"
+    "\n"
+    "    int rc = rdz_count;\n"
+    "\n"
+    "    sh->started[w] = rdz_now();\n"
+    "    __atomic_store_n(&sh->current[w], i, __ATOMIC_SEQ_CST);\n"
+    "\n"
+    "    f(m ? (const uint8_t *)m : (const uint8_t *)\"\", size);\n"
+    "\n"
+    "    __atomic_store_n(&sh->current[w], -1L, __ATOMIC_SEQ_CST);\n"
+    "    __atomic_fetch_add(&sh->execs, 1, __ATOMIC_SEQ_CST);\n"
+    "\n"
+    "    double du = rdz_duration(sh->started[w]);\n"
+    "\n"
+    "    if (m) munmap(m, size);\n"
+    "\n"
+    "    rdz_result *r = NULL;\n"
+    "    for (int j = rc; r == NULL && j < rdz_count; j++)\n"
+    "    {\n"
+    "      if (rdz_results[j].success == 0) r = rdz_results + j;\n"
+    "    }\n"
+    "\n"
+    "    char h[128]; char slow[128]; char *msg = NULL; int l = 0;\n"
+    "\n"
+    "    if (r)\n"
+    "    {\n"
+    "      msg = r->message;\n"
+    "      l = snprintf(\n"
+    "        h, 128, \"\%ld ensure \%d \%d \%d\\n\",\n"
+    "        i, r->lnumber, r->ltnumber, msg ? (int)strlen(msg) : -1);\n"
+    "    }\n"
+    "    else if (du > rdz_fuzz_timeout)\n"
+    "    {\n"
+    "      msg = slow;\n"
+    "      snprintf(\n"
+    "        slow, 128, \"     took \%.1fms, over the \%.0fms budget\",\n"
+    "        du, rdz_fuzz_timeout);\n"
+    "      l = snprintf(h, 128, \"\%ld slow -1 -1 \%d\\n\", i, (int)strlen(msg));\n"
+    "    }\n"
+    "\n"
+    "    if (l > 0)\n"
+    "    {\n"
+    "      rdz_write(fd, h, l);\n"
+    "      if (msg) rdz_write(fd, msg, strlen(msg));\n"
+    "      rdz_write(fd, \"\\n\", 1);\n"
+    "    }\n"
+    "\n"
+    "    for (int j = rc; j < rdz_count; j++) rdz_result_clear(rdz_results + j);\n"
+    "    rdz_count = rc; rdz_fail_count = 0; rdz_pending_count = 0;\n"
+    "  }\n"
+    "\n"
+    "  _exit(0);\n"
+    "}\n"
+    "\n"
+    "static void rdz_fuzz_flag_add(\n"
+    "  rdz_fuzz_report *rp, long input, const char *kind,\n"
+    "  int lnumber, int ltnumber, char *message)\n"
+    "{\n"
+    "  if (rp->count >= rp->size)\n"
+    "  {\n"
+    "    rp->size = rp->size * 2 + 4;\n"
+    "    rp->flags = realloc(rp->flags, rp->size * sizeof(rdz_fuzz_flag));\n"
+    "  }\n"
+    "\n"
+    "  rdz_fuzz_flag *f = rp->flags + rp->count++;\n"
+    "\n"
+    "  f->input = input;\n"
+    "  snprintf(f->kind, 16, \"\%s\", kind);\n"
+    "  f->lnumber = lnumber < 0 ? rdz_t->lstarts[rp->n] : lnumber;\n"
+    "  f->ltnumber = ltnumber < 0 ? rdz_t->ltstarts[rp->n] : ltnumber;\n"
+    "  f->message = message;\n"
+    "}\n"
+    "\n"
+    "static int rdz_fuzz_flag_cmp(const void *a, const void *b)\n"
+    "{\n"
+    "  long ia = ((rdz_fuzz_flag *)a)->input; long ib = ((rdz_fuzz_flag *)b)->input;\n"
+    "\n"
+    "  return ia < ib ? -1 : ia > ib;\n"
+    "}\n"
+    "\n"
+    "static pid_t rdz_fuzz_spawn(\n"
+    "  rdz_fuzz_func *f, rdz_fuzz_report *rp, rdz_fuzz_shared *sh, int w, int fd)\n"
+    "{\n"
+    "  fflush(stdout);\n"
+    "\n"
+    "  pid_t pid = fork();\n"
+    "  if (pid == 0) rdz_fuzz_work(f, rp->paths, rp->inputs, sh, w, fd);\n"
+    "\n"
+    "  return pid;\n"
+    "}\n"
+    "\n"
+    "double rdz_fuzz_run(int n, rdz_fuzz_func *f)\n"
+    "{\n"
+    "  // replays the corpus through the fuzz block, in forked workers so that\n"
+    "  // a crash or a hang only costs a worker, flags the failing inputs\n"
+    "\n"
+    "  if (rdz_fuzz_entry) return f(rdz_fuzz_data, rdz_fuzz_size);\n"
+    "\n"
+    "  double start = rdz_now();\n"
+    "\n"
+    "  rdz_fuzz_report *rp = calloc(1, sizeof(rdz_fuzz_report));\n"
+    "  rp->n = n;\n"
+    "  rp->paths = rdz_fuzz_corpus(n, &rp->corpus, &rp->inputs);\n"
+    "\n"
+    "  long cores = rdz_jobs > 1 ? rdz_jobs : sysconf(_SC_NPROCESSORS_ONLN);\n"
+    "  if (cores > rp->inputs) cores = rp->inputs;\n"
+    "  if (cores > RDZ_FUZZ_WORKERS_MAX) cores = RDZ_FUZZ_WORKERS_MAX;\n"
+    "  if (cores < 1) cores = 1;\n"
+    "  rp->workers = cores;\n"
+    "\n"
+    "  int sfd = rdz_tmpfd(\"fuzz\", n);\n"
+    "  rdz_fuzz_shared *sh = MAP_FAILED;\n"
+    "  if (sfd > -1 && ftruncate(sfd, sizeof(rdz_fuzz_shared)) == 0)\n"
+    "  {\n"
+    "    sh = mmap(\n"
+    "      NULL, sizeof(rdz_fuzz_shared), PROT_READ | PROT_WRITE, MAP_SHARED, sfd, 0);\n"
+    "  }\n"
+    "  if (sfd > -1) close(sfd);\n"
+    "\n"
+    "  if (sh == MAP_FAILED)\n"
+    "  {\n"
+    "    rdz_record(\n"
+    "      0, rdz_strdup(\"     couldn't map the fuzz workers' shared state\"),\n"
+    "      n, rdz_t->lstarts[n], rdz_t->ltstarts[n]);\n"
+    "    free(rp->corpus); free(rp);\n"
+    "\n"
+    "    return rdz_duration(start);\n"
+    "  }\n"
+    "\n"
+    "  pid_t pids[RDZ_FUZZ_WORKERS_MAX];\n"
+    "  int fds[RDZ_FUZZ_WORKERS_MAX];\n"
+    "  long killed[RDZ_FUZZ_WORKERS_MAX];\n"
+    "\n"
+    "  for (int w = 0; w < cores; w++)\n"
+    "  {\n"
+    "    sh->current[w] = -1; killed[w] = -1;\n"
+    "    fds[w] = rdz_tmpfd(\"fuzzw\", w);\n"
+    "    pids[w] = rdz_fuzz_spawn(f, rp, sh, w, fds[w]);\n"
+    "  }\n"
+    "\n"
+    "  struct timespec ts = { 0, 1000000 }; // 1ms\n"
+    "\n"
+    "  for (int live = cores; live > 0; )\n"
+    "  {\n"
+    "    int idle = 1;\n"
+    "\n"
+    "    for (int w = 0; w < cores; w++)\n"
+    "    {\n"
+    "      if (pids[w] < 1) continue;\n"
+    "\n"
+    "      int status = 0;\n"
+    "\n"
+    "      if (waitpid(pids[w], &status, WNOHANG) == pids[w])\n"
+    "      {\n"
+    "        idle = 0; live--; pids[w] = 0;\n"
+    "\n"
+    "        long i = __atomic_load_n(&sh->current[w], __ATOMIC_SEQ_CST);\n"
+    "        char *msg = calloc(128, sizeof(char));\n"
+    "\n"
+    "        if (i < 0) { free(msg); msg = NULL; }\n"
+    "        else if (killed[w] == i)\n"
+    "        {\n"
+    "          snprintf(\n"
+    "            msg, 128, \"     still running after \%.0fms, killed\",\n"
+    "            rdz_fuzz_timeout);\n"
+    "          rdz_fuzz_flag_add(rp, i, \"timeout\", -1, -1, msg);\n"
+    "        }\n"
+    "        else if (WIFSIGNALED(status))\n"
+    "        {\n"
+    "          snprintf(\n"
+    "            msg, 128, \"     crashed, signal \%d (\%s)\",\n"
+    "            WTERMSIG(status), strsignal(WTERMSIG(status)));\n"
+    "          rdz_fuzz_flag_add(rp, i, \"crash\", -1, -1, msg);\n"
+    "        }\n"
+    "        else\n"
+    "        {\n"
+    "          snprintf(\n"
+    "            msg, 128, \"     exited, status \%d\", WEXITSTATUS(status));\n"
+    "          rdz_fuzz_flag_add(rp, i, \"crash\", -1, -1, msg);\n"
+    "        }\n"
+    "\n"
+    "        sh->current[w] = -1; killed[w] = -1;\n"
+    "\n"
+    "        if (__atomic_load_n(&sh->next, __ATOMIC_SEQ_CST) < rp->inputs)\n"
+    "        {\n"
+    "          pids[w] = rdz_fuzz_spawn(f, rp, sh, w, fds[w]); live++;\n"
+    "        }\n"
+    "      }\n"
+    "      else\n"
+    "      {\n"
+    "        long i = __atomic_load_n(&sh->current[w], __ATOMIC_SEQ_CST);\n"
+    "\n"
+    "        if (\n"
+    "          i > -1 && killed[w] != i &&\n"
+    "          rdz_duration(sh->started[w]) > rdz_fuzz_timeout\n"
+    "        ) {\n"
+    "          kill(pids[w], SIGKILL); killed[w] = i;\n"
+    "        }\n"
+    "      }\n"
+    "    }\n"
+    "\n"
+    "    if (idle) nanosleep(&ts, NULL);\n"
+    "  }\n"
+    "\n"
+    "  for (int w = 0; w < cores; w++)\n"
+    "  {\n"
+    "    size_t l = 0; char *s = rdz_read(fds[w], &l); char *e = s + l;\n"
+    "    close(fds[w]);\n"
+    "\n"
+    "    for (char *ss = s; ss < e; )\n"
+    "    {\n"
+    "      long i; char kind[16]; int lnumber, ltnumber, ml, hl;\n"
+    "      if (sscanf(\n"
+    "        ss, \"\%ld \%15s \%d \%d \%d\%n\",\n"
+    "        &i, kind, &lnumber, &ltnumber, &ml, &hl) < 5) break;\n"
+    "\n"
+    "      ss += hl + 1;\n"
+    "      char *msg = ml > -1 ? rdz_strndup(ss, ml) : NULL;\n"
+    "      ss += (ml > -1 ? ml : 0) + 1;\n"
+    "\n"
+    "      rdz_fuzz_flag_add(rp, i, kind, lnumber, ltnumber, msg);\n"
+    "    }\n"
+    "\n"
+    "    free(s);\n"
+    "  }\n"
+    "\n"
+    "  rp->execs = sh->execs;\n"
+    "  munmap(sh, sizeof(rdz_fuzz_shared));\n"
+    "\n"
+    "  if (rp->count > 0) // the first flagged input becomes the failure\n"
+    "  {\n"
+    "    qsort(rp->flags, rp->count, sizeof(rdz_fuzz_flag), rdz_fuzz_flag_cmp);\n"
+    "      // not before, flags is NULL when nothing got flagged\n"
+    "\n"
+    "    rdz_fuzz_flag *fl = rp->flags;\n"
+    "    char *p = rp->paths[fl->input];\n"
+    "    char *m = fl->message ? fl->message : \"\";\n"
+    "\n"
+    "    char *msg = calloc(strlen(p ? p : \"\") + strlen(m) + 64, sizeof(char));\n"
+    "    sprintf(\n"
+    "      msg, \"     input \%s (\%s)\%s\%s\",\n"
+    "      p ? p : \"(empty)\", fl->kind, *m ? \"\\n\" : \"\", m);\n"
+    "\n"
+    "    rdz_record(0, msg, n, fl->lnumber, fl->ltnumber);\n"
+    "  }\n"
+    "\n"
+    "  rp->duration = rdz_duration(start);\n"
+    "\n"
+    "  rp->next = __atomic_load_n(&rdz_fuzz_reports, __ATOMIC_SEQ_CST);\n"
+    "  while ( ! __atomic_compare_exchange_n(\n"
+    "    &rdz_fuzz_reports, &rp->next, rp, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)\n"
+    "  );\n"
+    "\n"
+    "  return rp->duration;\n"
+    "}\n"
+    "\n"
+    "static int rdz_fuzz_report_cmp(const void *a, const void *b)\n"
+    "{\n"
+    "  return (*(rdz_fuzz_report **)a)->n - (*(rdz_fuzz_report **)b)->n;\n"
+    "}\n"
+    "\n"
+    "void rdz_fuzz_summary(int durations)\n"
+    "{\n"
+    "  if (rdz_fuzz_reports == NULL) return;\n"
+    "\n"
+    "  size_t count = 0;\n"
+    "  for (rdz_fuzz_report *rp = rdz_fuzz_reports; rp; rp = rp->next) count++;\n"
+    "\n"
+    "  rdz_fuzz_report **rps = calloc(count, sizeof(rdz_fuzz_report *));\n"
+    "  count = 0;\n"
+    "  for (rdz_fuzz_report *rp = rdz_fuzz_reports; rp; rp = rp->next) rps[count++] = rp;\n"
+    "\n"
+    "  qsort(rps, count, sizeof(rdz_fuzz_report *), rdz_fuzz_report_cmp);\n"
+    "\n"
+    "  printf(\"\%sFuzz:\\n\\n\", rdz_fail_count > 0 ? \"\\n\" : \"\");\n"
+    "\n"
+    "  for (size_t i = 0; i < count; i++)\n"
+    "  {\n"
+    "    rdz_fuzz_report *rp = rps[i];\n"
+    "    int n = rp->n;\n"
+    "\n"
+    "    char *title = rdz_determine_title(n);\n"
+    "\n"
+    "    printf(\"  \%s\%s\%s\", rp->count ? rdz_rd() : \"\", title, rdz_cl());\n"
+    "    printf(\" \%sL=\%d I=\%d\%s\\n\", rdz_gr(), rdz_t->ltstarts[n], n, rdz_cl());\n"
+    "\n"
+    "    if (rp->paths[0] == NULL)\n"
+    "      printf(\"     no corpus at \%s, replayed the empty input\", rp->corpus);\n"
+    "    else\n"
+    "      printf(\"     \%ld inputs from \%s\", rp->inputs, rp->corpus);\n"
+    "    printf(\", \%zu flagged\", rp->count);\n"
+    "    if (durations && rp->duration > 0.0)\n"
+    "    {\n"
+    "      printf(\n"
+    "        \", \%d workers, \%.0f execs/s\",\n"
+    "        rp->workers, rp->execs / (rp->duration / 1000.0));\n"
+    "    }\n"
+    "    printf(\"\\n\");\n"
+    "\n"
+    "    for (size_t j = 0; j < rp->count; j++)\n"
+    "    {\n"
+    "      rdz_fuzz_flag *fl = rp->flags + j;\n"
+    "      char *p = rp->paths[fl->input];\n"
+    "\n"
+    "      if (j < RDZ_FUZZ_LISTED)\n"
+    "      {\n"
+    "        printf(\"     \%s\%-7s \%s\%s\\n\", rdz_rd(), fl->kind, p ? p : \"(empty)\", rdz_cl());\n"
+    "      }\n"
+    "\n"
+    "      free(fl->message);\n"
+    "    }\n"
+    "    if (rp->count > RDZ_FUZZ_LISTED)\n"
+    "    {\n"
+    "      printf(\"     ... and \%zu more\\n\", rp->count - RDZ_FUZZ_LISTED);\n"
+    "    }\n"
+    "\n"
+    "    for (long j = 0; j < rp->inputs; j++) free(rp->paths[j]);\n"
+    "    free(rp->paths); free(rp->flags); free(rp->corpus); free(rp);\n"
+    "    free(title);\n"
+    "  }\n"
+    "\n"
+    "  printf(\"\\n\");\n"
+    "\n"
+    "  free(rps); rdz_fuzz_reports = NULL;\n"
+    "}\n"
+    "\n"
+    "void rdz_fuzz_init()\n"
+    "{\n"
+    "  // LLVMFuzzerInitialize(), the before alls around the fuzz blocks run once\n"
+    "\n"
+    "  rdz_fuzz_entry = 1;\n"
+    "\n"
+    "  char *done = calloc(rdz_t->count, sizeof(char));\n"
+    "  int *chain = calloc(rdz_t->count, sizeof(int));\n"
+    "\n"
+    "  for (int n = 0; n < rdz_t->count; n++)\n"
+    "  {\n"
+    "    if ( ! (rdz_t->flags[n] & RDZ_F_FUZZ) || ! rdz_doruns[n]) continue;\n"
+    "\n"
+    "    int depth = 0;\n"
+    "    for (int p = rdz_t->parents[n]; p > -1; p = rdz_t->parents[p]) chain[depth++] = p;\n"
+    "\n"
+    "    for (int k = depth - 1; k >= 0; k--)\n"
+    "    {\n"
+    "      int p = chain[k]; if (done[p]) continue;\n"
+    "      done[p] = 1;\n"
+    "\n"
+    "      const int *cs = rdz_children(p);\n"
+    "      for (int i = 0; i < rdz_t->ccounts[p]; i++)\n"
+    "      {\n"
+    "        if (rdz_t->types[cs[i]] == 'B') rdz_call(cs[i]);\n"
+    "      }\n"
+    "    }\n"
+    "  }\n"
+    "\n"
+    "  free(chain); free(done);\n"
+    "}\n"
+    "\n"
+    "int rdz_fuzz_one(const uint8_t *data, size_t size)\n"
+    "{\n"
+    "  // LLVMFuzzerTestOneInput(), a failing ensure aborts, for the fuzzer\n"
+    "  // to keep the input\n"
+    "\n"
+    "  rdz_fuzz_data = data; rdz_fuzz_size = size;\n"
+    "\n"
+    "  for (int n = 0; n < rdz_t->count; n++)\n"
+    "  {\n"
+    "    if ( ! (rdz_t->flags[n] & RDZ_F_FUZZ) || ! rdz_doruns[n]) continue;\n"
+    "\n"
+    "    rdz_run_offlines(rdz_t->parents[n], 'y');\n"
+    "    rdz_call(n);\n"
+    "    rdz_run_offlines(rdz_t->parents[n], 'z');\n"
+    "\n"
+    "    for (int i = 0; i < rdz_count; i++)\n"
+    "    {\n"
+    "      rdz_result *r = rdz_results + i;\n"
+    "\n"
+    "      if (r->success != 0) continue;\n"
+    "\n"
+    "      char *fname = rdz_fname(r->itnumber);\n"
+    "\n"
+    "      fprintf(stderr, \"\\n  \%s\\n\", r->title);\n"
+    "      if (r->message) fprintf(stderr, \"\%s\\n\", r->message);\n"
+    "      fprintf(stderr, \"     # \%s:\%d I=\%d\\n\\n\", fname, r->lnumber, r->itnumber);\n"
+    "\n"
+    "      abort();\n"
+    "    }\n"
+    "\n"
+    "    for (int i = 0; i < rdz_count; i++) rdz_result_clear(rdz_results + i);\n"
+    "    rdz_count = 0; rdz_fail_count = 0;\n"
+    "  }\n"
+    "\n"
+    "  return 0;\n"
+    "}\n"
+    "\n"
+    "#endif // RDZ_WITH_FUZZ\n"
+    "\n"
+    "\n"
+    "#if defined(RDZ_WITH_COMPARE) || defined(RDZ_WITH_BENCH)\n"
+    "\n"
+    "\n"
+    "static double rdz_sqrt(double x)\n"
+    "{\n"
+    "  if (x <= 0.0) return 0.0;\n"
+    "\n"
+    "  double r = x > 1.0 ? x : 1.0;\n"
+    "  for (int i = 0; i < 64; i++) r = 0.5 * (r + x / r);\n"
+    "\n"
+    "  return r;\n"
+    "}\n"
+    "\n"
+    "#ifdef RDZ_WITH_COMPARE\n"
+    "\n"
+    "static double rdz_exp(double x)\n"
+    "{\n"
+    "  if (x < -700.0) return 0.0;\n"
+    "\n"
+    "  int k = (int)(x / 0.6931471805599453);\n"
+    "  double r = x - k * 0.6931471805599453;\n"
+    "\n"
+    "  double s = 1.0; double t = 1.0;\n"
+    "  for (int i = 1; i < 24; i++) { t *= r / i; s += t; }\n"
+    "\n"
+    "  for (; k > 0; k--) s *= 2.0;\n"
+    "  for (; k < 0; k++) s *= 0.5;\n"
+    "\n"
+    "  return s;\n"
+    "}\n"
+    "\n"
+    "static double rdz_erfc(double x) // Numerical Recipes' erfcc, x >= 0\n"
+    "{\n"
+    "  double t = 1.0 / (1.0 + 0.5 * x);\n"
+    "\n"
+    "  return t * rdz_exp(\n"
+    "    -x * x - 1.26551223 + t * (1.00002368 + t * (0.37409196 +\n"
+    "    t * (0.09678418 + t * (-0.18628806 + t * (0.27886807 +\n"
+    "    t * (-1.13520398 + t * (1.48851587 + t * (-0.82215223 +\n"
+    "    t * 0.17087277)))))))));\n"
+    "}\n"
+    "\n"
+    "static unsigned long long rdz_xorshift(unsigned long long *s)\n"
+    "{\n"
+    "  *s ^= *s << 13; *s ^= *s >> 7; *s ^= *s << 17;\n"
+    "\n"
+    "  return *s;\n"
+    "}\n"
+    "\n"
+    "#endif // RDZ_WITH_COMPARE\n"
+    "\n"
+    "static double rdz_median(const double *samples, size_t count, double *tmp)\n"
+    "{\n"
+    "  memcpy(tmp, samples, count * sizeof(double));\n"
+    "  qsort(tmp, count, sizeof(double), rdz_double_cmp);\n"
+    "\n"
+    "  return count \% 2 ? tmp[count / 2] : 0.5 * (tmp[count / 2 - 1] + tmp[count / 2]);\n"
+    "}\n"
+    "\n"
+    "#ifdef RDZ_WITH_COMPARE\n"
+    "\n"
+    "static double rdz_mann_whitney(const double *a, const double *b, size_t n)\n"
+    "{\n"
+    "  // the two-sided p-value of the Mann-Whitney U test, normal approximation\n"
+    "  // with the tie correction, both sides have n samples\n"
+    "\n"
+    "  size_t nn = 2 * n;\n"
+    "  double *ks = calloc(nn, sizeof(double));\n"
+    "\n"
+    "  for (size_t i = 0; i < n; i++) { ks[i] = a[i]; ks[n + i] = b[i]; }\n"
+    "  qsort(ks, nn, sizeof(double), rdz_double_cmp);\n"
+    "\n"
+    "  // the rank of a value is the average position of its run of ties\n"
+    "\n"
+    "  double ra = 0.0; double ties = 0.0;\n"
+    "\n"
+    "  for (size_t i = 0; i < nn; )\n"
+    "  {\n"
+    "    size_t j = i; while (j < nn && ks[j] == ks[i]) j++;\n"
+    "\n"
+    "    double t = (double)(j - i);\n"
+    "    ties += t * t * t - t;\n"
+    "    i = j;\n"
+    "  }\n"
+    "\n"
+    "  for (size_t i = 0; i < n; i++)\n"
+    "  {\n"
+    "    size_t lo = 0, hi = nn; // first position >= a[i]\n"
+    "    while (lo < hi) { size_t m = (lo + hi) / 2; if (ks[m] < a[i]) lo = m + 1; else hi = m; }\n"
+    "    size_t e = lo; // first position > a[i]\n"
+    "    hi = nn;\n"
+    "    while (e < hi) { size_t m = (e + hi) / 2; if (ks[m] <= a[i]) e = m + 1; else hi = m; }\n"
+    "\n"
+    "    ra += 0.5 * (lo + 1 + e); // average of the 1-based ranks lo + 1 .. e\n"
+    "  }\n"
+    "\n"
+    "  free(ks);\n"
+    "\n"
+    "  double dn = (double)n; double dnn = (double)nn;\n"
+    "  double u = ra - dn * (dn + 1.0) / 2.0;\n"
+    "  double mu = dn * dn / 2.0;\n"
+    "  double sigma = rdz_sqrt(dn * dn / 12.0 * ((dnn + 1.0) - ties / (dnn * (dnn - 1.0))));\n"
+    "\n"
+    "  if (sigma <= 0.0) return 1.0;\n"
+    "\n"
+    "  double z = (u > mu ? u - mu : mu - u) - 0.5; if (z < 0.0) z = 0.0;\n"
+    "\n"
+    "  double p = rdz_erfc(z / sigma / 1.4142135623730951);\n"
+    "\n"
+    "  return p > 1.0 ? 1.0 : p;\n"
+    "}\n"
+    "\n"
+    "#endif // RDZ_WITH_COMPARE\n"
+    "\n"
+    "#define RDZ_BENCH_SAMPLES 2000\n"
+    "#define RDZ_BENCH_BOOTSTRAP 200\n"
+    "\n"
+    "#ifdef RDZ_CONCURRENT\n"
+    "__thread\n"
+    "#endif\n"
+    "double rdz_variant_t0 = -1.0;\n"
+    "#ifdef RDZ_CONCURRENT\n"
+    "__thread\n"
+    "#endif\n"
+    "double rdz_variant_t1 = -1.0;\n"
+    "\n"
+    "static double rdz_bench_now() // ns\n"
+    "{\n"
+    "  struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);\n"
+    "\n"
+    "  return 1.0e9 * ts.tv_sec + ts.tv_nsec;\n"
+    "}\n"
+    "\n"
+    "static void rdz_ns_to_s(double ns, char *s, size_t n)\n"
+    "{\n"
+    "  if (ns < 1.0e3) snprintf(s, n, \"\%.1fns\", ns);\n"
+    "  else if (ns < 1.0e6) snprintf(s, n, \"\%.2fus\", ns / 1.0e3);\n"
+    "  else if (ns < 1.0e9) snprintf(s, n, \"\%.2fms\", ns / 1.0e6);\n"
+    "  else snprintf(s, n, \"\%.2fs\", ns / 1.0e9);\n"
+    "}\n"
+    "\n"
+    "int rdz_variant(int variant, int k)\n"
+    "{\n"
+    "  if (variant != k) return 0;\n"
+    "\n"
+    "  rdz_variant_t0 = rdz_bench_now(); // the variant starts\n"
+    "\n"
+    "  return 1;\n"
+    "}\n"
+    "\n"
+    "void rdz_variant_stop()\n"
+    "{\n"
+    "  rdz_variant_t1 = rdz_bench_now(); // the body is over\n"
+    "}\n"
+    "\n"
+    "#endif // RDZ_WITH_COMPARE || RDZ_WITH_BENCH\n"
+    "\n"
+    "#ifdef RDZ_WITH_COMPARE\n"
+    "\n"
+    "typedef double rdz_compare_func(int variant);\n"
+    "\n"
+    "typedef struct rdz_compare_report { // one per compare block, for the summary\n"
+    "  int n;\n"
+    "  const char **names;\n"
+    "  int count;\n"
+    "  int winner;\n"
+    "  long rounds;\n"
+    "  long batch;\n"
+    "  double *medians; // ns, one per variant\n"
+    "  double *ratios; // median of the first variant / median of this one\n"
+    "  double *los; // the 95\% confidence interval of the ratio (bootstrap)\n"
+    "  double *his;\n"
+    "  double *ps; // Mann-Whitney U p-value, against the first variant\n"
+    "  struct rdz_compare_report *next;\n"
+    "} rdz_compare_report;\n"
+    "\n"
+    "static rdz_compare_report *rdz_compare_reports = NULL;\n"
+    "\n"
+    "static double rdz_compare_call(rdz_compare_func *f, int v, int from)\n"
+    "{\n"
+    "  // runs a variant, returns its duration in ns, or -1.0 if it failed\n"
+    "\n"
+    "  rdz_variant_t0 = -1.0; rdz_variant_t1 = -1.0;\n"
+    "\n"
+    "  f(v);\n"
+    "\n"
+    "  for (int i = from; i < rdz_count; i++)\n"
+    "  {\n"
+    "    if (rdz_results[i].success == 0) return -1.0; // keep the failure\n"
+    "  }\n"
+    "  for (int i = from; i < rdz_count; i++) rdz_result_clear(rdz_results + i);\n"
+    "  rdz_count = from;\n"
+    "\n"
+    "  if (rdz_variant_t0 < 0.0 || rdz_variant_t1 < rdz_variant_t0) return 0.0;\n"
+    "\n"
+    "  return rdz_variant_t1 - rdz_variant_t0;\n"
+    "}\n"
+    "\n"
+    "static void rdz_compare_stats(\n"
+    "  rdz_compare_report *rp, double **samples, int v, double *tmp)\n"
+    "{\n"
+    "  long n = rp->rounds;\n"
+    "\n"
+    "  rp->ps[v] = rdz_mann_whitney(samples[0], samples[v], n);\n"
+    "\n"
+    "  // bootstrap the ratio of the medians\n"
+    "\n"
+    "  double *ratios = calloc(RDZ_BENCH_BOOTSTRAP, sizeof(double));\n"
+    "  double *ra = calloc(n, sizeof(double));\n"
+    "  double *rb = calloc(n, sizeof(double));\n"
+    "  unsigned long long seed = 0x9e3779b97f4a7c15ULL + v;\n"
+    "\n"
+    "  for (int i = 0; i < RDZ_BENCH_BOOTSTRAP; i++)\n"
+    "  {\n"
+    "    for (long j = 0; j < n; j++)\n"
+    "    {\n"
+    "      ra[j] = samples[0][rdz_xorshift(&seed) \% n];\n"
+    "      rb[j] = samples[v][rdz_xorshift(&seed) \% n];\n"
+    "    }\n"
+    "    double mb = rdz_median(rb, n, tmp);\n"
+    "    ratios[i] = mb > 0.0 ? rdz_median(ra, n, tmp) / mb : 0.0;\n"
+    "  }\n"
+    "\n"
+    "  qsort(ratios, RDZ_BENCH_BOOTSTRAP, sizeof(double), rdz_double_cmp);\n"
+    "\n"
+    "  rp->los[v] = ratios[RDZ_BENCH_BOOTSTRAP * 25 / 1000];\n"
+    "  rp->his[v] = ratios[RDZ_BENCH_BOOTSTRAP * 975 / 1000 - 1];\n"
+    "\n"
+    "  free(rb); free(ra); free(ratios);\n"
+    "}\n"
+    "\n"
+    "double rdz_compare_run(\n"
+    "  int n, rdz_compare_func *f, const char **names, int count, int winner)\n"
+    "{\n"
+    "  // runs the variants in interleaved rounds (a b b a a b...), so that\n"
+    "  // drift (frequency scaling, caches, neighbours) hits them all alike\n"
+    "\n"
+    "  double start = rdz_now();\n"
+    "  int rc = rdz_count;\n"
+    "\n"
+    "  if (count < 2 || winner < -1)\n"
+    "  {\n"
+    "    rdz_record(\n"
+    "      0, rdz_strdup(count < 2 ?\n"
+    "        \"     compare needs at least two variants\" :\n"
+    "        \"     faster(\\\"...\\\") names none of the variants\"),\n"
+    "      n, rdz_t->lstarts[n], rdz_t->ltstarts[n]);\n"
+    "\n"
+    "    return rdz_duration(start);\n"
+    "  }\n"
+    "\n"
+    "  // warm up and calibrate, a sample is worth at least 10us\n"
+    "\n"
+    "  double slowest = 0.0;\n"
+    "\n"
+    "  for (int v = 0; v < count; v++)\n"
+    "  {\n"
+    "    double ns = rdz_compare_call(f, v, rc);\n"
+    "    if (ns < 0.0) return rdz_duration(start);\n"
+    "    if (ns > slowest) slowest = ns;\n"
+    "  }\n"
+    "\n"
+    "  long batch = slowest < 1.0e4 ? (long)(1.0e4 / (slowest > 1.0 ? slowest : 1.0)) : 1;\n"
+    "  if (batch < 1) batch = 1;\n"
+    "\n"
+    "  long rounds = (long)(rdz_bench_time * 1.0e6 / (count * batch * (slowest > 1.0 ? slowest : 1.0)));\n"
+    "  if (rounds > RDZ_BENCH_SAMPLES) rounds = RDZ_BENCH_SAMPLES;\n"
+    "  if (rounds < 10) rounds = 10;\n"
+    "\n"
+    "  double **samples = calloc(count, sizeof(double *));\n"
+    "  for (int v = 0; v < count; v++) samples[v] = calloc(rounds, sizeof(double));\n"
+    "\n"
+    "  int failed = 0;\n"
+    "\n"
+    "  for (long r = 0; ! failed && r < rounds; r++)\n"
+    "  {\n"
+    "    for (int i = 0; ! failed && i < count; i++)\n"
+    "    {\n"
+    "      int v = (r \% 2) ? count - 1 - i : i;\n"
+    "\n"
+    "      double sum = 0.0;\n"
+    "\n"
+    "      for (long b = 0; b < batch; b++)\n"
+    "      {\n"
+    "        double ns = rdz_compare_call(f, v, rc);\n"
+    "        if (ns < 0.0) { failed = 1; break; }\n"
+    "        sum += ns;\n"
+    "      }\n"
+    "\n"
+    "      samples[v][r] = sum / batch;\n"
+    "    }\n"
+    "  }\n"
+    "\n"
+    "  if (failed)\n"
+    "  {\n"
+    "    for (int v = 0; v < count; v++) free(samples[v]);\n"
+    "    free(samples);\n"
+    "\n"
+    "    return rdz_duration(start);\n"
+    "  }\n"
+    "\n"
+    "  rdz_compare_report *rp = calloc(1, sizeof(rdz_compare_report));\n"
+    "  rp->n = n; rp->names = names; rp->count = count; rp->winner = winner;\n"
+    "  rp->rounds = rounds; rp->batch = batch;\n"
+    "  rp->medians = calloc(count, sizeof(double));\n"
+    "  rp->ratios = calloc(count, sizeof(double));\n"
+    "  rp->los = calloc(count, sizeof(double));\n"
+    "  rp->his = calloc(count, sizeof(double));\n"
+    "  rp->ps = calloc(count, sizeof(double));\n"
+    "\n"
+    "  double *tmp = calloc(rounds, sizeof(double));\n"
+    "\n"
+    "  for (int v = 0; v < count; v++)\n"
+    "  {\n"
+    "    rp->medians[v] = rdz_median(samples[v], rounds, tmp);\n"
+    "  }\n"
+    "  for (int v = 1; v < count; v++)\n"
+    "  {\n"
+    "    rp->ratios[v] = rp->medians[v] > 0.0 ? rp->medians[0] / rp->medians[v] : 0.0;\n"
+    "    rdz_compare_stats(rp, samples, v, tmp);\n"
+    "  }\n"
+    "  rp->ratios[0] = 1.0; rp->los[0] = 1.0; rp->his[0] = 1.0; rp->ps[0] = 1.0;\n"
+    "\n"
+    "  // compare \"x\" faster(\"b\"), b has to be significantly faster than the others\n"
+    "\n"
+    "  for (int v = 0; winner > -1 && v < count; v++)\n"
+    "  {\n"
+    "    if (v == winner) continue;\n"
+    "\n"
+    "    double p = rdz_mann_whitney(samples[winner], samples[v], rounds);\n"
+    "    int faster = rp->medians[winner] < rp->medians[v];\n"
+    "\n"
+    "    if (faster && p < 0.05) continue;\n"
+    "\n"
+    "    char mw[64]; rdz_ns_to_s(rp->medians[winner], mw, 64);\n"
+    "    char mv[64]; rdz_ns_to_s(rp->medians[v], mv, 64);\n"
+    "\n"
+    "    char *msg = calloc(1024, sizeof(char));\n"
+    "    snprintf(\n"
+    "      msg, 1024,\n"
+    "      \"     expected \\\"\%s\\\" to be faster than \\\"\%s\\\" (p < 0.05)\\n\"\n"
+    "      \"          got \%s vs \%s, p=\%.4f\",\n"
+    "      names[winner], names[v], mw, mv, p);\n"
+    "\n"
+    "    rdz_record(0, msg, n, rdz_t->lstarts[n], rdz_t->ltstarts[n]);\n"
+    "\n"
+    "    break;\n"
+    "  }\n"
+    "\n"
+    "  free(tmp);\n"
+    "  for (int v = 0; v < count; v++) free(samples[v]);\n"
+    "  free(samples);\n"
+    "\n"
+    "  rp->next = __atomic_load_n(&rdz_compare_reports, __ATOMIC_SEQ_CST);\n"
+    "  while ( ! __atomic_compare_exchange_n(\n"
+    "    &rdz_compare_reports, &rp->next, rp, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)\n"
+    "  );\n"
+    "\n"
+    "  return rdz_duration(start);\n"
+    "}\n"
+    "\n"
+    "static int rdz_compare_report_cmp(const void *a, const void *b)\n"
+    "{\n"
+    "  return (*(rdz_compare_report **)a)->n - (*(rdz_compare_report **)b)->n;\n"
+    "}\n"
+    "\n"
+    "void rdz_compare_summary(int durations)\n"
+    "{\n"
+    "  if (rdz_compare_reports == NULL) return;\n"
+    "\n"
+    "  size_t count = 0;\n"
+    "  for (rdz_compare_report *rp = rdz_compare_reports; rp; rp = rp->next) count++;\n"
+    "\n"
+    "  rdz_compare_report **rps = calloc(count, sizeof(rdz_compare_report *));\n"
+    "  count = 0;\n"
+    "  for (rdz_compare_report *rp = rdz_compare_reports; rp; rp = rp->next) rps[count++] = rp;\n"
+    "\n"
+    "  qsort(rps, count, sizeof(rdz_compare_report *), rdz_compare_report_cmp);\n"
+    "\n"
+    "  printf(\"\%sCompare:\\n\\n\", rdz_fail_count > 0 ? \"\\n\" : \"\");\n"
+    "\n"
+    "  for (size_t i = 0; i < count; i++)\n"
+    "  {\n"
+    "    rdz_compare_report *rp = rps[i];\n"
+    "    int n = rp->n;\n"
+    "\n"
+    "    char *title = rdz_determine_title(n);\n"
+    "\n"
+    "    printf(\"  \%s\", title);\n"
+    "    printf(\" \%sL=\%d I=\%d\%s\\n\", rdz_gr(), rdz_t->ltstarts[n], n, rdz_cl());\n"
+    "\n"
+    "    for (int v = 0; v < rp->count; v++)\n"
+    "    {\n"
+    "      printf(\"     \%s\", rp->names[v]);\n"
+    "\n"
+    "      if (durations)\n"
+    "      {\n"
+    "        char m[64]; rdz_ns_to_s(rp->medians[v], m, 64);\n"
+    "        int l = strlen(rp->names[v]);\n"
+    "        printf(\"\%*s \%10s\", l < 12 ? 12 - l : 0, \"\", m);\n"
+    "\n"
+    "        double r = rp->ratios[v];\n"
+    "\n"
+    "        if (v == 0)\n"
+    "          printf(\"  \%s(baseline)\%s\", rdz_gr(), rdz_cl());\n"
+    "        else if (r >= 1.0)\n"
+    "          printf(\n"
+    "            \"  \%s\%.2fx faster\%s [\%.2fx, \%.2fx], p=\%.4f\",\n"
+    "            rp->ps[v] < 0.05 ? rdz_gn() : \"\", r, rdz_cl(),\n"
+    "            rp->los[v], rp->his[v], rp->ps[v]);\n"
+    "        else if (r > 0.0)\n"
+    "          printf(\n"
+    "            \"  \%s\%.2fx slower\%s [\%.2fx, \%.2fx], p=\%.4f\",\n"
+    "            rp->ps[v] < 0.05 ? rdz_rd() : \"\", 1.0 / r, rdz_cl(),\n"
+    "            rp->his[v] > 0.0 ? 1.0 / rp->his[v] : 0.0,\n"
+    "            rp->los[v] > 0.0 ? 1.0 / rp->los[v] : 0.0, rp->ps[v]);\n"
+    "      }\n"
+    "      printf(\"\\n\");\n"
+    "    }\n"
+    "\n"
+    "    if (durations)\n"
+    "    {\n"
+    "      printf(\n"
+    "        \"     \%s\%ld interleaved rounds, \%ld call\%s per sample\%s\\n\",\n"
+    "        rdz_gr(), rp->rounds, rp->batch, rp->batch > 1 ? \"s\" : \"\", rdz_cl());\n"
+    "    }\n"
+    "\n"
+    "    free(rp->medians); free(rp->ratios); free(rp->los); free(rp->his);\n"
+    "    free(rp->ps); free(rp);\n"
+    "    free(title);\n"
+    "  }\n"
+    "\n"
+    "  printf(\"\\n\");\n"
+    "\n"
+    "  free(rps); rdz_compare_reports = NULL;\n"
+    "}\n"
+    "\n"
+    "#endif // RDZ_WITH_COMPARE\n"
+    "\n"
+    "\n"
+    "#ifdef RDZ_WITH_BENCH\n"
+    "\n"
+    "#define RDZ_BENCH_SIZES 64\n"
+    "#define RDZ_BENCH_MODELS 5\n"
+    "\n"
+    "static const char *rdz_bench_models[] = { \"1\", \"log n\", \"n\", \"n log n\", \"n^2\" };\n"
+    "\n"
+    "static double rdz_log2(double x) // x >= 1\n"
+    "{\n"
+    "  int e = 0; while (x >= 2.0) { x *= 0.5; e++; }\n"
+    "\n"
+    "  // log2(x) for x in [1, 2), via atanh: ln(x) = 2 * atanh((x - 1) / (x + 1))\n"
+    "\n"
+    "  double y = (x - 1.0) / (x + 1.0); double yy = y * y;\n"
+    "  double s = 0.0; double t = y;\n"
+    "  for (int i = 1; i < 40; i += 2) { s += t / i; t *= yy; }\n"
+    "\n"
+    "  return e + 2.0 * s / 0.6931471805599453;\n"
+    "}\n"
+    "\n"
+    "static double rdz_bench_model(int m, double n)\n"
+    "{\n"
+    "  if (n < 1.0) n = 1.0;\n"
+    "  double l = rdz_log2(n); if (l < 1.0) l = 1.0;\n"
+    "\n"
+    "  if (m == 1) return l;\n"
+    "  if (m == 2) return n;\n"
+    "  if (m == 3) return n * l;\n"
+    "  if (m == 4) return n * n;\n"
+    "  return 1.0;\n"
+    "}\n"
+    "\n"
+    "static int rdz_bench_parse_model(const char *s)\n"
+    "{\n"
+    "  // \"n log n\", \"O(n log n)\", \"n^2\", \"n²\", \"1\"..., returns -1 if unknown\n"
+    "\n"
+    "  char *c = calloc(strlen(s) + 1, sizeof(char)); size_t l = 0;\n"
+    "\n"
+    "  for (const char *ss = s; *ss; ss++) // lowercase, no spaces\n"
+    "  {\n"
+    "    if (*ss == ' ' || *ss == '\\t') continue;\n"
+    "    c[l++] = (*ss >= 'A' && *ss <= 'Z') ? *ss + 32 : *ss;\n"
+    "  }\n"
+    "  if (l > 3 && c[0] == 'o' && c[1] == '(' && c[l - 1] == ')')\n"
+    "  {\n"
+    "    memmove(c, c + 2, l - 3); c[l - 3] = '\\0';\n"
+    "  }\n"
+    "\n"
+    "  int r = -1;\n"
+    "  if (strcmp(c, \"1\") == 0) r = 0;\n"
+    "  else if (strcmp(c, \"logn\") == 0) r = 1;\n"
+    "  else if (strcmp(c, \"n\") == 0) r = 2;\n"
+    "  else if (strcmp(c, \"nlogn\") == 0) r = 3;\n"
+    "  else if (strcmp(c, \"n^2\") == 0 || strcmp(c, \"n\\xc2\\xb2\") == 0) r = 4;\n"
+    "\n"
+    "  free(c);\n"
+    "\n"
+    "  return r;\n"
+    "}\n"
+    "\n"
+    "typedef double rdz_bench_func(size_t n);\n"
+    "\n"
+    "typedef struct rdz_bench_report { // one per benchmark block, for the summary\n"
+    "  int n;\n"
+    "  size_t count;\n"
+    "  size_t sizes[RDZ_BENCH_SIZES];\n"
+    "  double medians[RDZ_BENCH_SIZES]; // ns, one per size\n"
+    "  double inters[RDZ_BENCH_MODELS]; // t ~ inter + coef * model(n)\n"
+    "  double coefs[RDZ_BENCH_MODELS];\n"
+    "  double rmss[RDZ_BENCH_MODELS]; // root mean square error / mean time\n"
+    "  int best;\n"
+    "  long rounds;\n"
+    "  struct rdz_bench_report *next;\n"
+    "} rdz_bench_report;\n"
+    "\n"
+    "static rdz_bench_report *rdz_bench_reports = NULL;\n"
+    "\n"
+    "int rdz_measure()\n"
+    "{\n"
+    "  return rdz_variant(0, 0); // the timing starts here, the setup is excluded\n"
+    "}\n"
+    "\n"
+    "static double rdz_bench_call(rdz_bench_func *f, size_t size, int from)\n"
+    "{\n"
+    "  // runs the body for a size, returns its duration in ns, or -1.0 if it failed\n"
+    "\n"
+    "  rdz_variant_t0 = -1.0; rdz_variant_t1 = -1.0;\n"
+    "\n"
+    "  double start = rdz_bench_now();\n"
+    "\n"
+    "  f(size);\n"
+    "\n"
+    "  double end = rdz_bench_now();\n"
+    "\n"
+    "  for (int i = from; i < rdz_count; i++)\n"
+    "  {\n"
+    "    if (rdz_results[i].success == 0) return -1.0; // keep the failure\n"
+    "  }\n"
+    "  for (int i = from; i < rdz_count; i++) rdz_result_clear(rdz_results + i);\n"
+    "  rdz_count = from;\n"
+    "\n"
+    "  if (rdz_variant_t0 < 0.0) return end - start; // no measure { ... }\n"
+    "  if (rdz_variant_t1 < rdz_variant_t0) return 0.0;\n"
+    "\n"
+    "  return rdz_variant_t1 - rdz_variant_t0;\n"
+    "}\n"
+    "\n"
+    "static void rdz_bench_fit(rdz_bench_report *rp)\n"
+    "{\n"
+    "  // least squares, t ~ a + c * f(n), the intercept a absorbs the per call\n"
+    "  // overhead (timer, setup...) which would else pass for O(1) or O(log n),\n"
+    "  // the error is relative to the mean time so that the models compare\n"
+    "\n"
+    "  double n = rp->count;\n"
+    "  double mt = 0.0;\n"
+    "  for (size_t i = 0; i < rp->count; i++) mt += rp->medians[i];\n"
+    "  mt /= n;\n"
+    "\n"
+    "  double least = -1.0;\n"
+    "\n"
+    "  for (int m = 0; m < RDZ_BENCH_MODELS; m++)\n"
+    "  {\n"
+    "    double mf = 0.0;\n"
+    "    for (size_t i = 0; i < rp->count; i++) mf += rdz_bench_model(m, rp->sizes[i]);\n"
+    "    mf /= n;\n"
+    "\n"
+    "    double tf = 0.0; double ff = 0.0;\n"
+    "\n"
+    "    for (size_t i = 0; i < rp->count; i++)\n"
+    "    {\n"
+    "      double f = rdz_bench_model(m, rp->sizes[i]) - mf;\n"
+    "      tf += (rp->medians[i] - mt) * f; ff += f * f;\n"
+    "    }\n"
+    "\n"
+    "    double c = ff > 0.0 ? tf / ff : 0.0;\n"
+    "    double a = mt - c * mf;\n"
+    "\n"
+    "    if (c < 0.0) { c = 0.0; a = mt; } // getting faster, a constant then\n"
+    "    if (a < 0.0) // no negative overhead, through the origin then\n"
+    "    {\n"
+    "      tf = 0.0; ff = 0.0;\n"
+    "      for (size_t i = 0; i < rp->count; i++)\n"
+    "      {\n"
+    "        double f = rdz_bench_model(m, rp->sizes[i]);\n"
+    "        tf += rp->medians[i] * f; ff += f * f;\n"
+    "      }\n"
+    "      a = 0.0; c = ff > 0.0 ? tf / ff : 0.0;\n"
+    "    }\n"
+    "\n"
+    "    double e = 0.0;\n"
+    "\n"
+    "    for (size_t i = 0; i < rp->count; i++)\n"
+    "    {\n"
+    "      double d = rp->medians[i] - a - c * rdz_bench_model(m, rp->sizes[i]);\n"
+    "      e += d * d;\n"
+    "    }\n"
+    "\n"
+    "    rp->inters[m] = a;\n"
+    "    rp->coefs[m] = c;\n"
+    "    rp->rmss[m] = mt > 0.0 ? rdz_sqrt(e / n) / mt : 0.0;\n"
+    "\n"
+    "    if (least < 0.0 || rp->rmss[m] < least) least = rp->rmss[m];\n"
+    "  }\n"
+    "\n"
+    "  // the simplest model that fits about as well as the best one,\n"
+    "  // a flat curve is O(1) even if O(n^2) with a tiny c fits it a tad better\n"
+    "\n"
+    "  for (rp->best = 0; rp->best < RDZ_BENCH_MODELS - 1; rp->best++)\n"
+    "  {\n"
+    "    if (rp->rmss[rp->best] <= least * 1.25 + 0.01) break;\n"
+    "  }\n"
+    "}\n"
+    "\n"
+    "double rdz_benchmark_run(\n"
+    "  int n, rdz_bench_func *f,\n"
+    "  size_t from, size_t to, double step, char op, const char *complexity)\n"
+    "{\n"
+    "  // runs the body for each size, until its share of RDZ_BENCH_TIME is spent,\n"
+    "  // keeps the median per size and fits the medians against O(1) .. O(n^2)\n"
+    "\n"
+    "  double start = rdz_now();\n"
+    "  int rc = rdz_count;\n"
+    "\n"
+    "  int expected = complexity ? rdz_bench_parse_model(complexity) : -1;\n"
+    "\n"
+    "  if (\n"
+    "    from > to || (op == '*' && step <= 1.0) || (op == '+' && step < 1.0) ||\n"
+    "    (complexity && expected < 0)\n"
+    "  ) {\n"
+    "    char *msg = calloc(1024, sizeof(char));\n"
+    "    if (complexity && expected < 0)\n"
+    "      snprintf(\n"
+    "        msg, 1024,\n"
+    "        \"     unknown complexity(\\\"\%s\\\"), \"\n"
+    "        \"expected one of 1, log n, n, n log n, n^2\", complexity);\n"
+    "    else\n"
+    "      snprintf(\n"
+    "        msg, 1024,\n"
+    "        \"     sizes(\%zu .. \%zu, \%c\%g) doesn't go anywhere\", from, to, op == '+' ? '+' : 'x', step);\n"
+    "\n"
+    "    rdz_record(0, msg, n, rdz_t->lstarts[n], rdz_t->ltstarts[n]);\n"
+    "\n"
+    "    return rdz_duration(start);\n"
+    "  }\n"
+    "\n"
+    "  rdz_bench_report *rp = calloc(1, sizeof(rdz_bench_report));\n"
+    "  rp->n = n;\n"
+    "\n"
+    "  for (double s = from; s <= to && rp->count < RDZ_BENCH_SIZES; )\n"
+    "  {\n"
+    "    rp->sizes[rp->count++] = (size_t)s;\n"
+    "    s = op == '+' ? s + step : s * step;\n"
+    "  }\n"
+    "\n"
+    "  // the sizes are run in interleaved rounds (up, then down, then up...),\n"
+    "  // so that drift (frequency scaling, noisy neighbours) hits them all alike\n"
+    "  // instead of bending the curve\n"
+    "\n"
+    "  size_t sc = rp->count;\n"
+    "  double *samples = calloc(sc * RDZ_BENCH_SAMPLES, sizeof(double));\n"
+    "  double *tmp = calloc(RDZ_BENCH_SAMPLES, sizeof(double));\n"
+    "\n"
+    "  for (size_t i = 0; i < sc; i++) // warm up\n"
+    "  {\n"
+    "    if (rdz_bench_call(f, rp->sizes[i], rc) < 0.0) goto _over;\n"
+    "  }\n"
+    "\n"
+    "  long rounds = 0; double t0 = rdz_bench_now();\n"
+    "\n"
+    "  while (\n"
+    "    rounds < RDZ_BENCH_SAMPLES &&\n"
+    "    (rounds < 3 || rdz_bench_now() - t0 < rdz_bench_time * 1.0e6)\n"
+    "  ) {\n"
+    "    for (size_t j = 0; j < sc; j++)\n"
+    "    {\n"
+    "      size_t i = (rounds \% 2) ? sc - 1 - j : j;\n"
+    "\n"
+    "      double ns = rdz_bench_call(f, rp->sizes[i], rc);\n"
+    "      if (ns < 0.0) goto _over;\n"
+    "\n"
+    "      samples[i * RDZ_BENCH_SAMPLES + rounds] = ns;\n"
+    "    }\n"
+    "    rounds++;\n"
+    "  }\n"
+    "\n"
+    "  for (size_t i = 0; i < sc; i++)\n"
+    "  {\n"
+    "    rp->medians[i] = rdz_median(samples + i * RDZ_BENCH_SAMPLES, rounds, tmp);\n"
+    "  }\n"
+    "  rp->rounds = rounds;\n"
+    "\n"
+    "  rdz_bench_fit(rp);\n"
+    "\n"
+    "  // complexity(\"n log n\"), the best fit may not be worse than that, unless\n"
+    "  // n log n fits nearly as well (noise easily swaps close classes)\n"
+    "\n"
+    "  if (\n"
+    "    expected > -1 && rp->count > 1 && rp->best > expected &&\n"
+    "    rp->rmss[expected] > 2.0 * rp->rmss[rp->best] + 0.05\n"
+    "  )\n"
+    "  {\n"
+    "    char d[16]; rdz_duration_to_s(0.0, d); // not under RDZ_NO_DURATION\n"
+    "\n"
+    "    char *msg = calloc(1024, sizeof(char));\n"
+    "    int l = snprintf(\n"
+    "      msg, 1024,\n"
+    "      \"     expected at most O(\%s), got O(\%s)\",\n"
+    "      rdz_bench_models[expected], rdz_bench_models[rp->best]);\n"
+    "    if (*d) snprintf(\n"
+    "      msg + l, 1024 - l,\n"
+    "      \"\\n          rms \%.1f\%\% for O(\%s) vs \%.1f\%\% for O(\%s)\",\n"
+    "      100.0 * rp->rmss[rp->best], rdz_bench_models[rp->best],\n"
+    "      100.0 * rp->rmss[expected], rdz_bench_models[expected]);\n"
+    "\n"
+    "    rdz_record(0, msg, n, rdz_t->lstarts[n], rdz_t->ltstarts[n]);\n"
+    "  }\n"
+    "\n"
+    "  free(tmp); free(samples);\n"
+    "\n"
+    "  rp->next = __atomic_load_n(&rdz_bench_reports, __ATOMIC_SEQ_CST);\n"
+    "  while ( ! __atomic_compare_exchange_n(\n"
+    "    &rdz_bench_reports, &rp->next, rp, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)\n"
+    "  );\n"
+    "\n"
+    "  return rdz_duration(start);\n"
+    "\n"
+    "_over: // a failure, no report\n"
+    "\n"
+    "  free(tmp); free(samples); free(rp);\n"
+    "\n"
+    "  return rdz_duration(start);\n"
+    "}\n"
+    "\n"
+    "static int rdz_bench_report_cmp(const void *a, const void *b)\n"
+    "{\n"
+    "  return (*(rdz_bench_report **)a)->n - (*(rdz_bench_report **)b)->n;\n"
+    "}\n"
+    "\n"
+    "void rdz_benchmark_summary(int durations)\n"
+    "{\n"
+    "  if (rdz_bench_reports == NULL) return;\n"
+    "\n"
+    "  size_t count = 0;\n"
+    "  for (rdz_bench_report *rp = rdz_bench_reports; rp; rp = rp->next) count++;\n"
+    "\n"
+    "  rdz_bench_report **rps = calloc(count, sizeof(rdz_bench_report *));\n"
+    "  count = 0;\n"
+    "  for (rdz_bench_report *rp = rdz_bench_reports; rp; rp = rp->next) rps[count++] = rp;\n"
+    "\n"
+    "  qsort(rps, count, sizeof(rdz_bench_report *), rdz_bench_report_cmp);\n"
+    "\n"
+    "  printf(\"\%sBenchmark:\\n\\n\", rdz_fail_count > 0 ? \"\\n\" : \"\");\n"
+    "\n"
+    "  for (size_t i = 0; i < count; i++)\n"
+    "  {\n"
+    "    rdz_bench_report *rp = rps[i];\n"
+    "    int n = rp->n;\n"
+    "\n"
+    "    char *title = rdz_determine_title(n);\n"
+    "\n"
+    "    printf(\"  \%s\", title);\n"
+    "    printf(\" \%sL=\%d I=\%d\%s\\n\", rdz_gr(), rdz_t->ltstarts[n], n, rdz_cl());\n"
+    "\n"
+    "    for (size_t j = 0; j < rp->count; j++)\n"
+    "    {\n"
+    "      printf(\"     n=\%zu\", rp->sizes[j]);\n"
+    "\n"
+    "      if (durations)\n"
+    "      {\n"
+    "        char m[64]; rdz_ns_to_s(rp->medians[j], m, 64);\n"
+    "        char s[32]; snprintf(s, 32, \"\%zu\", rp->sizes[j]);\n"
+    "        int l = strlen(s);\n"
+    "        printf(\"\%*s \%10s\", l < 10 ? 10 - l : 0, \"\", m);\n"
+    "      }\n"
+    "      printf(\"\\n\");\n"
+    "    }\n"
+    "\n"
+    "    if (durations && rp->count > 1)\n"
+    "    {\n"
+    "      int b = rp->best;\n"
+    "      size_t l = rp->count - 1;\n"
+    "\n"
+    "      char a[64]; rdz_ns_to_s(rp->inters[b], a, 64);\n"
+    "      char c[64]; rdz_ns_to_s(rp->coefs[b], c, 64);\n"
+    "      if (rp->coefs[b] < 1.0) snprintf(c, 64, \"\%.3gns\", rp->coefs[b]);\n"
+    "      double pe = rp->medians[l] / rp->sizes[l];\n"
+    "      char e[64]; rdz_ns_to_s(pe, e, 64);\n"
+    "      if (pe < 1.0) snprintf(e, 64, \"\%.3gns\", pe);\n"
+    "\n"
+    "      printf(\n"
+    "        \"     best fit \%sO(\%s)\%s, ~\%s + \%s x \%s, rms \%.1f\%\%, \%s per element at n=\%zu\\n\",\n"
+    "        rdz_gn(), rdz_bench_models[b], rdz_cl(),\n"
+    "        a, c, rdz_bench_models[b], 100.0 * rp->rmss[b], e, rp->sizes[l]);\n"
+    "\n"
+    "      printf(\"     \%s\", rdz_gr());\n"
+    "      for (int m = 0; m < RDZ_BENCH_MODELS; m++)\n"
+    "      {\n"
+    "        printf(\n"
+    "          \"\%sO(\%s) \%.1f\%\%\",\n"
+    "          m > 0 ? \", \" : \"\", rdz_bench_models[m], 100.0 * rp->rmss[m]);\n"
+    "      }\n"
+    "      printf(\"\%s\\n\", rdz_cl());\n"
+    "    }\n"
+    "\n"
+    "    if (durations)\n"
+    "    {\n"
+    "      printf(\"     \%s\%ld interleaved rounds\%s\\n\", rdz_gr(), rp->rounds, rdz_cl());\n"
+    "    }\n"
+    "\n"
+    "    free(rp);\n"
+    "    free(title);\n"
+    "  }\n"
+    "\n"
+    "  printf(\"\\n\");\n"
+    "\n"
+    "  free(rps); rdz_bench_reports = NULL;\n"
+    "}\n"
+    "\n"
+    "#endif // RDZ_WITH_BENCH\n"
+    "\n"
+    "void rdz_run()\n"
+    "{\n"
+    "  if (rdz_list) { rdz_list_nodes(); return; }\n"
+    "\n"
+    "  if (rdz_durations && ! rdz_remote)\n"
+    "  {\n"
+    "    rdz_ran = calloc(rdz_t->count, sizeof(double));\n"
+    "    for (int i = 0; i < rdz_t->count; i++) rdz_ran[i] = -1.0;\n"
+    "  }\n"
+    "\n"
+    "  rdz_sample_start();\n"
+    "\n"
+    "  if (rdz_coordinator) rdz_coordinate();\n"
+    "  else if (rdz_remote) rdz_work();\n"
+    "  else if (rdz_bisect > -1) rdz_bisect_run();\n"
+    "  else if (rdz_repeat > 1 || rdz_until_fail) rdz_repeat_run();\n"
+    "  else if (rdz_valgrind)\n"
+    "  {\n"
+    "#ifdef RDZ_LEAKS\n"
+    "    rdz_leaky = calloc(rdz_t->count, sizeof(char));\n"
+    "#endif\n"
+    "    rdz_dorun(0);\n"
+    "    rdz_memcheck_run();\n"
+    "    free(rdz_leaky); rdz_leaky = NULL;\n"
+    "  }\n"
+    "  else rdz_dorun(0);\n"
+    "\n"
+    "  rdz_sample_stop();\n"
+    "  rdz_durations_save();\n"
+    "  rdz_trace_write();\n"
+    "\n"
+    "  if (rdz_bisect_fd > -1) rdz_bisect_report();\n"
+    "\n"
+    "  free(rdz_ran); rdz_ran = NULL;\n"
+    "}\n"
+    "\n"
+    "char *rdz_read_line(char *fname, int lnumber)\n"
+    "{\n"
+    "  char *l = calloc(1024, sizeof(char));\n"
+    "  char *ll = l;\n"
+    "\n"
+    "  FILE *in = fopen(fname, \"r\");\n"
+    "\n"
+    "  if (in == NULL)\n"
+    "  {\n"
+    "    fprintf(stderr, \"cannot find source file \%s\\n\", fname);\n"
+    "    exit(1);\n"
+    "  }\n"
+    "\n"
+    "  while(1)\n"
+    "  {\n"
+    "    if (lnumber < 1) break;\n"
+    "    char c = fgetc(in);\n"
+    "    if (c == EOF) break;\n"
+    "    if (c == '\\n') { lnumber--; continue; }\n"
+    "    if (lnumber == 1) *(ll++) = c;\n"
+    "  }\n"
+    "  fclose(in);\n"
+    "\n"
+    "  return l;\n"
+    "}\n"
+    "\n"
+    "void rdz_summary(int itcount, double duration)\n"
+    "{\n"
+    "  if (rdz_list || rdz_bisect > -1) return;\n"
+    "\n"
+    "  printf(\"\\n\");\n"
+    "\n"
+    "  if (rdz_pending_count > 0)\n"
+    "  {\n"
+    "    printf(\"Pending:\\n\");\n"
+    "\n"
+    "    for (int i = 0; i < rdz_count; i++)\n"
+    "    {\n"
+    "      rdz_result *r = rdz_results + i;\n"
+    "\n"
+    "      if (r->success != -1) continue;\n"
+    "\n"
+    "      char *fname = rdz_fname(r->itnumber);\n"
+    "\n"
+    "      printf(\"  \%s\%s\%s\\n\", rdz_yl(), r->title, rdz_cl());\n"
+    "      printf(\"   \%s# \%s\%s\\n\", rdz_cy(), r->message, rdz_cl());\n"
+    "      printf(\"   \%s# \%s:\%d\", rdz_cy(), fname, r->lnumber);\n"
+    "      printf(\" \%sL=\%d I=\%d\%s\\n\", rdz_gr(), r->ltnumber, r->itnumber, rdz_cl());\n"
+    "    }\n"
+    "\n"
+    "    printf(\"\\n\");\n"
+    "  }\n"
+    "\n"
+    "  if (rdz_fail_count > 0)\n"
+    "  {\n"
+    "    printf(\"Failures:\\n\\n\");\n"
+    "\n"
+    "    for (int i = 0, j = 0; i < rdz_count; i++)\n"
+    "    {\n"
+    "      rdz_result *r = rdz_results + i;\n"
+    "\n"
+    "      if (r->success != 0) continue;\n"
+    "\n"
+    "      char *fname = rdz_fname(r->itnumber);\n"
+    "\n"
+    "      char *line = rdz_read_line(fname, r->lnumber);\n"
+    "      printf(\"  \%d) \%s\\n\", ++j, r->title);\n"
+    "      if (r->message) { printf(\"\%s\%s\%s\\n\", rdz_rd(), r->message, rdz_cl()); }\n"
+    "      printf(\"     >\");\n"
+    "      printf(\"\%s\%s\%s\", rdz_rd(), line, rdz_cl());\n"
+    "      printf(\"<\\n\");\n"
+    "      printf(\"     \%s# \%s:\%d\%s\", rdz_cy(), fname, r->lnumber, rdz_cl());\n"
+    "      printf(\" \%sL=\%d I=\%d\%s\\n\", rdz_gr(), r->ltnumber, r->itnumber, rdz_cl());\n"
+    "      free(line);\n"
+    "    }\n"
+    "  }\n"
+    "\n"
+    "  char sdu[80]; rdz_duration_to_s(duration, sdu);\n"
+    "\n"
+    "#ifdef RDZ_CONCURRENT\n"
+    "  rdz_stress_summary(*sdu != 0); // ops/s vary, not shown under RDZ_NO_DURATION\n"
+    "#endif\n"
+    "  rdz_repeat_summary(*sdu != 0);\n"
+    "  rdz_sample_summary();\n"
+    "  rdz_memcheck_summary();\n"
+    "#ifdef RDZ_WITH_FUZZ\n"
+    "  rdz_fuzz_summary(*sdu != 0);\n"
+    "#endif\n"
+    "#ifdef RDZ_WITH_COMPARE\n"
+    "  rdz_compare_summary(*sdu != 0);\n"
+    "#endif\n"
+    "#ifdef RDZ_WITH_BENCH\n"
+    "  rdz_benchmark_summary(*sdu != 0);\n"
+    "#endif\n"
+    "\n"
+    "  printf(\"\\n\");\n"
+    "  printf(\"\%s\%d examples, \", rdz_fail_count > 0 ? rdz_rd() : rdz_gn(), itcount);\n"
+    "  printf(\"\%d tests seen, \", rdz_count - rdz_pending_count);\n"
+    "  printf(\"\%d failures\", rdz_fail_count);\n"
+    "  if (rdz_pending_count > 0) printf(\", \%d pending\", rdz_pending_count);\n"
+    "  if (rdz_snap_written > 0) printf(\", \%d snapshots written\", rdz_snap_written);\n"
+    "  if (rdz_snap_updated > 0) printf(\", \%d snapshots updated\", rdz_snap_updated);\n"
+    "  if (*sdu != 0) printf(\"  \%s\%s\", rdz_gr(), sdu);\n"
+    "  if (*sdu != 0 && rdz_conc_wall > 0.0)\n"
+    "  {\n"
+    "    printf(\"(concurrent x\%.2f) \", rdz_conc_work / rdz_conc_wall);\n"
+    "  }\n"
+    "  printf(\"\%s\\n\", rdz_cl());\n"
+    "  printf(\"\\n\");\n"
+    "\n"
+    "  if (rdz_fail_count > 0)\n"
+    "  {\n"
+    "    printf(\"Failed examples:\\n\\n\");\n"
+    "\n"
+    "    for (int i = 0; i < rdz_count; i++)\n"
+    "    {\n"
+    "      rdz_result *r = rdz_results + i;\n"
+    "\n"
+    "      if (r->success != 0) continue;\n"
+    "\n"
+    "      printf(\"\%smake spec I=\%d\", rdz_rd(), r->itnumber);\n"
+    "      printf(\" \%s# \%s\%s\\n\", rdz_cy(), r->title, rdz_cl());\n"
+    "    }\n"
+    "\n"
+    "    printf(\"\\n\");\n"
+    "  }\n"
+    "\n"
+    "  //printf(\"\%s\%s\%s\\n\", rdz_gr(), sdu, rdz_cl());\n"
+    "  //printf(\"\\n\");\n"
+    "}\n"
+    "\n"
+    , out);
+}